@@ -93,13 +93,13 @@ std::string PrintTypeDoc(
   {
     return "A data matrix filename.  The file can be CSV (.csv), TSV (.csv), "
         "ASCII (space-separated values, .txt), Armadillo ASCII (.txt), PGM "
-        "(.pgm), PPM (.ppm), Armadillo binary (.bin), or HDF5 (.h5, .hdf, "
-        ".hdf5, or .he5), if mlpack was compiled with HDF5 support.  The type "
-        "of the data is detected by the extension of the filename.  The storage"
-        " should be such that one row corresponds to one point, and one column "
-        "corresponds to one dimension (this is the typical storage format for "
-        "on-disk data).  All values of the matrix will be loaded as double-"
-        "precision floating point data.";
+        "(.pgm), PPM (.ppm), Armadillo binary (.bin), mlpack memory-mappable "
+        "binary (.mbin), or HDF5 (.h5, .hdf, .hdf5, or .he5), if mlpack was "
+        "compiled with HDF5 support.  The type of the data is detected by the "
+        "extension of the filename.  The storage should be such that one row "
+        "corresponds to one point, and one column corresponds to one dimension "
+        "(this is the typical storage format for on-disk data).  All values of "
+        "the matrix will be loaded as double-precision floating point data.";
   }
   else if (std::is_same<T, arma::Mat<size_t>>::value)
   {
@@ -107,12 +107,13 @@ std::string PrintTypeDoc(
         "integer values.  This type is often used for labels or indices.  The "
         "file can be CSV (.csv), TSV (.csv), ASCII (space-separated values, "
         ".txt), Armadillo ASCII (.txt), PGM (.pgm), PPM (.ppm), Armadillo "
-        "binary (.bin), or HDF5 (.h5, .hdf, .hdf5, or .he5), if mlpack was "
-        "compiled with HDF5 support.  The type of the data is detected by the "
-        "extension of the filename.  The storage should be such that one row "
-        "corresponds to one point, and one column corresponds to one dimension "
-        "(this is the typical storage format for on-disk data).  All values of "
-        "the matrix will be loaded as unsigned integers.";
+        "binary (.bin), mlpack memory-mappable binary (.mbin), or HDF5 (.h5, "
+        ".hdf, .hdf5, or .he5), if mlpack was compiled with HDF5 support.  The "
+        "type of the data is detected by the extension of the filename.  The "
+        "storage should be such that one row corresponds to one point, and one "
+        "column corresponds to one dimension (this is the typical storage "
+        "format for on-disk data).  All values of the matrix will be loaded as "
+        "unsigned integers.";
   }
   else if (std::is_same<T, arma::rowvec>::value ||
            std::is_same<T, arma::vec>::value)
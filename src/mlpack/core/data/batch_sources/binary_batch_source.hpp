@@ -0,0 +1,107 @@
+/**
+ * @file binary_batch_source.hpp
+ *
+ * A batch source that reads blocks of points from a memory-mappable binary
+ * matrix file (.mbin) with regular file reads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_SOURCES_BINARY_BATCH_SOURCE_HPP
+#define MLPACK_CORE_DATA_BATCH_SOURCES_BINARY_BATCH_SOURCE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/mapped_matrix.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * BinaryBatchSource reads contiguous blocks of points from a file in mlpack's
+ * memory-mappable binary format (see data::SaveMapped()), which must have been
+ * saved with the default transpose setting so that each point is stored
+ * contiguously.  Each block is read with a single seek and read, so only the
+ * requested block is ever held in memory.  This is useful where mmap() is not
+ * available or when the page cache should not be filled with the dataset; in
+ * other cases, MappedBatchSource avoids the copy.
+ *
+ * @tparam eT Type of element held in the file.
+ */
+template<typename eT = double>
+class BinaryBatchSource
+{
+ public:
+  //! The type of element held by each block.
+  typedef eT ElemType;
+
+  /**
+   * Open the given file and read its header.  Throws std::runtime_error if the
+   * file cannot be opened or is not a valid file for element type eT.
+   *
+   * @param filename Name of the .mbin file.
+   */
+  BinaryBatchSource(const std::string& filename) : filename(filename)
+  {
+    size_t fileSize;
+    if (!details::ReadMappedMatrixHeader<eT>(filename, stream, header,
+        fileSize, false))
+    {
+      std::ostringstream oss;
+      oss << "BinaryBatchSource: cannot read '" << filename << "'.";
+      throw std::runtime_error(oss.str());
+    }
+  }
+
+  //! Get the number of points in the file.
+  size_t NumPoints() const { return header.nCols; }
+  //! Get the dimensionality of the points in the file.
+  size_t Dimensionality() const { return header.nRows; }
+
+  /**
+   * Read the points [begin, begin + count) into the given matrix, one point
+   * per column.
+   *
+   * @param begin Index of first point to read.
+   * @param count Number of points to read.
+   * @param block Matrix to store the points in.
+   */
+  void Block(const size_t begin, const size_t count, arma::Mat<eT>& block)
+  {
+    if (begin + count > header.nCols)
+    {
+      std::ostringstream oss;
+      oss << "BinaryBatchSource::Block(): requested points " << begin << " to "
+          << (begin + count) << ", but file '" << filename << "' holds only "
+          << header.nCols << " points.";
+      throw std::invalid_argument(oss.str());
+    }
+
+    block.set_size(header.nRows, count);
+    stream.clear();
+    stream.seekg(header.dataOffset + begin * header.nRows * sizeof(eT),
+        std::ios::beg);
+    if (!stream.read(reinterpret_cast<char*>(block.memptr()),
+        block.n_elem * sizeof(eT)))
+    {
+      std::ostringstream oss;
+      oss << "BinaryBatchSource::Block(): reading from '" << filename
+          << "' failed.";
+      throw std::runtime_error(oss.str());
+    }
+  }
+
+ private:
+  //! Name of the file.
+  std::string filename;
+  //! Stream for reading the file.
+  std::ifstream stream;
+  //! Header of the file.
+  MappedMatrixHeader header;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * @file csv_batch_source.hpp
+ *
+ * A batch source that reads blocks of points from a numeric CSV file, without
+ * loading the whole file.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_SOURCES_CSV_BATCH_SOURCE_HPP
+#define MLPACK_CORE_DATA_BATCH_SOURCES_CSV_BATCH_SOURCE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/extension.hpp>
+
+#include <cerrno>
+#include <cstdlib>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * CSVBatchSource reads contiguous blocks of points from a numeric CSV, TSV or
+ * text file, where each line of the file is one point (as data::Load() expects
+ * by default).  The file is scanned once when the source is created to find
+ * the number of points and the position of every IndexStride()-th line; after
+ * that, only the lines of the requested block are read and parsed.
+ *
+ * Like the other batch sources (BinaryBatchSource and MappedBatchSource), this
+ * class provides NumPoints(), Dimensionality() and Block(), and can be used
+ * with StreamingFunction to optimize over a dataset that does not fit in
+ * memory.  For repeated passes over a large dataset, converting it once to the
+ * .mbin format with data::Save() and using MappedBatchSource is much faster.
+ *
+ * @tparam eT Type of element to load.
+ */
+template<typename eT = double>
+class CSVBatchSource
+{
+ public:
+  //! The type of element held by each block.
+  typedef eT ElemType;
+
+  /**
+   * Open the given file and scan it.  Throws std::runtime_error if the file
+   * cannot be opened.
+   *
+   * @param filename Name of the file; the delimiter is chosen by its extension
+   *     (.csv, .tsv or .txt).
+   * @param indexStride Remember the position of every indexStride-th line.
+   */
+  CSVBatchSource(const std::string& filename, const size_t indexStride = 64) :
+      filename(filename),
+      stream(filename.c_str(), std::ios::in | std::ios::binary),
+      dimensionality(0),
+      numPoints(0),
+      indexStride(std::max(indexStride, (size_t) 1))
+  {
+    if (!stream.is_open())
+    {
+      std::ostringstream oss;
+      oss << "CSVBatchSource: cannot open file '" << filename << "'.";
+      throw std::runtime_error(oss.str());
+    }
+
+    const std::string extension = Extension(filename);
+    delimiter = (extension == "tsv") ? '\t' :
+        ((extension == "txt") ? ' ' : ',');
+
+    // Scan the file to count the points and index the lines.
+    std::string line;
+    size_t offset = 0;
+    while (std::getline(stream, line))
+    {
+      if (numPoints % this->indexStride == 0)
+        lineOffsets.push_back(offset);
+      if (numPoints == 0)
+        dimensionality = CountTokens(line);
+
+      offset += line.size() + 1;
+      ++numPoints;
+    }
+  }
+
+  //! Get the number of points in the file.
+  size_t NumPoints() const { return numPoints; }
+  //! Get the dimensionality of the points in the file.
+  size_t Dimensionality() const { return dimensionality; }
+  //! Get the stride of the line index.
+  size_t IndexStride() const { return indexStride; }
+
+  /**
+   * Read the points [begin, begin + count) into the given matrix, one point
+   * per column.  Throws std::runtime_error if a line is malformed.
+   *
+   * @param begin Index of first point to read.
+   * @param count Number of points to read.
+   * @param block Matrix to store the points in.
+   */
+  void Block(const size_t begin, const size_t count, arma::Mat<eT>& block)
+  {
+    if (begin + count > numPoints)
+    {
+      std::ostringstream oss;
+      oss << "CSVBatchSource::Block(): requested points " << begin << " to "
+          << (begin + count) << ", but file '" << filename << "' holds only "
+          << numPoints << " points.";
+      throw std::invalid_argument(oss.str());
+    }
+
+    block.set_size(dimensionality, count);
+    if (count == 0)
+      return;
+
+    // Skip to the first line of the block from the nearest indexed line.
+    stream.clear();
+    stream.seekg(lineOffsets[begin / indexStride], std::ios::beg);
+    std::string line;
+    for (size_t i = (begin / indexStride) * indexStride; i < begin; ++i)
+      std::getline(stream, line);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (!std::getline(stream, line))
+      {
+        std::ostringstream oss;
+        oss << "CSVBatchSource::Block(): cannot read line " << (begin + i)
+            << " of file '" << filename << "'.";
+        throw std::runtime_error(oss.str());
+      }
+
+      ParseLine(line, begin + i, block.colptr(i));
+    }
+  }
+
+ private:
+  //! Return whether c separates values.
+  bool IsSeparator(const char c) const
+  {
+    return (c == delimiter || c == ' ' || c == '\t' || c == '\r');
+  }
+
+  //! Count the values on the given line.
+  size_t CountTokens(const std::string& line) const
+  {
+    size_t tokens = 0;
+    const char* p = line.c_str();
+    while (*p != '\0')
+    {
+      while (*p != '\0' && IsSeparator(*p))
+        ++p;
+      if (*p == '\0')
+        break;
+
+      ++tokens;
+      while (*p != '\0' && !IsSeparator(*p))
+        ++p;
+    }
+
+    return tokens;
+  }
+
+  //! Parse dimensionality values from the given line into out.
+  void ParseLine(const std::string& line, const size_t index, eT* out) const
+  {
+    const char* p = line.c_str();
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      while (*p != '\0' && IsSeparator(*p))
+        ++p;
+
+      char* end;
+      errno = 0;
+      const double value = std::strtod(p, &end);
+      if (end == p || errno == ERANGE || (*end != '\0' && !IsSeparator(*end)))
+      {
+        std::ostringstream oss;
+        oss << "CSVBatchSource::Block(): cannot parse dimension " << d
+            << " of line " << index << " of file '" << filename << "'.";
+        throw std::runtime_error(oss.str());
+      }
+
+      out[d] = eT(value);
+      p = end;
+    }
+  }
+
+  //! Name of the file.
+  std::string filename;
+  //! Stream for reading the file.
+  std::ifstream stream;
+  //! Character that separates values.
+  char delimiter;
+  //! Number of values on each line.
+  size_t dimensionality;
+  //! Number of lines in the file.
+  size_t numPoints;
+  //! Stride of the line index.
+  size_t indexStride;
+  //! Byte offset of every indexStride-th line.
+  std::vector<size_t> lineOffsets;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
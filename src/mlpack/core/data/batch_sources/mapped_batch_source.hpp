@@ -0,0 +1,118 @@
+/**
+ * @file mapped_batch_source.hpp
+ *
+ * A batch source that maps a memory-mappable binary matrix file (.mbin) into
+ * memory and hands out blocks of it without copying.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_SOURCES_MAPPED_BATCH_SOURCE_HPP
+#define MLPACK_CORE_DATA_BATCH_SOURCES_MAPPED_BATCH_SOURCE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/mapped_matrix.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * MappedBatchSource maps a file in mlpack's memory-mappable binary format into
+ * memory with data::LoadMapped(), and returns blocks of points as matrices that
+ * use the mapped memory directly.  Pages of the file are read by the operating
+ * system as they are touched, and can be evicted again under memory pressure,
+ * so the dataset may be larger than the available memory.  Block() also asks
+ * the operating system to start reading the block ahead of time, so calling it
+ * for the next block in a background thread (as StreamingFunction does) hides
+ * the latency of the disk.
+ *
+ * On systems without mmap(), the whole file is loaded into memory instead.
+ *
+ * @tparam eT Type of element held in the file.
+ */
+template<typename eT = double>
+class MappedBatchSource
+{
+ public:
+  //! The type of element held by each block.
+  typedef eT ElemType;
+
+  /**
+   * Map the given file into memory.  Throws std::runtime_error if the file
+   * cannot be mapped.
+   *
+   * @param filename Name of the .mbin file.
+   */
+  MappedBatchSource(const std::string& filename)
+  {
+    if (!LoadMapped(filename, matrix, false, true))
+    {
+      std::ostringstream oss;
+      oss << "MappedBatchSource: cannot map '" << filename << "'.";
+      throw std::runtime_error(oss.str());
+    }
+  }
+
+  //! Release the mapping.
+  ~MappedBatchSource() { Unmap(matrix); }
+
+  //! Get the number of points in the file.
+  size_t NumPoints() const { return matrix.n_cols; }
+  //! Get the dimensionality of the points in the file.
+  size_t Dimensionality() const { return matrix.n_rows; }
+
+  //! Get the whole mapped dataset.
+  const arma::Mat<eT>& Dataset() const { return matrix; }
+
+  /**
+   * Make the given matrix an alias of the points [begin, begin + count).  The
+   * block must not be used after the source is destroyed.  Writes to the block
+   * are never written to the file.
+   *
+   * @param begin Index of first point.
+   * @param count Number of points.
+   * @param block Matrix to make an alias of the points.
+   */
+  void Block(const size_t begin, const size_t count, arma::Mat<eT>& block)
+  {
+    if (begin + count > matrix.n_cols)
+    {
+      std::ostringstream oss;
+      oss << "MappedBatchSource::Block(): requested points " << begin << " to "
+          << (begin + count) << ", but the file holds only " << matrix.n_cols
+          << " points.";
+      throw std::invalid_argument(oss.str());
+    }
+
+    if (count == 0)
+    {
+      block.set_size(matrix.n_rows, 0);
+      return;
+    }
+
+    eT* mem = matrix.colptr(begin);
+    #ifndef _WIN32
+      // Ask for the pages of this block to be read ahead.  This is only a hint,
+      // so failures don't matter.
+      const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+      char* start = (char*) (((size_t) mem / pageSize) * pageSize);
+      const size_t length = ((char*) (mem + matrix.n_rows * count)) - start;
+      madvise(start, length, MADV_WILLNEED);
+    #endif
+
+    // Moving the alias into the block makes the block use the same memory.
+    arma::Mat<eT> alias(mem, matrix.n_rows, count, false, false);
+    block = std::move(alias);
+  }
+
+ private:
+  //! The mapped dataset.
+  arma::Mat<eT> matrix;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,369 @@
+/**
+ * @file streaming_function.hpp
+ *
+ * A decomposable function wrapper that evaluates a function on a dataset that
+ * is read block by block from a batch source, so that the dataset never has to
+ * be held in memory at once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_SOURCES_STREAMING_FUNCTION_HPP
+#define MLPACK_CORE_DATA_BATCH_SOURCES_STREAMING_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/log.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * StreamingFunction presents a separable (decomposable) objective function to
+ * the ensmallen optimizers that take batches, such as SGD and its variants,
+ * while only keeping one block of the dataset in memory at a time.  The
+ * dataset is read from a batch source (CSVBatchSource, BinaryBatchSource or
+ * MappedBatchSource) in blocks of BlockSize() points; for each block, a
+ * FunctionType is constructed on that block, and every batch asked for by the
+ * optimizer is evaluated by the FunctionType of the block (or blocks) that it
+ * falls in.  While a block is being used, the next one is read by a background
+ * thread, so that reading the data overlaps with the optimization.
+ *
+ * The responses (labels) are assumed to be small enough to be held in memory.
+ *
+ * FunctionType must be constructible as FunctionType(predictors, responses,
+ * args...), and must provide Shuffle() and the separable Evaluate() and
+ * Gradient() overloads; its separable EvaluateWithGradient() is used if it
+ * exists.  This is the case for, e.g., LogisticRegressionFunction,
+ * SoftmaxRegressionFunction and LinearSVMFunction:
+ *
+ * @code
+ * // Convert the dataset once; then it can be mapped without loading it.
+ * data::MappedBatchSource<> source("dataset.mbin");
+ * data::StreamingFunction<LogisticRegressionFunction<>,
+ *     data::MappedBatchSource<>> f(source, labels, 100000, lambda);
+ *
+ * arma::mat parameters(1, source.Dimensionality() + 1, arma::fill::zeros);
+ * ens::SGD<> sgd(0.01, 64);
+ * sgd.Optimize(f, parameters);
+ * @endcode
+ *
+ * Shuffle() shuffles the order of the blocks and then shuffles the points
+ * inside each block as it is loaded, which keeps the reads sequential.  Since
+ * each FunctionType only sees its own block, any term that FunctionType
+ * normalizes by its number of points (such as the regularization term of
+ * LogisticRegressionFunction) is normalized by the block size instead; scale
+ * the regularization parameter by BlockSize() / NumFunctions() to get the same
+ * objective as a FunctionType built on the whole dataset.
+ *
+ * @tparam FunctionType Separable function to optimize.
+ * @tparam SourceType Batch source to read the predictors from.
+ * @tparam ResponsesType Type of the responses.
+ */
+template<typename FunctionType,
+         typename SourceType,
+         typename ResponsesType = arma::Row<size_t>>
+class StreamingFunction
+{
+ public:
+  //! The type of element of the predictors.
+  typedef typename SourceType::ElemType ElemType;
+
+  /**
+   * Construct the StreamingFunction on the given source.  Neither the source
+   * nor the responses are copied, so they must outlive this object.
+   *
+   * @param source Source of the predictors.
+   * @param responses Responses for every point of the source.
+   * @param blockSize Number of points in each block.
+   * @param args Additional arguments for the constructor of FunctionType.
+   */
+  template<typename... Args>
+  StreamingFunction(SourceType& source,
+                    const ResponsesType& responses,
+                    const size_t blockSize,
+                    const Args&... args) :
+      source(source),
+      responses(responses),
+      blockSize(std::max(blockSize, (size_t) 1)),
+      numBlocks((source.NumPoints() + this->blockSize - 1) / this->blockSize),
+      shuffled(false),
+      currentPosition(numBlocks),
+      prefetchedBlock(numBlocks),
+      builder([args...](const arma::Mat<ElemType>& predictors,
+                        const ResponsesType& blockResponses)
+          {
+            return new FunctionType(predictors, blockResponses, args...);
+          })
+  {
+    if (responses.n_cols != source.NumPoints())
+    {
+      Log::Fatal << "StreamingFunction::StreamingFunction(): the source holds "
+          << source.NumPoints() << " points, but " << responses.n_cols
+          << " responses were given!" << std::endl;
+    }
+
+    blockOrder.set_size(numBlocks);
+    for (size_t k = 0; k < numBlocks; ++k)
+      blockOrder[k] = k;
+    ComputeStarts();
+  }
+
+  //! Wait for any block that is still being read.
+  ~StreamingFunction()
+  {
+    if (prefetch.valid())
+      prefetch.wait();
+  }
+
+  //! Shuffle the order of the blocks, and the points inside every block.
+  void Shuffle()
+  {
+    blockOrder = arma::shuffle(blockOrder);
+    ComputeStarts();
+    shuffled = true;
+
+    // The current block has to be shuffled again.
+    function.reset();
+    currentPosition = numBlocks;
+  }
+
+  //! Return the number of separable functions (the number of points).
+  size_t NumFunctions() const { return source.NumPoints(); }
+  //! Return the number of points in each block.
+  size_t BlockSize() const { return blockSize; }
+  //! Return the number of blocks.
+  size_t NumBlocks() const { return numBlocks; }
+
+  /**
+   * Evaluate the function for the points [begin, begin + batchSize) of the
+   * current order.
+   *
+   * @param parameters Parameters to evaluate at.
+   * @param begin First point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize = 1)
+  {
+    double objective = 0.0;
+    for (size_t i = begin; i < begin + batchSize; )
+    {
+      const size_t count = Prepare(i, begin + batchSize);
+      objective += function->Evaluate(parameters, i - starts[currentPosition],
+          count);
+      i += count;
+    }
+
+    return objective;
+  }
+
+  /**
+   * Evaluate the gradient of the function for the points
+   * [begin, begin + batchSize) of the current order.
+   *
+   * @param parameters Parameters to evaluate at.
+   * @param begin First point of the batch.
+   * @param gradient Matrix to store the gradient in.
+   * @param batchSize Number of points in the batch.
+   */
+  template<typename GradType>
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                GradType& gradient,
+                const size_t batchSize = 1)
+  {
+    GradType blockGradient;
+    for (size_t i = begin; i < begin + batchSize; )
+    {
+      const size_t count = Prepare(i, begin + batchSize);
+      function->Gradient(parameters, i - starts[currentPosition],
+          (i == begin) ? gradient : blockGradient, count);
+      if (i != begin)
+        gradient += blockGradient;
+      i += count;
+    }
+  }
+
+  /**
+   * Evaluate the function and its gradient for the points
+   * [begin, begin + batchSize) of the current order.
+   *
+   * @param parameters Parameters to evaluate at.
+   * @param begin First point of the batch.
+   * @param gradient Matrix to store the gradient in.
+   * @param batchSize Number of points in the batch.
+   */
+  template<typename GradType>
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              GradType& gradient,
+                              const size_t batchSize = 1)
+  {
+    double objective = 0.0;
+    GradType blockGradient;
+    for (size_t i = begin; i < begin + batchSize; )
+    {
+      const size_t count = Prepare(i, begin + batchSize);
+      objective += CallEvaluateWithGradient(*function, parameters,
+          i - starts[currentPosition], (i == begin) ? gradient : blockGradient,
+          count, 0);
+      if (i != begin)
+        gradient += blockGradient;
+      i += count;
+    }
+
+    return objective;
+  }
+
+  //! Get the function built on the current block (NULL if there is none).
+  FunctionType* Function() { return function.get(); }
+
+ private:
+  //! Call f.EvaluateWithGradient(), if FunctionType has it.
+  template<typename GradType>
+  static auto CallEvaluateWithGradient(FunctionType& f,
+                                       const arma::mat& parameters,
+                                       const size_t begin,
+                                       GradType& gradient,
+                                       const size_t batchSize,
+                                       const int /* preferred */)
+      -> decltype(f.EvaluateWithGradient(parameters, begin, gradient,
+          batchSize))
+  {
+    return f.EvaluateWithGradient(parameters, begin, gradient, batchSize);
+  }
+
+  //! Otherwise, call f.Evaluate() and f.Gradient().
+  template<typename GradType>
+  static double CallEvaluateWithGradient(FunctionType& f,
+                                         const arma::mat& parameters,
+                                         const size_t begin,
+                                         GradType& gradient,
+                                         const size_t batchSize,
+                                         const long /* fallback */)
+  {
+    f.Gradient(parameters, begin, gradient, batchSize);
+    return f.Evaluate(parameters, begin, batchSize);
+  }
+
+  //! Compute the first point of every block in the current order.
+  void ComputeStarts()
+  {
+    starts.set_size(numBlocks + 1);
+    starts[0] = 0;
+    for (size_t k = 0; k < numBlocks; ++k)
+      starts[k + 1] = starts[k] + BlockPoints(blockOrder[k]);
+  }
+
+  //! Return the number of points in the given block of the source.
+  size_t BlockPoints(const size_t block) const
+  {
+    return std::min(blockSize, source.NumPoints() - block * blockSize);
+  }
+
+  /**
+   * Make sure the block holding point i of the current order is loaded, and
+   * return the number of points of [i, end) that are in that block.
+   */
+  size_t Prepare(const size_t i, const size_t end)
+  {
+    if (currentPosition == numBlocks || i < starts[currentPosition] ||
+        i >= starts[currentPosition + 1])
+    {
+      const size_t position = std::upper_bound(starts.begin(), starts.end(),
+          i) - starts.begin() - 1;
+      Load(position);
+    }
+
+    return std::min(end, (size_t) starts[currentPosition + 1]) - i;
+  }
+
+  //! Load the block at the given position of the current order.
+  void Load(const size_t position)
+  {
+    // The old function may refer to the memory of the old block.
+    function.reset();
+
+    const size_t block = blockOrder[position];
+    bool loaded = false;
+    if (prefetch.valid())
+    {
+      prefetch.get();
+      if (prefetchedBlock == block)
+      {
+        predictors = std::move(nextPredictors);
+        loaded = true;
+      }
+    }
+
+    if (!loaded)
+      source.Block(block * blockSize, BlockPoints(block), predictors);
+
+    blockResponses = responses.cols(block * blockSize,
+        block * blockSize + BlockPoints(block) - 1);
+    function.reset(builder(predictors, blockResponses));
+    if (shuffled)
+      function->Shuffle();
+    currentPosition = position;
+
+    // Start reading the next block of the current order.
+    if (numBlocks > 1)
+    {
+      prefetchedBlock = blockOrder[(position + 1) % numBlocks];
+      prefetch = std::async(std::launch::async, [this]()
+          {
+            source.Block(prefetchedBlock * blockSize,
+                BlockPoints(prefetchedBlock), nextPredictors);
+          });
+    }
+  }
+
+  //! The source of the predictors.
+  SourceType& source;
+  //! The responses.
+  const ResponsesType& responses;
+  //! The number of points in each block.
+  size_t blockSize;
+  //! The number of blocks.
+  size_t numBlocks;
+  //! Whether or not Shuffle() has been called.
+  bool shuffled;
+
+  //! The order in which the blocks are visited.
+  arma::Col<size_t> blockOrder;
+  //! The first point of every block in the current order.
+  arma::Col<size_t> starts;
+
+  //! The position of the loaded block in the current order.
+  size_t currentPosition;
+  //! The predictors of the loaded block.
+  arma::Mat<ElemType> predictors;
+  //! The responses of the loaded block.
+  ResponsesType blockResponses;
+  //! The function built on the loaded block.
+  std::unique_ptr<FunctionType> function;
+
+  //! The block being read in the background.
+  size_t prefetchedBlock;
+  //! The predictors of the block being read in the background.
+  arma::Mat<ElemType> nextPredictors;
+  //! The task reading the next block.
+  std::future<void> prefetch;
+
+  //! Builds a FunctionType on a block.
+  std::function<FunctionType*(const arma::Mat<ElemType>&,
+                              const ResponsesType&)> builder;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
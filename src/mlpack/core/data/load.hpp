@@ -41,6 +41,7 @@ namespace data /** Functions to load and save matrices and models. */ {
  *  - Raw binary (raw_binary), denoted by .bin
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5, denoted by .hdf, .hdf5, .h5, or .he5
+ *  - mlpack memory-mappable binary, denoted by .mbin
  *
  * If the file extension is not one of those types, an error will be given.
  * This is preferable to Armadillo's default behavior of loading an unknown
@@ -53,6 +54,10 @@ namespace data /** Functions to load and save matrices and models. */ {
  * mlpack requires column-major matrices, this should be left at its default
  * value of 'true'.
  *
+ * Memory-mappable binary files (.mbin) are mapped into memory instead of being
+ * read when 'transpose' is true, and the matrix uses the mapped memory
+ * directly; see LoadMapped() and Unmap() for details.
+ *
  * @param filename Name of file to load.
  * @param matrix Matrix to load contents of file into.
  * @param fatal If an error should be reported as fatal (default false).
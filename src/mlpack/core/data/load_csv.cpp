@@ -3,7 +3,7 @@
  * @author Tham Ngap Wei
  * @author Mehul Kumar Nirala
  *
- * A CSV reader that uses boost::spirit.
+ * A CSV reader that splits the file into chunks and parses them in parallel.
  *
  * mlpack is free software; you may redistribute it and/or modify it under the
  * terms of the 3-clause BSD license.  You should have received a copy of the
@@ -12,63 +12,162 @@
  */
 #include "load_csv.hpp"
 
-using namespace boost::spirit;
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
 
 namespace mlpack {
 namespace data {
 
-LoadCSV::LoadCSV(const std::string& file) :
-  extension(Extension(file)),
-  filename(file),
-  inFile(file)
+namespace {
+
+/**
+ * Parse [begin, end) as a decimal floating-point number.  If the number has at
+ * most maxMantissa significant digits (in binary) and a decimal exponent of at
+ * most maxExponent in magnitude, it is computed exactly with a single
+ * multiplication or division by an exact power of ten; otherwise the number is
+ * handed to slowParse (strtod() or strtof()).
+ */
+template<typename T>
+bool ParseFloat(const char* begin,
+                const char* end,
+                T& value,
+                const T* powers,
+                const uint64_t maxMantissa,
+                const int64_t maxExponent,
+                T (*slowParse)(const char*, char**))
 {
-  // Attempt to open stream.
-  CheckOpen();
+  const char* p = begin;
+  bool negative = false;
+  if (p != end && (*p == '+' || *p == '-'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
 
-  //! Spirit rule for parsing quoted string.
-  boost::spirit::qi::rule<std::string::iterator, iter_type()> quotedRule;
-  // Match quoted strings as: "string" or 'string'
-  quotedRule = qi::raw[(qi::char_("'") >> *((qi::char_ - "'") |
-                               "'" >> qi::char_("'")) >> "'") |
-                       (qi::char_('"') >> *((qi::char_ - '"') |
-                               '"' >> qi::char_('"')) >> '"') ];
+  uint64_t mantissa = 0;
+  int64_t exponent = 0;
+  bool truncated = false;
+  bool anyDigits = false;
+  const uint64_t mantissaLimit = (UINT64_MAX - 9) / 10;
 
-  // Set rules.
-  if (extension == "csv")
+  // Integer part.
+  for (; p != end && *p >= '0' && *p <= '9'; ++p)
   {
-    // Match all characters that are not ',', '\r', or '\n'.
-    stringRule = quotedRule.copy() | qi::raw[*~qi::char_(",\r\n")];
+    anyDigits = true;
+    if (mantissa <= mantissaLimit)
+      mantissa = 10 * mantissa + (*p - '0');
+    else
+    {
+      truncated = true;
+      ++exponent;
+    }
   }
-  else if (extension == "txt")
+
+  // Fractional part.
+  if (p != end && *p == '.')
   {
-    // Match all characters that are not ' ', ',', '\r', or '\n'.
-    stringRule = quotedRule.copy() | qi::raw[*~qi::char_(" ,\r\n")];
+    for (++p; p != end && *p >= '0' && *p <= '9'; ++p)
+    {
+      anyDigits = true;
+      if (mantissa <= mantissaLimit)
+      {
+        mantissa = 10 * mantissa + (*p - '0');
+        --exponent;
+      }
+      else
+      {
+        truncated = true;
+      }
+    }
   }
-  else // TSV.
+
+  if (!anyDigits)
+    return false;
+
+  // Exponent.
+  if (p != end && (*p == 'e' || *p == 'E'))
   {
-    // Match all characters that are not '\t', '\r', or '\n'.
-    stringRule = quotedRule.copy() | qi::raw[*~qi::char_("\t\r\n")];
+    ++p;
+    bool negativeExponent = false;
+    if (p != end && (*p == '+' || *p == '-'))
+    {
+      negativeExponent = (*p == '-');
+      ++p;
+    }
+
+    if (p == end || *p < '0' || *p > '9')
+      return false;
+
+    int64_t e = 0;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p)
+      if (e < 100000)
+        e = 10 * e + (*p - '0');
+
+    exponent += negativeExponent ? -e : e;
   }
 
-  if (extension == "csv")
+  if (p != end)
+    return false;
+
+  if (!truncated && mantissa <= maxMantissa && exponent >= -maxExponent &&
+      exponent <= maxExponent)
   {
-    // Extract a single comma as the delimiter, catching whitespace on either
-    // side.
-    delimiterRule = qi::raw[(*qi::char_(" ") >> qi::char_(",") >>
-        *qi::char_(" "))];
+    // Both the mantissa and the power of ten are exact, so the result is
+    // correctly rounded.
+    value = (exponent < 0) ? T(mantissa) / powers[-exponent] :
+        T(mantissa) * powers[exponent];
+    if (negative)
+      value = -value;
+    return true;
   }
+
+  // Let the C library handle the hard cases.
+  const std::string token(begin, end);
+  char* tokenEnd;
+  errno = 0;
+  value = slowParse(token.c_str(), &tokenEnd);
+  return (errno != ERANGE && tokenEnd == token.c_str() + token.size());
+}
+
+//! Powers of ten that are exactly representable as doubles.
+const double doublePowers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+    1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+    1e21, 1e22 };
+
+//! Powers of ten that are exactly representable as floats.
+const float floatPowers[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f,
+    1e8f, 1e9f, 1e10f };
+
+} // namespace
+
+LoadCSV::LoadCSV(const std::string& file, const size_t chunkSize) :
+  extension(Extension(file)),
+  filename(file),
+  inFile(file, std::ios::in | std::ios::binary),
+  chunkSize(chunkSize),
+  fileData(NULL),
+  fileSize(0),
+  mapping(NULL)
+{
+  // Attempt to open stream.
+  CheckOpen();
+
+  // Set the delimiter.
+  if (extension == "csv")
+    delimiter = ',';
   else if (extension == "txt")
-  {
-    // This one is a little more difficult, we need to catch any number of
-    // spaces more than one.
-    delimiterRule = qi::raw[+qi::char_(" ")];
-  }
+    delimiter = ' ';
   else // TSV.
-  {
-    // Catch a tab character, possibly with whitespace on either side.
-    delimiterRule = qi::raw[(*qi::char_(" ") >> qi::char_("\t") >>
-        *qi::char_(" "))];
-  }
+    delimiter = '\t';
 }
 
 void LoadCSV::CheckOpen()
@@ -83,5 +182,145 @@ void LoadCSV::CheckOpen()
   inFile.unsetf(std::ios::skipws);
 }
 
+LoadCSV::~LoadCSV()
+{
+  ReleaseContents();
+}
+
+void LoadCSV::MapContents()
+{
+  ReleaseContents();
+
+#ifndef _WIN32
+  // Map the file instead of reading it, so that the only copy of its contents
+  // is in the page cache, and pages that were parsed can be dropped again.
+  const int fd = open(filename.c_str(), O_RDONLY);
+  struct stat fileStat;
+  if (fd == -1 || fstat(fd, &fileStat) != 0)
+  {
+    if (fd != -1)
+      close(fd);
+
+    std::ostringstream oss;
+    oss << "Cannot read file '" << filename << "'. " << std::endl;
+    throw std::runtime_error(oss.str());
+  }
+
+  fileSize = (size_t) fileStat.st_size;
+  if (fileSize > 0)
+  {
+    mapping = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+      mapping = NULL;
+      fileSize = 0;
+      close(fd);
+
+      std::ostringstream oss;
+      oss << "Cannot map file '" << filename << "' into memory. " << std::endl;
+      throw std::runtime_error(oss.str());
+    }
+
+    fileData = static_cast<const char*>(mapping);
+  }
+  close(fd);
+#else
+  // Without mmap(), the file has to be read into memory.
+  inFile.clear();
+  inFile.seekg(0, std::ios::end);
+  const std::streamoff size = inFile.tellg();
+  inFile.seekg(0, std::ios::beg);
+
+  contents.resize((size_t) std::max(size, (std::streamoff) 0));
+  if (!contents.empty() && !inFile.read(&contents[0], contents.size()))
+  {
+    std::ostringstream oss;
+    oss << "Cannot read file '" << filename << "'. " << std::endl;
+    throw std::runtime_error(oss.str());
+  }
+
+  fileData = contents.data();
+  fileSize = contents.size();
+#endif
+
+  if (fileSize == 0)
+    fileData = "";
+}
+
+void LoadCSV::ReleaseContents()
+{
+#ifndef _WIN32
+  if (mapping != NULL)
+    munmap(mapping, fileSize);
+#endif
+
+  mapping = NULL;
+  std::string().swap(contents);
+  fileData = NULL;
+  fileSize = 0;
+}
+
+void LoadCSV::SplitChunks()
+{
+  MapContents();
+
+  size_t numThreads = 1;
+  #ifdef HAS_OPENMP
+    numThreads = omp_get_max_threads();
+  #endif
+
+  // Aim for a few chunks per thread, but don't bother splitting small files.
+  const size_t targetSize = (chunkSize > 0) ? chunkSize :
+      std::max((size_t) (1 << 20), fileSize / (4 * numThreads));
+
+  // Each chunk ends right after a newline (or at the end of the file).
+  chunkBounds.assign(1, 0);
+  while (chunkBounds.back() < fileSize)
+  {
+    const size_t target = chunkBounds.back() + targetSize;
+    if (target >= fileSize)
+    {
+      chunkBounds.push_back(fileSize);
+    }
+    else
+    {
+      const char* newline = (const char*) std::memchr(fileData + target - 1,
+          '\n', fileSize - (target - 1));
+      chunkBounds.push_back((newline == NULL) ? fileSize :
+          (newline - fileData) + 1);
+    }
+  }
+
+  // Count the lines in each chunk.
+  const size_t numChunks = chunkBounds.size() - 1;
+  chunkLines.assign(numChunks + 1, 0);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t c = 0; c < (omp_size_t) numChunks; ++c)
+  {
+    chunkLines[c + 1] = std::count(fileData + chunkBounds[c],
+        fileData + chunkBounds[c + 1], '\n');
+  }
+
+  // The last line may not end with a newline.
+  if (fileSize > 0 && fileData[fileSize - 1] != '\n')
+    ++chunkLines[numChunks];
+
+  for (size_t c = 1; c <= numChunks; ++c)
+    chunkLines[c] += chunkLines[c - 1];
+}
+
+bool LoadCSV::ParseNumber(const char* begin, const char* end, double& value)
+{
+  return ParseFloat<double>(begin, end, value, doublePowers,
+      (uint64_t(1) << 53), 22, std::strtod);
+}
+
+bool LoadCSV::ParseNumber(const char* begin, const char* end, float& value)
+{
+  return ParseFloat<float>(begin, end, value, floatPowers,
+      (uint64_t(1) << 24), 10, std::strtof);
+}
+
 } // namespace data
 } // namespace mlpack
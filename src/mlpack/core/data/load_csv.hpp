@@ -12,35 +12,59 @@
 #ifndef MLPACK_CORE_DATA_LOAD_CSV_HPP
 #define MLPACK_CORE_DATA_LOAD_CSV_HPP
 
-#include <boost/spirit/include/qi.hpp>
-#include <boost/algorithm/string/trim.hpp>
-
 #include <mlpack/core.hpp>
 #include <mlpack/core/util/log.hpp>
 
+#include <cctype>
+#include <cstring>
+#include <limits>
 #include <set>
 #include <string>
+#include <type_traits>
 
 #include "extension.hpp"
 #include "format.hpp"
 #include "dataset_mapper.hpp"
+#include "map_policies/map_policy_traits.hpp"
 
 namespace mlpack {
 namespace data {
 
 /**
- *Load the csv file.This class use boost::spirit
- *to implement the parser, please refer to following link
- *http://theboostcpplibraries.com/boost.spirit for quick review.
+ * Load the csv file.  The file is mapped into memory (or read, on systems
+ * without mmap()) and split into chunks on line boundaries; the chunks are
+ * then tokenized and parsed in parallel (if OpenMP is available).  Numeric
+ * tokens are parsed directly when the mapping policy allows it (see
+ * MapPolicyTraits); all other tokens are passed to the DatasetMapper in file
+ * order afterwards, so the mappings do not depend on the number of threads.
+ *
+ * Only the tokenization and the parsing of numbers are parallel.  With a
+ * policy that does not set MapPolicyTraits::ParsesNumbersDirectly (such as
+ * MissingPolicy), every token goes through the DatasetMapper on one thread.
+ * With a policy that needs a first pass but does not set
+ * MapPolicyTraits::FirstPassOnlySetsTypes, the first pass also runs on one
+ * thread, in file order.
+ *
+ * Tokens are separated by commas for .csv files, by tabs for .tsv files and by
+ * spaces for .txt files; whitespace around each token is ignored, and tokens
+ * may be quoted with ' or ".
  */
 class LoadCSV
 {
  public:
   /**
-   * Construct the LoadCSV object on the given file.  This will construct the
-   * rules necessary for loading and attempt to open the file.
+   * Construct the LoadCSV object on the given file.  This will attempt to open
+   * the file.
+   *
+   * @param file Name of file to load.
+   * @param chunkSize Approximate size, in bytes, of the chunks that the file is
+   *     split into for parsing.  If 0, a size is chosen based on the size of
+   *     the file and the number of threads.
    */
-  LoadCSV(const std::string& file);
+  LoadCSV(const std::string& file, const size_t chunkSize = 0);
+
+  //! Release the mapping of the file, if any.
+  ~LoadCSV();
 
   /**
    * Load the file into the given matrix with the given DatasetMapper object.
@@ -58,10 +82,7 @@ class LoadCSV
   {
     CheckOpen();
 
-    if (transpose)
-      TransposeParse(inout, infoSet);
-    else
-      NonTransposeParse(inout, infoSet);
+    Parse(inout, infoSet, transpose);
   }
 
   /**
@@ -77,64 +98,9 @@ class LoadCSV
   template<typename T, typename MapPolicy>
   void GetMatrixSize(size_t& rows, size_t& cols, DatasetMapper<MapPolicy>& info)
   {
-    using namespace boost::spirit;
-
-    // Take a pass through the file.  If the DatasetMapper policy requires it,
-    // we will pass everything string through MapString().  This might be useful
-    // if, e.g., the MapPolicy needs to find which dimensions are numeric or
-    // categorical.
-
-    // Reset to the start of the file.
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
-    rows = 0;
-    cols = 0;
-
-    // First, count the number of rows in the file (this is the dimensionality).
-    std::string line;
-    while (std::getline(inFile, line))
-    {
-      ++rows;
-    }
-    info = DatasetMapper<MapPolicy>(rows);
-
-    // Now, jump back to the beginning of the file.
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
-    rows = 0;
-
-    while (std::getline(inFile, line))
-    {
-      ++rows;
-      // Remove whitespace from either side.
-      boost::trim(line);
-
-      if (rows == 1)
-      {
-        // Extract the number of columns.
-        auto findColSize = [&cols](iter_type) { ++cols; };
-        qi::parse(line.begin(), line.end(),
-            stringRule[findColSize] % delimiterRule);
-      }
-
-      // I guess this is technically a second pass, but that's ok... still the
-      // same idea...
-      if (MapPolicy::NeedsFirstPass)
-      {
-        // In this case we must pass everything we parse to the MapPolicy.
-        auto firstPassMap = [&](const iter_type& iter)
-        {
-          std::string str(iter.begin(), iter.end());
-          boost::trim(str);
-
-          info.template MapFirstPass<T>(std::move(str), rows - 1);
-        };
-
-        // Now parse the line.
-        qi::parse(line.begin(), line.end(),
-            stringRule[firstPassMap] % delimiterRule);
-      }
-    }
+    std::vector<std::pair<size_t, size_t>> deferredLines;
+    Scan<T>(NULL, info, false, cols, deferredLines);
+    rows = chunkLines.back();
   }
 
   /**
@@ -152,61 +118,17 @@ class LoadCSV
                               size_t& cols,
                               DatasetMapper<MapPolicy>& info)
   {
-    using namespace boost::spirit;
-
-    // Take a pass through the file.  If the DatasetMapper policy requires it,
-    // we will pass everything string through MapString().  This might be useful
-    // if, e.g., the MapPolicy needs to find which dimensions are numeric or
-    // categorical.
-
-    // Reset to the start of the file.
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
-    rows = 0;
-    cols = 0;
-
-    std::string line;
-    while (std::getline(inFile, line))
-    {
-      ++cols;
-      // Remove whitespace from either side.
-      boost::trim(line);
-
-      if (cols == 1)
-      {
-        // Extract the number of dimensions.
-        auto findRowSize = [&rows](iter_type) { ++rows; };
-        qi::parse(line.begin(), line.end(),
-            stringRule[findRowSize] % delimiterRule);
-
-        // Now that we know the dimensionality, initialize the DatasetMapper.
-        info.SetDimensionality(rows);
-      }
-
-      // If we need to do a first pass for the DatasetMapper, do it.
-      if (MapPolicy::NeedsFirstPass)
-      {
-        size_t dim = 0;
-
-        // In this case we must pass everything we parse to the MapPolicy.
-        auto firstPassMap = [&](const iter_type& iter)
-        {
-          std::string str(iter.begin(), iter.end());
-          boost::trim(str);
-
-          info.template MapFirstPass<T>(std::move(str), dim++);
-        };
-
-        // Now parse the line.
-        qi::parse(line.begin(), line.end(),
-            stringRule[firstPassMap] % delimiterRule);
-      }
-    }
+    std::vector<std::pair<size_t, size_t>> deferredLines;
+    Scan<T>(NULL, info, true, rows, deferredLines);
+    cols = chunkLines.back();
   }
 
- private:
-  using iter_type = boost::iterator_range<std::string::iterator>;
+  //! Get the approximate size of each chunk (0 means automatic).
+  size_t ChunkSize() const { return chunkSize; }
+  //! Modify the approximate size of each chunk (0 means automatic).
+  size_t& ChunkSize() { return chunkSize; }
 
+ private:
   /**
    * Check whether or not the file has successfully opened; throw an exception
    * if not.
@@ -214,153 +136,437 @@ class LoadCSV
   void CheckOpen();
 
   /**
-   * Parse a non-transposed matrix.
+   * Map the file into memory (or read it, if mmap() is not available).  This
+   * sets fileData and fileSize.
+   */
+  void MapContents();
+
+  //! Release the memory holding the contents of the file.
+  void ReleaseContents();
+
+  /**
+   * Map the file into memory, split it into chunks that start at the
+   * beginning of a line, and count the lines in each chunk.  This fills
+   * fileData, chunkBounds and chunkLines.
+   */
+  void SplitChunks();
+
+  /**
+   * Parse the file into the given matrix, mapping with the given DatasetMapper
+   * object.
    *
    * @param inout Matrix to load into.
    * @param infoSet DatasetMapper object to load with.
+   * @param transpose If true, each line of the file is a column of the matrix.
    */
   template<typename T, typename PolicyType>
-  void NonTransposeParse(arma::Mat<T>& inout,
-                         DatasetMapper<PolicyType>& infoSet)
+  void Parse(arma::Mat<T>& inout,
+             DatasetMapper<PolicyType>& infoSet,
+             const bool transpose)
+  {
+    size_t numTokens;
+    std::vector<std::pair<size_t, size_t>> deferredLines;
+    Scan<T>(&inout, infoSet, transpose, numTokens, deferredLines);
+
+    // Now pass everything that we could not parse ourselves to the
+    // DatasetMapper.  This has to happen in file order, so that the mappings
+    // are the same no matter how the file was split.
+    bool mapAllLines = !MapPolicyTraits<PolicyType>::ParsesNumbersDirectly;
+    for (size_t d = 0; d < infoSet.Dimensionality() && !mapAllLines; ++d)
+      if (infoSet.Type(d) == Datatype::categorical)
+        mapAllLines = true;
+
+    const char* data = fileData;
+    if (mapAllLines)
+    {
+      const char* pos = data;
+      for (size_t line = 0; line < chunkLines.back(); ++line)
+      {
+        const char* lineEnd = LineEnd(pos, data + fileSize);
+        MapLine(inout, infoSet, transpose, line, pos, lineEnd);
+        pos = lineEnd + 1;
+      }
+    }
+    else
+    {
+      for (size_t i = 0; i < deferredLines.size(); ++i)
+      {
+        const char* pos = data + deferredLines[i].second;
+        MapLine(inout, infoSet, transpose, deferredLines[i].first, pos,
+            LineEnd(pos, data + fileSize));
+      }
+    }
+
+    // We don't need the contents of the file anymore.
+    ReleaseContents();
+  }
+
+  /**
+   * Split the file into chunks and take a pass over each of them in parallel,
+   * counting the tokens on each line, storing every token that can be parsed
+   * as a number directly into the matrix (if the mapping policy allows it and
+   * the matrix is given), and taking the first pass for the DatasetMapper (if
+   * the mapping policy needs it).  If the first pass only sets the types of
+   * the dimensions (see MapPolicyTraits), the first pass of each chunk uses its
+   * own copy of the DatasetMapper, and a dimension is categorical when any of
+   * the chunks found it to be; otherwise the first pass is taken afterwards on
+   * one thread, in file order.  An exception is thrown if a line has the wrong
+   * number of tokens.
+   *
+   * @param matrix Matrix to store parsed numbers in (may be NULL).
+   * @param info DatasetMapper object to re-initialize and take the first pass
+   *     with.
+   * @param transpose If true, each line of the file is a column of the matrix.
+   * @param numTokens Variable to be filled with the number of tokens on each
+   *     line.
+   * @param deferredLines Filled with the index and byte offset of each line
+   *     that holds a token that could not be parsed as a number.
+   */
+  template<typename T, typename MapPolicy>
+  void Scan(arma::Mat<T>* matrix,
+            DatasetMapper<MapPolicy>& info,
+            const bool transpose,
+            size_t& numTokens,
+            std::vector<std::pair<size_t, size_t>>& deferredLines)
   {
-    using namespace boost::spirit;
+    SplitChunks();
 
-    // Get the size of the matrix.
-    size_t rows, cols;
-    GetMatrixSize<T>(rows, cols, infoSet);
+    const char* data = fileData;
+    const size_t numLines = chunkLines.back();
+    const size_t numChunks = chunkBounds.size() - 1;
 
-    // Set up output matrix.
-    inout.set_size(rows, cols);
-    size_t row = 0;
-    size_t col = 0;
+    // The first line tells us the number of tokens on each line.
+    numTokens = (numLines == 0) ? 0 : Tokenize(data,
+        LineEnd(data, data + fileSize),
+        [](const size_t, const char*, const char*) { });
 
-    // Reset file position.
-    std::string line;
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
+    const size_t dimensionality = transpose ? numTokens : numLines;
+    info.SetDimensionality(dimensionality);
+    if (matrix)
+    {
+      matrix->set_size(transpose ? numTokens : numLines,
+          transpose ? numLines : numTokens);
+    }
 
-    auto setCharClass = [&](iter_type const &iter)
+    const bool parseNumbers = MapPolicyTraits<MapPolicy>::ParsesNumbersDirectly;
+    const bool parallelFirstPass = MapPolicy::NeedsFirstPass &&
+        MapPolicyTraits<MapPolicy>::FirstPassOnlySetsTypes;
+    std::vector<DatasetMapper<MapPolicy>> chunkInfo(
+        parallelFirstPass ? numChunks : 0, info);
+    std::vector<std::vector<std::pair<size_t, size_t>>> chunkDeferred(
+        numChunks);
+    std::vector<size_t> errorLines(numChunks, numLines);
+    std::vector<size_t> errorTokens(numChunks, 0);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t c = 0; c < (omp_size_t) numChunks; ++c)
     {
-      std::string str(iter.begin(), iter.end());
-      if (str == "\t")
+      // Numeric tokens only need to be seen once per dimension by the first
+      // pass.
+      std::vector<char> numericSeen(transpose ? numTokens : 1, 0);
+
+      const char* pos = data + chunkBounds[c];
+      const char* chunkEnd = data + chunkBounds[c + 1];
+      for (size_t line = chunkLines[c]; line < chunkLines[c + 1]; ++line)
       {
-        str.clear();
-      }
-      boost::trim(str);
+        const char* lineEnd = LineEnd(pos, chunkEnd);
+        if (!transpose)
+          numericSeen[0] = 0;
 
-      inout(row, col++) = infoSet.template MapString<T>(std::move(str), row);
-    };
+        bool deferred = false;
+        auto scanToken = [&](const size_t k, const char* begin, const char* end)
+        {
+          if (k >= numTokens)
+            return;
+
+          const size_t dim = transpose ? k : line;
+          T value;
+          if (parseNumbers && ParseNumber(begin, end, value))
+          {
+            if (matrix)
+              (*matrix)(transpose ? k : line, transpose ? line : k) = value;
+
+            char& seen = numericSeen[transpose ? k : 0];
+            if (parallelFirstPass && !seen)
+            {
+              chunkInfo[c].template MapFirstPass<T>(std::string(begin, end),
+                  dim);
+              seen = 1;
+            }
+          }
+          else
+          {
+            deferred = true;
+            if (parallelFirstPass)
+            {
+              chunkInfo[c].template MapFirstPass<T>(std::string(begin, end),
+                  dim);
+            }
+          }
+        };
 
-    while (std::getline(inFile, line))
-    {
-      // Remove whitespace from either side.
-      boost::trim(line);
+        const size_t lineTokens = Tokenize(pos, lineEnd, scanToken);
+        if (lineTokens != numTokens)
+        {
+          errorLines[c] = line;
+          errorTokens[c] = lineTokens;
+          break;
+        }
 
-      // Parse the numbers from a line (ex: 1,2,3,4); if the parser finds a
-      // number it will execute the setNum function.
-      const bool canParse = qi::parse(line.begin(), line.end(),
-          stringRule[setCharClass] % delimiterRule);
+        if (deferred && parseNumbers)
+          chunkDeferred[c].push_back(std::make_pair(line, pos - data));
 
-      // Make sure we got the right number of rows.
-      if (col != cols)
+        pos = lineEnd + 1;
+      }
+    }
+
+    // Report the first malformed line, if any.
+    for (size_t c = 0; c < numChunks; ++c)
+    {
+      if (errorLines[c] != numLines)
       {
         std::ostringstream oss;
-        oss << "LoadCSV::NonTransposeParse(): wrong number of dimensions ("
-            << col << ") on line " << row << "; should be " << cols
+        oss << "LoadCSV::Load(): wrong number of dimensions (" << errorTokens[c]
+            << ") on line " << errorLines[c] << "; should be " << numTokens
             << " dimensions.";
         throw std::runtime_error(oss.str());
       }
+    }
+
+    // Merge the first passes of each chunk.
+    for (size_t c = 0; c < chunkInfo.size(); ++c)
+      for (size_t d = 0; d < dimensionality; ++d)
+        if (chunkInfo[c].Type(d) == Datatype::categorical)
+          info.Type(d) = Datatype::categorical;
 
-      if (!canParse)
+    // Any other first pass sees every token, in file order.
+    if (MapPolicy::NeedsFirstPass && !parallelFirstPass)
+    {
+      const char* pos = data;
+      for (size_t line = 0; line < numLines; ++line)
       {
-        std::ostringstream oss;
-        oss << "LoadCSV::NonTransposeParse(): parsing error on line " << col
-            << "!";
-        throw std::runtime_error(oss.str());
+        const char* lineEnd = LineEnd(pos, data + fileSize);
+        Tokenize(pos, lineEnd, [&](const size_t k, const char* begin,
+            const char* end)
+        {
+          info.template MapFirstPass<T>(std::string(begin, end),
+              transpose ? k : line);
+        });
+        pos = lineEnd + 1;
       }
+    }
 
-      ++row; col = 0;
+    deferredLines.clear();
+    for (size_t c = 0; c < numChunks; ++c)
+    {
+      deferredLines.insert(deferredLines.end(), chunkDeferred[c].begin(),
+          chunkDeferred[c].end());
     }
   }
 
   /**
-   * Parse a transposed matrix.
-   *
-   * @param inout Matrix to load into.
-   * @param infoSet DatasetMapper to load with.
+   * Map every token on the given line that is in a categorical dimension or
+   * cannot be parsed as a number with the DatasetMapper, and store the results
+   * in the matrix.
    */
   template<typename T, typename PolicyType>
-  void TransposeParse(arma::Mat<T>& inout, DatasetMapper<PolicyType>& infoSet)
+  void MapLine(arma::Mat<T>& inout,
+               DatasetMapper<PolicyType>& infoSet,
+               const bool transpose,
+               const size_t line,
+               const char* begin,
+               const char* end)
   {
-    using namespace boost::spirit;
-
-    // Get matrix size.  This also initializes infoSet correctly.
-    size_t rows, cols;
-    GetTransposeMatrixSize<T>(rows, cols, infoSet);
-
-    // Set the matrix size.
-    inout.set_size(rows, cols);
-
-    // Initialize auxiliary variables.
-    size_t row = 0;
-    size_t col = 0;
-    std::string line;
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
-
-    /**
-     * This is the parse rule for strings.  When we get a string we have to pass
-     * it to the DatasetMapper.
-     */
-    auto parseString = [&](iter_type const &iter)
+    auto mapToken = [&](const size_t k, const char* tokenBegin,
+                        const char* tokenEnd)
     {
-      // All parsed values must be mapped.
-      std::string str(iter.begin(), iter.end());
-      boost::trim(str);
-
-      inout(row, col) = infoSet.template MapString<T>(std::move(str), row);
-      ++row;
+      const size_t dim = transpose ? k : line;
+      T value;
+      if (MapPolicyTraits<PolicyType>::ParsesNumbersDirectly &&
+          infoSet.Type(dim) == Datatype::numeric &&
+          ParseNumber(tokenBegin, tokenEnd, value))
+        return;
+
+      inout(transpose ? k : line, transpose ? line : k) =
+          infoSet.template MapString<T>(std::string(tokenBegin, tokenEnd),
+          dim);
     };
 
-    while (std::getline(inFile, line))
+    Tokenize(begin, end, mapToken);
+  }
+
+  /**
+   * Split the given line into tokens, calling f(index, begin, end) for each
+   * token with surrounding whitespace removed, and return the number of
+   * tokens.  An empty line holds a single empty token.
+   */
+  template<typename FunctionType>
+  size_t Tokenize(const char* begin,
+                  const char* end,
+                  FunctionType&& f) const
+  {
+    // Remove whitespace from either side.
+    Trim(begin, end);
+
+    size_t numTokens = 0;
+    const char* pos = begin;
+    while (true)
     {
-      // Remove whitespace from either side.
-      boost::trim(line);
+      // A token is either a quoted string, or everything up to the next
+      // delimiter.
+      const char* tokenBegin = pos;
+      if (!SkipQuoted(pos, end))
+      {
+        while (pos != end && !IsTokenEnd(*pos))
+          ++pos;
+      }
 
-      // Reset the row we are looking at.  (Remember this is transposed.)
-      row = 0;
+      const char* tokenEnd = pos;
+      Trim(tokenBegin, tokenEnd);
+      f(numTokens++, tokenBegin, tokenEnd);
 
-      // Now use boost::spirit to parse the characters of the line;
-      // parseString() will be called when a token is detected.
-      const bool canParse = qi::parse(line.begin(), line.end(),
-          stringRule[parseString] % delimiterRule);
+      // Look for the next delimiter, which may be surrounded by spaces.
+      const char* next = pos;
+      while (next != end && *next == ' ')
+        ++next;
+      if (delimiter != ' ')
+      {
+        if (next == end || *next != delimiter)
+          break;
 
-      // Make sure we got the right number of rows.
-      if (row != rows)
+        ++next;
+        while (next != end && *next == ' ')
+          ++next;
+      }
+      else if (next == pos)
       {
-        std::ostringstream oss;
-        oss << "LoadCSV::TransposeParse(): wrong number of dimensions (" << row
-            << ") on line " << col << "; should be " << rows << " dimensions.";
-        throw std::runtime_error(oss.str());
+        break;
       }
 
-      if (!canParse)
+      pos = next;
+    }
+
+    return numTokens;
+  }
+
+  /**
+   * If a quoted string ('string' or "string", with doubled quotes as escapes)
+   * starts at pos, move pos past it and return true.
+   */
+  static bool SkipQuoted(const char*& pos, const char* end)
+  {
+    if (pos == end || (*pos != '"' && *pos != '\''))
+      return false;
+
+    const char quote = *pos;
+    const char* p = pos + 1;
+    while (p != end)
+    {
+      if (*p != quote)
+        ++p;
+      else if (p + 1 != end && *(p + 1) == quote)
+        p += 2;
+      else
+        break;
+    }
+
+    if (p == end)
+      return false;
+
+    pos = p + 1;
+    return true;
+  }
+
+  //! Return whether the given character ends an unquoted token.
+  bool IsTokenEnd(const char c) const
+  {
+    return (c == delimiter || c == '\r' || c == '\n' ||
+        (delimiter == ' ' && c == ','));
+  }
+
+  //! Remove whitespace from both ends of [begin, end).
+  static void Trim(const char*& begin, const char*& end)
+  {
+    while (begin != end && std::isspace((unsigned char) *begin))
+      ++begin;
+    while (end != begin && std::isspace((unsigned char) *(end - 1)))
+      --end;
+  }
+
+  //! Return the end of the line starting at pos.
+  static const char* LineEnd(const char* pos, const char* end)
+  {
+    const char* newline = (const char*) std::memchr(pos, '\n', end - pos);
+    return (newline == NULL) ? end : newline;
+  }
+
+  /**
+   * Parse [begin, end) as a decimal number, returning false if it is not one.
+   * Only plain decimal notation (with an optional sign, fractional part and
+   * exponent) is accepted; anything else is left to the DatasetMapper.
+   */
+  static bool ParseNumber(const char* begin, const char* end, double& value);
+  static bool ParseNumber(const char* begin, const char* end, float& value);
+
+  /**
+   * Parse [begin, end) as an integer, returning false if it is not one or if
+   * it does not fit in T.
+   */
+  template<typename T>
+  static typename std::enable_if<std::is_integral<T>::value, bool>::type
+  ParseNumber(const char* begin, const char* end, T& value)
+  {
+    bool negative = false;
+    if (begin != end && (*begin == '+' || *begin == '-'))
+    {
+      negative = (*begin == '-');
+      ++begin;
+    }
+
+    if (begin == end || (negative && !std::is_signed<T>::value))
+      return false;
+
+    // Accumulate the magnitude as a negative number for signed types, so that
+    // the minimum value can be read too.
+    T result = 0;
+    for (const char* p = begin; p != end; ++p)
+    {
+      if (*p < '0' || *p > '9')
+        return false;
+
+      const T digit = (T) (*p - '0');
+      if (std::is_signed<T>::value)
       {
-        std::ostringstream oss;
-        oss << "LoadCSV::TransposeParse(): parsing error on line " << col
-            << "!";
-        throw std::runtime_error(oss.str());
+        if (result < (std::numeric_limits<T>::min() + digit) / 10)
+          return false;
+        result = result * 10 - digit;
       }
+      else
+      {
+        if (result > (std::numeric_limits<T>::max() - digit) / 10)
+          return false;
+        result = result * 10 + digit;
+      }
+    }
 
-      // Increment the column index.
-      ++col;
+    if (std::is_signed<T>::value && !negative)
+    {
+      if (result == std::numeric_limits<T>::min())
+        return false;
+      result = -result;
     }
+
+    value = result;
+    return true;
   }
 
-  //! Spirit rule for parsing.
-  boost::spirit::qi::rule<std::string::iterator, iter_type()> stringRule;
-  //! Spirit rule for delimiters (i.e. ',' for CSVs).
-  boost::spirit::qi::rule<std::string::iterator, iter_type()> delimiterRule;
+  //! Other types are never parsed directly.
+  template<typename T>
+  static typename std::enable_if<!std::is_integral<T>::value, bool>::type
+  ParseNumber(const char* /* begin */, const char* /* end */, T& /* value */)
+  {
+    return false;
+  }
 
   //! Extension (type) of file.
   std::string extension;
@@ -368,6 +574,22 @@ class LoadCSV
   std::string filename;
   //! Opened stream for reading.
   std::ifstream inFile;
+  //! Character that separates tokens.
+  char delimiter;
+  //! Approximate size of each chunk, in bytes (0 means automatic).
+  size_t chunkSize;
+  //! Contents of the file, if it had to be read instead of mapped.
+  std::string contents;
+  //! Start of the contents of the file, while it is being parsed.
+  const char* fileData;
+  //! Size of the file, in bytes.
+  size_t fileSize;
+  //! Memory mapping of the file (NULL if it is not mapped).
+  void* mapping;
+  //! Byte offsets of the start of each chunk, followed by the file size.
+  std::vector<size_t> chunkBounds;
+  //! Index of the first line of each chunk, followed by the number of lines.
+  std::vector<size_t> chunkLines;
 };
 
 } // namespace data
@@ -27,6 +27,7 @@
 #include <boost/algorithm/string.hpp>
 
 #include "load_arff.hpp"
+#include "mapped_matrix.hpp"
 
 namespace mlpack {
 namespace data {
@@ -107,6 +108,20 @@ bool Load(const std::string& filename,
     return false;
   }
 
+  // Memory-mappable binary files aren't loaded through Armadillo.
+  if (extension == "mbin")
+  {
+    stream.close();
+    // The reason of a failure is reported as a warning, so that the timer can
+    // be stopped before a fatal error is reported.
+    const bool success = LoadMapped(filename, matrix, false, transpose);
+    Timer::Stop("loading_data");
+    if (!success && fatal)
+      Log::Fatal << "Loading from '" << filename << "' failed." << std::endl;
+
+    return success;
+  }
+
   bool unknownType = false;
   arma::file_type loadType;
   std::string stringType;
@@ -15,6 +15,7 @@
 #include <mlpack/prereqs.hpp>
 #include <unordered_map>
 #include <mlpack/core/data/map_policies/datatype.hpp>
+#include <mlpack/core/data/map_policies/map_policy_traits.hpp>
 
 namespace mlpack {
 namespace data {
@@ -147,6 +148,19 @@ class IncrementPolicy
   bool forceAllMappings;
 }; // class IncrementPolicy
 
+/**
+ * Numeric tokens never change the type of a dimension unless all mappings are
+ * forced, in which case any token makes its dimension categorical; either way,
+ * numbers in numeric dimensions are returned as-is by MapString().
+ */
+template<>
+class MapPolicyTraits<IncrementPolicy>
+{
+ public:
+  static const bool ParsesNumbersDirectly = true;
+  static const bool FirstPassOnlySetsTypes = true;
+};
+
 } // namespace data
 } // namespace mlpack
 
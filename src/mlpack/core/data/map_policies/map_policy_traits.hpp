@@ -0,0 +1,64 @@
+/**
+ * @file map_policy_traits.hpp
+ *
+ * This file provides the MapPolicyTraits class, a template class that gives
+ * loaders information about the behavior of a mapping policy.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAP_POLICIES_MAP_POLICY_TRAITS_HPP
+#define MLPACK_CORE_DATA_MAP_POLICIES_MAP_POLICY_TRAITS_HPP
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The MapPolicyTraits class provides compile-time information about a mapping
+ * policy used by DatasetMapper.  Loaders such as LoadCSV use this information
+ * to avoid passing every token of a file through the policy.  The default
+ * values are conservative, so a policy that does not specialize this class
+ * will see every token.
+ *
+ * A specialization should be placed next to the policy it describes:
+ *
+ * @code
+ * template<>
+ * class MapPolicyTraits<MyPolicy>
+ * {
+ *  public:
+ *   static const bool ParsesNumbersDirectly = true;
+ *   static const bool FirstPassOnlySetsTypes = true;
+ * };
+ * @endcode
+ */
+template<typename PolicyType>
+class MapPolicyTraits
+{
+ public:
+  /**
+   * If true, then every token that can be read as a number of the output type
+   * has the same effect on MapFirstPass() no matter which number it is, and
+   * MapString() returns that number for such tokens in numeric dimensions
+   * without changing any mappings.  This allows a loader to parse numeric
+   * tokens itself and only call the policy for the other ones (and for one
+   * numeric token per dimension during the first pass).
+   */
+  static const bool ParsesNumbersDirectly = false;
+
+  /**
+   * If true, then MapFirstPass() only changes the types of the dimensions, and
+   * a dimension ends up categorical if and only if some token makes it
+   * categorical, regardless of the order of the tokens.  This allows a loader
+   * to take the first pass over parts of a file separately (for instance, in
+   * parallel) and merge the types afterwards.
+   */
+  static const bool FirstPassOnlySetsTypes = false;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file mapped_matrix.hpp
+ *
+ * Load and save matrices in mlpack's memory-mappable binary format (.mbin).
+ * Loading a file in this format maps it into memory and wraps the mapped
+ * memory as an Armadillo matrix, so no copy of the data is made.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_MATRIX_HPP
+#define MLPACK_CORE_DATA_MAPPED_MATRIX_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <cstdint>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The header of a memory-mappable binary matrix file.  The file consists of
+ * this 64-byte header, followed (at dataOffset bytes from the start of the
+ * file) by the elements of the matrix in column-major order.  The matrix stored
+ * is the matrix as mlpack uses it in memory: each column is one point.  Since
+ * dataOffset is a multiple of 64, the data is aligned for vectorized access
+ * once the file is mapped.
+ */
+struct MappedMatrixHeader
+{
+  //! Magic string identifying the format ("MLPKMMAT").
+  char magic[8];
+  //! Version of the format.
+  uint32_t version;
+  //! Code of the element type (see MappedElementType()).
+  uint32_t elementType;
+  //! Number of rows of the matrix.
+  uint64_t nRows;
+  //! Number of columns of the matrix.
+  uint64_t nCols;
+  //! Offset of the first element from the start of the file, in bytes.
+  uint64_t dataOffset;
+  //! Byte order marker; this is 0x01020304 when written by the same byte order.
+  uint32_t byteOrder;
+  //! Reserved for future use; must be zero.
+  char reserved[20];
+};
+
+//! The current version of the memory-mappable binary matrix format.
+static const uint32_t MappedMatrixVersion = 1;
+
+/**
+ * Return the code identifying the element type eT in a memory-mappable binary
+ * matrix file.  The high byte holds the kind of element (1: floating point, 2:
+ * signed integer, 3: unsigned integer), and the low byte holds its size in
+ * bytes.
+ */
+template<typename eT>
+uint32_t MappedElementType();
+
+/**
+ * Load a matrix from a memory-mappable binary matrix file.  If transpose is
+ * true (the default for data::Load()), the file is mapped into memory and the
+ * matrix uses the mapped memory directly as auxiliary memory, so the cost of
+ * loading is bounded by page faults.  The mapping is private: modifications of
+ * the matrix are never written back to the file.  The mapping stays valid until
+ * Unmap() is called on the matrix, or until the program exits; if the matrix is
+ * resized, it will allocate new memory as usual.  Use the MappedMatrix class
+ * instead to release the mapping when the matrix goes out of scope.
+ *
+ * If transpose is false, the contents of the file are copied and transposed
+ * into the matrix.  On systems without mmap(), the file is always read into
+ * memory.
+ *
+ * This is called by data::Load() for files with the .mbin extension.
+ *
+ * @param filename Name of file to load.
+ * @param matrix Matrix to load contents of file into.
+ * @param fatal If an error should be reported as fatal.
+ * @param transpose If false, the matrix is transposed after loading.
+ * @return Boolean value indicating success or failure of load.
+ */
+template<typename eT>
+bool LoadMapped(const std::string& filename,
+                arma::Mat<eT>& matrix,
+                const bool fatal,
+                const bool transpose);
+
+/**
+ * Save a matrix to a memory-mappable binary matrix file.  If transpose is true
+ * (the default for data::Save()), the matrix is written as it is held in
+ * memory, so that it can later be loaded without any copy.
+ *
+ * This is called by data::Save() for files with the .mbin extension.
+ *
+ * @param filename Name of file to save to.
+ * @param matrix Matrix to save.
+ * @param fatal If an error should be reported as fatal.
+ * @param transpose If false, the transpose of the matrix is saved.
+ * @return Boolean value indicating success or failure of save.
+ */
+template<typename eT>
+bool SaveMapped(const std::string& filename,
+                const arma::Mat<eT>& matrix,
+                const bool fatal,
+                const bool transpose);
+
+/**
+ * Release the memory mapping used by the given matrix, if it was loaded from a
+ * memory-mappable binary matrix file.  The matrix is emptied.  If the matrix
+ * does not use a memory mapping, nothing is done.
+ *
+ * @param matrix Matrix to release the mapping of.
+ * @return true if a mapping was released.
+ */
+template<typename eT>
+bool Unmap(arma::Mat<eT>& matrix);
+
+/**
+ * A matrix loaded from a memory-mappable binary matrix file that owns its
+ * memory mapping: the mapping is released when the MappedMatrix is destroyed
+ * (or reset, or loaded again).  As with LoadMapped(), the matrix uses the
+ * mapped memory directly, and the mapping is private.  The matrix must not be
+ * used after the MappedMatrix that holds it is destroyed.
+ *
+ * @code
+ * data::MappedMatrix<double> dataset("dataset.mbin");
+ * const arma::mat& points = dataset.Matrix();
+ * @endcode
+ */
+template<typename eT>
+class MappedMatrix
+{
+ public:
+  //! Create an empty matrix, without any mapping.
+  MappedMatrix();
+
+  /**
+   * Map the given memory-mappable binary matrix file.
+   *
+   * @param filename Name of file to load.
+   * @param fatal If an error should be reported as fatal.
+   */
+  MappedMatrix(const std::string& filename, const bool fatal = false);
+
+  //! Take ownership of the mapping of the given MappedMatrix.
+  MappedMatrix(MappedMatrix&& other);
+
+  //! Release the current mapping and take ownership of the given one.
+  MappedMatrix& operator=(MappedMatrix&& other);
+
+  //! Release the mapping.
+  ~MappedMatrix();
+
+  /**
+   * Release the current mapping, and map the given memory-mappable binary
+   * matrix file.
+   *
+   * @param filename Name of file to load.
+   * @param fatal If an error should be reported as fatal.
+   * @return Boolean value indicating success or failure of load.
+   */
+  bool Load(const std::string& filename, const bool fatal = false);
+
+  //! Release the mapping and empty the matrix.
+  void Reset();
+
+  //! Get the matrix.
+  const arma::Mat<eT>& Matrix() const { return matrix; }
+  //! Modify the matrix.
+  arma::Mat<eT>& Matrix() { return matrix; }
+
+ private:
+  // A mapping can only have one owner.
+  MappedMatrix(const MappedMatrix& other) = delete;
+  MappedMatrix& operator=(const MappedMatrix& other) = delete;
+
+  //! The matrix, which uses the mapped memory.
+  arma::Mat<eT> matrix;
+  //! The start of the mapping (NULL if there is none).
+  void* region;
+  //! The length of the mapping.
+  size_t regionSize;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "mapped_matrix_impl.hpp"
+
+#endif
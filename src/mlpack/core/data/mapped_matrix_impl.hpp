@@ -0,0 +1,483 @@
+/**
+ * @file mapped_matrix_impl.hpp
+ *
+ * Implementation of loading and saving for mlpack's memory-mappable binary
+ * matrix format.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_MATRIX_IMPL_HPP
+#define MLPACK_CORE_DATA_MAPPED_MATRIX_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mapped_matrix.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <type_traits>
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace mlpack {
+namespace data {
+
+namespace details {
+
+static_assert(sizeof(MappedMatrixHeader) == 64,
+    "MappedMatrixHeader must be exactly 64 bytes");
+
+//! The magic string at the start of every memory-mappable matrix file.
+inline const char* MappedMatrixMagic() { return "MLPKMMAT"; }
+
+//! Report an error while loading or saving, and return false.
+inline bool MappedMatrixError(const std::string& message, const bool fatal)
+{
+  if (fatal)
+    Log::Fatal << message << std::endl;
+  else
+    Log::Warn << message << std::endl;
+
+  return false;
+}
+
+/**
+ * The memory mappings currently in use by matrices loaded with LoadMapped(),
+ * keyed by the address of the first element of the matrix.  Each entry holds
+ * the start and length of the mapping.  The mappings that were not released
+ * with Unmap() are released when the registry is destroyed at exit.
+ */
+class MappedRegionRegistry
+{
+ public:
+  ~MappedRegionRegistry()
+  {
+#ifndef _WIN32
+    for (std::map<const void*, std::pair<void*, size_t>>::iterator it =
+        regions.begin(); it != regions.end(); ++it)
+      munmap(it->second.first, it->second.second);
+#endif
+  }
+
+  //! The registered mappings.
+  std::map<const void*, std::pair<void*, size_t>> regions;
+};
+
+//! Get the registry of memory mappings in use.
+inline std::map<const void*, std::pair<void*, size_t>>& MappedRegions()
+{
+  static MappedRegionRegistry registry;
+  return registry.regions;
+}
+
+//! Mutex protecting MappedRegions().
+inline std::mutex& MappedRegionsMutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+/**
+ * Open the given memory-mappable matrix file, and read and check its header for
+ * elements of type eT.  On success, the stream is left open and fileSize holds
+ * the size of the file.
+ */
+template<typename eT>
+bool ReadMappedMatrixHeader(const std::string& filename,
+                            std::ifstream& stream,
+                            MappedMatrixHeader& header,
+                            size_t& fileSize,
+                            const bool fatal)
+{
+  stream.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+  {
+    return MappedMatrixError("Cannot open file '" + filename + "'; "
+        "load failed.", fatal);
+  }
+
+  if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)))
+  {
+    return MappedMatrixError("File '" + filename + "' is too short "
+        "to be a memory-mappable matrix file; load failed.", fatal);
+  }
+
+  if (std::memcmp(header.magic, MappedMatrixMagic(), 8) != 0)
+  {
+    return MappedMatrixError("File '" + filename + "' is not a "
+        "memory-mappable matrix file; load failed.", fatal);
+  }
+
+  if (header.version > MappedMatrixVersion)
+  {
+    std::ostringstream oss;
+    oss << "File '" << filename << "' has version " << header.version << " of "
+        << "the memory-mappable matrix format, but only versions up to "
+        << MappedMatrixVersion << " are supported; load failed.";
+    return MappedMatrixError(oss.str(), fatal);
+  }
+
+  if (header.byteOrder != 0x01020304)
+  {
+    return MappedMatrixError("File '" + filename + "' was written "
+        "with a different byte order; load failed.", fatal);
+  }
+
+  if (header.elementType != MappedElementType<eT>())
+  {
+    std::ostringstream oss;
+    oss << "File '" << filename << "' holds elements of type code 0x"
+        << std::hex << header.elementType << ", but the matrix has type code "
+        << "0x" << MappedElementType<eT>() << "; load failed.";
+    return MappedMatrixError(oss.str(), fatal);
+  }
+
+  // Check the sizes before computing them, so that a crafted header can't make
+  // them wrap around.
+  stream.seekg(0, std::ios::end);
+  fileSize = (size_t) stream.tellg();
+  const uint64_t maxElements = std::min((uint64_t)
+      std::numeric_limits<size_t>::max() / sizeof(eT),
+      (uint64_t) std::numeric_limits<arma::uword>::max());
+  if (header.nRows > maxElements || header.nCols > maxElements ||
+      (header.nCols != 0 && header.nRows > maxElements / header.nCols) ||
+      header.dataOffset < sizeof(header) || header.dataOffset % 64 != 0 ||
+      header.dataOffset > fileSize ||
+      header.nRows * header.nCols * sizeof(eT) > fileSize - header.dataOffset)
+  {
+    return MappedMatrixError("File '" + filename + "' is truncated "
+        "or has an invalid header; load failed.", fatal);
+  }
+
+  return true;
+}
+
+#ifndef _WIN32
+/**
+ * Map the given memory-mappable matrix file, whose header has already been
+ * read and checked, into memory.  On success, region and regionSize hold the
+ * mapping, which must be released with munmap().
+ */
+inline bool MapMatrixFile(const std::string& filename,
+                          const size_t fileSize,
+                          void*& region,
+                          size_t& regionSize,
+                          const bool fatal)
+{
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+  {
+    return MappedMatrixError("Cannot open file '" + filename + "'; "
+        "load failed.", fatal);
+  }
+
+  // The mapping is private, so writes to the matrix (for instance, when a tree
+  // rearranges the dataset) are copy-on-write and never reach the file.
+  region = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (region == MAP_FAILED)
+  {
+    region = NULL;
+    return MappedMatrixError("Mapping file '" + filename + "' into "
+        "memory failed; load failed.", fatal);
+  }
+
+  regionSize = fileSize;
+  return true;
+}
+#endif
+
+/**
+ * Read the data of the given memory-mappable matrix file, whose header has
+ * already been read and checked, into the given matrix.  This is used when the
+ * file cannot be mapped.
+ */
+template<typename eT>
+bool ReadMappedMatrixData(const std::string& filename,
+                          std::ifstream& stream,
+                          const MappedMatrixHeader& header,
+                          arma::Mat<eT>& matrix,
+                          const bool fatal)
+{
+  matrix.set_size(header.nRows, header.nCols);
+  stream.seekg(header.dataOffset);
+  if (!stream.read(reinterpret_cast<char*>(matrix.memptr()),
+      matrix.n_elem * sizeof(eT)))
+  {
+    matrix.reset();
+    return MappedMatrixError("Reading from '" + filename + "' failed.",
+        fatal);
+  }
+
+  return true;
+}
+
+} // namespace details
+
+template<typename eT>
+uint32_t MappedElementType()
+{
+  const uint32_t kind = std::is_floating_point<eT>::value ? 1 :
+      (std::is_signed<eT>::value ? 2 : 3);
+  return (kind << 8) | (uint32_t) sizeof(eT);
+}
+
+template<typename eT>
+bool LoadMapped(const std::string& filename,
+                arma::Mat<eT>& matrix,
+                const bool fatal,
+                const bool transpose)
+{
+  // Read and check the header first.
+  std::ifstream stream;
+  MappedMatrixHeader header;
+  size_t fileSize;
+  if (!details::ReadMappedMatrixHeader<eT>(filename, stream, header, fileSize,
+      fatal))
+    return false;
+
+  const size_t dataSize = header.nRows * header.nCols * sizeof(eT);
+
+  Log::Info << "Loading '" << filename << "' as memory-mappable binary data.  "
+      << "Size is " << (transpose ? header.nRows : header.nCols) << " x "
+      << (transpose ? header.nCols : header.nRows) << ".\n";
+
+#ifndef _WIN32
+  stream.close();
+
+  void* region;
+  size_t regionSize;
+  if (!details::MapMatrixFile(filename, fileSize, region, regionSize, fatal))
+    return false;
+
+  eT* mem = reinterpret_cast<eT*>(static_cast<char*>(region) +
+      header.dataOffset);
+
+  if (!transpose)
+  {
+    // The file holds the transpose of what we want, so we have to copy anyway.
+    arma::Mat<eT> mapped(mem, header.nRows, header.nCols, false, true);
+    matrix = arma::trans(mapped);
+    munmap(region, regionSize);
+    return true;
+  }
+
+  // Don't register empty matrices: Armadillo won't use auxiliary memory for
+  // them.
+  if (dataSize == 0)
+  {
+    munmap(region, regionSize);
+    matrix.set_size(header.nRows, header.nCols);
+    return true;
+  }
+
+  // Wrap the mapped memory without a copy.  The matrix is not strict, so it may
+  // still be resized (at which point it will allocate its own memory).
+  arma::Mat<eT> mapped(mem, header.nRows, header.nCols, false, false);
+  Unmap(matrix);
+  matrix = std::move(mapped);
+
+  std::lock_guard<std::mutex> lock(details::MappedRegionsMutex());
+  details::MappedRegions()[matrix.memptr()] = std::make_pair(region,
+      regionSize);
+#else
+  // No mmap() here, so we have to read the data.
+  (void) dataSize;
+  arma::Mat<eT> data;
+  if (!details::ReadMappedMatrixData(filename, stream, header, data, fatal))
+    return false;
+
+  if (transpose)
+    matrix = std::move(data);
+  else
+    matrix = arma::trans(data);
+#endif
+
+  return true;
+}
+
+template<typename eT>
+bool SaveMapped(const std::string& filename,
+                const arma::Mat<eT>& matrix,
+                const bool fatal,
+                const bool transpose)
+{
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary |
+      std::ios::trunc);
+  if (!stream.is_open())
+  {
+    return details::MappedMatrixError("Cannot open file '" + filename + "' "
+        "for writing; save failed.", fatal);
+  }
+
+  // If we aren't transposing, then the file has to hold the transpose.
+  arma::Mat<eT> transposed;
+  if (!transpose)
+    transposed = arma::trans(matrix);
+  const arma::Mat<eT>& output = transpose ? matrix : transposed;
+
+  MappedMatrixHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, details::MappedMatrixMagic(), 8);
+  header.version = MappedMatrixVersion;
+  header.elementType = MappedElementType<eT>();
+  header.nRows = output.n_rows;
+  header.nCols = output.n_cols;
+  header.dataOffset = sizeof(header);
+  header.byteOrder = 0x01020304;
+
+  Log::Info << "Saving memory-mappable binary data to '" << filename << "'."
+      << std::endl;
+
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream.write(reinterpret_cast<const char*>(output.memptr()),
+      output.n_elem * sizeof(eT));
+  if (!stream.good())
+  {
+    return details::MappedMatrixError("Save to '" + filename + "' failed.",
+        fatal);
+  }
+
+  return true;
+}
+
+template<typename eT>
+bool Unmap(arma::Mat<eT>& matrix)
+{
+#ifndef _WIN32
+  std::lock_guard<std::mutex> lock(details::MappedRegionsMutex());
+  std::map<const void*, std::pair<void*, size_t>>& regions =
+      details::MappedRegions();
+  typename std::map<const void*, std::pair<void*, size_t>>::iterator it =
+      regions.find(matrix.memptr());
+  if (it == regions.end())
+    return false;
+
+  // Detach the matrix from the mapping before it goes away.
+  matrix.reset();
+  munmap(it->second.first, it->second.second);
+  regions.erase(it);
+  return true;
+#else
+  (void) matrix;
+  return false;
+#endif
+}
+
+template<typename eT>
+MappedMatrix<eT>::MappedMatrix() :
+    region(NULL),
+    regionSize(0)
+{
+  // Nothing to do.
+}
+
+template<typename eT>
+MappedMatrix<eT>::MappedMatrix(const std::string& filename, const bool fatal) :
+    region(NULL),
+    regionSize(0)
+{
+  Load(filename, fatal);
+}
+
+template<typename eT>
+MappedMatrix<eT>::MappedMatrix(MappedMatrix&& other) :
+    matrix(std::move(other.matrix)),
+    region(other.region),
+    regionSize(other.regionSize)
+{
+  other.matrix.reset();
+  other.region = NULL;
+  other.regionSize = 0;
+}
+
+template<typename eT>
+MappedMatrix<eT>& MappedMatrix<eT>::operator=(MappedMatrix&& other)
+{
+  if (this != &other)
+  {
+    Reset();
+    matrix = std::move(other.matrix);
+    region = other.region;
+    regionSize = other.regionSize;
+
+    other.matrix.reset();
+    other.region = NULL;
+    other.regionSize = 0;
+  }
+
+  return *this;
+}
+
+template<typename eT>
+MappedMatrix<eT>::~MappedMatrix()
+{
+  Reset();
+}
+
+template<typename eT>
+bool MappedMatrix<eT>::Load(const std::string& filename, const bool fatal)
+{
+  Reset();
+
+  std::ifstream stream;
+  MappedMatrixHeader header;
+  size_t fileSize;
+  if (!details::ReadMappedMatrixHeader<eT>(filename, stream, header, fileSize,
+      fatal))
+    return false;
+
+  Log::Info << "Loading '" << filename << "' as memory-mappable binary data.  "
+      << "Size is " << header.nRows << " x " << header.nCols << ".\n";
+
+#ifndef _WIN32
+  // Armadillo won't use auxiliary memory for empty matrices.
+  if (header.nRows * header.nCols == 0)
+  {
+    matrix.set_size(header.nRows, header.nCols);
+    return true;
+  }
+
+  stream.close();
+  if (!details::MapMatrixFile(filename, fileSize, region, regionSize, fatal))
+    return false;
+
+  eT* mem = reinterpret_cast<eT*>(static_cast<char*>(region) +
+      header.dataOffset);
+  matrix = arma::Mat<eT>(mem, header.nRows, header.nCols, false, false);
+  return true;
+#else
+  return details::ReadMappedMatrixData(filename, stream, header, matrix,
+      fatal);
+#endif
+}
+
+template<typename eT>
+void MappedMatrix<eT>::Reset()
+{
+  // Detach the matrix from the mapping before it goes away.
+  matrix.reset();
+
+#ifndef _WIN32
+  if (region != NULL)
+    munmap(region, regionSize);
+#endif
+
+  region = NULL;
+  regionSize = 0;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -39,6 +39,7 @@ namespace data /** Functions to load and save matrices. */ {
  *  - Raw binary (raw_binary), denoted by .bin
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5 (hdf5_binary), denoted by .hdf5, .hdf, .h5, or .he5
+ *  - mlpack memory-mappable binary, denoted by .mbin (see SaveMapped())
  *
  * If the file extension is not one of those types, an error will be given.  If
  * the 'fatal' parameter is set to true, a std::runtime_error exception will be
@@ -15,6 +15,7 @@
 // In case it hasn't already been included.
 #include "save.hpp"
 #include "extension.hpp"
+#include "mapped_matrix.hpp"
 
 #include <boost/serialization/serialization.hpp>
 #include <boost/archive/xml_oarchive.hpp>
@@ -64,6 +65,19 @@ bool Save(const std::string& filename,
     return false;
   }
 
+  // Memory-mappable binary files aren't saved through Armadillo.
+  if (extension == "mbin")
+  {
+    // The reason of a failure is reported as a warning, so that the timer can
+    // be stopped before a fatal error is reported.
+    const bool success = SaveMapped(filename, matrix, false, transpose);
+    Timer::Stop("saving_data");
+    if (!success && fatal)
+      Log::Fatal << "Saving to '" << filename << "' failed." << std::endl;
+
+    return success;
+  }
+
   // Catch errors opening the file.
   std::fstream stream;
 #ifdef  _WIN32 // Always open in binary mode on Windows.
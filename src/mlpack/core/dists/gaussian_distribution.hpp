@@ -110,17 +110,16 @@ class GaussianDistribution
     // Column i of 'diffs' is the difference between x.col(i) and the mean.
     arma::mat diffs = x;
     diffs.each_col() -= mean;
-    // Now, we only want to calculate the diagonal elements of (diffs' * cov^-1
-    // * diffs).  We just don't need any of the other elements.  We can
-    // calculate the right hand part of the equation (instead of the left side)
-    // so that later we are referencing columns, not rows -- that is faster.
-    const arma::mat rhs = -0.5 * invCov * diffs;
-    arma::vec logExponents(diffs.n_cols); // We will now fill this.
-    for (size_t i = 0; i < diffs.n_cols; i++)
-      logExponents(i) = accu(diffs.unsafe_col(i) % rhs.unsafe_col(i));
+    // With cov = LL^T, the exponent diffs.col(i)^T * cov^-1 * diffs.col(i) is
+    // the squared norm of L^-1 * diffs.col(i).  So the exponents of all of the
+    // observations take one triangular solve with the Cholesky factor (no
+    // inverse is needed), and a sum over each column.
+    const arma::mat whitened = arma::solve(arma::trimatl(covLower), diffs);
+    const arma::rowvec logExponents = -0.5 *
+        arma::sum(arma::square(whitened), 0);
 
     logProbabilities = -0.5 * x.n_rows * log2pi - 0.5 * logDetCov +
-      logExponents;
+      logExponents.t();
   }
 
   /**
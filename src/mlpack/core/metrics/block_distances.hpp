@@ -0,0 +1,236 @@
+/**
+ * @file block_distances.hpp
+ *
+ * Compute the distances between every pair of points from two contiguous
+ * blocks of points at once, as needed when two leaves of a tree are compared.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_METRICS_BLOCK_DISTANCES_HPP
+#define MLPACK_CORE_METRICS_BLOCK_DISTANCES_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <unordered_map>
+#include "lmetric.hpp"
+
+namespace mlpack {
+namespace metric {
+
+/**
+ * The center of a block of points and the squared norms of the points of the
+ * block once they are centered, as used by BlockDistances() for the Euclidean
+ * distances.
+ */
+template<typename eT>
+struct BlockNorms
+{
+  //! The mean of the points of the block.
+  arma::Col<eT> center;
+  //! The squared norm of each point of the block, relative to the center.
+  arma::Row<eT> norms;
+};
+
+/**
+ * A cache of the BlockNorms of blocks of points from one matrix, so that they
+ * are only computed the first time that a block is used.  This is meant for
+ * the leaves of a reference tree, which are compared to many query leaves
+ * during a dual-tree traversal.  Blocks are identified by the index of their
+ * first point, so the points of the matrix must not change while the cache is
+ * in use (call Clear() otherwise).
+ */
+template<typename eT>
+class BlockNormCache
+{
+ public:
+  /**
+   * Get the BlockNorms of the points [begin, begin + count) of the given
+   * matrix, computing them if they are not cached yet.  The count must not be
+   * zero.
+   *
+   * @param points Matrix holding the block.
+   * @param begin Index of the first point of the block.
+   * @param count Number of points in the block.
+   */
+  const BlockNorms<eT>& Get(const arma::Mat<eT>& points,
+                            const size_t begin,
+                            const size_t count)
+  {
+    BlockNorms<eT>& block = blocks[begin];
+    if (block.norms.n_elem != count)
+    {
+      arma::Mat<eT> centered = points.cols(begin, begin + count - 1);
+      block.center = arma::mean(centered, 1);
+      centered.each_col() -= block.center;
+      block.norms = arma::sum(arma::square(centered), 0);
+    }
+
+    return block;
+  }
+
+  //! Forget all of the cached blocks.
+  void Clear() { blocks.clear(); }
+
+ private:
+  //! The cached blocks, indexed by their first point.
+  std::unordered_map<size_t, BlockNorms<eT>> blocks;
+};
+
+/**
+ * Compute the distances between the points [aBegin, aBegin + aCount) of a and
+ * the points [bBegin, bBegin + bCount) of b; after the call, distances(i, j)
+ * holds the distance between point (aBegin + i) of a and point (bBegin + j) of
+ * b.  This general version calls metric.Evaluate() for every pair; the
+ * overload for the Euclidean and squared Euclidean distances on dense matrices
+ * below is much faster.
+ *
+ * @param metric Metric to use.
+ * @param a First set of points.
+ * @param aBegin Index of the first point of a.
+ * @param aCount Number of points of a.
+ * @param b Second set of points.
+ * @param bBegin Index of the first point of b.
+ * @param bCount Number of points of b.
+ * @param distances Matrix to store the distances in.
+ */
+template<typename MetricType, typename MatType>
+void BlockDistances(MetricType& metric,
+                    const MatType& a,
+                    const size_t aBegin,
+                    const size_t aCount,
+                    const MatType& b,
+                    const size_t bBegin,
+                    const size_t bCount,
+                    arma::Mat<typename MatType::elem_type>& distances)
+{
+  distances.set_size(aCount, bCount);
+  for (size_t j = 0; j < bCount; ++j)
+    for (size_t i = 0; i < aCount; ++i)
+      distances(i, j) = metric.Evaluate(a.col(aBegin + i), b.col(bBegin + j));
+}
+
+/**
+ * Compute the distances between two blocks of points like above; the cache of
+ * the norms of the blocks of b is not needed by the general version, so it is
+ * ignored.
+ */
+template<typename MetricType, typename MatType>
+void BlockDistances(MetricType& metric,
+                    const MatType& a,
+                    const size_t aBegin,
+                    const size_t aCount,
+                    const MatType& b,
+                    const size_t bBegin,
+                    const size_t bCount,
+                    arma::Mat<typename MatType::elem_type>& distances,
+                    BlockNormCache<typename MatType::elem_type>& /* bCache */)
+{
+  BlockDistances(metric, a, aBegin, aCount, b, bBegin, bCount, distances);
+}
+
+/**
+ * Compute the (squared) Euclidean distances between the points
+ * [aBegin, aBegin + aCount) of a and the points [bBegin, bBegin + bCount) of b
+ * with the expansion ||x - y||^2 = ||x||^2 + ||y||^2 - 2 x^T y.  The inner
+ * products are computed with one matrix multiplication, which Armadillo hands
+ * to the BLAS, so the work is done by vectorized (SSE/AVX/AVX-512, depending
+ * on the BLAS) kernels instead of one short vector operation per pair.
+ *
+ * The expansion loses precision when ||x - y||^2 is much smaller than
+ * ||x||^2 + ||y||^2.  To limit this, both blocks are first centered on the mean
+ * of the second block (so the norms are on the scale of the blocks, not of the
+ * dataset), and any pair whose squared distance is still small compared to its
+ * squared norms is computed again directly.  This bounds the relative error
+ * of every squared distance by a small multiple of the square root of the
+ * machine epsilon, and duplicate points are at distance exactly 0.
+ *
+ * The center and the norms of the block of b are taken from bCache, so when
+ * the same block of b is used many times they are only computed once.
+ *
+ * @param metric Metric to use.
+ * @param a First set of points.
+ * @param aBegin Index of the first point of a.
+ * @param aCount Number of points of a.
+ * @param b Second set of points.
+ * @param bBegin Index of the first point of b.
+ * @param bCount Number of points of b.
+ * @param distances Matrix to store the distances in.
+ * @param bCache Cache of the norms of the blocks of b.
+ */
+template<bool TakeRoot, typename eT>
+void BlockDistances(LMetric<2, TakeRoot>& /* metric */,
+                    const arma::Mat<eT>& a,
+                    const size_t aBegin,
+                    const size_t aCount,
+                    const arma::Mat<eT>& b,
+                    const size_t bBegin,
+                    const size_t bCount,
+                    arma::Mat<eT>& distances,
+                    BlockNormCache<eT>& bCache)
+{
+  if (aCount == 0 || bCount == 0)
+  {
+    distances.set_size(aCount, bCount);
+    return;
+  }
+
+  // Center both blocks on the mean of the second block.
+  const BlockNorms<eT>& bBlockNorms = bCache.Get(b, bBegin, bCount);
+  const arma::Col<eT>& center = bBlockNorms.center;
+  const arma::Row<eT>& bNorms = bBlockNorms.norms;
+  arma::Mat<eT> aBlock = a.cols(aBegin, aBegin + aCount - 1);
+  arma::Mat<eT> bBlock = b.cols(bBegin, bBegin + bCount - 1);
+  aBlock.each_col() -= center;
+  bBlock.each_col() -= center;
+
+  const arma::Col<eT> aNorms = arma::sum(arma::square(aBlock), 0).t();
+
+  distances = eT(-2) * aBlock.t() * bBlock;
+  distances.each_col() += aNorms;
+  distances.each_row() += bNorms;
+
+  // Recompute the pairs that are too close for the expansion to be accurate.
+  const eT tolerance = 10 * std::sqrt(std::numeric_limits<eT>::epsilon()) *
+      eT(a.n_rows);
+  for (size_t j = 0; j < bCount; ++j)
+  {
+    for (size_t i = 0; i < aCount; ++i)
+    {
+      eT& distance = distances(i, j);
+      if (distance <= tolerance * (aNorms[i] + bNorms[j]))
+      {
+        distance = LMetric<2, false>::Evaluate(a.unsafe_col(aBegin + i),
+            b.unsafe_col(bBegin + j));
+      }
+    }
+  }
+
+  if (TakeRoot)
+    distances = arma::sqrt(distances);
+}
+
+/**
+ * Compute the (squared) Euclidean distances between two blocks of points like
+ * above, computing the norms of the block of b from scratch.
+ */
+template<bool TakeRoot, typename eT>
+void BlockDistances(LMetric<2, TakeRoot>& metric,
+                    const arma::Mat<eT>& a,
+                    const size_t aBegin,
+                    const size_t aCount,
+                    const arma::Mat<eT>& b,
+                    const size_t bBegin,
+                    const size_t bCount,
+                    arma::Mat<eT>& distances)
+{
+  BlockNormCache<eT> bCache;
+  BlockDistances(metric, a, aBegin, aCount, b, bBegin, bCount, distances,
+      bCache);
+}
+
+} // namespace metric
+} // namespace mlpack
+
+#endif
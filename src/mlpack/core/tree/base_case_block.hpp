@@ -0,0 +1,87 @@
+/**
+ * @file base_case_block.hpp
+ *
+ * A utility for traversers that evaluates the base cases between two blocks of
+ * points at once, if the rules support it.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BASE_CASE_BLOCK_HPP
+#define MLPACK_CORE_TREE_BASE_CASE_BLOCK_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+namespace details {
+
+//! Call rule.BaseCaseBlock(), if RuleType has it.
+template<typename RuleType>
+auto CallBaseCaseBlock(RuleType& rule,
+                       const size_t queryBegin,
+                       const size_t queryEnd,
+                       const size_t referenceBegin,
+                       const size_t referenceEnd,
+                       const int /* preferred */)
+    -> decltype(rule.BaseCaseBlock(queryBegin, queryEnd, referenceBegin,
+        referenceEnd), void())
+{
+  rule.BaseCaseBlock(queryBegin, queryEnd, referenceBegin, referenceEnd);
+}
+
+//! Otherwise, call rule.BaseCase() for every pair.
+template<typename RuleType>
+void CallBaseCaseBlock(RuleType& rule,
+                       const size_t queryBegin,
+                       const size_t queryEnd,
+                       const size_t referenceBegin,
+                       const size_t referenceEnd,
+                       const long /* fallback */)
+{
+  for (size_t query = queryBegin; query < queryEnd; ++query)
+    for (size_t ref = referenceBegin; ref < referenceEnd; ++ref)
+      rule.BaseCase(query, ref);
+}
+
+} // namespace details
+
+/**
+ * Evaluate the base cases between every query point in
+ * [queryBegin, queryEnd) and every reference point in
+ * [referenceBegin, referenceEnd), in that order.  If RuleType has a method
+ *
+ * @code
+ * void BaseCaseBlock(const size_t queryBegin,
+ *                    const size_t queryEnd,
+ *                    const size_t referenceBegin,
+ *                    const size_t referenceEnd);
+ * @endcode
+ *
+ * then it is called to evaluate all of the base cases at once (this lets the
+ * rules compute all of the distances with metric::BlockDistances()); otherwise,
+ * rule.BaseCase() is called for every pair.
+ *
+ * @param rule Rules to evaluate the base cases with.
+ * @param queryBegin Index of the first query point.
+ * @param queryEnd One past the index of the last query point.
+ * @param referenceBegin Index of the first reference point.
+ * @param referenceEnd One past the index of the last reference point.
+ */
+template<typename RuleType>
+void BaseCaseBlock(RuleType& rule,
+                   const size_t queryBegin,
+                   const size_t queryEnd,
+                   const size_t referenceBegin,
+                   const size_t referenceEnd)
+{
+  details::CallBaseCaseBlock(rule, queryBegin, queryEnd, referenceBegin,
+      referenceEnd, 0);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -15,23 +15,38 @@
 
 #include "../statistic.hpp"
 #include "midpoint_split.hpp"
+#include "split_traits.hpp"
+
+#include <unordered_set>
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 
+// Forward declaration, so that InsertPoints() can refuse UB trees.
+template<typename BoundType, typename MatType>
+class UBTreeSplit;
+
 /**
  * A binary space partitioning tree, such as a KD-tree or a ball tree.  Once the
  * bound and type of dataset is defined, the tree will construct itself.  Call
  * the constructor with the dataset to build the tree on, and the entire tree
  * will be built.
  *
- * This particular tree does not allow growth, so you cannot add or delete nodes
- * from it.  If you need to add or delete a node, the better procedure is to
- * rebuild the tree entirely.
+ * Points can be added to and removed from the tree in batches with
+ * InsertPoints() and DeletePoints(), which only rebuild the parts of the tree
+ * that change; after many updates the tree may be less balanced than a tree
+ * built from scratch.
  *
  * This tree does take one runtime parameter in the constructor, which is the
  * max leaf size to be used.
  *
+ * If mlpack is compiled with OpenMP and SplitTraits<SplitType>::IsThreadSafe is
+ * true (as it is for MidpointSplit and MeanSplit, so for KD-trees and ball
+ * trees), the tree is built in parallel: large children are built in separate
+ * tasks, and the points of large nodes are partitioned in parallel.  The nodes
+ * hold the same points as when the tree is built serially, but the order of the
+ * points inside a node (and so oldFromNew) may differ.
+ *
  * @tparam MetricType The metric used for tree-building.  The BoundType may
  *     place restrictions on the metrics that can be used.
  * @tparam StatisticType Extra data contained in the node.  See statistic.hpp
@@ -88,6 +103,17 @@ class BinarySpaceTree
   //! The dataset.  If we are the root of the tree, we own the dataset and must
   //! delete it.
   MatType* dataset;
+  //! If this is the root of a tree that has been compacted with Compact(), the
+  //! memory that holds all of the other nodes of the tree; otherwise, NULL.
+  BinarySpaceTree* nodeStorage = NULL;
+  //! If this is the root of a tree that points were inserted into, the memory
+  //! that holds the dataset and spare columns for later insertions; the dataset
+  //! is an alias of its first columns.  Otherwise, NULL.
+  MatType* datasetStorage = NULL;
+
+  //! The number of points a child must hold to be built in its own OpenMP task
+  //! (when the splitter allows it; see SplitTraits).
+  static const size_t parallelBuildMinSize = 4096;
 
  public:
   //! A single-tree traverser for binary space trees; see
@@ -327,6 +353,77 @@ class BinarySpaceTree
   //! Return whether or not this node is a leaf (true if it has no children).
   bool IsLeaf() const;
 
+  /**
+   * Move every node of the tree except the root into one contiguous block of
+   * memory, in van Emde Boas order (the default) or in breadth-first order, so
+   * that the nodes visited one after another by a traversal are close to each
+   * other in memory.  Breadth-first order keeps the top levels of the tree,
+   * which every traversal visits, together; van Emde Boas order also keeps each
+   * small subtree together, so a descent from the root to a leaf touches few
+   * cache lines at every depth.  The structure of the tree does not change, so
+   * all traversers work on a compacted tree as before.
+   *
+   * This may only be called on the root of the tree, and invalidates any
+   * pointers to the other nodes of the tree.  The children of a compacted tree
+   * must not be deleted or replaced individually; copying a compacted tree
+   * gives a tree that is not compacted.
+   *
+   * @param vanEmdeBoas If true, use van Emde Boas order; otherwise, use
+   *     breadth-first order.
+   */
+  void Compact(const bool vanEmdeBoas = true);
+
+  //! Return whether or not this is the root of a tree that has been compacted.
+  bool IsCompact() const { return nodeStorage != NULL; }
+
+  /**
+   * Insert the given points into the tree without rebuilding it.  Each point is
+   * sent down to the child whose bound is nearest until it reaches a leaf, and
+   * the bounds of the nodes on the way are expanded to hold it; then every leaf
+   * that holds more than maxLeafSize points is split as during construction.
+   * The points of the dataset are moved in place to put the new points in the
+   * ranges of their leaves, so inserting many points at once is much cheaper
+   * than inserting them one at a time.  The dataset keeps spare columns that
+   * grow geometrically, so it is only reallocated once in a while.
+   *
+   * oldFromNew must hold the mapping filled by the constructor (or by an
+   * earlier update), and is updated; the new points get the old indices that
+   * follow the existing points, in order.  If the tree was built without a
+   * mapping, pass 0, 1, ..., n - 1.  The statistics of the nodes that changed
+   * are rebuilt.  If the tree was compacted, it is compacted again afterwards
+   * (in van Emde Boas order).
+   *
+   * This may only be called on the root of the tree.  Trees built with
+   * UBTreeSplit do not support insertion.
+   *
+   * @param points Points to insert.
+   * @param oldFromNew Old index of every point of the dataset.
+   * @param maxLeafSize Maximum number of points in a leaf.
+   */
+  void InsertPoints(const MatType& points,
+                    std::vector<size_t>& oldFromNew,
+                    const size_t maxLeafSize = 20);
+
+  /**
+   * Delete the points at the given indices of the dataset of the tree (that is,
+   * indices in the rearranged dataset, as returned by Point()).  The points are
+   * removed from the dataset, nodes that become empty are removed, and the
+   * bounds and statistics of the nodes that changed are recomputed (except the
+   * ball bounds of internal nodes, which can't be combined and are kept).
+   *
+   * oldFromNew is updated as if the deleted points had been removed from the
+   * original dataset with shed_cols(): the deleted old indices are dropped, and
+   * the old indices after them are decreased.  If the tree was compacted, it is
+   * compacted again afterwards (in van Emde Boas order).
+   *
+   * This may only be called on the root of the tree.
+   *
+   * @param points Indices of the points to delete in the dataset of the tree.
+   * @param oldFromNew Old index of every point of the dataset.
+   */
+  void DeletePoints(const std::vector<size_t>& points,
+                    std::vector<size_t>& oldFromNew);
+
   //! Gets the left child of this node.
   BinarySpaceTree* Left() const { return left; }
   //! Modify the left child of this node.
@@ -545,6 +642,95 @@ class BinarySpaceTree
    */
   void UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate);
 
+  /**
+   * Recompute the bound of the current node from the bounds of its children.
+   *
+   * @param boundToUpdate The bound to update.
+   */
+  template<typename BoundType2>
+  void CombineChildBounds(BoundType2& boundToUpdate);
+
+  /**
+   * Ball bounds can't be combined, so the bound of the current node is kept
+   * (it still holds all of the points of the node).
+   *
+   * @param boundToUpdate The bound to update.
+   */
+  void CombineChildBounds(bound::BallBound<MetricType>& boundToUpdate);
+
+  /**
+   * Delete the children of this node, and set them to NULL.  If this is the
+   * root of a compacted tree, the memory holding all of its nodes is released.
+   */
+  void DeleteChildren();
+
+  /**
+   * Destroy the given node of a compacted tree and its descendants, without
+   * releasing their memory.
+   */
+  static void DestroyCompactNode(BinarySpaceTree* node);
+
+  /**
+   * Move every node of a compacted tree back into its own allocation, so that
+   * nodes can be added and deleted.
+   */
+  void Uncompact();
+
+  /**
+   * Set the begin and count of every node of this subtree from the counts of
+   * the leaves, with the first point at the given position.  Returns the
+   * position after the last point of the subtree.
+   */
+  size_t UpdateRanges(const size_t position);
+
+  /**
+   * Set the number of columns of the dataset of the root, keeping its first
+   * columns.  When the dataset grows, it becomes an alias of the first columns
+   * of datasetStorage, which grows geometrically, so that repeated insertions
+   * only copy the dataset once in a while.  New columns are uninitialized.
+   *
+   * @param nCols New number of columns of the dataset.
+   */
+  void ResizeDataset(const size_t nCols);
+
+  /**
+   * Send the given points down to the leaves of this subtree, expanding the
+   * bounds on the way, and append each leaf that receives points (in order)
+   * along with the indices of those points to leafPoints.
+   */
+  void RoutePoints(const MatType& points,
+                   const std::vector<size_t>& indices,
+                   std::vector<std::pair<BinarySpaceTree*,
+                                         std::vector<size_t>>>& leafPoints);
+
+  /**
+   * After an insertion, split the leaves in the given set and update the
+   * distances and statistics of the nodes in the set, from the bottom up.
+   */
+  void RefreshInserted(const std::unordered_set<BinarySpaceTree*>& changed,
+                       std::vector<size_t>& oldFromNew,
+                       const size_t maxLeafSize,
+                       SplitType<BoundType<MetricType>, MatType>& splitter);
+
+  /**
+   * After a deletion, remove empty nodes and recompute the bounds, distances
+   * and statistics of the nodes in the given set, from the bottom up.
+   */
+  void RefreshDeleted(const std::unordered_set<BinarySpaceTree*>& changed);
+
+  //! Recompute the parent distances of the children of this node.
+  void UpdateChildDistances();
+
+  /**
+   * Append the first levels levels of the subtree rooted at node to order, in
+   * van Emde Boas order, and append the nodes just below those levels to
+   * frontier.
+   */
+  static void VanEmdeBoasOrder(BinarySpaceTree* node,
+                               const size_t levels,
+                               std::vector<BinarySpaceTree*>& order,
+                               std::vector<BinarySpaceTree*>& frontier);
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
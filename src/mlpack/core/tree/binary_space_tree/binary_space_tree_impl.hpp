@@ -16,6 +16,7 @@
 
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
+#include <new>
 #include <queue>
 
 namespace mlpack {
@@ -399,8 +400,9 @@ operator=(const BinarySpaceTree& other)
 
   // Freeing memory that will not be used anymore.
   delete dataset;
-  delete left;
-  delete right;
+  delete datasetStorage;
+  datasetStorage = NULL;
+  DeleteChildren();
 
   left = NULL;
   right = NULL;
@@ -471,8 +473,8 @@ operator=(BinarySpaceTree&& other)
 
   // Freeing memory that will not be used anymore.
   delete dataset;
-  delete left;
-  delete right;
+  delete datasetStorage;
+  DeleteChildren();
 
   parent = other.Parent();
   left = other.Left();
@@ -485,6 +487,8 @@ operator=(BinarySpaceTree&& other)
   furthestDescendantDistance = other.FurthestDescendantDistance();
   minimumBoundDistance = other.MinimumBoundDistance();
   dataset = other.dataset;
+  nodeStorage = other.nodeStorage;
+  datasetStorage = other.datasetStorage;
 
   other.left = NULL;
   other.right = NULL;
@@ -495,6 +499,8 @@ operator=(BinarySpaceTree&& other)
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.nodeStorage = NULL;
+  other.datasetStorage = NULL;
 
   return *this;
 }
@@ -521,7 +527,9 @@ BinarySpaceTree(BinarySpaceTree&& other) :
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
-    dataset(other.dataset)
+    dataset(other.dataset),
+    nodeStorage(other.nodeStorage),
+    datasetStorage(other.datasetStorage)
 {
   // Now we are a clone of the other tree.  But we must also clear the other
   // tree's contents, so it doesn't delete anything when it is destructed.
@@ -534,6 +542,8 @@ BinarySpaceTree(BinarySpaceTree&& other) :
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.nodeStorage = NULL;
+  other.datasetStorage = NULL;
 
   // Set new parent.
   if (left)
@@ -577,12 +587,14 @@ template<typename MetricType,
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     ~BinarySpaceTree()
 {
-  delete left;
-  delete right;
+  DeleteChildren();
 
   // If we're the root, delete the matrix.
   if (!parent)
+  {
     delete dataset;
+    delete datasetStorage;
+  }
 }
 
 template<typename MetricType,
@@ -597,6 +609,647 @@ inline bool BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
   return !left;
 }
 
+/**
+ * Move all nodes but the root into one contiguous block of memory.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    Compact(const bool vanEmdeBoas)
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument("BinarySpaceTree::Compact(): only the root of "
+        "a tree can be compacted");
+  }
+
+  // Collect the nodes in breadth-first order, counting the levels.
+  std::vector<BinarySpaceTree*> order;
+  order.push_back(this);
+  size_t levels = 0;
+  for (size_t levelBegin = 0; levelBegin < order.size(); ++levels)
+  {
+    const size_t levelEnd = order.size();
+    for (size_t i = levelBegin; i < levelEnd; ++i)
+    {
+      if (order[i]->left)
+        order.push_back(order[i]->left);
+      if (order[i]->right)
+        order.push_back(order[i]->right);
+    }
+    levelBegin = levelEnd;
+  }
+
+  if (order.size() == 1)
+    return;
+
+  if (vanEmdeBoas)
+  {
+    std::vector<BinarySpaceTree*> frontier;
+    order.clear();
+    VanEmdeBoasOrder(this, levels, order, frontier);
+  }
+
+  // Every node comes after its parent in either order, so by the time a node is
+  // moved, its parent has already been moved and points to the node's old
+  // location.  The root (order[0]) stays where it is.
+  BinarySpaceTree* storage = static_cast<BinarySpaceTree*>(
+      ::operator new((order.size() - 1) * sizeof(BinarySpaceTree)));
+  for (size_t i = 1; i < order.size(); ++i)
+  {
+    BinarySpaceTree* oldNode = order[i];
+    BinarySpaceTree* node = new (storage + (i - 1))
+        BinarySpaceTree(std::move(*oldNode));
+
+    if (node->parent->left == oldNode)
+      node->parent->left = node;
+    else
+      node->parent->right = node;
+
+    // The moved-from node no longer has children or a dataset.
+    if (nodeStorage)
+      oldNode->~BinarySpaceTree();
+    else
+      delete oldNode;
+  }
+
+  ::operator delete(nodeStorage);
+  nodeStorage = storage;
+}
+
+/**
+ * Delete the children of this node.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    DeleteChildren()
+{
+  if (nodeStorage)
+  {
+    // The children were not allocated one by one, so they can only be
+    // destroyed, and then the whole block is released.
+    if (left)
+      DestroyCompactNode(left);
+    if (right)
+      DestroyCompactNode(right);
+
+    ::operator delete(nodeStorage);
+    nodeStorage = NULL;
+  }
+  else
+  {
+    delete left;
+    delete right;
+  }
+
+  left = NULL;
+  right = NULL;
+}
+
+/**
+ * Destroy a node of a compacted tree and its descendants.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    DestroyCompactNode(BinarySpaceTree* node)
+{
+  if (node->left)
+    DestroyCompactNode(node->left);
+  if (node->right)
+    DestroyCompactNode(node->right);
+
+  node->left = NULL;
+  node->right = NULL;
+  node->~BinarySpaceTree();
+}
+
+/**
+ * Collect the first levels of a subtree in van Emde Boas order: the top half of
+ * the levels is laid out recursively, and then each subtree hanging below it.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    VanEmdeBoasOrder(BinarySpaceTree* node,
+                     const size_t levels,
+                     std::vector<BinarySpaceTree*>& order,
+                     std::vector<BinarySpaceTree*>& frontier)
+{
+  if (levels == 1)
+  {
+    order.push_back(node);
+    if (node->left)
+      frontier.push_back(node->left);
+    if (node->right)
+      frontier.push_back(node->right);
+    return;
+  }
+
+  const size_t topLevels = levels / 2;
+  std::vector<BinarySpaceTree*> topFrontier;
+  VanEmdeBoasOrder(node, topLevels, order, topFrontier);
+  for (size_t i = 0; i < topFrontier.size(); ++i)
+    VanEmdeBoasOrder(topFrontier[i], levels - topLevels, order, frontier);
+}
+
+/**
+ * Insert points into the tree, splitting the leaves that become too large.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    InsertPoints(const MatType& points,
+                 std::vector<size_t>& oldFromNew,
+                 const size_t maxLeafSize)
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument("BinarySpaceTree::InsertPoints(): points can "
+        "only be inserted at the root of a tree");
+  }
+  if (std::is_same<SplitType<BoundType<MetricType>, MatType>,
+                   UBTreeSplit<BoundType<MetricType>, MatType>>::value)
+  {
+    throw std::invalid_argument("BinarySpaceTree::InsertPoints(): UB trees "
+        "do not support insertion");
+  }
+  if (oldFromNew.size() != dataset->n_cols)
+  {
+    throw std::invalid_argument("BinarySpaceTree::InsertPoints(): oldFromNew "
+        "must hold one index for every point of the tree");
+  }
+
+  if (points.n_cols == 0)
+    return;
+
+  // An empty tree takes the dimensionality of the new points.
+  if (dataset->n_cols == 0)
+  {
+    dataset->set_size(points.n_rows, 0);
+    bound = BoundType<MetricType>(points.n_rows);
+  }
+  else if (points.n_rows != dataset->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "BinarySpaceTree::InsertPoints(): the points have " << points.n_rows
+        << " dimensions, but the tree has " << dataset->n_rows << "!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const bool compact = IsCompact();
+  Uncompact();
+
+  // Find the leaf of every new point; the leaves come out in the order of their
+  // points in the dataset.
+  std::vector<size_t> indices(points.n_cols);
+  for (size_t i = 0; i < points.n_cols; ++i)
+    indices[i] = i;
+  std::vector<std::pair<BinarySpaceTree*, std::vector<size_t>>> leafPoints;
+  RoutePoints(points, indices, leafPoints);
+
+  // Make room for the new points; the dataset has spare columns, so it is only
+  // reallocated once in a while.  Then move the points into place from the
+  // back: the old points keep their order, and the new points of each leaf go
+  // after the old points of that leaf.  The old points only move towards the
+  // end, so nothing is overwritten before it is moved.
+  const size_t oldSize = dataset->n_cols;
+  ResizeDataset(oldSize + points.n_cols);
+  oldFromNew.resize(oldSize + points.n_cols);
+
+  const size_t nRows = dataset->n_rows;
+  ElemType* data = dataset->memptr();
+  std::unordered_set<BinarySpaceTree*> changed;
+  size_t oldEnd = oldSize, newEnd = oldSize + points.n_cols;
+  for (size_t l = leafPoints.size(); l > 0; --l)
+  {
+    BinarySpaceTree* leaf = leafPoints[l - 1].first;
+    const std::vector<size_t>& leafIndices = leafPoints[l - 1].second;
+
+    // First the old points after the leaf.
+    const size_t leafEnd = leaf->begin + leaf->count;
+    std::copy_backward(data + leafEnd * nRows, data + oldEnd * nRows,
+        data + newEnd * nRows);
+    std::copy_backward(oldFromNew.begin() + leafEnd,
+        oldFromNew.begin() + oldEnd, oldFromNew.begin() + newEnd);
+    newEnd -= oldEnd - leafEnd;
+    oldEnd = leafEnd;
+
+    // Then the new points of the leaf.
+    newEnd -= leafIndices.size();
+    for (size_t i = 0; i < leafIndices.size(); ++i)
+    {
+      dataset->col(newEnd + i) = points.col(leafIndices[i]);
+      oldFromNew[newEnd + i] = oldSize + leafIndices[i];
+    }
+    leaf->count += leafIndices.size();
+
+    for (BinarySpaceTree* node = leaf; node != NULL; node = node->parent)
+      if (!changed.insert(node).second)
+        break;
+  }
+
+  UpdateRanges(0);
+
+  SplitType<BoundType<MetricType>, MatType> splitter;
+  RefreshInserted(changed, oldFromNew, maxLeafSize, splitter);
+
+  if (compact)
+    Compact();
+}
+
+/**
+ * Delete points from the tree, removing the nodes that become empty.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    DeletePoints(const std::vector<size_t>& points,
+                 std::vector<size_t>& oldFromNew)
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument("BinarySpaceTree::DeletePoints(): points can "
+        "only be deleted at the root of a tree");
+  }
+  if (oldFromNew.size() != dataset->n_cols)
+  {
+    throw std::invalid_argument("BinarySpaceTree::DeletePoints(): oldFromNew "
+        "must hold one index for every point of the tree");
+  }
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    if (points[i] >= dataset->n_cols)
+    {
+      std::ostringstream oss;
+      oss << "BinarySpaceTree::DeletePoints(): cannot delete point "
+          << points[i] << "; the tree holds only " << dataset->n_cols
+          << " points!";
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  if (points.empty())
+    return;
+
+  const bool compact = IsCompact();
+  Uncompact();
+
+  // Find the leaf of every deleted point.
+  const size_t oldSize = dataset->n_cols;
+  std::vector<bool> deleted(oldSize, false);
+  std::vector<bool> deletedOld(oldSize, false);
+  std::unordered_set<BinarySpaceTree*> changed;
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    if (deleted[points[i]])
+      continue;
+    deleted[points[i]] = true;
+    deletedOld[oldFromNew[points[i]]] = true;
+
+    BinarySpaceTree* node = this;
+    changed.insert(node);
+    while (node->left)
+    {
+      node = (points[i] < node->right->begin) ? node->left : node->right;
+      changed.insert(node);
+    }
+    --node->count;
+  }
+
+  // The old indices after each deleted one move down.
+  std::vector<size_t> newOld(oldSize);
+  size_t numDeleted = 0;
+  for (size_t i = 0; i < oldSize; ++i)
+  {
+    newOld[i] = i - numDeleted;
+    if (deletedOld[i])
+      ++numDeleted;
+  }
+
+  // Move the kept points to the front in place; they only move towards the
+  // beginning, so nothing is overwritten before it is moved.
+  size_t position = 0;
+  for (size_t i = 0; i < oldSize; ++i)
+  {
+    if (deleted[i])
+      continue;
+
+    if (position != i)
+      dataset->col(position) = dataset->col(i);
+    oldFromNew[position] = newOld[oldFromNew[i]];
+    ++position;
+  }
+
+  ResizeDataset(oldSize - numDeleted);
+  oldFromNew.resize(oldSize - numDeleted);
+  UpdateRanges(0);
+
+  RefreshDeleted(changed);
+
+  if (compact)
+    Compact();
+}
+
+/**
+ * Resize the dataset of the root, keeping its first columns.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    ResizeDataset(const size_t nCols)
+{
+  const size_t nRows = dataset->n_rows;
+
+  // The storage is only used while the dataset is an alias of it; the dataset
+  // may have been replaced through Dataset() since.
+  if (datasetStorage && ((dataset->memptr() != datasetStorage->memptr()) ||
+      (datasetStorage->n_rows != nRows)))
+  {
+    delete datasetStorage;
+    datasetStorage = NULL;
+  }
+
+  if (!datasetStorage && (nCols <= dataset->n_cols))
+  {
+    // Shrinking a dataset that has no spare columns.
+    dataset->resize(nRows, nCols);
+    return;
+  }
+
+  if (!datasetStorage || (nCols > datasetStorage->n_cols))
+  {
+    // Grow geometrically, so that the points are only copied once in a while.
+    MatType* storage = new MatType(nRows, std::max(nCols,
+        (size_t) (2 * dataset->n_cols)));
+    std::copy(dataset->memptr(), dataset->memptr() + dataset->n_elem,
+        storage->memptr());
+
+    // This frees the memory of the dataset, unless it is an alias of the old
+    // storage.
+    dataset->~MatType();
+    new (dataset) MatType(storage->memptr(), nRows, nCols, false, false);
+    delete datasetStorage;
+    datasetStorage = storage;
+    return;
+  }
+
+  // The storage is large enough; only the alias changes.
+  dataset->~MatType();
+  new (dataset) MatType(datasetStorage->memptr(), nRows, nCols, false, false);
+}
+
+/**
+ * Move the nodes of a compacted tree into their own allocations.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    Uncompact()
+{
+  if (!nodeStorage)
+    return;
+
+  // Parents are moved before their children, as in Compact().
+  std::queue<BinarySpaceTree*> nodes;
+  nodes.push(left);
+  nodes.push(right);
+  while (!nodes.empty())
+  {
+    BinarySpaceTree* oldNode = nodes.front();
+    nodes.pop();
+
+    BinarySpaceTree* node = new BinarySpaceTree(std::move(*oldNode));
+    if (node->parent->left == oldNode)
+      node->parent->left = node;
+    else
+      node->parent->right = node;
+    oldNode->~BinarySpaceTree();
+
+    if (node->left)
+      nodes.push(node->left);
+    if (node->right)
+      nodes.push(node->right);
+  }
+
+  ::operator delete(nodeStorage);
+  nodeStorage = NULL;
+}
+
+/**
+ * Recompute the ranges of the nodes from the counts of the leaves.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+size_t BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
+    SplitType>::UpdateRanges(const size_t position)
+{
+  begin = position;
+  if (left)
+    count = right->UpdateRanges(left->UpdateRanges(position)) - begin;
+
+  return begin + count;
+}
+
+/**
+ * Send points down to the leaves, expanding the bounds on the way.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    RoutePoints(const MatType& points,
+                const std::vector<size_t>& indices,
+                std::vector<std::pair<BinarySpaceTree*,
+                                      std::vector<size_t>>>& leafPoints)
+{
+  if (indices.empty())
+    return;
+
+  const MatType nodePoints = points.cols(arma::conv_to<arma::uvec>::from(
+      indices));
+  bound |= nodePoints;
+
+  if (!left)
+  {
+    leafPoints.push_back(std::make_pair(this, indices));
+    return;
+  }
+
+  std::vector<size_t> leftIndices, rightIndices;
+  for (size_t i = 0; i < indices.size(); ++i)
+  {
+    if (GetNearestChild(points.col(indices[i])) == 0)
+      leftIndices.push_back(indices[i]);
+    else
+      rightIndices.push_back(indices[i]);
+  }
+
+  left->RoutePoints(points, leftIndices, leafPoints);
+  right->RoutePoints(points, rightIndices, leafPoints);
+}
+
+/**
+ * Split the leaves that received points and update the nodes above them.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    RefreshInserted(const std::unordered_set<BinarySpaceTree*>& changed,
+                    std::vector<size_t>& oldFromNew,
+                    const size_t maxLeafSize,
+                    SplitType<BoundType<MetricType>, MatType>& splitter)
+{
+  if (changed.count(this) == 0)
+    return;
+
+  if (!left)
+  {
+    // This also updates the furthest descendant distance.
+    SplitNode(oldFromNew, maxLeafSize, splitter);
+  }
+  else
+  {
+    left->RefreshInserted(changed, oldFromNew, maxLeafSize, splitter);
+    right->RefreshInserted(changed, oldFromNew, maxLeafSize, splitter);
+
+    furthestDescendantDistance = 0.5 * bound.Diameter();
+    UpdateChildDistances();
+  }
+
+  stat = StatisticType(*this);
+}
+
+/**
+ * Remove empty nodes and shrink the bounds of the nodes that lost points.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    RefreshDeleted(const std::unordered_set<BinarySpaceTree*>& changed)
+{
+  if (changed.count(this) == 0)
+    return;
+
+  if (left && count == 0)
+  {
+    // Only the root can end up empty; it becomes an empty leaf.
+    delete left;
+    delete right;
+    left = NULL;
+    right = NULL;
+  }
+  else if (left)
+  {
+    left->RefreshDeleted(changed);
+    right->RefreshDeleted(changed);
+
+    // If one child is now empty, the other child takes the place of this node.
+    if (left->count == 0 || right->count == 0)
+    {
+      BinarySpaceTree* child = (left->count == 0) ? right : left;
+      delete (child == left) ? right : left;
+
+      left = child->left;
+      right = child->right;
+      if (left)
+        left->parent = this;
+      if (right)
+        right->parent = this;
+
+      child->left = NULL;
+      child->right = NULL;
+      delete child;
+    }
+  }
+
+  if (left)
+  {
+    CombineChildBounds(bound);
+  }
+  else
+  {
+    bound = BoundType<MetricType>(dataset->n_rows);
+    UpdateBound(bound);
+  }
+
+  furthestDescendantDistance = 0.5 * bound.Diameter();
+  UpdateChildDistances();
+  stat = StatisticType(*this);
+}
+
+/**
+ * Recompute the parent distances of the children.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    UpdateChildDistances()
+{
+  if (!left)
+    return;
+
+  arma::vec center, leftCenter, rightCenter;
+  Center(center);
+  left->Center(leftCenter);
+  right->Center(rightCenter);
+
+  left->ParentDistance() = bound.Metric().Evaluate(center, leftCenter);
+  right->ParentDistance() = bound.Metric().Evaluate(center, rightCenter);
+}
+
 /**
  * Returns the number of children in this node.
  */
@@ -869,6 +1522,23 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     SplitNode(const size_t maxLeafSize,
               SplitType<BoundType<MetricType>, MatType>& splitter)
 {
+  #ifdef HAS_OPENMP
+  // If the splitter allows it, build the whole tree inside one parallel region,
+  // so that large children (and the partitions of large nodes) are handled by
+  // OpenMP tasks.
+  if (SplitTraits<Split>::IsThreadSafe && !parent &&
+      count >= 2 * parallelBuildMinSize && !omp_in_parallel() &&
+      omp_get_max_threads() > 1)
+  {
+    #pragma omp parallel
+    {
+      #pragma omp single
+      SplitNode(maxLeafSize, splitter);
+    }
+    return;
+  }
+  #endif
+
   // We need to expand the bounds of this node properly.
   UpdateBound(bound);
 
@@ -904,11 +1574,17 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
   assert(splitCol < begin + count);
 
   // Now that we know the split column, we will recursively split the children
-  // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
+  // by calling their constructors (which perform this splitting process).  The
+  // children hold disjoint parts of the dataset, so when the tree is built in
+  // parallel, a large left child is built in its own task.
+  SplitType<BoundType<MetricType>, MatType>* splitterPtr = &splitter;
+  #pragma omp task if (SplitTraits<Split>::IsThreadSafe && \
+      splitCol - begin >= parallelBuildMinSize) firstprivate(splitterPtr)
+  left = new BinarySpaceTree(this, begin, splitCol - begin, *splitterPtr,
       maxLeafSize);
   right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
       splitter, maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
   arma::vec center, leftCenter, rightCenter;
@@ -936,6 +1612,23 @@ SplitNode(std::vector<size_t>& oldFromNew,
           const size_t maxLeafSize,
           SplitType<BoundType<MetricType>, MatType>& splitter)
 {
+  #ifdef HAS_OPENMP
+  // If the splitter allows it, build the whole tree inside one parallel region,
+  // so that large children (and the partitions of large nodes) are handled by
+  // OpenMP tasks.
+  if (SplitTraits<Split>::IsThreadSafe && !parent &&
+      count >= 2 * parallelBuildMinSize && !omp_in_parallel() &&
+      omp_get_max_threads() > 1)
+  {
+    #pragma omp parallel
+    {
+      #pragma omp single
+      SplitNode(oldFromNew, maxLeafSize, splitter);
+    }
+    return;
+  }
+  #endif
+
   // We need to expand the bounds of this node properly.
   UpdateBound(bound);
 
@@ -972,11 +1665,19 @@ SplitNode(std::vector<size_t>& oldFromNew,
   assert(splitCol < begin + count);
 
   // Now that we know the split column, we will recursively split the children
-  // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
-      splitter, maxLeafSize);
+  // by calling their constructors (which perform this splitting process).  The
+  // children hold disjoint parts of the dataset (and of oldFromNew), so when
+  // the tree is built in parallel, a large left child is built in its own task.
+  std::vector<size_t>* oldFromNewPtr = &oldFromNew;
+  SplitType<BoundType<MetricType>, MatType>* splitterPtr = &splitter;
+  #pragma omp task if (SplitTraits<Split>::IsThreadSafe && \
+      splitCol - begin >= parallelBuildMinSize) \
+      firstprivate(oldFromNewPtr, splitterPtr)
+  left = new BinarySpaceTree(this, begin, splitCol - begin, *oldFromNewPtr,
+      *splitterPtr, maxLeafSize);
   right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
       oldFromNew, splitter, maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
   arma::vec center, leftCenter, rightCenter;
@@ -1033,6 +1734,33 @@ UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate)
     boundToUpdate |= dataset->cols(begin, begin + count - 1);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename BoundType2>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+CombineChildBounds(BoundType2& boundToUpdate)
+{
+  boundToUpdate = BoundType2(dataset->n_rows);
+  boundToUpdate |= left->bound;
+  boundToUpdate |= right->bound;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+CombineChildBounds(bound::BallBound<MetricType>& /* boundToUpdate */)
+{
+  // Ball bounds can't be combined; the old bound still holds all of the points.
+}
+
 // Default constructor (private), for boost::serialization.
 template<typename MetricType,
          typename StatisticType,
@@ -1071,16 +1799,15 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
   // If we're loading, and we have children, they need to be deleted.
   if (Archive::is_loading::value)
   {
-    if (left)
-      delete left;
-    if (right)
-      delete right;
+    DeleteChildren();
     if (!parent)
+    {
       delete dataset;
+      delete datasetStorage;
+      datasetStorage = NULL;
+    }
 
     parent = NULL;
-    left = NULL;
-    right = NULL;
   }
 
   ar & BOOST_SERIALIZATION_NVP(begin);
@@ -17,6 +17,8 @@
 // In case it hasn't been included yet.
 #include "breadth_first_dual_tree_traverser.hpp"
 
+#include <mlpack/core/tree/base_case_block.hpp>
+
 namespace mlpack {
 namespace tree {
 
@@ -129,24 +131,13 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
     // If both are leaves, we must evaluate the base case.
     if (queryNode.IsLeaf() && referenceNode.IsLeaf())
     {
-      // Loop through each of the points in each node.
+      // Evaluate the base cases between all of the points in each node.
       const size_t queryEnd = queryNode.Begin() + queryNode.Count();
       const size_t refEnd = referenceNode.Begin() + referenceNode.Count();
-      for (size_t query = queryNode.Begin(); query < queryEnd; ++query)
-      {
-        // See if we need to investigate this point (this function should be
-        // implemented for the single-tree recursion too).  Restore the
-        // traversal information first.
-//        const double childScore = rule.Score(query, referenceNode);
-
-//        if (childScore == DBL_MAX)
-//          continue; // We can't improve this particular point.
-
-        for (size_t ref = referenceNode.Begin(); ref < refEnd; ++ref)
-          rule.BaseCase(query, ref);
+      BaseCaseBlock(rule, queryNode.Begin(), queryEnd, referenceNode.Begin(),
+          refEnd);
 
-        numBaseCases += referenceNode.Count();
-      }
+      numBaseCases += queryNode.Count() * referenceNode.Count();
     }
     else if ((!queryNode.IsLeaf()) && referenceNode.IsLeaf())
     {
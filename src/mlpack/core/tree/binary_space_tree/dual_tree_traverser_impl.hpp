@@ -17,6 +17,8 @@
 // In case it hasn't been included yet.
 #include "dual_tree_traverser.hpp"
 
+#include <mlpack/core/tree/base_case_block.hpp>
+
 namespace mlpack {
 namespace tree {
 
@@ -71,24 +73,34 @@ DualTreeTraverser<RuleType>::Traverse(
   // If both are leaves, we must evaluate the base case.
   if (queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
-    // Loop through each of the points in each node.
+    // Loop through each of the points in each node.  The base cases for each
+    // run of query points that can't be pruned are evaluated together; queryEnd
+    // is treated as a pruned point, to end the last run.
     const size_t queryEnd = queryNode.Begin() + queryNode.Count();
     const size_t refEnd = referenceNode.Begin() + referenceNode.Count();
-    for (size_t query = queryNode.Begin(); query < queryEnd; ++query)
+    size_t runBegin = queryNode.Begin();
+    for (size_t query = queryNode.Begin(); query <= queryEnd; ++query)
     {
       // See if we need to investigate this point (this function should be
       // implemented for the single-tree recursion too).  Restore the traversal
       // information first.
-      rule.TraversalInfo() = traversalInfo;
-      const double childScore = rule.Score(query, referenceNode);
-
-      if (childScore == DBL_MAX)
-        continue; // We can't improve this particular point.
+      bool pruned = true;
+      if (query < queryEnd)
+      {
+        rule.TraversalInfo() = traversalInfo;
+        pruned = (rule.Score(query, referenceNode) == DBL_MAX);
+      }
 
-      for (size_t ref = referenceNode.Begin(); ref < refEnd; ++ref)
-        rule.BaseCase(query, ref);
+      if (!pruned)
+        continue;
 
-      numBaseCases += referenceNode.Count();
+      // We can't improve this particular point, so finish the run before it.
+      if (runBegin < query)
+      {
+        BaseCaseBlock(rule, runBegin, query, referenceNode.Begin(), refEnd);
+        numBaseCases += (query - runBegin) * referenceNode.Count();
+      }
+      runBegin = query + 1;
     }
   }
   else if (((!queryNode.IsLeaf()) && referenceNode.IsLeaf()) ||
@@ -17,6 +17,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/tree/perform_split.hpp>
+#include "split_traits.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -119,6 +120,14 @@ class MidpointSplit
   }
 };
 
+//! MidpointSplit is thread-safe; see SplitTraits::IsThreadSafe.
+template<typename BoundType, typename MatType>
+class SplitTraits<MidpointSplit<BoundType, MatType>>
+{
+ public:
+  static const bool IsThreadSafe = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
@@ -0,0 +1,50 @@
+/**
+ * @file split_traits.hpp
+ *
+ * A traits class for the split types of the BinarySpaceTree, which tells the
+ * tree how the splitter may be used while the tree is built.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The SplitTraits class describes a split type of the BinarySpaceTree.  The
+ * default values are the safe ones; a split type that can do better should
+ * specialize this class, like MidpointSplit and MeanSplit do:
+ *
+ * @code
+ * template<typename BoundType, typename MatType>
+ * class SplitTraits<MySplit<BoundType, MatType>>
+ * {
+ *  public:
+ *   static const bool IsThreadSafe = true;
+ * };
+ * @endcode
+ */
+template<typename SplitType>
+class SplitTraits
+{
+ public:
+  /**
+   * This is true if SplitNode() and PerformSplit() may be called at the same
+   * time on disjoint nodes of the same dataset, so that the children of a node
+   * can be built in parallel.  This is not the case if the splitter keeps state
+   * that is shared between the nodes, or if it draws random numbers (the
+   * random number generator is shared).  MidpointSplit and MeanSplit do
+   * neither: they only read the points and the bound of the node they split.
+   */
+  static const bool IsThreadSafe = false;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
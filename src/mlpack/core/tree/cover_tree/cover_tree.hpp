@@ -459,6 +459,10 @@ class CoverTree
   //! The metric used for this tree.
   MetricType* metric;
 
+  //! The number of points above which ComputeDistances() evaluates the
+  //! distances in parallel.
+  static const size_t parallelDistanceMinSize = 2048;
+
   /**
    * Create the children for this node.
    */
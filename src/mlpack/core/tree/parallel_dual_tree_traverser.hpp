@@ -0,0 +1,126 @@
+/**
+ * @file parallel_dual_tree_traverser.hpp
+ *
+ * A dual-tree traverser that splits the query tree into independent subtrees
+ * and traverses each of them against the reference tree in its own OpenMP
+ * task, using the given tree's own dual-tree traverser for each subtree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+#define MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The ParallelDualTreeTraverser wraps any dual-tree traverser and runs it in
+ * parallel over the query tree.  Query nodes with more than MinTaskSize()
+ * descendants are split into their children, each of which is handed to an
+ * OpenMP task; every task creates its own copy of the rules and its own
+ * instance of DualTreeTraversalType, and traverses its query subtree against
+ * the whole reference tree.
+ *
+ * Because each query point is handled by exactly one task, this gives the same
+ * results as the serial traversal for exact searches.  Some pruning between
+ * the top levels of the query tree and the reference tree is lost, but this is
+ * negligible compared to the work done in each subtree.
+ *
+ * The following requirements must hold for this traverser to be used:
+ *
+ *  - The descendant points of the children of a query node must be disjoint
+ *    and must contain every descendant point of the node.  This is true for
+ *    every tree in mlpack, except spill trees built with overlapping children.
+ *
+ *  - RuleType must be copy-constructible, and a copy must write its results
+ *    into the same storage as the object it was copied from, while keeping
+ *    its own traversal information (see NeighborSearchRules for an example).
+ *    The counters of the copies (BaseCases() and Scores()) are added back into
+ *    the original rules once the traversal is finished.
+ *
+ *  - The rules may only modify the statistics of query nodes during the
+ *    dual-tree traversal.
+ *
+ * If OpenMP is not available or only one thread may be used, the given
+ * DualTreeTraversalType is simply used directly with the given rules.
+ *
+ * ParallelDualTreeTraverser has the same interface as the regular traversers,
+ * so it can be used as a DualTreeTraversalType itself, for instance via a
+ * template alias:
+ *
+ * @code
+ * template<typename RuleType>
+ * using ParallelKDTreeTraverser = ParallelDualTreeTraverser<RuleType,
+ *     KDTree<EuclideanDistance, EmptyStatistic, arma::mat>::DualTreeTraverser>;
+ * @endcode
+ *
+ * @tparam RuleType Rules for the traversal.
+ * @tparam DualTreeTraversalType Serial dual-tree traverser to use on each
+ *     subtree.
+ */
+template<typename RuleType,
+         template<typename> class DualTreeTraversalType>
+class ParallelDualTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the parallel dual-tree traverser with the given rule set.
+   *
+   * @param rule Rules to use for the traversal.
+   * @param minTaskSize Query nodes with at most this many descendants will not
+   *     be split into further tasks.  If 0, a value is chosen at traversal time
+   *     based on the number of threads.
+   */
+  ParallelDualTreeTraverser(RuleType& rule, const size_t minTaskSize = 0);
+
+  /**
+   * Traverse the two trees.  This does not reset the number of tasks.
+   *
+   * @param queryNode The query node to be traversed.
+   * @param referenceNode The reference node to be traversed.
+   */
+  template<typename TreeType>
+  void Traverse(TreeType& queryNode, TreeType& referenceNode);
+
+  //! Get the minimum number of descendants of a query node to split it.
+  size_t MinTaskSize() const { return minTaskSize; }
+  //! Modify the minimum number of descendants of a query node to split it.
+  size_t& MinTaskSize() { return minTaskSize; }
+
+  //! Get the number of subtree traversals that were run.
+  size_t NumTasks() const { return numTasks; }
+  //! Modify the number of subtree traversals that were run.
+  size_t& NumTasks() { return numTasks; }
+
+ private:
+  /**
+   * Traverse the given query subtree, either by spawning a task for each child
+   * or by running the serial traverser with a copy of the rules.
+   */
+  template<typename TreeType>
+  void TraverseSubtree(TreeType* queryNode,
+                       TreeType* referenceNode,
+                       const size_t taskSize);
+
+  //! Reference to the rules with which the trees will be traversed.
+  RuleType& rule;
+
+  //! The minimum number of descendants needed to split a query node.
+  size_t minTaskSize;
+
+  //! The number of subtree traversals that were run.
+  size_t numTasks;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "parallel_dual_tree_traverser_impl.hpp"
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * @file parallel_dual_tree_traverser_impl.hpp
+ *
+ * Implementation of the ParallelDualTreeTraverser, which runs a dual-tree
+ * traverser on independent query subtrees in separate OpenMP tasks.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+#define MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_dual_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename RuleType,
+         template<typename> class DualTreeTraversalType>
+ParallelDualTreeTraverser<RuleType, DualTreeTraversalType>::
+ParallelDualTreeTraverser(RuleType& rule, const size_t minTaskSize) :
+    rule(rule),
+    minTaskSize(minTaskSize),
+    numTasks(0)
+{ /* Nothing to do. */ }
+
+template<typename RuleType,
+         template<typename> class DualTreeTraversalType>
+template<typename TreeType>
+void ParallelDualTreeTraverser<RuleType, DualTreeTraversalType>::Traverse(
+    TreeType& queryNode,
+    TreeType& referenceNode)
+{
+  size_t numThreads = 1;
+  #ifdef HAS_OPENMP
+    // If we are already inside a parallel region, we'll just run serially.
+    if (!omp_in_parallel())
+      numThreads = omp_get_max_threads();
+  #endif
+
+  if (numThreads == 1)
+  {
+    // There is nothing to gain from splitting the query tree, so use the
+    // serial traverser with the original rules.
+    DualTreeTraversalType<RuleType> traverser(rule);
+    traverser.Traverse(queryNode, referenceNode);
+    ++numTasks;
+    return;
+  }
+
+  // By default, aim for a few tasks per thread so that the load is balanced
+  // even when some query subtrees are much more expensive than others.
+  const size_t taskSize = (minTaskSize > 0) ? minTaskSize :
+      std::max((size_t) 1, queryNode.NumDescendants() / (16 * numThreads));
+
+  #pragma omp parallel
+  {
+    #pragma omp single
+    TraverseSubtree(&queryNode, &referenceNode, taskSize);
+  }
+}
+
+template<typename RuleType,
+         template<typename> class DualTreeTraversalType>
+template<typename TreeType>
+void ParallelDualTreeTraverser<RuleType, DualTreeTraversalType>::
+TraverseSubtree(TreeType* queryNode,
+                TreeType* referenceNode,
+                const size_t taskSize)
+{
+  if (!queryNode->IsLeaf() && queryNode->NumDescendants() > taskSize)
+  {
+    // Each child holds a disjoint set of query points, so the children can be
+    // handled independently.
+    for (size_t i = 0; i < queryNode->NumChildren(); ++i)
+    {
+      TreeType* child = &queryNode->Child(i);
+
+      #pragma omp task firstprivate(child)
+      TraverseSubtree(child, referenceNode, taskSize);
+    }
+
+    #pragma omp taskwait
+    return;
+  }
+
+  // Traverse this subtree with its own copy of the rules.
+  RuleType taskRule(rule);
+  const size_t initialBaseCases = taskRule.BaseCases();
+  const size_t initialScores = taskRule.Scores();
+
+  DualTreeTraversalType<RuleType> traverser(taskRule);
+  traverser.Traverse(*queryNode, *referenceNode);
+
+  #pragma omp critical
+  {
+    rule.BaseCases() += taskRule.BaseCases() - initialBaseCases;
+    rule.Scores() += taskRule.Scores() - initialScores;
+    ++numTasks;
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -16,10 +16,77 @@
 #ifndef MLPACK_CORE_TREE_PERFORM_SPLIT_HPP
 #define MLPACK_CORE_TREE_PERFORM_SPLIT_HPP
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 namespace split {
 
+namespace details {
+
+//! The smallest number of points that a task of ParallelPerformSplit() handles.
+const size_t parallelSplitChunkSize = 16384;
+
+/**
+ * Return the number of chunks that the points of a node with the given number
+ * of points should be partitioned in.  This is 1 (so the partition is done
+ * serially) unless we are in a parallel region with more than one thread, as we
+ * are while a tree is built in parallel.  Every chunk holds fewer than
+ * 2 * parallelSplitChunkSize points, so a chunk is never split again.
+ */
+inline size_t NumSplitChunks(const size_t count)
+{
+  #ifdef HAS_OPENMP
+    if (omp_in_parallel() && omp_get_num_threads() > 1 &&
+        count >= 2 * parallelSplitChunkSize)
+      return count / parallelSplitChunkSize;
+  #endif
+
+  return 1;
+}
+
+/**
+ * Return the index of the k'th column of a set of ranges of columns, given the
+ * first column of every range and the number of columns before every range.
+ */
+inline size_t RangeColumn(const std::vector<size_t>& rangeBegin,
+                          const std::vector<size_t>& rangeOffset,
+                          const size_t k)
+{
+  const size_t range = std::upper_bound(rangeOffset.begin(),
+      rangeOffset.end(), k) - rangeOffset.begin() - 1;
+  return rangeBegin[range] + (k - rangeOffset[range]);
+}
+
+/**
+ * Partition the points [begin, begin + count) like PerformSplit() does, in
+ * parallel.  The range is divided into numChunks chunks, each of which is
+ * partitioned in its own OpenMP task.  After that, every point in the left part
+ * of a chunk that ends up right of the split column has to be swapped with a
+ * point in the right part of a chunk that ends up left of it; there are equally
+ * many of both, and the swaps are independent, so they are done in parallel
+ * too.  The points are only ever swapped, so this works in place.
+ *
+ * @param data The dataset used by the binary space tree.
+ * @param begin Index of the starting point in the dataset that belongs to
+ *    this node.
+ * @param count Number of points in this node.
+ * @param splitInfo The information about the split.
+ * @param oldFromNew If not NULL, this is permuted along with the points.
+ * @param numChunks Number of chunks to partition separately.
+ */
+template<typename MatType, typename SplitType>
+size_t ParallelPerformSplit(MatType& data,
+                            const size_t begin,
+                            const size_t count,
+                            const typename SplitType::SplitInfo& splitInfo,
+                            std::vector<size_t>* oldFromNew,
+                            const size_t numChunks);
+
+} // namespace details
+
 /**
  * This function implements the default split behavior i.e. it rearranges
  * points according to the split information. The SplitType::AssignToLeftNode()
@@ -38,6 +105,14 @@ size_t PerformSplit(MatType& data,
                     const size_t count,
                     const typename SplitType::SplitInfo& splitInfo)
 {
+  // Large nodes are partitioned in parallel when the tree is built in parallel.
+  const size_t numChunks = details::NumSplitChunks(count);
+  if (numChunks > 1)
+  {
+    return details::ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, NULL, numChunks);
+  }
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
@@ -104,6 +179,14 @@ size_t PerformSplit(MatType& data,
                     const typename SplitType::SplitInfo& splitInfo,
                     std::vector<size_t>& oldFromNew)
 {
+  // Large nodes are partitioned in parallel when the tree is built in parallel.
+  const size_t numChunks = details::NumSplitChunks(count);
+  if (numChunks > 1)
+  {
+    return details::ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, &oldFromNew, numChunks);
+  }
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
@@ -152,6 +235,100 @@ size_t PerformSplit(MatType& data,
   return left;
 }
 
+namespace details {
+
+template<typename MatType, typename SplitType>
+size_t ParallelPerformSplit(MatType& data,
+                            const size_t begin,
+                            const size_t count,
+                            const typename SplitType::SplitInfo& splitInfo,
+                            std::vector<size_t>* oldFromNew,
+                            const size_t numChunks)
+{
+  // The tasks get pointers, so that nothing is copied into them.
+  MatType* dataPtr = &data;
+  const typename SplitType::SplitInfo* splitInfoPtr = &splitInfo;
+
+  // Partition every chunk on its own.  Each chunk is small enough to be
+  // partitioned serially.
+  std::vector<size_t> chunkBegin(numChunks + 1);
+  std::vector<size_t> chunkSplit(numChunks);
+  for (size_t c = 0; c <= numChunks; ++c)
+    chunkBegin[c] = begin + (count * c) / numChunks;
+
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    #pragma omp task shared(chunkBegin, chunkSplit) \
+        firstprivate(c, dataPtr, splitInfoPtr, oldFromNew)
+    {
+      const size_t chunkCount = chunkBegin[c + 1] - chunkBegin[c];
+      if (oldFromNew)
+      {
+        chunkSplit[c] = PerformSplit<MatType, SplitType>(*dataPtr,
+            chunkBegin[c], chunkCount, *splitInfoPtr, *oldFromNew);
+      }
+      else
+      {
+        chunkSplit[c] = PerformSplit<MatType, SplitType>(*dataPtr,
+            chunkBegin[c], chunkCount, *splitInfoPtr);
+      }
+    }
+  }
+  #pragma omp taskwait
+
+  size_t splitCol = begin;
+  for (size_t c = 0; c < numChunks; ++c)
+    splitCol += chunkSplit[c] - chunkBegin[c];
+
+  // Collect the ranges of points that are on the wrong side of splitCol:
+  // right points before it, and left points after it.
+  std::vector<size_t> rightBegin, rightOffset, leftBegin, leftOffset;
+  size_t numRight = 0, numLeft = 0;
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    const size_t rightEnd = std::min(chunkBegin[c + 1], splitCol);
+    if (chunkSplit[c] < rightEnd)
+    {
+      rightBegin.push_back(chunkSplit[c]);
+      rightOffset.push_back(numRight);
+      numRight += rightEnd - chunkSplit[c];
+    }
+
+    const size_t leftStart = std::max(chunkBegin[c], splitCol);
+    if (leftStart < chunkSplit[c])
+    {
+      leftBegin.push_back(leftStart);
+      leftOffset.push_back(numLeft);
+      numLeft += chunkSplit[c] - leftStart;
+    }
+  }
+
+  Log::Assert(numRight == numLeft);
+
+  // Swap the k'th misplaced right point with the k'th misplaced left point.
+  for (size_t t = 0; t < numChunks; ++t)
+  {
+    #pragma omp task shared(rightBegin, rightOffset, leftBegin, leftOffset) \
+        firstprivate(t, dataPtr, oldFromNew, numRight)
+    {
+      const size_t kEnd = (numRight * (t + 1)) / numChunks;
+      for (size_t k = (numRight * t) / numChunks; k < kEnd; ++k)
+      {
+        const size_t right = RangeColumn(rightBegin, rightOffset, k);
+        const size_t left = RangeColumn(leftBegin, leftOffset, k);
+        dataPtr->swap_cols(left, right);
+        if (oldFromNew)
+          std::swap((*oldFromNew)[left], (*oldFromNew)[right]);
+      }
+    }
+  }
+  #pragma omp taskwait
+
+  return splitCol;
+}
+
+} // namespace details
+
 } // namespace split
 } // namespace tree
 } // namespace mlpack
@@ -20,6 +20,8 @@
 #include "r_tree_split.hpp"
 #include "r_tree_descent_heuristic.hpp"
 #include "no_auxiliary_information.hpp"
+#include "hilbert_r_tree_descent_heuristic.hpp"
+#include "discrete_hilbert_value.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -32,6 +34,15 @@ namespace tree /** Trees and tree-building procedures. */ {
  *
  * This tree does allow growth, so you can add and delete nodes from it.
  *
+ * By default the tree is built by inserting the points one by one.  A large
+ * tree is built much faster by bulk-loading it (pass bulkLoad = true to the
+ * constructor): the points are sorted by their Hilbert values (computed in
+ * parallel, if OpenMP is available) and packed, in that order, into leaves and
+ * nodes that are filled up as evenly as the node sizes allow.  Trees whose
+ * nodes must not overlap (R+ and R++ trees) and Hilbert R trees can't be
+ * packed this way; for those, bulk-loading inserts the points in Hilbert order,
+ * which still keeps the insertions local.
+ *
  * @tparam MetricType This *must* be EuclideanDistance, but the template
  *     parameter is required to satisfy the TreeType API.
  * @tparam StatisticType Extra data contained in the node.  See statistic.hpp
@@ -127,13 +138,16 @@ class RectangleTree
    *      have.
    * @param firstDataIndex The index of the first data point.  UNUSED UNLESS WE
    *      ADD SUPPORT FOR HAVING A "CENTERAL" DATA MATRIX.
+   * @param bulkLoad If true, bulk-load the tree instead of inserting the points
+   *      one by one.
    */
   RectangleTree(const MatType& data,
                 const size_t maxLeafSize = 20,
                 const size_t minLeafSize = 8,
                 const size_t maxNumChildren = 5,
                 const size_t minNumChildren = 2,
-                const size_t firstDataIndex = 0);
+                const size_t firstDataIndex = 0,
+                const bool bulkLoad = false);
 
   /**
    * Construct this as the root node of a rectangle tree type using the given
@@ -148,13 +162,16 @@ class RectangleTree
    *      have.
    * @param firstDataIndex The index of the first data point.  UNUSED UNLESS WE
    *      ADD SUPPORT FOR HAVING A "CENTERAL" DATA MATRIX.
+   * @param bulkLoad If true, bulk-load the tree instead of inserting the points
+   *      one by one.
    */
   RectangleTree(MatType&& data,
                 const size_t maxLeafSize = 20,
                 const size_t minLeafSize = 8,
                 const size_t maxNumChildren = 5,
                 const size_t minNumChildren = 2,
-                const size_t firstDataIndex = 0);
+                const size_t firstDataIndex = 0,
+                const bool bulkLoad = false);
 
   /**
    * Construct this as an empty node with the specified parent.  Copying the
@@ -563,6 +580,32 @@ class RectangleTree
    */
   void BuildStatistics(RectangleTree* node);
 
+  /**
+   * Bulk-load the points [firstDataIndex, dataset->n_cols) into this empty root
+   * node: sort them by Hilbert value, and then either pack them into nodes with
+   * PackNode(), or insert them in that order if the tree type can't be packed.
+   *
+   * @param firstDataIndex The index of the first point to load.
+   */
+  void BulkLoad(const size_t firstDataIndex);
+
+  /**
+   * Fill this empty node with the points order[first, first + numPoints) such
+   * that all of its leaves are height levels below it, and every node has as
+   * few children as possible, with the points spread evenly over them.
+   *
+   * @param order Indices of the points, sorted by Hilbert value.
+   * @param first Position in order of the first point of this node.
+   * @param numPoints Number of points of this node.
+   * @param capacity The number of points that a node of every height can hold.
+   * @param height The height of this node (0 for a leaf).
+   */
+  void PackNode(const std::vector<size_t>& order,
+                const size_t first,
+                const size_t numPoints,
+                const std::vector<size_t>& capacity,
+                const size_t height);
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
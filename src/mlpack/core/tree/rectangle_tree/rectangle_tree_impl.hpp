@@ -17,6 +17,7 @@
 
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
+#include <mlpack/core/tree/tree_traits.hpp>
 
 namespace mlpack {
 namespace tree {
@@ -40,6 +41,112 @@ BuildStatistics(RectangleTree* node)
   node->Stat() = StatisticType(*node);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+BulkLoad(const size_t firstDataIndex)
+{
+  if (firstDataIndex >= dataset->n_cols)
+    return;
+
+  // Computing the Hilbert values is the expensive part, so it is done in
+  // parallel.
+  typedef DiscreteHilbertValue<ElemType> HilbertValue;
+  const size_t numPoints = dataset->n_cols - firstDataIndex;
+  arma::Mat<typename HilbertValue::HilbertElemType> values(dataset->n_rows,
+      numPoints);
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t i = 0; i < (omp_size_t) numPoints; ++i)
+  {
+    values.col(i) = HilbertValue::CalculateValue(dataset->col(firstDataIndex +
+        i));
+  }
+
+  std::vector<size_t> order(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [&values](const size_t a,
+                                                  const size_t b)
+      {
+        return HilbertValue::CompareValues(values.unsafe_col(a),
+            values.unsafe_col(b)) < 0;
+      });
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] += firstDataIndex;
+
+  // Packing gives overlapping nodes, so it can't be used when the nodes must
+  // be disjoint.  The auxiliary information of a Hilbert R tree can only be
+  // built by insertion.  Nodes that can't hold at least two children or one
+  // point can't be packed either.
+  if (!TreeTraits<RectangleTree>::HasOverlappingChildren ||
+      std::is_same<DescentType, HilbertRTreeDescentHeuristic>::value ||
+      maxLeafSize == 0 || maxNumChildren < 2)
+  {
+    for (size_t i = 0; i < numPoints; ++i)
+      InsertPoint(order[i]);
+    return;
+  }
+
+  // Find the height of the tree: the lowest height at which a node can hold
+  // all of the points.
+  std::vector<size_t> capacity(1, maxLeafSize);
+  while (capacity.back() < numPoints)
+    capacity.push_back(capacity.back() * maxNumChildren);
+
+  PackNode(order, 0, numPoints, capacity, capacity.size() - 1);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+PackNode(const std::vector<size_t>& order,
+         const size_t first,
+         const size_t numPoints,
+         const std::vector<size_t>& capacity,
+         const size_t height)
+{
+  numDescendants = numPoints;
+
+  if (height == 0)
+  {
+    for (size_t i = first; i < first + numPoints; ++i)
+    {
+      bound |= dataset->col(order[i]);
+      points[count++] = order[i];
+    }
+
+    return;
+  }
+
+  // Use as few children as possible, but at least two, so that the subtree
+  // doesn't degenerate into a chain.  Spreading the points evenly keeps every
+  // child at least about half full.
+  const size_t childCapacity = capacity[height - 1];
+  const size_t numNodes = std::min(numPoints, std::max((size_t) 2,
+      (numPoints + childCapacity - 1) / childCapacity));
+  for (size_t i = 0; i < numNodes; ++i)
+  {
+    const size_t childFirst = first + (numPoints * i) / numNodes;
+    const size_t childEnd = first + (numPoints * (i + 1)) / numNodes;
+
+    RectangleTree* child = new RectangleTree(this);
+    children[numChildren++] = child;
+    child->PackNode(order, childFirst, childEnd - childFirst, capacity,
+        height - 1);
+    bound |= child->Bound();
+  }
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -53,7 +160,8 @@ RectangleTree(const MatType& data,
               const size_t minLeafSize,
               const size_t maxNumChildren,
               const size_t minNumChildren,
-              const size_t firstDataIndex) :
+              const size_t firstDataIndex,
+              const bool bulkLoad) :
     maxNumChildren(maxNumChildren),
     minNumChildren(minNumChildren),
     numChildren(0),
@@ -71,11 +179,18 @@ RectangleTree(const MatType& data,
     points(maxLeafSize + 1), // Add one to make splitting the node simpler.
     auxiliaryInfo(this)
 {
-  // For now, just insert the points in order.
-  RectangleTree* root = this;
+  if (bulkLoad)
+  {
+    BulkLoad(firstDataIndex);
+  }
+  else
+  {
+    // Insert the points in order.
+    RectangleTree* root = this;
 
-  for (size_t i = firstDataIndex; i < data.n_cols; i++)
-    root->InsertPoint(i);
+    for (size_t i = firstDataIndex; i < data.n_cols; i++)
+      root->InsertPoint(i);
+  }
 
   // Initialize statistic recursively after tree construction is complete.
   BuildStatistics(this);
@@ -94,7 +209,8 @@ RectangleTree(MatType&& data,
               const size_t minLeafSize,
               const size_t maxNumChildren,
               const size_t minNumChildren,
-              const size_t firstDataIndex) :
+              const size_t firstDataIndex,
+              const bool bulkLoad) :
     maxNumChildren(maxNumChildren),
     minNumChildren(minNumChildren),
     numChildren(0),
@@ -112,11 +228,18 @@ RectangleTree(MatType&& data,
     points(maxLeafSize + 1), // Add one to make splitting the node simpler.
     auxiliaryInfo(this)
 {
-  // For now, just insert the points in order.
-  RectangleTree* root = this;
+  if (bulkLoad)
+  {
+    BulkLoad(firstDataIndex);
+  }
+  else
+  {
+    // Insert the points in order.
+    RectangleTree* root = this;
 
-  for (size_t i = firstDataIndex; i < dataset->n_cols; i++)
-    root->InsertPoint(i);
+    for (size_t i = firstDataIndex; i < dataset->n_cols; i++)
+      root->InsertPoint(i);
+  }
 
   // Initialize statistic recursively after tree construction is complete.
   BuildStatistics(this);
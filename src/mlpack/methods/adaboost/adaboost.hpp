@@ -169,6 +169,17 @@ class AdaBoost
   void Classify(const MatType& test,
                 arma::Row<size_t>& predictedLabels);
 
+  /**
+   * Append the weak learners to the given FlatForest, for fast classification
+   * of many points.  Each weak learner votes for its predicted class with its
+   * weight, so the FlatForest gives the same predictions and probabilities as
+   * Classify().  This is only available when the weak learners are decision
+   * trees (like ID3DecisionStump).
+   *
+   * @param forest Forest to append the weak learners to.
+   */
+  void Flatten(tree::FlatForest& forest) const;
+
   /**
    * Serialize the AdaBoost model.
    */
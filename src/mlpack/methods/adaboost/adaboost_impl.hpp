@@ -250,6 +250,17 @@ void AdaBoost<WeakLearnerType, MatType>::Classify(
   }
 }
 
+/**
+ * Append the weak learners to a FlatForest.
+ */
+template<typename WeakLearnerType, typename MatType>
+void AdaBoost<WeakLearnerType, MatType>::Flatten(
+    tree::FlatForest& forest) const
+{
+  for (size_t i = 0; i < wl.size(); ++i)
+    wl[i].Flatten(forest, alpha[i], true);
+}
+
 /**
  * Serialize the AdaBoost model.
  */
@@ -44,7 +44,9 @@ namespace dbscan {
  * range search technique used and the point selection strategy by means of
  * template parameters.
  *
- * @tparam RangeSearchType Class to use for range searching.
+ * @tparam RangeSearchType Class to use for range searching; it must provide the
+ *      Search() overloads of RangeSearch that return results in compressed
+ *      sparse row form.
  * @tparam PointSelectionPolicy Strategy for selecting next point to cluster
  *      with.
  */
@@ -152,8 +152,11 @@ void DBSCAN<RangeSearchType, PointSelectionPolicy>::PointwiseCluster(
     const MatType& data,
     emst::UnionFind& uf)
 {
-  std::vector<std::vector<size_t>> neighbors;
-  std::vector<std::vector<double>> distances;
+  // The results are held in compressed sparse row form, so that the same
+  // buffers can be reused for every point.
+  std::vector<size_t> offsets;
+  std::vector<size_t> neighbors;
+  std::vector<double> distances;
 
   for (size_t i = 0; i < data.n_cols; ++i)
   {
@@ -161,12 +164,12 @@ void DBSCAN<RangeSearchType, PointSelectionPolicy>::PointwiseCluster(
       Log::Info << "DBSCAN clustering on point " << i << "..." << std::endl;
 
     // Do the range search for only this point.
-    rangeSearch.Search(data.col(i), math::Range(0.0, epsilon), neighbors,
-        distances);
+    rangeSearch.Search(data.col(i), math::Range(0.0, epsilon), offsets,
+        neighbors, distances);
 
     // Union to all neighbors.
-    for (size_t j = 0; j < neighbors[0].size(); ++j)
-      uf.Union(i, neighbors[0][j]);
+    for (size_t j = 0; j < neighbors.size(); ++j)
+      uf.Union(i, neighbors[j]);
   }
 }
 
@@ -182,11 +185,15 @@ void DBSCAN<RangeSearchType, PointSelectionPolicy>::BatchCluster(
     emst::UnionFind& uf)
 {
   // For each point, find the points in epsilon-nighborhood and their distances.
-  std::vector<std::vector<size_t>> neighbors;
-  std::vector<std::vector<double>> distances;
+  // The results are held in compressed sparse row form: the neighbors of point
+  // i are neighbors[offsets[i]] through neighbors[offsets[i + 1] - 1].
+  std::vector<size_t> offsets;
+  std::vector<size_t> neighbors;
+  std::vector<double> distances;
   Log::Info << "Performing range search." << std::endl;
   rangeSearch.Train(data);
-  rangeSearch.Search(data, math::Range(0.0, epsilon), neighbors, distances);
+  rangeSearch.Search(data, math::Range(0.0, epsilon), offsets, neighbors,
+      distances);
   Log::Info << "Range search complete." << std::endl;
 
   // Now loop over all points.
@@ -194,8 +201,8 @@ void DBSCAN<RangeSearchType, PointSelectionPolicy>::BatchCluster(
   {
     // Get the next index.
     const size_t index = pointSelector.Select(i, data);
-    for (size_t j = 0; j < neighbors[index].size(); ++j)
-      uf.Union(index, neighbors[index][j]);
+    for (size_t j = offsets[index]; j < offsets[index + 1]; ++j)
+      uf.Union(index, neighbors[j]);
   }
 }
 
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_DECISION_TREE_ALL_CATEGORICAL_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "flat_forest.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -86,6 +87,26 @@ class AllCategoricalSplit
       const ElemType& point,
       const arma::Col<ElemType>& classProbabilities,
       const AuxiliarySplitInfo<ElemType>& /* aux */);
+
+  /**
+   * Store the split in the given node of a FlatForest.  On input, childNodes
+   * holds one element per child; each is set to the node of the forest that
+   * the child should be stored in.
+   *
+   * @param forest Forest to store the split in.
+   * @param node Node to store the split in.
+   * @param dimension Dimension of the split.
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   * @param childNodes Nodes of the children.
+   */
+  template<typename ElemType>
+  static void Flatten(FlatForest& forest,
+                      const size_t node,
+                      const size_t dimension,
+                      const arma::Col<ElemType>& classProbabilities,
+                      const AuxiliarySplitInfo<ElemType>& /* aux */,
+                      std::vector<size_t>& childNodes);
 };
 
 } // namespace tree
@@ -128,6 +128,23 @@ size_t AllCategoricalSplit<FitnessFunction>::CalculateDirection(
   return (size_t) point;
 }
 
+template<typename FitnessFunction>
+template<typename ElemType>
+void AllCategoricalSplit<FitnessFunction>::Flatten(
+    FlatForest& forest,
+    const size_t node,
+    const size_t dimension,
+    const arma::Col<ElemType>& /* classProbabilities */,
+    const AuxiliarySplitInfo<ElemType>& /* aux */,
+    std::vector<size_t>& childNodes)
+{
+  // There is one child per category.
+  const size_t first = forest.AddCategoricalSplit(node, dimension,
+      childNodes.size());
+  for (size_t i = 0; i < childNodes.size(); ++i)
+    childNodes[i] = first + i;
+}
+
 } // namespace tree
 } // namespace mlpack
 
@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_DECISION_TREE_BEST_BINARY_NUMERIC_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "flat_forest.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -62,6 +63,42 @@ class BestBinaryNumericSplit
       arma::Col<typename VecType::elem_type>& classProbabilities,
       AuxiliarySplitInfo<typename VecType::elem_type>& aux);
 
+  /**
+   * Like SplitIfBetter(), but the values of the dimension are given already
+   * sorted, with the labels and weights in the same order.  This is used by
+   * DecisionTree::TrainPresorted(), which sorts each dimension only once.
+   *
+   * @param bestGain Best gain seen so far (we'll only split if we find gain
+   *      better than this).
+   * @param sortedData The sorted values of the dimension to check for a split
+   *      in.
+   * @param sortedLabels Labels for each value.
+   * @param numClasses Number of classes in the dataset.
+   * @param sortedWeights Weights for each value (only used if UseWeights is
+   *      true).
+   * @param minimumLeafSize Minimum number of points in a leaf node for
+   *      splitting.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param classProbabilities Class probabilities vector, which may be filled
+   *      with split information a successful split.
+   * @param aux Auxiliary split information, which may be modified on a
+   *      successful split.
+   */
+  template<bool UseWeights,
+           typename VecType,
+           typename LabelsType,
+           typename WeightVecType>
+  static double SplitIfBetterSorted(
+      const double bestGain,
+      const VecType& sortedData,
+      const LabelsType& sortedLabels,
+      const size_t numClasses,
+      const WeightVecType& sortedWeights,
+      const size_t minimumLeafSize,
+      const double minimumGainSplit,
+      arma::Col<typename VecType::elem_type>& classProbabilities,
+      AuxiliarySplitInfo<typename VecType::elem_type>& aux);
+
   /**
    * Returns 2, since the binary split always has two children.
    */
@@ -84,6 +121,26 @@ class BestBinaryNumericSplit
       const ElemType& point,
       const arma::Col<ElemType>& classProbabilities,
       const AuxiliarySplitInfo<ElemType>& /* aux */);
+
+  /**
+   * Store the split in the given node of a FlatForest.  On input, childNodes
+   * holds one element per child; each is set to the node of the forest that
+   * the child should be stored in.
+   *
+   * @param forest Forest to store the split in.
+   * @param node Node to store the split in.
+   * @param dimension Dimension of the split.
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   * @param childNodes Nodes of the children.
+   */
+  template<typename ElemType>
+  static void Flatten(FlatForest& forest,
+                      const size_t node,
+                      const size_t dimension,
+                      const arma::Col<ElemType>& classProbabilities,
+                      const AuxiliarySplitInfo<ElemType>& /* aux */,
+                      std::vector<size_t>& childNodes);
 };
 
 } // namespace tree
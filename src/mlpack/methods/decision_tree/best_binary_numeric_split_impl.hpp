@@ -26,7 +26,7 @@ double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetter(
     const size_t minimumLeafSize,
     const double minimumGainSplit,
     arma::Col<typename VecType::elem_type>& classProbabilities,
-    AuxiliarySplitInfo<typename VecType::elem_type>& /* aux */)
+    AuxiliarySplitInfo<typename VecType::elem_type>& aux)
 {
   // First sanity check: if we don't have enough points, we can't split.
   if (data.n_elem < (minimumLeafSize * 2))
@@ -34,27 +34,54 @@ double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetter(
   if (bestGain == 0.0)
     return DBL_MAX; // It can't be outperformed.
 
-  // Next, sort the data.
-  arma::uvec sortedIndices = arma::sort_index(data);
-  arma::Row<size_t> sortedLabels(labels.n_elem);
+  // Next, sort the data, and put the labels and weights in the same order.
+  const arma::uvec sortedIndices = arma::sort_index(data);
+  arma::Col<typename VecType::elem_type> sortedData(sortedIndices.n_elem);
+  arma::Row<size_t> sortedLabels(sortedIndices.n_elem);
   arma::rowvec sortedWeights;
-  for (size_t i = 0; i < sortedLabels.n_elem; ++i)
-    sortedLabels[i] = labels[sortedIndices[i]];
-
-  // Sanity check: if the first element is the same as the last, we can't split
-  // in this dimension.
-  if (data[sortedIndices[0]] == data[sortedIndices[sortedIndices.n_elem - 1]])
-    return DBL_MAX;
-
   // Only initialize if we are using weights.
   if (UseWeights)
+    sortedWeights.set_size(sortedIndices.n_elem);
+  for (size_t i = 0; i < sortedIndices.n_elem; ++i)
   {
-    sortedWeights.set_size(sortedLabels.n_elem);
-    // The weights must keep the same order as the labels.
-    for (size_t i = 0; i < sortedLabels.n_elem; ++i)
+    sortedData[i] = data[sortedIndices[i]];
+    sortedLabels[i] = labels[sortedIndices[i]];
+    if (UseWeights)
       sortedWeights[i] = weights[sortedIndices[i]];
   }
 
+  return SplitIfBetterSorted<UseWeights>(bestGain, sortedData, sortedLabels,
+      numClasses, sortedWeights, minimumLeafSize, minimumGainSplit,
+      classProbabilities, aux);
+}
+
+template<typename FitnessFunction>
+template<bool UseWeights,
+         typename VecType,
+         typename LabelsType,
+         typename WeightVecType>
+double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetterSorted(
+    const double bestGain,
+    const VecType& sortedData,
+    const LabelsType& sortedLabels,
+    const size_t numClasses,
+    const WeightVecType& sortedWeights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    arma::Col<typename VecType::elem_type>& classProbabilities,
+    AuxiliarySplitInfo<typename VecType::elem_type>& /* aux */)
+{
+  // First sanity check: if we don't have enough points, we can't split.
+  if (sortedData.n_elem < (minimumLeafSize * 2))
+    return DBL_MAX;
+  if (bestGain == 0.0)
+    return DBL_MAX; // It can't be outperformed.
+
+  // Sanity check: if the first element is the same as the last, we can't split
+  // in this dimension.
+  if (sortedData[0] == sortedData[sortedData.n_elem - 1])
+    return DBL_MAX;
+
   // Loop through all possible split points, choosing the best one.  Also, force
   // a minimum leaf size of 1 (empty children don't make sense).
   double bestFoundGain = std::min(bestGain + minimumGainSplit, 0.0);
@@ -82,7 +109,7 @@ double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetter(
     }
 
     // These points have to be on the right.
-    for (size_t i = minimum - 1; i < data.n_elem; ++i)
+    for (size_t i = minimum - 1; i < sortedData.n_elem; ++i)
     {
       classWeightSums(sortedLabels[i], 1) += sortedWeights[i];
       totalRightWeight += sortedWeights[i];
@@ -91,7 +118,7 @@ double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetter(
   else
   {
     classCounts.zeros(numClasses, 2);
-    bestFoundGain *= data.n_elem;
+    bestFoundGain *= sortedData.n_elem;
 
     // Initialize the counts.
     // These points have to be on the left.
@@ -99,11 +126,11 @@ double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetter(
       ++classCounts(sortedLabels[i], 0);
 
     // These points have to be on the right.
-    for (size_t i = minimum - 1; i < data.n_elem; ++i)
+    for (size_t i = minimum - 1; i < sortedData.n_elem; ++i)
       ++classCounts(sortedLabels[i], 1);
   }
 
-  for (size_t index = minimum; index < data.n_elem - minimum; ++index)
+  for (size_t index = minimum; index < sortedData.n_elem - minimum; ++index)
   {
     // Update class weight sums or counts.
     if (UseWeights)
@@ -120,7 +147,7 @@ double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetter(
     }
 
     // Make sure that the value has changed.
-    if (data[sortedIndices[index]] == data[sortedIndices[index - 1]])
+    if (sortedData[index] == sortedData[index - 1])
       continue;
 
     // Calculate the gain for the left and right child.  Only use weights if
@@ -156,8 +183,8 @@ double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetter(
       classProbabilities.set_size(1);
       // The actual split value will be halfway between the value at index - 1
       // and index.
-      classProbabilities[0] = (data[sortedIndices[index - 1]] +
-          data[sortedIndices[index]]) / 2.0;
+      classProbabilities[0] = (sortedData[index - 1] +
+          sortedData[index]) / 2.0;
 
       return gain;
     }
@@ -166,8 +193,8 @@ double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetter(
       // We still have a better split.
       bestFoundGain = gain;
       classProbabilities.set_size(1);
-      classProbabilities[0] = (data[sortedIndices[index - 1]] +
-          data[sortedIndices[index]]) / 2.0;
+      classProbabilities[0] = (sortedData[index - 1] +
+          sortedData[index]) / 2.0;
       improved = true;
     }
   }
@@ -198,6 +225,23 @@ size_t BestBinaryNumericSplit<FitnessFunction>::CalculateDirection(
     return 1; // Go right.
 }
 
+template<typename FitnessFunction>
+template<typename ElemType>
+void BestBinaryNumericSplit<FitnessFunction>::Flatten(
+    FlatForest& forest,
+    const size_t node,
+    const size_t dimension,
+    const arma::Col<ElemType>& classProbabilities,
+    const AuxiliarySplitInfo<ElemType>& /* aux */,
+    std::vector<size_t>& childNodes)
+{
+  // Points at most the split point go left, like in CalculateDirection().
+  const size_t first = forest.AddNumericSplit(node, dimension,
+      classProbabilities[0]);
+  childNodes[0] = first;
+  childNodes[1] = first + 1;
+}
+
 } // namespace tree
 } // namespace mlpack
 
@@ -17,8 +17,12 @@
 #include "gini_gain.hpp"
 #include "information_gain.hpp"
 #include "best_binary_numeric_split.hpp"
+#include "numeric_split_traits.hpp"
+#include "histogram_numeric_split.hpp"
 #include "all_categorical_split.hpp"
+#include "dimension_selection_traits.hpp"
 #include "all_dimension_select.hpp"
+#include "flat_forest.hpp"
 #include <type_traits>
 
 namespace mlpack {
@@ -30,6 +34,17 @@ namespace tree {
  *
  * The class inherits from the auxiliary split information in order to prevent
  * an empty auxiliary split information struct from taking any extra size.
+ *
+ * When OpenMP is available, large trees are built by several threads: the
+ * candidate dimensions of large nodes are evaluated in parallel, and large
+ * children are built in their own OpenMP tasks.  If training starts inside a
+ * parallel region (as in RandomForest), the tasks go to the threads of that
+ * region; otherwise a parallel region is started for the tree.  Children are
+ * only built in their own tasks when DimensionSelectionTraits says that the
+ * dimension selector is deterministic; a random selector (like
+ * MultipleRandomDimensionSelect) visits the nodes in the same depth-first order
+ * as a single thread, so it draws the same random numbers.  Either way, the
+ * tree is the same as the one built by a single thread.
  */
 template<typename FitnessFunction = GiniGain,
          template<typename> class NumericSplitType = BestBinaryNumericSplit,
@@ -400,6 +415,337 @@ class DecisionTree :
                const std::enable_if_t<arma::is_arma_type<typename
                    std::remove_reference<WeightsType>::type>::value>* = 0);
 
+  /**
+   * Train the decision tree on the given data, assuming that all dimensions are
+   * numeric, like Train(), but sort each dimension only once instead of at
+   * every node.  The order of the points along each dimension is kept, and when
+   * a node is split, the part of each order that belongs to the node is stably
+   * partitioned between its children, so the points of each child stay sorted.
+   * The tree is built one level at a time, so all of the nodes of a level are
+   * processed in one pass over the order of each dimension.  The orders take
+   * one index per point and dimension of extra memory.
+   *
+   * NumericSplitType must have a SplitIfBetterSorted() method, like
+   * BestBinaryNumericSplit.  With a deterministic DimensionSelectionType (like
+   * AllDimensionSelect), the tree is the same as the one Train() builds.  A
+   * random DimensionSelectionType draws the dimensions of the nodes in
+   * breadth-first order instead of depth-first order, so the tree will differ.
+   *
+   * @param data Dataset to train on.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double TrainPresorted(const MatType& data,
+                        const arma::Row<size_t>& labels,
+                        const size_t numClasses,
+                        const size_t minimumLeafSize = 10,
+                        const double minimumGainSplit = 1e-7,
+                        const size_t maximumDepth = 0,
+                        DimensionSelectionType dimensionSelector =
+                            DimensionSelectionType());
+
+  /**
+   * Train the decision tree on the given weighted data, assuming that all
+   * dimensions are numeric, like Train(), but sort each dimension only once
+   * instead of at every node.  See the unweighted overload of TrainPresorted()
+   * for details.
+   *
+   * @param data Dataset to train on.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of all the labels.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double TrainPresorted(const MatType& data,
+                        const arma::Row<size_t>& labels,
+                        const size_t numClasses,
+                        const arma::rowvec& weights,
+                        const size_t minimumLeafSize = 10,
+                        const double minimumGainSplit = 1e-7,
+                        const size_t maximumDepth = 0,
+                        DimensionSelectionType dimensionSelector =
+                            DimensionSelectionType());
+
+  /**
+   * Train the decision tree on the given data, assuming that all dimensions are
+   * numeric, like Train(), but bin each dimension only once instead of at every
+   * node.  Each dimension is divided into bins with
+   * NumericSplitType::ComputeBins(), and the bin of every value is kept.  The
+   * histogram of the points of the root (the count or weight of each class in
+   * each bin of each dimension) is computed once; when a node is split, the
+   * histograms of all of its children but the largest are computed from their
+   * points, and the histogram of the largest child is the histogram of the node
+   * minus the others.  The splits are found from the histograms with
+   * NumericSplitType::SplitIfBetterBinned().  The bins take one byte per point
+   * and dimension of extra memory.
+   *
+   * NumericSplitType must have ComputeBins() and SplitIfBetterBinned() methods,
+   * like HistogramNumericSplit.  Like Train(), large nodes evaluate their
+   * dimensions in parallel and build large children in their own tasks, and
+   * the tree is the same as the one built by a single thread.  Since the bins
+   * are the same at every node, the tree may differ from the one Train() builds
+   * with HistogramNumericSplit (which bins each node separately); when a
+   * dimension has at most HistogramNumericSplit::MaxBins distinct values, each
+   * value has its own bin and the splits are exact.
+   *
+   * @param data Dataset to train on.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double TrainHistogram(const MatType& data,
+                        const arma::Row<size_t>& labels,
+                        const size_t numClasses,
+                        const size_t minimumLeafSize = 10,
+                        const double minimumGainSplit = 1e-7,
+                        const size_t maximumDepth = 0,
+                        DimensionSelectionType dimensionSelector =
+                            DimensionSelectionType());
+
+  /**
+   * Train the decision tree on the given weighted data, assuming that all
+   * dimensions are numeric, like Train(), but bin each dimension only once
+   * instead of at every node.  See the unweighted overload of TrainHistogram()
+   * for details.
+   *
+   * @param data Dataset to train on.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of all the labels.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double TrainHistogram(const MatType& data,
+                        const arma::Row<size_t>& labels,
+                        const size_t numClasses,
+                        const arma::rowvec& weights,
+                        const size_t minimumLeafSize = 10,
+                        const double minimumGainSplit = 1e-7,
+                        const size_t maximumDepth = 0,
+                        DimensionSelectionType dimensionSelector =
+                            DimensionSelectionType());
+
+  /**
+   * Train the decision tree on the given points of the given data, which may
+   * hold some points several times (like a bootstrap sample), from bins that
+   * were computed once for the whole dataset with BinData().  This is like
+   * TrainHistogram(), but the bins can be shared by many trees: RandomForest
+   * bins the dataset once and trains each tree on its bootstrap sample this
+   * way.  Only the indices of the points are copied.
+   *
+   * @param data Dataset to train on.
+   * @param bins Bin of each value of the dataset, from BinData().
+   * @param binMin Smallest value of each bin, from BinData().
+   * @param binMax Largest value of each bin, from BinData().
+   * @param points Indices of the points of data to train on.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double TrainHistogram(const MatType& data,
+                        const arma::Mat<unsigned char>& bins,
+                        const arma::Mat<typename MatType::elem_type>& binMin,
+                        const arma::Mat<typename MatType::elem_type>& binMax,
+                        arma::uvec points,
+                        const arma::Row<size_t>& labels,
+                        const size_t numClasses,
+                        const size_t minimumLeafSize = 10,
+                        const double minimumGainSplit = 1e-7,
+                        const size_t maximumDepth = 0,
+                        DimensionSelectionType dimensionSelector =
+                            DimensionSelectionType());
+
+  /**
+   * Train the decision tree on the given weighted points of the given data,
+   * from bins that were computed with BinData().  See the unweighted overload
+   * of this TrainHistogram() for details.
+   *
+   * @param data Dataset to train on.
+   * @param bins Bin of each value of the dataset, from BinData().
+   * @param binMin Smallest value of each bin, from BinData().
+   * @param binMax Largest value of each bin, from BinData().
+   * @param points Indices of the points of data to train on.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each point of the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double TrainHistogram(const MatType& data,
+                        const arma::Mat<unsigned char>& bins,
+                        const arma::Mat<typename MatType::elem_type>& binMin,
+                        const arma::Mat<typename MatType::elem_type>& binMax,
+                        arma::uvec points,
+                        const arma::Row<size_t>& labels,
+                        const size_t numClasses,
+                        const arma::rowvec& weights,
+                        const size_t minimumLeafSize = 10,
+                        const double minimumGainSplit = 1e-7,
+                        const size_t maximumDepth = 0,
+                        DimensionSelectionType dimensionSelector =
+                            DimensionSelectionType());
+
+  /**
+   * Bin each dimension of the given data with NumericSplitType::ComputeBins(),
+   * in parallel, for TrainHistogram().  The bins take one byte per point and
+   * dimension.
+   *
+   * @param data Dataset to bin.
+   * @param bins Set to the bin of each value of the dataset.
+   * @param binMin Set to the smallest value of each bin; column i holds
+   *     dimension i.
+   * @param binMax Set to the largest value of each bin; column i holds
+   *     dimension i.
+   */
+  template<typename MatType>
+  static void BinData(const MatType& data,
+                      arma::Mat<unsigned char>& bins,
+                      arma::Mat<typename MatType::elem_type>& binMin,
+                      arma::Mat<typename MatType::elem_type>& binMax);
+
+  /**
+   * Train the decision tree on the given points of the given data, which may
+   * hold some points several times (like a bootstrap sample).  The result is
+   * the same as training on data.cols(points) with Train(), but the data is
+   * not copied: the tree only reorders a copy of the indices of the points, so
+   * the extra memory is one index per point instead of a copy of the data.
+   * This is how RandomForest trains its trees.
+   *
+   * @param data Dataset to train on.
+   * @param points Indices of the points of data to train on.
+   * @param datasetInfo Type information for each dimension of the dataset.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double TrainSubset(const MatType& data,
+                     arma::uvec points,
+                     const data::DatasetInfo& datasetInfo,
+                     const arma::Row<size_t>& labels,
+                     const size_t numClasses,
+                     const size_t minimumLeafSize = 10,
+                     const double minimumGainSplit = 1e-7,
+                     const size_t maximumDepth = 0,
+                     DimensionSelectionType dimensionSelector =
+                         DimensionSelectionType());
+
+  /**
+   * Train the decision tree on the given points of the given data, assuming
+   * that all dimensions are numeric.  See the first overload of TrainSubset()
+   * for details.
+   *
+   * @param data Dataset to train on.
+   * @param points Indices of the points of data to train on.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double TrainSubset(const MatType& data,
+                     arma::uvec points,
+                     const arma::Row<size_t>& labels,
+                     const size_t numClasses,
+                     const size_t minimumLeafSize = 10,
+                     const double minimumGainSplit = 1e-7,
+                     const size_t maximumDepth = 0,
+                     DimensionSelectionType dimensionSelector =
+                         DimensionSelectionType());
+
+  /**
+   * Train the decision tree on the given weighted points of the given data.
+   * See the first overload of TrainSubset() for details.
+   *
+   * @param data Dataset to train on.
+   * @param points Indices of the points of data to train on.
+   * @param datasetInfo Type information for each dimension of the dataset.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each point of the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double TrainSubset(const MatType& data,
+                     arma::uvec points,
+                     const data::DatasetInfo& datasetInfo,
+                     const arma::Row<size_t>& labels,
+                     const size_t numClasses,
+                     const arma::rowvec& weights,
+                     const size_t minimumLeafSize = 10,
+                     const double minimumGainSplit = 1e-7,
+                     const size_t maximumDepth = 0,
+                     DimensionSelectionType dimensionSelector =
+                         DimensionSelectionType());
+
+  /**
+   * Train the decision tree on the given weighted points of the given data,
+   * assuming that all dimensions are numeric.  See the first overload of
+   * TrainSubset() for details.
+   *
+   * @param data Dataset to train on.
+   * @param points Indices of the points of data to train on.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each point of the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double TrainSubset(const MatType& data,
+                     arma::uvec points,
+                     const arma::Row<size_t>& labels,
+                     const size_t numClasses,
+                     const arma::rowvec& weights,
+                     const size_t minimumLeafSize = 10,
+                     const double minimumGainSplit = 1e-7,
+                     const size_t maximumDepth = 0,
+                     DimensionSelectionType dimensionSelector =
+                         DimensionSelectionType());
+
   /**
    * Classify the given point, using the entire tree.  The predicted label is
    * returned.
@@ -449,6 +795,20 @@ class DecisionTree :
                 arma::Row<size_t>& predictions,
                 arma::mat& probabilities) const;
 
+  /**
+   * Append the tree to the given FlatForest, for fast classification of many
+   * points.  The FlatForest gives the same predictions and probabilities as
+   * Classify().
+   *
+   * @param forest Forest to append the tree to.
+   * @param weight Weight of the tree in the forest.
+   * @param hardVote If true, the tree votes for its predicted class only,
+   *     instead of adding its class probabilities.
+   */
+  void Flatten(FlatForest& forest,
+               const double weight = 1.0,
+               const bool hardVote = false) const;
+
   /**
    * Serialize the tree.
    */
@@ -507,6 +867,20 @@ class DecisionTree :
   typedef typename CategoricalSplit::template AuxiliarySplitInfo<ElemType>
       CategoricalAuxiliarySplitInfo;
 
+  //! Nodes with fewer points than this are built by a single thread.
+  static const size_t MinimumParallelSize = 2048;
+
+  //! Children can only be built in their own tasks if the dimension selector
+  //! does not draw random numbers; otherwise the nodes must draw their
+  //! dimensions in the same order as a single thread.
+  static const bool ParallelChildren = !NoRecursion &&
+      DimensionSelectionTraits<DimensionSelectionType>::IsDeterministic;
+
+  /**
+   * Store this node and its subtree in the given (unset) node of a FlatForest.
+   */
+  void FlattenNode(FlatForest& forest, const size_t node) const;
+
   /**
    * Calculate the class probabilities of the given labels.
    */
@@ -515,6 +889,70 @@ class DecisionTree :
                                    const size_t numClasses,
                                    const WeightsRowType& weights);
 
+  /**
+   * Find the best split of the points of a node among the dimensions given by
+   * the dimension selector.  If a split is found, bestDim and bestGain are set
+   * to it, and its information is stored in classProbabilities and the
+   * auxiliary split information; otherwise, they are not modified.  When
+   * called from a parallel region on a large node, the dimensions are evaluated
+   * in parallel tasks, and the result is the same as when they are evaluated
+   * one after another.
+   *
+   * @param dataRow Function that returns the values of the points of the node
+   *      in the given dimension, as a row vector.
+   * @param datasetInfo Type information for each dimension, or NULL if all
+   *      dimensions are numeric.
+   * @param labels Labels of the points of the node.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of the points of the node (only used if UseWeights
+   *      is true).
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @param bestDim Dimension of the best split (not modified if none).
+   * @param bestGain Gain of the node; set to the gain of the best split.
+   */
+  template<bool UseWeights,
+           typename RowFunctionType,
+           typename LabelsType,
+           typename WeightsType>
+  void FindSplit(const RowFunctionType& dataRow,
+                 const data::DatasetInfo* datasetInfo,
+                 const LabelsType& labels,
+                 const size_t numClasses,
+                 const WeightsType& weights,
+                 const size_t minimumLeafSize,
+                 const double minimumGainSplit,
+                 DimensionSelectionType& dimensionSelector,
+                 size_t& bestDim,
+                 double& bestGain);
+
+  /**
+   * Find the dimension with the best split, for FindSplit() and
+   * TrainHistogram().  When called from a parallel region on a large node, the
+   * dimensions are drawn first and then evaluated in parallel tasks, and the
+   * result is the same as when they are evaluated one after another.
+   *
+   * @param splitIfBetter Function that takes a dimension, a gain, class
+   *      probabilities and numeric and categorical auxiliary split information,
+   *      and returns the gain of the best split of the dimension if it is
+   *      better than the given gain (filling the probabilities and auxiliary
+   *      split information), or DBL_MAX otherwise.
+   * @param count Number of points of the node.
+   * @param datasetInfo Type information for each dimension, or NULL if all
+   *      dimensions are numeric.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @param bestDim Dimension of the best split (not modified if none).
+   * @param bestGain Gain of the node; set to the gain of the best split.
+   */
+  template<typename SplitFunctionType>
+  void FindBestDimension(const SplitFunctionType& splitIfBetter,
+                         const size_t count,
+                         const data::DatasetInfo* datasetInfo,
+                         DimensionSelectionType& dimensionSelector,
+                         size_t& bestDim,
+                         double& bestGain);
+
   /**
    * Corresponding to the public Train() method, this method is designed for
    * avoiding unnecessary copies during training.  This function is called to
@@ -572,6 +1010,178 @@ class DecisionTree :
                const double minimumGainSplit,
                const size_t maximumDepth,
                DimensionSelectionType& dimensionSelector);
+
+  /**
+   * Train on the points points[begin, begin + count) of the data, reordering
+   * only the points vector; this is called by the public TrainSubset()
+   * methods, and to train children.
+   *
+   * @param data Dataset to train on.
+   * @param points Indices of the points to train on.
+   * @param begin Index in points of the first point of this node.
+   * @param count Number of points in this node.
+   * @param datasetInfo Type information for each dimension, or NULL if all
+   *      dimensions are numeric.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each point (only used if UseWeights is true).
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<bool UseWeights, typename MatType>
+  double TrainSubset(const MatType& data,
+                     arma::uvec& points,
+                     const size_t begin,
+                     const size_t count,
+                     const data::DatasetInfo* datasetInfo,
+                     const arma::Row<size_t>& labels,
+                     const size_t numClasses,
+                     const arma::rowvec& weights,
+                     const size_t minimumLeafSize,
+                     const double minimumGainSplit,
+                     const size_t maximumDepth,
+                     DimensionSelectionType& dimensionSelector);
+
+  /**
+   * Throw an exception if the given points, labels and weights do not match
+   * the given data; this is called by the public TrainSubset() and
+   * TrainHistogram() methods, whose name is given as the caller.
+   */
+  template<typename MatType>
+  static void CheckSubset(const MatType& data,
+                          const arma::uvec& points,
+                          const arma::Row<size_t>& labels,
+                          const arma::rowvec* weights,
+                          const std::string& caller);
+
+  /**
+   * Build the tree level by level from presorted dimensions; this is called by
+   * the public TrainPresorted() methods.
+   *
+   * @param data Dataset to train on.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of all the labels (only used if UseWeights is true).
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<bool UseWeights, typename MatType>
+  double TrainPresorted(const MatType& data,
+                        const arma::Row<size_t>& labels,
+                        const size_t numClasses,
+                        const arma::rowvec& weights,
+                        const size_t minimumLeafSize,
+                        const double minimumGainSplit,
+                        const size_t maximumDepth,
+                        DimensionSelectionType& dimensionSelector);
+
+  /**
+   * Throw an exception if the given bins do not match the given data; this is
+   * called by the public TrainHistogram() methods that take bins.
+   */
+  template<typename MatType>
+  static void CheckBins(const MatType& data,
+                        const arma::Mat<unsigned char>& bins,
+                        const arma::Mat<typename MatType::elem_type>& binMin,
+                        const arma::Mat<typename MatType::elem_type>& binMax);
+
+  /**
+   * Compute the histogram of the root and train the tree from it; this is
+   * called by the public TrainHistogram() methods.
+   *
+   * @param data Dataset to train on.
+   * @param bins Bin of each value of the dataset.
+   * @param binMin Smallest value of each bin; column i holds dimension i.
+   * @param binMax Largest value of each bin; column i holds dimension i.
+   * @param points Indices of the points of the dataset to train on.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of all the labels (only used if UseWeights is true).
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<bool UseWeights, typename MatType>
+  double TrainHistogram(const MatType& data,
+                        const arma::Mat<unsigned char>& bins,
+                        const arma::Mat<typename MatType::elem_type>& binMin,
+                        const arma::Mat<typename MatType::elem_type>& binMax,
+                        arma::uvec& points,
+                        const arma::Row<size_t>& labels,
+                        const size_t numClasses,
+                        const arma::rowvec& weights,
+                        const size_t minimumLeafSize,
+                        const double minimumGainSplit,
+                        const size_t maximumDepth,
+                        DimensionSelectionType& dimensionSelector);
+
+  /**
+   * Train this node and its children from the histogram of the points of the
+   * node, which are points[begin, begin + count).  The points are reordered so
+   * that the points of each child are contiguous, and the histogram is used up
+   * (it becomes the histogram of the largest child).
+   *
+   * @param data Dataset to train on.
+   * @param bins Bin of each value of the dataset.
+   * @param binMin Smallest value of each bin; column i holds dimension i.
+   * @param binMax Largest value of each bin; column i holds dimension i.
+   * @param points Indices of the points of the dataset.
+   * @param begin Index of the first point of the node in points.
+   * @param count Number of points of the node.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of all the labels (only used if UseWeights is true).
+   * @param histogram Count (or weight) of each class (row) in each bin (column)
+   *     of each dimension (slice), for the points of the node.
+   * @param binSizes Number of points of the node in each bin (row) of each
+   *     dimension (column).
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of the subtree.
+   */
+  template<bool UseWeights, typename MatType, typename CountType>
+  double TrainHistogram(
+      const MatType& data,
+      const arma::Mat<unsigned char>& bins,
+      const arma::Mat<typename MatType::elem_type>& binMin,
+      const arma::Mat<typename MatType::elem_type>& binMax,
+      arma::uvec& points,
+      const size_t begin,
+      const size_t count,
+      const arma::Row<size_t>& labels,
+      const size_t numClasses,
+      const arma::rowvec& weights,
+      arma::Cube<CountType>& histogram,
+      arma::Mat<size_t>& binSizes,
+      const size_t minimumLeafSize,
+      const double minimumGainSplit,
+      const size_t maximumDepth,
+      DimensionSelectionType& dimensionSelector);
+
+  /**
+   * Add the points points[begin, begin + count) to the given histogram and bin
+   * sizes; this is used by TrainHistogram().  In a parallel region, large
+   * nodes fill blocks of dimensions in parallel tasks.
+   */
+  template<bool UseWeights, typename CountType>
+  static void AddToHistogram(const arma::Mat<unsigned char>& bins,
+                             const arma::uvec& points,
+                             const size_t begin,
+                             const size_t count,
+                             const arma::Row<size_t>& labels,
+                             const arma::rowvec& weights,
+                             arma::Cube<CountType>& histogram,
+                             arma::Mat<size_t>& binSizes);
 };
 
 /**
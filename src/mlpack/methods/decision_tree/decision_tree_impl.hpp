@@ -14,6 +14,10 @@
 
 #include "decision_tree.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace tree {
 
@@ -681,6 +685,26 @@ double DecisionTree<FitnessFunction,
     const size_t maximumDepth,
     DimensionSelectionType& dimensionSelector)
 {
+  #ifdef HAS_OPENMP
+  // If we are not in a parallel region yet, start one for a large tree, so
+  // that the threads can share the subtrees and the dimensions of the nodes.
+  if (!omp_in_parallel() && count >= MinimumParallelSize &&
+      omp_get_max_threads() > 1)
+  {
+    double gain = 0.0;
+    #pragma omp parallel
+    {
+      #pragma omp single
+      {
+        gain = Train<UseWeights>(data, begin, count, datasetInfo, labels,
+            numClasses, weights, minimumLeafSize, minimumGainSplit,
+            maximumDepth, dimensionSelector);
+      }
+    }
+    return gain;
+  }
+  #endif
+
   // Clear children if needed.
   for (size_t i = 0; i < children.size(); ++i)
     delete children[i];
@@ -696,53 +720,18 @@ double DecisionTree<FitnessFunction,
       numClasses,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
   size_t bestDim = datasetInfo.Dimensionality(); // This means "no split".
-  const size_t end = dimensionSelector.End();
 
   if (maximumDepth != 1)
   {
-    for (size_t i = dimensionSelector.Begin(); i != end;
-         i = dimensionSelector.Next())
+    auto dataRow = [&](const size_t i)
     {
-      double dimGain = -DBL_MAX;
-      if (datasetInfo.Type(i) == data::Datatype::categorical)
-      {
-        dimGain = CategoricalSplit::template SplitIfBetter<UseWeights>(bestGain,
-            data.cols(begin, begin + count - 1).row(i),
-            datasetInfo.NumMappings(i),
-            labels.subvec(begin, begin + count - 1),
-            numClasses,
-            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-            minimumLeafSize,
-            minimumGainSplit,
-            classProbabilities,
-            *this);
-      }
-      else if (datasetInfo.Type(i) == data::Datatype::numeric)
-      {
-        dimGain = NumericSplit::template SplitIfBetter<UseWeights>(bestGain,
-            data.cols(begin, begin + count - 1).row(i),
-            labels.subvec(begin, begin + count - 1),
-            numClasses,
-            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-            minimumLeafSize,
-            minimumGainSplit,
-            classProbabilities,
-            *this);
-      }
-
-      // If the splitter reported that it did not split, move to the next
-      // dimension.
-      if (dimGain == DBL_MAX)
-        continue;
-
-      // Was there an improvement?  If so mark that it's the new best dimension.
-      bestDim = i;
-      bestGain = dimGain;
-
-      // If the gain is the best possible, no need to keep looking.
-      if (bestGain >= 0.0)
-        break;
-    }
+      return data.cols(begin, begin + count - 1).row(i);
+    };
+    FindSplit<UseWeights>(dataRow, &datasetInfo,
+        labels.subvec(begin, begin + count - 1), numClasses,
+        UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+        minimumLeafSize, minimumGainSplit, dimensionSelector, bestDim,
+        bestGain);
   }
 
   // Did we split or not?  If so, then split the data and create the children.
@@ -787,11 +776,12 @@ double DecisionTree<FitnessFunction,
     }
 
     // Split into children.
+    arma::Col<size_t> childBegins(numChildren);
     size_t currentCol = begin;
     for (size_t i = 0; i < numChildren; ++i)
     {
-      size_t currentChildBegin = currentCol;
-      for (size_t j = currentChildBegin; j < begin + count; ++j)
+      childBegins[i] = currentCol;
+      for (size_t j = childBegins[i]; j < begin + count; ++j)
       {
         if (childAssignments[j - begin] == i)
         {
@@ -804,25 +794,43 @@ double DecisionTree<FitnessFunction,
         }
       }
 
-      // Now build the child recursively.
-      DecisionTree* child = new DecisionTree();
-      if (NoRecursion)
-      {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, currentCol - currentChildBegin, minimumGainSplit,
-            maximumDepth - 1, dimensionSelector);
-      }
-      else
+      children.push_back(new DecisionTree());
+    }
+
+    // Now build the children recursively.  Large children are built in their
+    // own tasks, which any idle thread of the team can take.  The children own
+    // disjoint ranges of the data, and each gets its own dimension selector.
+    // A random dimension selector draws from the global random number
+    // generator, so then the children are built in order by this thread.
+    arma::vec childGains(numChildren);
+    for (size_t i = 0; i < numChildren; ++i)
+    {
+      #pragma omp task default(shared) firstprivate(i) \
+          if(ParallelChildren && childCounts[i] >= MinimumParallelSize)
       {
-        // During recursion entropy of child node may change.
-        double childGain = child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, minimumLeafSize, minimumGainSplit, maximumDepth - 1,
-            dimensionSelector);
-        bestGain += double(childCounts[i]) / double(count) * (-childGain);
+        DimensionSelectionType childSelector(dimensionSelector);
+        if (NoRecursion)
+        {
+          children[i]->Train<UseWeights>(data, childBegins[i], childCounts[i],
+              datasetInfo, labels, numClasses, weights, childCounts[i],
+              minimumGainSplit, maximumDepth - 1, childSelector);
+        }
+        else
+        {
+          // During recursion entropy of child node may change.
+          childGains[i] = children[i]->Train<UseWeights>(data, childBegins[i],
+              childCounts[i], datasetInfo, labels, numClasses, weights,
+              minimumLeafSize, minimumGainSplit, maximumDepth - 1,
+              childSelector);
+        }
       }
-      children.push_back(child);
+    }
+    #pragma omp taskwait
+
+    if (!NoRecursion)
+    {
+      for (size_t i = 0; i < numChildren; ++i)
+        bestGain += double(childCounts[i]) / double(count) * (-childGains[i]);
     }
   }
   else
@@ -866,6 +874,26 @@ double DecisionTree<FitnessFunction,
     const size_t maximumDepth,
     DimensionSelectionType& dimensionSelector)
 {
+  #ifdef HAS_OPENMP
+  // If we are not in a parallel region yet, start one for a large tree, so
+  // that the threads can share the subtrees and the dimensions of the nodes.
+  if (!omp_in_parallel() && count >= MinimumParallelSize &&
+      omp_get_max_threads() > 1)
+  {
+    double gain = 0.0;
+    #pragma omp parallel
+    {
+      #pragma omp single
+      {
+        gain = Train<UseWeights>(data, begin, count, labels, numClasses,
+            weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+            dimensionSelector);
+      }
+    }
+    return gain;
+  }
+  #endif
+
   // Clear children if needed.
   for (size_t i = 0; i < children.size(); ++i)
     delete children[i];
@@ -887,34 +915,15 @@ double DecisionTree<FitnessFunction,
 
   if (maximumDepth != 1)
   {
-    for (size_t i = dimensionSelector.Begin(); i != dimensionSelector.End();
-         i = dimensionSelector.Next())
+    auto dataRow = [&](const size_t i)
     {
-      const double dimGain = NumericSplitType<FitnessFunction>::template
-          SplitIfBetter<UseWeights>(bestGain,
-                                    data.cols(begin, begin + count - 1).row(i),
-                                    labels.cols(begin, begin + count - 1),
-                                    numClasses,
-                                    UseWeights ?
-                                        weights.cols(begin, begin + count - 1) :
-                                        weights,
-                                    minimumLeafSize,
-                                    minimumGainSplit,
-                                    classProbabilities,
-                                    *this);
-
-      // If the splitter did not report that it improved, then move to the next
-      // dimension.
-      if (dimGain == DBL_MAX)
-        continue;
-
-      bestDim = i;
-      bestGain = dimGain;
-
-      // If the gain is the best possible, no need to keep looking.
-      if (bestGain >= 0.0)
-        break;
-    }
+      return data.cols(begin, begin + count - 1).row(i);
+    };
+    FindSplit<UseWeights>(dataRow, NULL,
+        labels.subvec(begin, begin + count - 1), numClasses,
+        UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+        minimumLeafSize, minimumGainSplit, dimensionSelector, bestDim,
+        bestGain);
   }
 
   // Did we split or not?  If so, then split the data and create the children.
@@ -946,11 +955,12 @@ double DecisionTree<FitnessFunction,
       bestGain = 0.0;
     }
 
+    arma::Col<size_t> childBegins(numChildren);
     size_t currentCol = begin;
     for (size_t i = 0; i < numChildren; ++i)
     {
-      size_t currentChildBegin = currentCol;
-      for (size_t j = currentChildBegin; j < begin + count; ++j)
+      childBegins[i] = currentCol;
+      for (size_t j = childBegins[i]; j < begin + count; ++j)
       {
         if (childAssignments[j - begin] == i)
         {
@@ -963,25 +973,39 @@ double DecisionTree<FitnessFunction,
         }
       }
 
-      // Now build the child recursively.
-      DecisionTree* child = new DecisionTree();
-      if (NoRecursion)
-      {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            currentCol - currentChildBegin, minimumGainSplit, maximumDepth - 1,
-            dimensionSelector);
-      }
-      else
+      children.push_back(new DecisionTree());
+    }
+
+    // Now build the children recursively, with large children in their own
+    // tasks.
+    arma::vec childGains(numChildren);
+    for (size_t i = 0; i < numChildren; ++i)
+    {
+      #pragma omp task default(shared) firstprivate(i) \
+          if(ParallelChildren && childCounts[i] >= MinimumParallelSize)
       {
-        // During recursion entropy of child node may change.
-        double childGain = child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            minimumLeafSize, minimumGainSplit, maximumDepth - 1,
-            dimensionSelector);
-        bestGain += double(childCounts[i]) / double(count) * (-childGain);
+        DimensionSelectionType childSelector(dimensionSelector);
+        if (NoRecursion)
+        {
+          children[i]->Train<UseWeights>(data, childBegins[i], childCounts[i],
+              labels, numClasses, weights, childCounts[i], minimumGainSplit,
+              maximumDepth - 1, childSelector);
+        }
+        else
+        {
+          // During recursion entropy of child node may change.
+          childGains[i] = children[i]->Train<UseWeights>(data, childBegins[i],
+              childCounts[i], labels, numClasses, weights, minimumLeafSize,
+              minimumGainSplit, maximumDepth - 1, childSelector);
+        }
       }
-      children.push_back(child);
+    }
+    #pragma omp taskwait
+
+    if (!NoRecursion)
+    {
+      for (size_t i = 0; i < numChildren; ++i)
+        bestGain += double(childCounts[i]) / double(count) * (-childGains[i]);
     }
   }
   else
@@ -1174,6 +1198,60 @@ size_t DecisionTree<FitnessFunction,
         classProbabilities, *this);
 }
 
+//! Append the tree to a FlatForest.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::Flatten(FlatForest& forest,
+                                        const double weight,
+                                        const bool hardVote) const
+{
+  FlattenNode(forest, forest.AddTree(NumClasses(), weight, hardVote));
+}
+
+//! Store a subtree in a node of a FlatForest.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::FlattenNode(FlatForest& forest,
+                                            const size_t node) const
+{
+  if (children.size() == 0)
+  {
+    forest.SetLeaf(node, dimensionTypeOrMajorityClass, classProbabilities);
+    return;
+  }
+
+  // The split type knows how its split information is laid out.
+  std::vector<size_t> childNodes(children.size());
+  if ((data::Datatype) dimensionTypeOrMajorityClass ==
+      data::Datatype::categorical)
+    CategoricalSplit::Flatten(forest, node, splitDimension, classProbabilities,
+        *this, childNodes);
+  else
+    NumericSplit::Flatten(forest, node, splitDimension, classProbabilities,
+        *this, childNodes);
+
+  for (size_t i = 0; i < children.size(); ++i)
+    children[i]->FlattenNode(forest, childNodes[i]);
+}
+
 // Get the number of classes in the tree.
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
@@ -1196,6 +1274,1492 @@ size_t DecisionTree<FitnessFunction,
     return children[0]->NumClasses();
 }
 
+//! Train on the given data with presorted dimensions.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainPresorted(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  // A decision stump has only one split, so there is nothing to save.
+  if (NoRecursion)
+  {
+    return Train(data, labels, numClasses, minimumLeafSize, minimumGainSplit,
+        maximumDepth, dimensionSelector);
+  }
+
+  // Sanity check on data.
+  if (data.n_cols != labels.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::TrainPresorted(): number of points (" << data.n_cols
+        << ") does not match number of labels (" << labels.n_elem << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Pass off work to the TrainPresorted() method.
+  arma::rowvec weights; // Fake weights, not used.
+  return TrainPresorted<false>(data, labels, numClasses, weights,
+      minimumLeafSize, minimumGainSplit, maximumDepth, dimensionSelector);
+}
+
+//! Train on the given weighted data with presorted dimensions.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainPresorted(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  // A decision stump has only one split, so there is nothing to save.
+  if (NoRecursion)
+  {
+    return Train(data, labels, numClasses, weights, minimumLeafSize,
+        minimumGainSplit, maximumDepth, dimensionSelector);
+  }
+
+  // Sanity check on data.
+  if (data.n_cols != labels.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::TrainPresorted(): number of points (" << data.n_cols
+        << ") does not match number of labels (" << labels.n_elem << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Pass off work to the TrainPresorted() method.
+  return TrainPresorted<true>(data, labels, numClasses, weights,
+      minimumLeafSize, minimumGainSplit, maximumDepth, dimensionSelector);
+}
+
+//! Build the tree level by level from presorted dimensions.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<bool UseWeights, typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainPresorted(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType& dimensionSelector)
+{
+  typedef typename MatType::elem_type DataElemType;
+
+  // Clear children if needed.
+  for (size_t i = 0; i < children.size(); ++i)
+    delete children[i];
+  children.clear();
+
+  const size_t numPoints = data.n_cols;
+  const size_t numDimensions = data.n_rows;
+
+  // Sort each dimension once.  Column d of sortedPoints holds the points in
+  // increasing order of dimension d.  The points of each node of the current
+  // level take the same range of rows in every column.
+  arma::umat sortedPoints(numPoints, numDimensions);
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t d = 0; d < (omp_size_t) numDimensions; ++d)
+    sortedPoints.col(d) = arma::stable_sort_index(data.row(d));
+
+  // The nodes of the current level, and the range of their points.
+  std::vector<DecisionTree*> nodes(1, this);
+  std::vector<size_t> begins(1, 0);
+  std::vector<size_t> counts(1, numPoints);
+
+  // The maximum depth that Train() would give to the nodes of this level.
+  size_t levelMaximumDepth = maximumDepth;
+
+  // The child that each point goes to, when its node is split.
+  arma::Col<size_t> directions(numPoints);
+
+  arma::Row<size_t> sortedLabels;
+  arma::rowvec sortedWeights;
+
+  // The entropy of the tree is the entropy of the leaves, weighted by their
+  // number of points.
+  double gain = 0.0;
+
+  while (!nodes.empty())
+  {
+    const size_t numNodes = nodes.size();
+
+    // Get the gain of each node without a split, and the dimensions to try
+    // splitting it on.
+    std::vector<double> bestGains(numNodes);
+    std::vector<size_t> bestDims(numNodes, numDimensions); // "No split."
+    std::vector<std::vector<size_t>> nodeDims(numNodes);
+    size_t maxNodeDims = 0;
+    for (size_t k = 0; k < numNodes; ++k)
+    {
+      sortedLabels.set_size(counts[k]);
+      if (UseWeights)
+        sortedWeights.set_size(counts[k]);
+      for (size_t j = 0; j < counts[k]; ++j)
+      {
+        const size_t point = sortedPoints(begins[k] + j, 0);
+        sortedLabels[j] = labels[point];
+        if (UseWeights)
+          sortedWeights[j] = weights[point];
+      }
+
+      bestGains[k] = FitnessFunction::template Evaluate<UseWeights>(
+          sortedLabels, numClasses, sortedWeights);
+
+      if (levelMaximumDepth != 1)
+      {
+        for (size_t i = dimensionSelector.Begin(); i != dimensionSelector.End();
+             i = dimensionSelector.Next())
+          nodeDims[k].push_back(i);
+      }
+      maxNodeDims = std::max(maxNodeDims, nodeDims[k].size());
+    }
+
+    // The r'th pass tries the r'th dimension of every node; with
+    // AllDimensionSelect, this is one pass over the order of dimension r.  Like
+    // in Train(), a node stops looking when no split can be better.  The nodes
+    // are independent, so each pass handles them in parallel.
+    std::vector<char> finished(numNodes, false);
+    for (size_t r = 0; r < maxNodeDims; ++r)
+    {
+      #pragma omp parallel for schedule(dynamic)
+      for (omp_size_t k = 0; k < (omp_size_t) numNodes; ++k)
+      {
+        if (finished[k] || r >= nodeDims[k].size())
+          continue;
+
+        const size_t d = nodeDims[k][r];
+        arma::Col<DataElemType> dimData(counts[k]);
+        arma::Row<size_t> dimLabels(counts[k]);
+        arma::rowvec dimWeights;
+        if (UseWeights)
+          dimWeights.set_size(counts[k]);
+        for (size_t j = 0; j < counts[k]; ++j)
+        {
+          const size_t point = sortedPoints(begins[k] + j, d);
+          dimData[j] = data(d, point);
+          dimLabels[j] = labels[point];
+          if (UseWeights)
+            dimWeights[j] = weights[point];
+        }
+
+        const double dimGain = NumericSplit::template
+            SplitIfBetterSorted<UseWeights>(bestGains[k], dimData, dimLabels,
+            numClasses, dimWeights, minimumLeafSize, minimumGainSplit,
+            nodes[k]->classProbabilities, *nodes[k]);
+
+        // If the splitter did not report that it improved, then move to the
+        // next dimension.
+        if (dimGain == DBL_MAX)
+          continue;
+
+        bestDims[k] = d;
+        bestGains[k] = dimGain;
+
+        // If the gain is the best possible, no need to keep looking.
+        if (dimGain >= 0.0)
+          finished[k] = true;
+      }
+    }
+
+    // Split the nodes that found a split, and make leaves of the others.
+    std::vector<DecisionTree*> nextNodes;
+    std::vector<size_t> nextBegins;
+    std::vector<size_t> nextCounts;
+    std::vector<size_t> firstChildren(numNodes);
+    for (size_t k = 0; k < numNodes; ++k)
+    {
+      DecisionTree& node = *nodes[k];
+
+      // We won't be using these members, so reset them.
+      node.CategoricalAuxiliarySplitInfo::operator=(
+          CategoricalAuxiliarySplitInfo());
+
+      if (bestDims[k] == numDimensions)
+      {
+        node.NumericAuxiliarySplitInfo::operator=(NumericAuxiliarySplitInfo());
+
+        // Calculate class probabilities because we are a leaf.
+        sortedLabels.set_size(counts[k]);
+        if (UseWeights)
+          sortedWeights.set_size(counts[k]);
+        for (size_t j = 0; j < counts[k]; ++j)
+        {
+          const size_t point = sortedPoints(begins[k] + j, 0);
+          sortedLabels[j] = labels[point];
+          if (UseWeights)
+            sortedWeights[j] = weights[point];
+        }
+        node.CalculateClassProbabilities<UseWeights>(sortedLabels, numClasses,
+            sortedWeights);
+
+        gain += double(counts[k]) / double(numPoints) * bestGains[k];
+        continue;
+      }
+
+      // We know that the split is numeric.
+      node.splitDimension = bestDims[k];
+      node.dimensionTypeOrMajorityClass = (size_t) data::Datatype::numeric;
+      const size_t numChildren = NumericSplit::NumChildren(
+          node.classProbabilities, node);
+
+      // Calculate all child assignments, and the counts of the children.
+      arma::Col<size_t> childCounts(numChildren, arma::fill::zeros);
+      for (size_t j = begins[k]; j < begins[k] + counts[k]; ++j)
+      {
+        const size_t point = sortedPoints(j, 0);
+        directions[point] = NumericSplit::CalculateDirection(
+            data(bestDims[k], point), node.classProbabilities, node);
+        ++childCounts[directions[point]];
+      }
+
+      firstChildren[k] = nextNodes.size();
+      size_t childBegin = begins[k];
+      for (size_t i = 0; i < numChildren; ++i)
+      {
+        DecisionTree* child = new DecisionTree();
+        node.children.push_back(child);
+        nextNodes.push_back(child);
+        nextBegins.push_back(childBegin);
+        nextCounts.push_back(childCounts[i]);
+        childBegin += childCounts[i];
+      }
+    }
+
+    // Stably partition the points of each split node between its children in
+    // every column, so that the points of each child take the range of the
+    // child and stay sorted.
+    if (!nextNodes.empty())
+    {
+      #pragma omp parallel for schedule(dynamic)
+      for (omp_size_t d = 0; d < (omp_size_t) numDimensions; ++d)
+      {
+        arma::uvec buffer(numPoints);
+        for (size_t k = 0; k < numNodes; ++k)
+        {
+          if (bestDims[k] == numDimensions)
+            continue;
+
+          std::vector<size_t> positions(nextBegins.begin() + firstChildren[k],
+              nextBegins.begin() + firstChildren[k] +
+              nodes[k]->children.size());
+          for (size_t j = begins[k]; j < begins[k] + counts[k]; ++j)
+          {
+            const size_t point = sortedPoints(j, d);
+            buffer[positions[directions[point]]++] = point;
+          }
+
+          sortedPoints.col(d).subvec(begins[k], begins[k] + counts[k] - 1) =
+              buffer.subvec(begins[k], begins[k] + counts[k] - 1);
+        }
+      }
+    }
+
+    nodes.swap(nextNodes);
+    begins.swap(nextBegins);
+    counts.swap(nextCounts);
+    --levelMaximumDepth;
+  }
+
+  return -gain;
+}
+
+//! Train on the given data, binning each dimension once.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainHistogram(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  // A decision stump has only one split, so there is nothing to save.
+  if (NoRecursion)
+  {
+    return Train(data, labels, numClasses, minimumLeafSize, minimumGainSplit,
+        maximumDepth, dimensionSelector);
+  }
+
+  // Sanity check on data.
+  if (data.n_cols != labels.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::TrainHistogram(): number of points (" << data.n_cols
+        << ") does not match number of labels (" << labels.n_elem << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Bin each dimension once; the root holds every point.
+  arma::Mat<unsigned char> bins;
+  arma::Mat<typename MatType::elem_type> binMin, binMax;
+  BinData(data, bins, binMin, binMax);
+  arma::uvec points(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    points[i] = i;
+
+  // Pass off work to the TrainHistogram() method.
+  arma::rowvec weights; // Fake weights, not used.
+  return TrainHistogram<false>(data, bins, binMin, binMax, points, labels,
+      numClasses, weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+      dimensionSelector);
+}
+
+//! Train on the given weighted data, binning each dimension once.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainHistogram(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  // A decision stump has only one split, so there is nothing to save.
+  if (NoRecursion)
+  {
+    return Train(data, labels, numClasses, weights, minimumLeafSize,
+        minimumGainSplit, maximumDepth, dimensionSelector);
+  }
+
+  // Sanity check on data.
+  if (data.n_cols != labels.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::TrainHistogram(): number of points (" << data.n_cols
+        << ") does not match number of labels (" << labels.n_elem << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Bin each dimension once; the root holds every point.
+  arma::Mat<unsigned char> bins;
+  arma::Mat<typename MatType::elem_type> binMin, binMax;
+  BinData(data, bins, binMin, binMax);
+  arma::uvec points(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    points[i] = i;
+
+  // Pass off work to the TrainHistogram() method.
+  return TrainHistogram<true>(data, bins, binMin, binMax, points, labels,
+      numClasses, weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+      dimensionSelector);
+}
+
+//! Train on the given points of the data, with the given bins.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainHistogram(
+    const MatType& data,
+    const arma::Mat<unsigned char>& bins,
+    const arma::Mat<typename MatType::elem_type>& binMin,
+    const arma::Mat<typename MatType::elem_type>& binMax,
+    arma::uvec points,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  // A decision stump has only one split, so there is nothing to save.
+  if (NoRecursion)
+  {
+    return TrainSubset(data, std::move(points), labels, numClasses,
+        minimumLeafSize, minimumGainSplit, maximumDepth, dimensionSelector);
+  }
+
+  CheckSubset(data, points, labels, NULL, "TrainHistogram");
+  CheckBins(data, bins, binMin, binMax);
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Pass off work to the TrainHistogram() method.
+  arma::rowvec weights; // Fake weights, not used.
+  return TrainHistogram<false>(data, bins, binMin, binMax, points, labels,
+      numClasses, weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+      dimensionSelector);
+}
+
+//! Train on the given weighted points of the data, with the given bins.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainHistogram(
+    const MatType& data,
+    const arma::Mat<unsigned char>& bins,
+    const arma::Mat<typename MatType::elem_type>& binMin,
+    const arma::Mat<typename MatType::elem_type>& binMax,
+    arma::uvec points,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  // A decision stump has only one split, so there is nothing to save.
+  if (NoRecursion)
+  {
+    return TrainSubset(data, std::move(points), labels, numClasses, weights,
+        minimumLeafSize, minimumGainSplit, maximumDepth, dimensionSelector);
+  }
+
+  CheckSubset(data, points, labels, &weights, "TrainHistogram");
+  CheckBins(data, bins, binMin, binMax);
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Pass off work to the TrainHistogram() method.
+  return TrainHistogram<true>(data, bins, binMin, binMax, points, labels,
+      numClasses, weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+      dimensionSelector);
+}
+
+//! Bin each dimension of the data.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::BinData(
+    const MatType& data,
+    arma::Mat<unsigned char>& bins,
+    arma::Mat<typename MatType::elem_type>& binMin,
+    arma::Mat<typename MatType::elem_type>& binMax)
+{
+  typedef typename MatType::elem_type DataElemType;
+
+  const size_t maxBins = NumericSplit::MaxBins;
+  const size_t numDimensions = data.n_rows;
+
+  bins.set_size(numDimensions, data.n_cols);
+  binMin.zeros(maxBins, numDimensions);
+  binMax.zeros(maxBins, numDimensions);
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t d = 0; d < (omp_size_t) numDimensions; ++d)
+  {
+    arma::Row<unsigned char> dimBins;
+    arma::Col<DataElemType> dimMin, dimMax;
+    NumericSplit::ComputeBins(arma::Row<DataElemType>(data.row(d)), dimBins,
+        dimMin, dimMax);
+    bins.row(d) = dimBins;
+    if (dimMin.n_elem > 0)
+    {
+      binMin.col(d).subvec(0, dimMin.n_elem - 1) = dimMin;
+      binMax.col(d).subvec(0, dimMax.n_elem - 1) = dimMax;
+    }
+  }
+}
+
+//! Check the bins given to TrainHistogram().
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::CheckBins(
+    const MatType& data,
+    const arma::Mat<unsigned char>& bins,
+    const arma::Mat<typename MatType::elem_type>& binMin,
+    const arma::Mat<typename MatType::elem_type>& binMax)
+{
+  if (bins.n_rows != data.n_rows || bins.n_cols != data.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::TrainHistogram(): bins are " << bins.n_rows << "x"
+        << bins.n_cols << ", but the data is " << data.n_rows << "x"
+        << data.n_cols << "!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (binMin.n_rows != NumericSplit::MaxBins ||
+      binMin.n_cols != data.n_rows ||
+      binMax.n_rows != binMin.n_rows ||
+      binMax.n_cols != binMin.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::TrainHistogram(): bin limits must be "
+        << NumericSplit::MaxBins << "x" << data.n_rows << "; use BinData() to "
+        << "compute them!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+//! Train the tree from the histogram of the root.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<bool UseWeights, typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainHistogram(
+    const MatType& data,
+    const arma::Mat<unsigned char>& bins,
+    const arma::Mat<typename MatType::elem_type>& binMin,
+    const arma::Mat<typename MatType::elem_type>& binMax,
+    arma::uvec& points,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType& dimensionSelector)
+{
+  typedef typename std::conditional<UseWeights, double, size_t>::type
+      CountType;
+
+  #ifdef HAS_OPENMP
+  // If we are not in a parallel region yet, start one for a large tree, so
+  // that the threads can share the subtrees and the dimensions of the nodes.
+  if (!omp_in_parallel() && points.n_elem >= MinimumParallelSize &&
+      omp_get_max_threads() > 1)
+  {
+    double gain = 0.0;
+    #pragma omp parallel
+    {
+      #pragma omp single
+      {
+        gain = TrainHistogram<UseWeights>(data, bins, binMin, binMax, points,
+            labels, numClasses, weights, minimumLeafSize, minimumGainSplit,
+            maximumDepth, dimensionSelector);
+      }
+    }
+    return gain;
+  }
+  #endif
+
+  // The histogram of the root holds all of the points.
+  arma::Cube<CountType> histogram(numClasses, NumericSplit::MaxBins,
+      data.n_rows, arma::fill::zeros);
+  arma::Mat<size_t> binSizes(NumericSplit::MaxBins, data.n_rows,
+      arma::fill::zeros);
+  AddToHistogram<UseWeights>(bins, points, 0, points.n_elem, labels, weights,
+      histogram, binSizes);
+
+  return TrainHistogram<UseWeights>(data, bins, binMin, binMax, points, 0,
+      points.n_elem, labels, numClasses, weights, histogram, binSizes,
+      minimumLeafSize, minimumGainSplit, maximumDepth, dimensionSelector);
+}
+
+//! Train this node and its children from the histogram of the node.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<bool UseWeights, typename MatType, typename CountType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainHistogram(
+    const MatType& data,
+    const arma::Mat<unsigned char>& bins,
+    const arma::Mat<typename MatType::elem_type>& binMin,
+    const arma::Mat<typename MatType::elem_type>& binMax,
+    arma::uvec& points,
+    const size_t begin,
+    const size_t count,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    arma::Cube<CountType>& histogram,
+    arma::Mat<size_t>& binSizes,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType& dimensionSelector)
+{
+  // Clear children if needed.
+  for (size_t i = 0; i < children.size(); ++i)
+    delete children[i];
+  children.clear();
+
+  // Gather the labels (and weights) of the points of the node.
+  arma::Row<size_t> nodeLabels(count);
+  arma::rowvec nodeWeights;
+  if (UseWeights)
+    nodeWeights.set_size(count);
+  for (size_t j = 0; j < count; ++j)
+  {
+    nodeLabels[j] = labels[points[begin + j]];
+    if (UseWeights)
+      nodeWeights[j] = weights[points[begin + j]];
+  }
+
+  double bestGain = FitnessFunction::template Evaluate<UseWeights>(nodeLabels,
+      numClasses, nodeWeights);
+  size_t bestDim = data.n_rows; // This means "no split".
+
+  if (maximumDepth != 1)
+  {
+    // Get the gain of the best split of dimension i from its histogram, if it
+    // is better than gain.
+    auto splitIfBetter = [&](const size_t i,
+                             const double gain,
+                             arma::vec& probabilities,
+                             NumericAuxiliarySplitInfo& numericAux,
+                             CategoricalAuxiliarySplitInfo& /* categorical */)
+    {
+      return NumericSplit::template SplitIfBetterBinned<UseWeights>(gain,
+          histogram.slice(i), binSizes.unsafe_col(i), binMin.unsafe_col(i),
+          binMax.unsafe_col(i), minimumLeafSize, minimumGainSplit,
+          probabilities, numericAux);
+    };
+
+    FindBestDimension(splitIfBetter, count, NULL, dimensionSelector, bestDim,
+        bestGain);
+  }
+
+  // We won't be using these members, so reset them.
+  CategoricalAuxiliarySplitInfo::operator=(CategoricalAuxiliarySplitInfo());
+
+  if (bestDim == data.n_rows)
+  {
+    NumericAuxiliarySplitInfo::operator=(NumericAuxiliarySplitInfo());
+
+    // Calculate class probabilities because we are a leaf.
+    CalculateClassProbabilities<UseWeights>(nodeLabels, numClasses,
+        nodeWeights);
+    return -bestGain;
+  }
+
+  // We know that the split is numeric.
+  splitDimension = bestDim;
+  dimensionTypeOrMajorityClass = (size_t) data::Datatype::numeric;
+  const size_t numChildren = NumericSplit::NumChildren(classProbabilities,
+      *this);
+
+  // Calculate all child assignments, and the counts of the children.
+  arma::Col<size_t> directions(count);
+  arma::Col<size_t> childCounts(numChildren, arma::fill::zeros);
+  for (size_t j = 0; j < count; ++j)
+  {
+    directions[j] = NumericSplit::CalculateDirection(
+        data(bestDim, points[begin + j]), classProbabilities, *this);
+    ++childCounts[directions[j]];
+  }
+
+  // Stably partition the points of the node between its children.
+  arma::Col<size_t> childBegins(numChildren);
+  childBegins[0] = begin;
+  for (size_t i = 1; i < numChildren; ++i)
+    childBegins[i] = childBegins[i - 1] + childCounts[i - 1];
+  arma::uvec nodePoints = points.subvec(begin, begin + count - 1);
+  arma::Col<size_t> positions(childBegins);
+  for (size_t j = 0; j < count; ++j)
+    points[positions[directions[j]]++] = nodePoints[j];
+
+  // Bin the points of every child but the largest one, and get the histogram
+  // of the largest one by subtracting the others from the histogram of the
+  // node.
+  const size_t largest = childCounts.index_max();
+  std::vector<arma::Cube<CountType>> childHistograms(numChildren);
+  std::vector<arma::Mat<size_t>> childBinSizes(numChildren);
+  for (size_t i = 0; i < numChildren; ++i)
+  {
+    if (i == largest)
+      continue;
+
+    childHistograms[i].zeros(arma::size(histogram));
+    childBinSizes[i].zeros(arma::size(binSizes));
+    AddToHistogram<UseWeights>(bins, points, childBegins[i], childCounts[i],
+        labels, weights, childHistograms[i], childBinSizes[i]);
+    histogram -= childHistograms[i];
+    binSizes -= childBinSizes[i];
+  }
+  childHistograms[largest] = std::move(histogram);
+  childBinSizes[largest] = std::move(binSizes);
+
+  // Now build the children recursively, with large children in their own
+  // tasks, like in Train().  The children own disjoint ranges of the points.
+  for (size_t i = 0; i < numChildren; ++i)
+    children.push_back(new DecisionTree());
+
+  arma::vec childGains(numChildren);
+  for (size_t i = 0; i < numChildren; ++i)
+  {
+    #pragma omp task default(shared) firstprivate(i) \
+        if(ParallelChildren && childCounts[i] >= MinimumParallelSize)
+    {
+      DimensionSelectionType childSelector(dimensionSelector);
+      childGains[i] = children[i]->TrainHistogram<UseWeights>(data, bins,
+          binMin, binMax, points, childBegins[i], childCounts[i], labels,
+          numClasses, weights, childHistograms[i], childBinSizes[i],
+          minimumLeafSize, minimumGainSplit, maximumDepth - 1, childSelector);
+
+      // The histogram of the child is not needed anymore.
+      childHistograms[i].reset();
+      childBinSizes[i].reset();
+    }
+  }
+  #pragma omp taskwait
+
+  bestGain = 0.0;
+  for (size_t i = 0; i < numChildren; ++i)
+    bestGain += double(childCounts[i]) / double(count) * (-childGains[i]);
+
+  return -bestGain;
+}
+
+//! Add points to a histogram.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<bool UseWeights, typename CountType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::AddToHistogram(
+    const arma::Mat<unsigned char>& bins,
+    const arma::uvec& points,
+    const size_t begin,
+    const size_t count,
+    const arma::Row<size_t>& labels,
+    const arma::rowvec& weights,
+    arma::Cube<CountType>& histogram,
+    arma::Mat<size_t>& binSizes)
+{
+  // In a parallel region, a large node splits the dimensions into one block
+  // per thread, and each block is filled by its own task; the blocks are
+  // disjoint slices of the histogram.
+  size_t numBlocks = 1;
+  #ifdef HAS_OPENMP
+  if (omp_in_parallel() && count >= MinimumParallelSize)
+    numBlocks = std::min((size_t) omp_get_num_threads(), (size_t) bins.n_rows);
+  #endif
+
+  for (size_t k = 0; k < numBlocks; ++k)
+  {
+    #pragma omp task default(shared) firstprivate(k) if(numBlocks > 1)
+    {
+      const size_t dimBegin = k * bins.n_rows / numBlocks;
+      const size_t dimEnd = (k + 1) * bins.n_rows / numBlocks;
+      for (size_t j = begin; j < begin + count; ++j)
+      {
+        const size_t point = points[j];
+        const size_t label = labels[point];
+        const CountType weight = UseWeights ? (CountType) weights[point] : 1;
+        const unsigned char* pointBins = bins.colptr(point);
+        for (size_t d = dimBegin; d < dimEnd; ++d)
+        {
+          histogram(label, pointBins[d], d) += weight;
+          ++binSizes(pointBins[d], d);
+        }
+      }
+    }
+  }
+  #pragma omp taskwait
+}
+
+//! Train on the given points of the data.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainSubset(
+    const MatType& data,
+    arma::uvec points,
+    const data::DatasetInfo& datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  CheckSubset(data, points, labels, NULL, "TrainSubset");
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Pass off work to the TrainSubset() method.
+  arma::rowvec weights; // Fake weights, not used.
+  return TrainSubset<false>(data, points, 0, points.n_elem, &datasetInfo,
+      labels, numClasses, weights, minimumLeafSize, minimumGainSplit,
+      maximumDepth, dimensionSelector);
+}
+
+//! Train on the given points of the data, assuming all dimensions are
+//! numeric.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainSubset(
+    const MatType& data,
+    arma::uvec points,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  CheckSubset(data, points, labels, NULL, "TrainSubset");
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Pass off work to the TrainSubset() method.
+  arma::rowvec weights; // Fake weights, not used.
+  return TrainSubset<false>(data, points, 0, points.n_elem, NULL, labels,
+      numClasses, weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+      dimensionSelector);
+}
+
+//! Train on the given weighted points of the data.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainSubset(
+    const MatType& data,
+    arma::uvec points,
+    const data::DatasetInfo& datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  CheckSubset(data, points, labels, &weights, "TrainSubset");
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Pass off work to the TrainSubset() method.
+  return TrainSubset<true>(data, points, 0, points.n_elem, &datasetInfo,
+      labels, numClasses, weights, minimumLeafSize, minimumGainSplit,
+      maximumDepth, dimensionSelector);
+}
+
+//! Train on the given weighted points of the data, assuming all
+//! dimensions are numeric.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainSubset(
+    const MatType& data,
+    arma::uvec points,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  CheckSubset(data, points, labels, &weights, "TrainSubset");
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Pass off work to the TrainSubset() method.
+  return TrainSubset<true>(data, points, 0, points.n_elem, NULL, labels,
+      numClasses, weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+      dimensionSelector);
+}
+
+//! Check the arguments of TrainSubset() and TrainHistogram().
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename MatType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::CheckSubset(
+    const MatType& data,
+    const arma::uvec& points,
+    const arma::Row<size_t>& labels,
+    const arma::rowvec* weights,
+    const std::string& caller)
+{
+  if (data.n_cols != labels.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::" << caller << "(): number of points ("
+        << data.n_cols << ") does not match number of labels ("
+        << labels.n_elem << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (weights && weights->n_elem != labels.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::" << caller << "(): number of weights ("
+        << weights->n_elem << ") does not match number of labels ("
+        << labels.n_elem << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (points.n_elem == 0)
+  {
+    throw std::invalid_argument("DecisionTree::" + caller + "(): no points to "
+        "train on!");
+  }
+
+  if (points.max() >= data.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::" << caller << "(): point index " << points.max()
+        << " is out of range for a dataset of " << data.n_cols << " points!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+//! Train on the given range of the points vector.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<bool UseWeights, typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::TrainSubset(
+    const MatType& data,
+    arma::uvec& points,
+    const size_t begin,
+    const size_t count,
+    const data::DatasetInfo* datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType& dimensionSelector)
+{
+  #ifdef HAS_OPENMP
+  // If we are not in a parallel region yet, start one for a large tree, so
+  // that the threads can share the subtrees and the dimensions of the nodes.
+  if (!omp_in_parallel() && count >= MinimumParallelSize &&
+      omp_get_max_threads() > 1)
+  {
+    double gain = 0.0;
+    #pragma omp parallel
+    {
+      #pragma omp single
+      {
+        gain = TrainSubset<UseWeights>(data, points, begin, count, datasetInfo,
+            labels, numClasses, weights, minimumLeafSize, minimumGainSplit,
+            maximumDepth, dimensionSelector);
+      }
+    }
+    return gain;
+  }
+  #endif
+
+  // Clear children if needed.
+  for (size_t i = 0; i < children.size(); ++i)
+    delete children[i];
+  children.clear();
+
+  // Without type information, all splits are numeric.
+  if (!datasetInfo)
+    CategoricalAuxiliarySplitInfo::operator=(CategoricalAuxiliarySplitInfo());
+
+  // Gather the labels and weights of the points of this node.  The values of
+  // the points are gathered one dimension at a time, when the dimension is
+  // evaluated.
+  arma::uvec nodePoints = points.subvec(begin, begin + count - 1);
+  arma::Row<size_t> nodeLabels = labels.cols(nodePoints);
+  arma::rowvec nodeWeights;
+  if (UseWeights)
+    nodeWeights = weights.cols(nodePoints);
+
+  double bestGain = FitnessFunction::template Evaluate<UseWeights>(nodeLabels,
+      numClasses, nodeWeights);
+  size_t bestDim = data.n_rows; // This means "no split".
+
+  if (maximumDepth != 1)
+  {
+    auto dataRow = [&](const size_t i) -> arma::Row<typename MatType::elem_type>
+    {
+      arma::Row<typename MatType::elem_type> row(count);
+      for (size_t j = 0; j < count; ++j)
+        row[j] = data(i, nodePoints[j]);
+      return row;
+    };
+    FindSplit<UseWeights>(dataRow, datasetInfo, nodeLabels, numClasses,
+        nodeWeights, minimumLeafSize, minimumGainSplit, dimensionSelector,
+        bestDim, bestGain);
+  }
+
+  // Did we split or not?  If so, then split the points and create the
+  // children.
+  if (bestDim != data.n_rows)
+  {
+    const bool categorical = datasetInfo &&
+        datasetInfo->Type(bestDim) == data::Datatype::categorical;
+    dimensionTypeOrMajorityClass = (size_t) (categorical ?
+        data::Datatype::categorical : data::Datatype::numeric);
+    splitDimension = bestDim;
+
+    // Get the number of children we will have.
+    const size_t numChildren = categorical ?
+        CategoricalSplit::NumChildren(classProbabilities, *this) :
+        NumericSplit::NumChildren(classProbabilities, *this);
+
+    // Calculate all child assignments.
+    arma::Row<size_t> childAssignments(count);
+    for (size_t j = 0; j < count; ++j)
+    {
+      childAssignments[j] = categorical ?
+          CategoricalSplit::CalculateDirection(data(bestDim, nodePoints[j]),
+              classProbabilities, *this) :
+          NumericSplit::CalculateDirection(data(bestDim, nodePoints[j]),
+              classProbabilities, *this);
+    }
+
+    // We don't need the gathered values anymore.
+    nodePoints.reset();
+    nodeLabels.reset();
+    nodeWeights.reset();
+
+    // Figure out counts of children.
+    arma::Row<size_t> childCounts(numChildren, arma::fill::zeros);
+    for (size_t j = 0; j < count; ++j)
+      childCounts[childAssignments[j]]++;
+
+    // Initialize bestGain if recursive split is allowed.
+    if (!NoRecursion)
+    {
+      bestGain = 0.0;
+    }
+
+    // Split the points into children, in the same order as Train() splits the
+    // columns of the data.
+    arma::Col<size_t> childBegins(numChildren);
+    size_t currentCol = begin;
+    for (size_t i = 0; i < numChildren; ++i)
+    {
+      childBegins[i] = currentCol;
+      for (size_t j = childBegins[i]; j < begin + count; ++j)
+      {
+        if (childAssignments[j - begin] == i)
+        {
+          childAssignments.swap_cols(currentCol - begin, j - begin);
+          points.swap_rows(currentCol, j);
+          ++currentCol;
+        }
+      }
+
+      children.push_back(new DecisionTree());
+    }
+
+    // Now build the children recursively, with large children in their own
+    // tasks.
+    arma::vec childGains(numChildren);
+    for (size_t i = 0; i < numChildren; ++i)
+    {
+      #pragma omp task default(shared) firstprivate(i) \
+          if(ParallelChildren && childCounts[i] >= MinimumParallelSize)
+      {
+        DimensionSelectionType childSelector(dimensionSelector);
+        if (NoRecursion)
+        {
+          children[i]->TrainSubset<UseWeights>(data, points, childBegins[i],
+              childCounts[i], datasetInfo, labels, numClasses, weights,
+              childCounts[i], minimumGainSplit, maximumDepth - 1,
+              childSelector);
+        }
+        else
+        {
+          // During recursion entropy of child node may change.
+          childGains[i] = children[i]->TrainSubset<UseWeights>(data, points,
+              childBegins[i], childCounts[i], datasetInfo, labels, numClasses,
+              weights, minimumLeafSize, minimumGainSplit, maximumDepth - 1,
+              childSelector);
+        }
+      }
+    }
+    #pragma omp taskwait
+
+    if (!NoRecursion)
+    {
+      for (size_t i = 0; i < numChildren; ++i)
+        bestGain += double(childCounts[i]) / double(count) * (-childGains[i]);
+    }
+  }
+  else
+  {
+    // Clear auxiliary info objects.
+    NumericAuxiliarySplitInfo::operator=(NumericAuxiliarySplitInfo());
+    CategoricalAuxiliarySplitInfo::operator=(CategoricalAuxiliarySplitInfo());
+
+    // Calculate class probabilities because we are a leaf.
+    CalculateClassProbabilities<UseWeights>(nodeLabels, numClasses,
+        nodeWeights);
+  }
+
+  return -bestGain;
+}
+
+//! Find the best split of the given points.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<bool UseWeights,
+         typename RowFunctionType,
+         typename LabelsType,
+         typename WeightsType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::FindSplit(
+    const RowFunctionType& dataRow,
+    const data::DatasetInfo* datasetInfo,
+    const LabelsType& labels,
+    const size_t numClasses,
+    const WeightsType& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    DimensionSelectionType& dimensionSelector,
+    size_t& bestDim,
+    double& bestGain)
+{
+  // Get the gain of the best split of dimension i, if it is better than gain.
+  auto splitIfBetter = [&](const size_t i,
+                           const double gain,
+                           arma::vec& probabilities,
+                           NumericAuxiliarySplitInfo& numericAux,
+                           CategoricalAuxiliarySplitInfo& categoricalAux)
+  {
+    if (datasetInfo &&
+        datasetInfo->Type(i) == data::Datatype::categorical)
+    {
+      return CategoricalSplit::template SplitIfBetter<UseWeights>(gain,
+          dataRow(i),
+          datasetInfo->NumMappings(i),
+          labels,
+          numClasses,
+          weights,
+          minimumLeafSize,
+          minimumGainSplit,
+          probabilities,
+          categoricalAux);
+    }
+
+    return NumericSplit::template SplitIfBetter<UseWeights>(gain,
+        dataRow(i),
+        labels,
+        numClasses,
+        weights,
+        minimumLeafSize,
+        minimumGainSplit,
+        probabilities,
+        numericAux);
+  };
+
+  FindBestDimension(splitIfBetter, labels.n_elem, datasetInfo,
+      dimensionSelector, bestDim, bestGain);
+}
+
+//! Find the dimension with the best split.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename SplitFunctionType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::FindBestDimension(
+    const SplitFunctionType& splitIfBetter,
+    const size_t count,
+    const data::DatasetInfo* datasetInfo,
+    DimensionSelectionType& dimensionSelector,
+    size_t& bestDim,
+    double& bestGain)
+{
+  #ifdef HAS_OPENMP
+  const bool parallel = omp_in_parallel() && omp_get_num_threads() > 1 &&
+      count >= MinimumParallelSize;
+  #else
+  (void) count;
+  const bool parallel = false;
+  #endif
+
+  if (!parallel)
+  {
+    // Look through the list of dimensions and obtain the gain of the best
+    // split.  The split information is stored in classProbabilities and the
+    // auxiliary split information of this node.
+    const size_t end = dimensionSelector.End();
+    for (size_t i = dimensionSelector.Begin(); i != end;
+         i = dimensionSelector.Next())
+    {
+      const double dimGain = splitIfBetter(i, bestGain, classProbabilities,
+          *this, *this);
+
+      // If the splitter reported that it did not split, move to the next
+      // dimension.
+      if (dimGain == DBL_MAX)
+        continue;
+
+      // Was there an improvement?  If so mark that it's the new best dimension.
+      bestDim = i;
+      bestGain = dimGain;
+
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain >= 0.0)
+        break;
+    }
+
+    return;
+  }
+
+  // Evaluate every dimension in its own task, against the gain of the node.
+  // The dimensions are drawn here, before the tasks start, so a random
+  // dimension selector draws the same numbers as in the serial loop.
+  std::vector<size_t> dims;
+  const size_t end = dimensionSelector.End();
+  for (size_t i = dimensionSelector.Begin(); i != end;
+       i = dimensionSelector.Next())
+    dims.push_back(i);
+
+  const double nodeGain = bestGain;
+  std::vector<double> dimGains(dims.size());
+  std::vector<arma::vec> dimProbabilities(dims.size());
+  std::vector<NumericAuxiliarySplitInfo> numericAux(dims.size());
+  std::vector<CategoricalAuxiliarySplitInfo> categoricalAux(dims.size());
+  for (size_t j = 0; j < dims.size(); ++j)
+  {
+    #pragma omp task default(shared) firstprivate(j)
+    dimGains[j] = splitIfBetter(dims[j], nodeGain, dimProbabilities[j],
+        numericAux[j], categoricalAux[j]);
+  }
+  #pragma omp taskwait
+
+  // Now take the results in order, like the serial loop.  A split must improve
+  // on the best gain, so a dimension that did not improve on the gain of the
+  // node can't improve on a later best gain either.  The rare dimension that
+  // beats the current best gain is evaluated again against it, since the split
+  // type may ask for more than a plain improvement (e.g. minimumGainSplit).
+  bool improved = false;
+  for (size_t j = 0; j < dims.size(); ++j)
+  {
+    double dimGain = dimGains[j];
+    if (dimGain == DBL_MAX)
+      continue;
+
+    if (improved)
+    {
+      if (dimGain <= bestGain)
+        continue;
+
+      dimGain = splitIfBetter(dims[j], bestGain, dimProbabilities[j],
+          numericAux[j], categoricalAux[j]);
+      if (dimGain == DBL_MAX)
+        continue;
+    }
+
+    improved = true;
+    bestDim = dims[j];
+    bestGain = dimGain;
+    classProbabilities = dimProbabilities[j];
+    if (datasetInfo &&
+        datasetInfo->Type(dims[j]) == data::Datatype::categorical)
+      CategoricalAuxiliarySplitInfo::operator=(categoricalAux[j]);
+    else
+      NumericAuxiliarySplitInfo::operator=(numericAux[j]);
+
+    // If the gain is the best possible, no need to keep looking.
+    if (bestGain >= 0.0)
+      break;
+  }
+}
+
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
          template<typename> class CategoricalSplitType,
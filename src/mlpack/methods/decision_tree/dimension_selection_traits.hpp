@@ -0,0 +1,41 @@
+/**
+ * @file dimension_selection_traits.hpp
+ *
+ * This provides the DimensionSelectionTraits class, a template class to get
+ * information about dimension selection policies.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_DIMENSION_SELECTION_TRAITS_HPP
+#define MLPACK_METHODS_DECISION_TREE_DIMENSION_SELECTION_TRAITS_HPP
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * This is a template class that can provide information about dimension
+ * selection policies.  By default, this class will provide the weakest possible
+ * assumptions on the policy, and each policy should override values as
+ * necessary.
+ */
+template<typename DimensionSelectionType>
+class DimensionSelectionTraits
+{
+ public:
+  /**
+   * If true, then Begin() and Next() do not draw random numbers, so nodes can
+   * select their dimensions in any order (and from any thread) and still give
+   * the same tree.  A policy that draws from the global random number generator
+   * must select the dimensions of the nodes in the same order as a single
+   * thread would.
+   */
+  static const bool IsDeterministic = false;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
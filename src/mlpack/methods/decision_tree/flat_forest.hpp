@@ -0,0 +1,277 @@
+/**
+ * @file flat_forest.hpp
+ *
+ * A compiled representation of a trained tree ensemble, stored in contiguous
+ * node arrays, that classifies blocks of points quickly.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_FLAT_FOREST_HPP
+#define MLPACK_METHODS_DECISION_TREE_FLAT_FOREST_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A FlatForest is a read-only copy of a trained tree ensemble (or of a single
+ * tree) that is laid out for fast classification.  Instead of following
+ * pointers from node to node, the nodes of all trees are stored in a few
+ * contiguous arrays (split dimension, threshold, offset of the first child),
+ * the children of a node are stored next to each other, and the weighted class
+ * probabilities of the leaves are stored in one more array.  Points are
+ * classified in blocks: each tree takes every point of the block one level
+ * down at a time, so the nodes of the tree stay in the cache and the loads for
+ * different points do not depend on each other.  Blocks are classified in
+ * parallel when OpenMP is available.
+ *
+ * The output for a point is the weighted sum over the trees of the class
+ * probabilities of the leaf it falls in, divided by the sum of the weights;
+ * the prediction is the class with the highest value.  A tree can also vote
+ * for the majority class of the leaf only (a "hard" vote), as AdaBoost does.
+ *
+ * A FlatForest is usually built directly from a model:
+ *
+ * @code
+ * RandomForest<> rf(data, labels, numClasses);
+ * FlatForest flat(rf); // Or flat(decisionTree), flat(adaboost), ...
+ * arma::Row<size_t> predictions;
+ * flat.Classify(testData, predictions);
+ * @endcode
+ *
+ * This works for every class that has a method
+ *
+ * @code
+ * void Flatten(FlatForest& forest) const;
+ * @endcode
+ *
+ * which appends its trees to the given forest; DecisionTree, RandomForest,
+ * AdaBoost<ID3DecisionStump> and HoeffdingTree all have one.  The predictions
+ * are the same as the ones of the model, and so are the probabilities, except
+ * that a HoeffdingTree gives hard votes.
+ *
+ * Models append their trees with AddTree(), and then turn each node into a
+ * split with AddNumericSplit() or AddCategoricalSplit() (which create the
+ * children) or into a leaf with SetLeaf().  Numeric splits send points with
+ * value <= threshold to the first child and other points to the second child;
+ * categorical splits send points with value c to child c.  Categorical values
+ * that are negative or NaN go to the first child, and values past the last
+ * category go to the last child.  The split types of the trees do this
+ * translation in their Flatten() functions.
+ */
+class FlatForest
+{
+ public:
+  //! Create an empty forest.
+  FlatForest();
+
+  /**
+   * Create a forest that holds the trees of the given model, by calling
+   * model.Flatten(*this).
+   *
+   * @param model Trained model to flatten.
+   */
+  template<typename ModelType>
+  explicit FlatForest(const ModelType& model);
+
+  /**
+   * Add a new tree to the forest, and return the index of its root node.  The
+   * root must then be turned into a split or a leaf, and so must the children
+   * of every split, before the next tree is added.
+   *
+   * @param numClasses Number of classes of the tree (must be the same for all
+   *     trees).
+   * @param weight Weight of the tree.
+   * @param hardVote If true, each leaf votes for its majority class only,
+   *     instead of adding its class probabilities.
+   */
+  size_t AddTree(const size_t numClasses,
+                 const double weight = 1.0,
+                 const bool hardVote = false);
+
+  /**
+   * Turn the given node into a numeric split, and return the index of its
+   * first child; the second child is the next node.  Points whose value in the
+   * given dimension is at most the threshold go to the first child.
+   *
+   * @param node Node to split.
+   * @param dimension Dimension to split on.
+   * @param threshold Largest value that goes to the first child.
+   */
+  size_t AddNumericSplit(const size_t node,
+                         const size_t dimension,
+                         const double threshold);
+
+  /**
+   * Turn the given node into a categorical split with one child per category,
+   * and return the index of the first child; the other children follow it.
+   * Points whose value in the given dimension is c go to child c; negative or
+   * NaN values go to the first child, and values of at least numCategories go
+   * to the last child.
+   *
+   * @param node Node to split.
+   * @param dimension Dimension to split on.
+   * @param numCategories Number of categories (and children).
+   */
+  size_t AddCategoricalSplit(const size_t node,
+                             const size_t dimension,
+                             const size_t numCategories);
+
+  /**
+   * Turn the given node into a leaf.
+   *
+   * @param node Node to turn into a leaf.
+   * @param prediction Majority class of the leaf.
+   * @param probabilities Class probabilities of the leaf (ignored if the tree
+   *     gives hard votes).
+   */
+  void SetLeaf(const size_t node,
+               const size_t prediction,
+               const arma::vec& probabilities);
+
+  /**
+   * Classify the given point.
+   *
+   * @param point Point to classify.
+   */
+  template<typename VecType>
+  size_t Classify(const VecType& point) const;
+
+  /**
+   * Classify the given point and also return the class probabilities.
+   *
+   * @param point Point to classify.
+   * @param prediction This will be set to the predicted class of the point.
+   * @param probabilities This will be filled with the class probabilities.
+   */
+  template<typename VecType>
+  void Classify(const VecType& point,
+                size_t& prediction,
+                arma::vec& probabilities) const;
+
+  /**
+   * Classify the given points.
+   *
+   * @param data Points to classify.
+   * @param predictions This will be filled with the predicted classes.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data, arma::Row<size_t>& predictions) const;
+
+  /**
+   * Classify the given points and also return the class probabilities of each
+   * point.
+   *
+   * @param data Points to classify.
+   * @param predictions This will be filled with the predicted classes.
+   * @param probabilities This will be filled with the class probabilities
+   *     (one column per point).
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
+  //! Get the number of trees.
+  size_t NumTrees() const { return roots.size(); }
+  //! Get the total number of nodes of all trees.
+  size_t NumNodes() const { return dimensions.size(); }
+  //! Get the number of classes.
+  size_t NumClasses() const { return numClasses; }
+
+  //! Serialize the forest.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! The number of points that are classified together.
+  static const size_t BlockSize = 64;
+  //! The value of leafIndices for nodes that are not leaves.
+  static const size_t NotALeaf = size_t(-1);
+
+  //! Allocate the given number of new (unset) children of the given node, and
+  //! return the index of the first one.
+  size_t AddChildren(const size_t node, const size_t count);
+
+  //! Throw an exception if the given node cannot be set.
+  void CheckUnset(const size_t node, const char* caller) const;
+
+  //! Throw an exception if the forest cannot be used for classification.
+  void CheckComplete(const char* caller) const;
+
+  //! Return the child of the given split node that the given value goes to.
+  //! Categorical values outside of [0, largest category] (including NaN) are
+  //! clamped before the conversion, which would be undefined for them.
+  size_t Next(const size_t node, const double value) const
+  {
+    if (categorical[node])
+    {
+      if (!(value > 0.0))
+        return children[node];
+      else if (value >= thresholds[node])
+        return children[node] + (size_t) thresholds[node];
+      else
+        return children[node] + (size_t) value;
+    }
+    else
+    {
+      return children[node] + (size_t) !(value <= thresholds[node]);
+    }
+  }
+
+  /**
+   * Compute the (unnormalized) sums of the leaf values for the points
+   * [begin, begin + count) of the given data, where count is at most
+   * BlockSize.  The sums are written to the count columns starting at sums.
+   */
+  template<typename MatType>
+  void ClassifyBlock(const MatType& data,
+                     const size_t begin,
+                     const size_t count,
+                     double* sums) const;
+
+  //! The number of classes.
+  size_t numClasses;
+  //! The sum of the weights of the trees.
+  double totalWeight;
+  //! The weight of the last tree.
+  double lastWeight;
+  //! Whether the last tree gives hard votes.
+  bool lastHardVote;
+  //! The number of nodes that are neither splits nor leaves yet.
+  size_t unsetNodes;
+
+  //! The root node of each tree.
+  std::vector<size_t> roots;
+  //! The depth of each tree (the number of splits on its longest path).
+  std::vector<size_t> depths;
+
+  //! The dimension each node splits on.
+  std::vector<size_t> dimensions;
+  //! The threshold of each numeric split, or the largest category of each
+  //! categorical split.
+  std::vector<double> thresholds;
+  //! The index of the first child of each split.
+  std::vector<size_t> children;
+  //! Whether each split is categorical.
+  std::vector<char> categorical;
+  //! The column of leafValues of each leaf, or NotALeaf.
+  std::vector<size_t> leafIndices;
+  //! The depth of each node.
+  std::vector<size_t> nodeDepths;
+
+  //! The weighted values of the leaves, numClasses per leaf.
+  std::vector<double> leafValues;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_forest_impl.hpp"
+
+#endif
@@ -0,0 +1,309 @@
+/**
+ * @file flat_forest_impl.hpp
+ *
+ * Implementation of FlatForest.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_FLAT_FOREST_IMPL_HPP
+#define MLPACK_METHODS_DECISION_TREE_FLAT_FOREST_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_forest.hpp"
+
+namespace mlpack {
+namespace tree {
+
+inline FlatForest::FlatForest() :
+    numClasses(0),
+    totalWeight(0.0),
+    lastWeight(0.0),
+    lastHardVote(false),
+    unsetNodes(0)
+{
+  // Nothing to do.
+}
+
+template<typename ModelType>
+FlatForest::FlatForest(const ModelType& model) :
+    numClasses(0),
+    totalWeight(0.0),
+    lastWeight(0.0),
+    lastHardVote(false),
+    unsetNodes(0)
+{
+  model.Flatten(*this);
+}
+
+inline size_t FlatForest::AddTree(const size_t numClasses,
+                                  const double weight,
+                                  const bool hardVote)
+{
+  if (unsetNodes != 0)
+  {
+    throw std::invalid_argument("FlatForest::AddTree(): the previous tree is "
+        "not complete!");
+  }
+
+  if (roots.empty())
+  {
+    this->numClasses = numClasses;
+  }
+  else if (numClasses != this->numClasses)
+  {
+    std::ostringstream oss;
+    oss << "FlatForest::AddTree(): the tree has " << numClasses << " classes, "
+        << "but the forest has " << this->numClasses << "!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  totalWeight += weight;
+  lastWeight = weight;
+  lastHardVote = hardVote;
+
+  // Allocate the root.
+  const size_t root = dimensions.size();
+  dimensions.push_back(0);
+  thresholds.push_back(0.0);
+  children.push_back(0);
+  categorical.push_back(0);
+  leafIndices.push_back((size_t) NotALeaf);
+  nodeDepths.push_back(0);
+  ++unsetNodes;
+
+  roots.push_back(root);
+  depths.push_back(0);
+  return root;
+}
+
+inline size_t FlatForest::AddNumericSplit(const size_t node,
+                                          const size_t dimension,
+                                          const double threshold)
+{
+  CheckUnset(node, "AddNumericSplit");
+
+  dimensions[node] = dimension;
+  thresholds[node] = threshold;
+  categorical[node] = 0;
+  return AddChildren(node, 2);
+}
+
+inline size_t FlatForest::AddCategoricalSplit(const size_t node,
+                                              const size_t dimension,
+                                              const size_t numCategories)
+{
+  CheckUnset(node, "AddCategoricalSplit");
+  if (numCategories == 0)
+  {
+    throw std::invalid_argument("FlatForest::AddCategoricalSplit(): a split "
+        "must have at least one category!");
+  }
+
+  dimensions[node] = dimension;
+  thresholds[node] = (double) (numCategories - 1);
+  categorical[node] = 1;
+  return AddChildren(node, numCategories);
+}
+
+inline void FlatForest::SetLeaf(const size_t node,
+                                const size_t prediction,
+                                const arma::vec& probabilities)
+{
+  CheckUnset(node, "SetLeaf");
+  if (prediction >= numClasses ||
+      (!lastHardVote && probabilities.n_elem != numClasses))
+  {
+    throw std::invalid_argument("FlatForest::SetLeaf(): the leaf does not "
+        "match the number of classes of the forest!");
+  }
+
+  leafIndices[node] = leafValues.size() / numClasses;
+  if (lastHardVote)
+  {
+    leafValues.resize(leafValues.size() + numClasses, 0.0);
+    leafValues[leafValues.size() - numClasses + prediction] = lastWeight;
+  }
+  else
+  {
+    for (size_t c = 0; c < numClasses; ++c)
+      leafValues.push_back(lastWeight * probabilities[c]);
+  }
+  --unsetNodes;
+}
+
+inline size_t FlatForest::AddChildren(const size_t node, const size_t count)
+{
+  // The node is now set, and its children are not.
+  unsetNodes += count - 1;
+
+  const size_t first = dimensions.size();
+  children[node] = first;
+  dimensions.resize(first + count, 0);
+  thresholds.resize(first + count, 0.0);
+  children.resize(first + count, 0);
+  categorical.resize(first + count, 0);
+  leafIndices.resize(first + count, (size_t) NotALeaf);
+  nodeDepths.resize(first + count, nodeDepths[node] + 1);
+
+  depths.back() = std::max(depths.back(), nodeDepths[node] + 1);
+  return first;
+}
+
+inline void FlatForest::CheckUnset(const size_t node, const char* caller) const
+{
+  // A node is unset if it is not a leaf and does not have children yet.  (The
+  // root of the first tree is node 0, so no child can be node 0.)
+  if (roots.empty() || node < roots.back() || node >= dimensions.size() ||
+      leafIndices[node] != NotALeaf || children[node] != 0)
+  {
+    std::ostringstream oss;
+    oss << "FlatForest::" << caller << "(): node " << node << " is not an "
+        << "unset node of the last tree!";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+inline void FlatForest::CheckComplete(const char* caller) const
+{
+  if (roots.empty())
+  {
+    std::ostringstream oss;
+    oss << "FlatForest::" << caller << "(): the forest has no trees!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (unsetNodes != 0)
+  {
+    std::ostringstream oss;
+    oss << "FlatForest::" << caller << "(): the last tree is not complete!";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<typename VecType>
+size_t FlatForest::Classify(const VecType& point) const
+{
+  size_t prediction;
+  arma::vec probabilities;
+  Classify(point, prediction, probabilities);
+  return prediction;
+}
+
+template<typename VecType>
+void FlatForest::Classify(const VecType& point,
+                          size_t& prediction,
+                          arma::vec& probabilities) const
+{
+  CheckComplete("Classify");
+
+  probabilities.zeros(numClasses);
+  for (size_t t = 0; t < roots.size(); ++t)
+  {
+    size_t node = roots[t];
+    while (leafIndices[node] == NotALeaf)
+      node = Next(node, point[dimensions[node]]);
+
+    const double* leaf = leafValues.data() + leafIndices[node] * numClasses;
+    for (size_t c = 0; c < numClasses; ++c)
+      probabilities[c] += leaf[c];
+  }
+
+  prediction = probabilities.index_max();
+  probabilities /= totalWeight;
+}
+
+template<typename MatType>
+void FlatForest::Classify(const MatType& data,
+                          arma::Row<size_t>& predictions) const
+{
+  arma::mat probabilities;
+  Classify(data, predictions, probabilities);
+}
+
+template<typename MatType>
+void FlatForest::Classify(const MatType& data,
+                          arma::Row<size_t>& predictions,
+                          arma::mat& probabilities) const
+{
+  CheckComplete("Classify");
+
+  predictions.set_size(data.n_cols);
+  probabilities.zeros(numClasses, data.n_cols);
+
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+  #pragma omp parallel for
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t count = std::min((size_t) BlockSize,
+        (size_t) data.n_cols - begin);
+    ClassifyBlock(data, begin, count, probabilities.colptr(begin));
+
+    for (size_t i = begin; i < begin + count; ++i)
+      predictions[i] = probabilities.col(i).index_max();
+  }
+
+  probabilities /= totalWeight;
+}
+
+template<typename MatType>
+void FlatForest::ClassifyBlock(const MatType& data,
+                               const size_t begin,
+                               const size_t count,
+                               double* sums) const
+{
+  size_t nodes[BlockSize];
+  for (size_t t = 0; t < roots.size(); ++t)
+  {
+    // Take every point one level down at a time.  Points that reached a leaf
+    // stay there.
+    for (size_t i = 0; i < count; ++i)
+      nodes[i] = roots[t];
+
+    for (size_t level = 0; level < depths[t]; ++level)
+    {
+      for (size_t i = 0; i < count; ++i)
+      {
+        const size_t node = nodes[i];
+        if (leafIndices[node] == NotALeaf)
+          nodes[i] = Next(node, data(dimensions[node], begin + i));
+      }
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      const double* leaf = leafValues.data() + leafIndices[nodes[i]] *
+          numClasses;
+      double* sum = sums + i * numClasses;
+      for (size_t c = 0; c < numClasses; ++c)
+        sum[c] += leaf[c];
+    }
+  }
+}
+
+template<typename Archive>
+void FlatForest::serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(numClasses);
+  ar & BOOST_SERIALIZATION_NVP(totalWeight);
+  ar & BOOST_SERIALIZATION_NVP(lastWeight);
+  ar & BOOST_SERIALIZATION_NVP(lastHardVote);
+  ar & BOOST_SERIALIZATION_NVP(unsetNodes);
+  ar & BOOST_SERIALIZATION_NVP(roots);
+  ar & BOOST_SERIALIZATION_NVP(depths);
+  ar & BOOST_SERIALIZATION_NVP(dimensions);
+  ar & BOOST_SERIALIZATION_NVP(thresholds);
+  ar & BOOST_SERIALIZATION_NVP(children);
+  ar & BOOST_SERIALIZATION_NVP(categorical);
+  ar & BOOST_SERIALIZATION_NVP(leafIndices);
+  ar & BOOST_SERIALIZATION_NVP(nodeDepths);
+  ar & BOOST_SERIALIZATION_NVP(leafValues);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * @file histogram_numeric_split.hpp
+ *
+ * A tree splitter that finds a binary numeric split by binning the points of
+ * the node into a histogram instead of sorting them.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_HPP
+#define MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "flat_forest.hpp"
+#include "numeric_split_traits.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The HistogramNumericSplit is a splitting function for decision trees that
+ * finds a binary split of a numeric dimension without sorting it.  The range of
+ * the values of the node is divided into MaxBins bins of equal width, the class
+ * counts (or weights) of each bin are accumulated in one pass over the points,
+ * and then only the boundaries between the bins are considered as split
+ * points.  This takes O(n + MaxBins * c) time per node and dimension (for n
+ * points and c classes), instead of the O(n log n) time of
+ * BestBinaryNumericSplit.
+ *
+ * Through SplitIfBetter(), which only sees the values of one node, the bins
+ * are computed again at every node, so they get finer as the nodes get smaller;
+ * if the points of a node take at most MaxBins distinct values that all fall in
+ * different bins, the split is usually the same as the one
+ * BestBinaryNumericSplit finds.  Like BestBinaryNumericSplit, the split point
+ * is placed halfway between the last value on the left and the first value on
+ * the right.
+ *
+ * DecisionTree::TrainHistogram() avoids the binning at every node: it bins each
+ * dimension once for the whole dataset with ComputeBins(), keeps the bin of
+ * every value, and gets the histograms of the children of a node by binning the
+ * points of all but the largest child and subtracting their histograms from the
+ * histogram of the node.  The splits are then found with SplitIfBetterBinned().
+ * RandomForest does the same for all of its trees, so each dimension is binned
+ * once for the whole forest.
+ *
+ * This can be used with DecisionTree and RandomForest:
+ *
+ * @code
+ * DecisionTree<GiniGain, HistogramNumericSplit> tree(data, labels, numClasses);
+ * DecisionTree<GiniGain, HistogramNumericSplit> binnedTree;
+ * binnedTree.TrainHistogram(data, labels, numClasses);
+ * RandomForest<GiniGain, MultipleRandomDimensionSelect, HistogramNumericSplit>
+ *     forest(data, labels, numClasses);
+ * @endcode
+ *
+ * @tparam FitnessFunction Fitness function to use to calculate gain.
+ */
+template<typename FitnessFunction>
+class HistogramNumericSplit
+{
+ public:
+  //! The maximum number of bins that a dimension is divided into.
+  static const size_t MaxBins = 256;
+
+  // No extra info needed for split.
+  template<typename ElemType>
+  class AuxiliarySplitInfo { };
+
+  /**
+   * Check if we can split a node.  If we can split a node in a way that
+   * improves on 'bestGain', then we return the improved gain.  Otherwise we
+   * return the value 'bestGain'.  If a split is made, then classProbabilities
+   * and aux may be modified.
+   *
+   * @param bestGain Best gain seen so far (we'll only split if we find gain
+   *      better than this).
+   * @param data The dimension of data points to check for a split in.
+   * @param labels Labels for each point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each point (only used if UseWeights is true).
+   * @param minimumLeafSize Minimum number of points in a leaf node for
+   *      splitting.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param classProbabilities Class probabilities vector, which may be filled
+   *      with split information a successful split.
+   * @param aux Auxiliary split information, which may be modified on a
+   *      successful split.
+   */
+  template<bool UseWeights, typename VecType, typename WeightVecType>
+  static double SplitIfBetter(
+      const double bestGain,
+      const VecType& data,
+      const arma::Row<size_t>& labels,
+      const size_t numClasses,
+      const WeightVecType& weights,
+      const size_t minimumLeafSize,
+      const double minimumGainSplit,
+      arma::Col<typename VecType::elem_type>& classProbabilities,
+      AuxiliarySplitInfo<typename VecType::elem_type>& aux);
+
+  /**
+   * Find the best split of a dimension from the histogram of the points of a
+   * node in that dimension; this is used by SplitIfBetter() and by
+   * DecisionTree::TrainHistogram().  Only the boundaries between non-empty bins
+   * are considered.  If a split is found that improves on 'bestGain', the
+   * improved gain is returned and the split point is stored in
+   * classProbabilities; otherwise, DBL_MAX is returned.
+   *
+   * @param bestGain Best gain seen so far (we'll only split if we find gain
+   *      better than this).
+   * @param binCounts Count (or weight, if UseWeights is true) of each class in
+   *      each bin; column i holds bin i.
+   * @param binSizes Number of points in each bin.
+   * @param binMin Smallest value of each bin.
+   * @param binMax Largest value of each bin.
+   * @param minimumLeafSize Minimum number of points in a leaf node for
+   *      splitting.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param classProbabilities Class probabilities vector, which may be filled
+   *      with split information a successful split.
+   * @param aux Auxiliary split information, which may be modified on a
+   *      successful split.
+   */
+  template<bool UseWeights, typename CountType, typename ElemType>
+  static double SplitIfBetterBinned(
+      const double bestGain,
+      const arma::Mat<CountType>& binCounts,
+      const arma::Col<size_t>& binSizes,
+      const arma::Col<ElemType>& binMin,
+      const arma::Col<ElemType>& binMax,
+      const size_t minimumLeafSize,
+      const double minimumGainSplit,
+      arma::Col<ElemType>& classProbabilities,
+      AuxiliarySplitInfo<ElemType>& aux);
+
+  /**
+   * Divide the values of one dimension of a dataset into at most MaxBins bins,
+   * once for the whole dataset.  If there are at most MaxBins distinct values,
+   * each gets its own bin; otherwise the bins are delimited by quantiles of the
+   * values, so that they hold about the same number of points.
+   *
+   * @param values Values of the dimension.
+   * @param bins Set to the bin of each value.
+   * @param binMin Set to the smallest value of each bin.
+   * @param binMax Set to the largest value of each bin.
+   */
+  template<typename ElemType>
+  static void ComputeBins(const arma::Row<ElemType>& values,
+                          arma::Row<unsigned char>& bins,
+                          arma::Col<ElemType>& binMin,
+                          arma::Col<ElemType>& binMax);
+
+  /**
+   * Returns 2, since the binary split always has two children.
+   */
+  template<typename ElemType>
+  static size_t NumChildren(const arma::Col<ElemType>& /* classProbabilities */,
+                            const AuxiliarySplitInfo<ElemType>& /* aux */)
+  {
+    return 2;
+  }
+
+  /**
+   * Given a point, calculate which child it should go to (left or right).
+   *
+   * @param point Point to calculate direction of.
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   */
+  template<typename ElemType>
+  static size_t CalculateDirection(
+      const ElemType& point,
+      const arma::Col<ElemType>& classProbabilities,
+      const AuxiliarySplitInfo<ElemType>& /* aux */)
+  {
+    return (point <= classProbabilities[0]) ? 0 : 1;
+  }
+
+  /**
+   * Store the split in the given node of a FlatForest.  On input, childNodes
+   * holds one element per child; each is set to the node of the forest that
+   * the child should be stored in.
+   *
+   * @param forest Forest to store the split in.
+   * @param node Node to store the split in.
+   * @param dimension Dimension of the split.
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   * @param childNodes Nodes of the children.
+   */
+  template<typename ElemType>
+  static void Flatten(FlatForest& forest,
+                      const size_t node,
+                      const size_t dimension,
+                      const arma::Col<ElemType>& classProbabilities,
+                      const AuxiliarySplitInfo<ElemType>& /* aux */,
+                      std::vector<size_t>& childNodes)
+  {
+    const size_t first = forest.AddNumericSplit(node, dimension,
+        classProbabilities[0]);
+    childNodes[0] = first;
+    childNodes[1] = first + 1;
+  }
+};
+
+//! HistogramNumericSplit can bin each dimension once for the whole dataset.
+template<typename FitnessFunction>
+class NumericSplitTraits<HistogramNumericSplit<FitnessFunction>>
+{
+ public:
+  static const bool UsesBins = true;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "histogram_numeric_split_impl.hpp"
+
+#endif
@@ -0,0 +1,265 @@
+/**
+ * @file histogram_numeric_split_impl.hpp
+ *
+ * Implementation of the histogram-based binary numeric split.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+#define MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "histogram_numeric_split.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction>
+template<bool UseWeights, typename VecType, typename WeightVecType>
+double HistogramNumericSplit<FitnessFunction>::SplitIfBetter(
+    const double bestGain,
+    const VecType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const WeightVecType& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    arma::Col<typename VecType::elem_type>& classProbabilities,
+    AuxiliarySplitInfo<typename VecType::elem_type>& aux)
+{
+  typedef typename VecType::elem_type ElemType;
+
+  // First sanity check: if we don't have enough points, we can't split.
+  if (data.n_elem < (minimumLeafSize * 2))
+    return DBL_MAX;
+  if (bestGain == 0.0)
+    return DBL_MAX; // It can't be outperformed.
+
+  // Find the range of the values.  If they are all the same, we can't split in
+  // this dimension.
+  ElemType minValue = data[0];
+  ElemType maxValue = data[0];
+  for (size_t i = 1; i < data.n_elem; ++i)
+  {
+    if (data[i] < minValue)
+      minValue = data[i];
+    else if (data[i] > maxValue)
+      maxValue = data[i];
+  }
+  if (minValue == maxValue)
+    return DBL_MAX;
+
+  // Put each point in its bin, and accumulate the class counts or weights of
+  // each bin.  We also keep the smallest and largest value of each bin, so that
+  // the split point can be placed between two actual values.
+  const double range = (double) maxValue - (double) minValue;
+  arma::Col<size_t> binSizes(MaxBins, arma::fill::zeros);
+  arma::Col<ElemType> binMin(MaxBins), binMax(MaxBins);
+  arma::Mat<size_t> binCounts;
+  arma::mat binWeights;
+  if (UseWeights)
+    binWeights.zeros(numClasses, MaxBins);
+  else
+    binCounts.zeros(numClasses, MaxBins);
+
+  for (size_t i = 0; i < data.n_elem; ++i)
+  {
+    const size_t bin = std::min((size_t) (MaxBins * (((double) data[i] -
+        (double) minValue) / range)), MaxBins - 1);
+    if (binSizes[bin] == 0)
+    {
+      binMin[bin] = data[i];
+      binMax[bin] = data[i];
+    }
+    else if (data[i] < binMin[bin])
+    {
+      binMin[bin] = data[i];
+    }
+    else if (data[i] > binMax[bin])
+    {
+      binMax[bin] = data[i];
+    }
+
+    ++binSizes[bin];
+    if (UseWeights)
+      binWeights(labels[i], bin) += weights[i];
+    else
+      ++binCounts(labels[i], bin);
+  }
+
+  if (UseWeights)
+  {
+    return SplitIfBetterBinned<true>(bestGain, binWeights, binSizes, binMin,
+        binMax, minimumLeafSize, minimumGainSplit, classProbabilities, aux);
+  }
+  else
+  {
+    return SplitIfBetterBinned<false>(bestGain, binCounts, binSizes, binMin,
+        binMax, minimumLeafSize, minimumGainSplit, classProbabilities, aux);
+  }
+}
+
+template<typename FitnessFunction>
+template<bool UseWeights, typename CountType, typename ElemType>
+double HistogramNumericSplit<FitnessFunction>::SplitIfBetterBinned(
+    const double bestGain,
+    const arma::Mat<CountType>& binCounts,
+    const arma::Col<size_t>& binSizes,
+    const arma::Col<ElemType>& binMin,
+    const arma::Col<ElemType>& binMax,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    arma::Col<ElemType>& classProbabilities,
+    AuxiliarySplitInfo<ElemType>& /* aux */)
+{
+  const size_t numClasses = binCounts.n_rows;
+  const size_t numPoints = arma::accu(binSizes);
+
+  // First sanity check: if we don't have enough points, we can't split.
+  if (numPoints < (minimumLeafSize * 2))
+    return DBL_MAX;
+  if (bestGain == 0.0)
+    return DBL_MAX; // It can't be outperformed.
+
+  // Only the boundaries between non-empty bins can be split points.
+  const arma::uvec bins = arma::find(binSizes);
+  if (bins.n_elem < 2)
+    return DBL_MAX;
+
+  // Loop through all possible split points, choosing the best one.  Also, force
+  // a minimum leaf size of 1 (empty children don't make sense).  The counts of
+  // the right child are the counts of the node minus those of the left child.
+  double bestFoundGain = std::min(bestGain + minimumGainSplit, 0.0);
+  bool improved = false;
+  const size_t minimum = std::max(minimumLeafSize, (size_t) 1);
+
+  const arma::Col<CountType> totalCounts = arma::sum(binCounts, 1);
+  const CountType totalCount = arma::accu(totalCounts);
+  arma::Col<CountType> leftCounts(numClasses, arma::fill::zeros);
+  arma::Col<CountType> rightCounts;
+  CountType leftCount = 0;
+  if (UseWeights)
+    bestFoundGain *= totalCount;
+  else
+    bestFoundGain *= numPoints;
+
+  size_t leftSize = 0;
+  for (size_t b = 0; b < bins.n_elem - 1; ++b)
+  {
+    const size_t bin = bins[b];
+    leftSize += binSizes[bin];
+    leftCounts += binCounts.col(bin);
+    if (UseWeights)
+      leftCount += arma::accu(binCounts.col(bin));
+
+    if (leftSize < minimum)
+      continue;
+    if (numPoints - leftSize < minimum)
+      break;
+
+    // Calculate the gain for the left and right child.  Only use weights if
+    // needed.
+    rightCounts = totalCounts - leftCounts;
+    double gain;
+    if (UseWeights)
+    {
+      const CountType rightCount = totalCount - leftCount;
+      const double leftGain = FitnessFunction::template EvaluatePtr<true>(
+          leftCounts.memptr(), numClasses, leftCount);
+      const double rightGain = FitnessFunction::template EvaluatePtr<true>(
+          rightCounts.memptr(), numClasses, rightCount);
+      gain = double(leftCount) * leftGain + double(rightCount) * rightGain;
+    }
+    else
+    {
+      const size_t rightSize = numPoints - leftSize;
+      const double leftGain = FitnessFunction::template EvaluatePtr<false>(
+          leftCounts.memptr(), numClasses, (CountType) leftSize);
+      const double rightGain = FitnessFunction::template EvaluatePtr<false>(
+          rightCounts.memptr(), numClasses, (CountType) rightSize);
+      gain = double(leftSize) * leftGain + double(rightSize) * rightGain;
+    }
+
+    // Corner case: is this the best possible split?
+    if (gain >= 0.0)
+    {
+      // We can take a shortcut: no split will be better than this, so just take
+      // this one.
+      classProbabilities.set_size(1);
+      classProbabilities[0] = (binMax[bin] + binMin[bins[b + 1]]) / 2.0;
+      return gain;
+    }
+    else if (gain > bestFoundGain)
+    {
+      // We still have a better split.
+      bestFoundGain = gain;
+      classProbabilities.set_size(1);
+      classProbabilities[0] = (binMax[bin] + binMin[bins[b + 1]]) / 2.0;
+      improved = true;
+    }
+  }
+
+  // If we didn't improve, return the original gain exactly as we got it
+  // (without introducing floating point errors).
+  if (!improved)
+    return DBL_MAX;
+
+  if (UseWeights)
+    bestFoundGain /= totalCount;
+  else
+    bestFoundGain /= numPoints;
+
+  return bestFoundGain;
+}
+
+template<typename FitnessFunction>
+template<typename ElemType>
+void HistogramNumericSplit<FitnessFunction>::ComputeBins(
+    const arma::Row<ElemType>& values,
+    arma::Row<unsigned char>& bins,
+    arma::Col<ElemType>& binMin,
+    arma::Col<ElemType>& binMax)
+{
+  static_assert(MaxBins <= 256, "the bins must fit in an unsigned char");
+
+  bins.set_size(values.n_elem);
+  binMin.reset();
+  binMax.reset();
+  if (values.n_elem == 0)
+    return;
+
+  // The largest value of each bin.  With few distinct values, every value has
+  // its own bin; otherwise, the bins end at evenly spaced quantiles.
+  const arma::Row<ElemType> sorted = arma::sort(values);
+  arma::Col<ElemType> upper = arma::unique(sorted).t();
+  if (upper.n_elem > MaxBins)
+  {
+    upper.set_size(MaxBins);
+    for (size_t i = 0; i < MaxBins; ++i)
+      upper[i] = sorted[((i + 1) * sorted.n_elem) / MaxBins - 1];
+    upper = arma::unique(upper);
+  }
+
+  binMin.set_size(upper.n_elem);
+  binMax.set_size(upper.n_elem);
+  arma::Col<size_t> binSizes(upper.n_elem, arma::fill::zeros);
+  for (size_t i = 0; i < values.n_elem; ++i)
+  {
+    const size_t bin = std::min((size_t) (std::lower_bound(upper.begin(),
+        upper.end(), values[i]) - upper.begin()), (size_t) upper.n_elem - 1);
+    bins[i] = (unsigned char) bin;
+    if (binSizes[bin] == 0 || values[i] < binMin[bin])
+      binMin[bin] = values[i];
+    if (binSizes[bin] == 0 || values[i] > binMax[bin])
+      binMax[bin] = values[i];
+    ++binSizes[bin];
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * @file numeric_split_traits.hpp
+ *
+ * This provides the NumericSplitTraits class, a template class to get
+ * information about numeric split types.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_NUMERIC_SPLIT_TRAITS_HPP
+#define MLPACK_METHODS_DECISION_TREE_NUMERIC_SPLIT_TRAITS_HPP
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * This is a template class that can provide information about numeric split
+ * types.  By default, this class will provide the weakest possible assumptions
+ * on the split type, and each split type should override values as necessary.
+ */
+template<typename NumericSplitType>
+class NumericSplitTraits
+{
+ public:
+  /**
+   * If true, then the split type has ComputeBins() and SplitIfBetterBinned()
+   * methods, so trees can be trained with DecisionTree::TrainHistogram(), and
+   * RandomForest bins each dimension once for all of its trees.
+   */
+  static const bool UsesBins = false;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -109,6 +109,23 @@ class EMFit
                 arma::vec& weights,
                 const bool useInitialModel = false);
 
+  /**
+   * Run the clusterer, and then turn the cluster assignments into Gaussians.
+   * This is a helper function for both overloads of Estimate(); calling it and
+   * then Estimate() with useInitialModel = true is the same as calling
+   * Estimate() with useInitialModel = false.  GMM::Train() uses this to draw
+   * the random initial models of its trials before running them in parallel.
+   * The vectors must be already set to the number of clusters.
+   *
+   * @param observations List of observations.
+   * @param dists Vector to store the distributions in.
+   * @param weights Vector to store a priori weights in.
+   */
+  void InitialClustering(
+      const arma::mat& observations,
+      std::vector<Distribution>& dists,
+      arma::vec& weights);
+
   //! Get the clusterer.
   const InitialClusteringType& Clusterer() const { return clusterer; }
   //! Modify the clusterer.
@@ -135,19 +152,35 @@ class EMFit
 
  private:
   /**
-   * Run the clusterer, and then turn the cluster assignments into Gaussians.
-   * This is a helper function for both overloads of Estimate().  The vectors
-   * must be already set to the number of clusters.
+   * Calculate the log-probability of each observation being from each
+   * Gaussian, normalized over the Gaussians, in blocks of observations that
+   * are handled in parallel.
    *
    * @param observations List of observations.
-   * @param means Vector to store means in.
-   * @param covariances Vector to store covariances in.
-   * @param weights Vector to store a priori weights in.
+   * @param dists Current distributions.
+   * @param weights Current a priori weights.
+   * @param condLogProb Matrix to store the conditional log-probabilities in
+   *     (one row for each observation).
    */
-  void InitialClustering(
-      const arma::mat& observations,
-      std::vector<Distribution>& dists,
-      arma::vec& weights);
+  void ConditionalLogProbabilities(const arma::mat& observations,
+                                   const std::vector<Distribution>& dists,
+                                   const arma::vec& weights,
+                                   arma::mat& condLogProb) const;
+
+  /**
+   * Update the mean and covariance of each Gaussian from the conditional
+   * log-probabilities, with the Gaussians handled in parallel.
+   *
+   * @param observations List of observations.
+   * @param condLogProb Conditional log-probabilities of the observations.
+   * @param dists Distributions to update.
+   * @param probRowSums Vector to store the log of the sum of the
+   *     probabilities of each Gaussian in.
+   */
+  void UpdateDistributions(const arma::mat& observations,
+                           const arma::mat& condLogProb,
+                           std::vector<Distribution>& dists,
+                           arma::vec& probRowSums);
 
   /**
    * Calculate the log-likelihood of a model.  Yes, this is reimplemented in the
@@ -180,6 +213,9 @@ class EMFit
       arma::vec& weights,
       const bool useInitialModel);
 
+  //! Number of observations handled at once in each step.
+  static const size_t blockSize = 4096;
+
   //! Maximum iterations of EM algorithm.
   size_t maxIterations;
   //! Tolerance for convergence of EM.
@@ -18,6 +18,8 @@
 #include "diagonal_constraint.hpp"
 #include <mlpack/core/math/log_add.hpp>
 
+#include <exception>
+
 namespace mlpack {
 namespace gmm {
 
@@ -62,9 +64,12 @@ Estimate(const arma::mat& observations,
   {
     // EMFit::Estimate() using DiagonalConstraint with GaussianDistribution
     // makes use of slower implementation.
-    Log::Warn << "EMFit::Estimate() using DiagonalConstraint with "
-        << "GaussianDistribution makes use of slower implementation, so "
-        << "DiagonalGMM is recommended for faster training." << std::endl;
+    #pragma omp critical
+    {
+      Log::Warn << "EMFit::Estimate() using DiagonalConstraint with "
+          << "GaussianDistribution makes use of slower implementation, so "
+          << "DiagonalGMM is recommended for faster training." << std::endl;
+    }
   }
 
   // Only perform initial clustering if the user wanted it.
@@ -73,8 +78,13 @@ Estimate(const arma::mat& observations,
 
   double l = LogLikelihood(observations, dists, weights);
 
-  Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
-      << l << std::endl;
+  // GMM::Train() may fit several models at the same time, so the output is
+  // serialized.
+  #pragma omp critical
+  {
+    Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
+        << l << std::endl;
+  }
 
   double lOld = -DBL_MAX;
   arma::mat condLogProb(observations.n_cols, dists.size());
@@ -83,76 +93,20 @@ Estimate(const arma::mat& observations,
   size_t iteration = 1;
   while (std::abs(l - lOld) > tolerance && iteration != maxIterations)
   {
-    Log::Info << "EMFit::Estimate(): iteration " << iteration << ", "
-        << "log-likelihood " << l << "." << std::endl;
-
-    // Calculate the conditional probabilities of choosing a particular
-    // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
+    #pragma omp critical
     {
-      // Store conditional log probabilities into condLogProb vector for each
-      // Gaussian.  First we make an alias of the condLogProb vector.
-      arma::vec condLogProbAlias = condLogProb.unsafe_col(i);
-      dists[i].LogProbability(observations, condLogProbAlias);
-      condLogProbAlias += log(weights[i]);
+      Log::Info << "EMFit::Estimate(): iteration " << iteration << ", "
+          << "log-likelihood " << l << "." << std::endl;
     }
 
-    // Normalize row-wise.
-    for (size_t i = 0; i < condLogProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = mlpack::math::AccuLog(condLogProb.row(i));
-      if (probSum != -std::numeric_limits<double>::infinity())
-        condLogProb.row(i) -= probSum;
-    }
+    // Calculate the conditional probabilities of choosing a particular
+    // Gaussian given the observations and the present theta value.
+    ConditionalLogProbabilities(observations, dists, weights, condLogProb);
 
-    // Store the sum of the probability of each state over all the observations.
+    // Calculate the new means and covariances, and store the sum of the
+    // probability of each state over all the observations.
     arma::vec probRowSums(dists.size());
-    for (size_t i = 0; i < dists.size(); ++i)
-    {
-      probRowSums(i) = mlpack::math::AccuLog(condLogProb.col(i));
-    }
-
-    // Calculate the new value of the means using the updated conditional
-    // probabilities.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != -std::numeric_limits<double>::infinity())
-        dists[i].Mean() = observations * arma::exp(condLogProb.col(i) -
-                                                   probRowSums[i]);
-      else
-        continue;
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations.each_col() - dists[i].Mean();
-
-      // If the distribution is DiagonalGaussianDistribution, calculate the
-      // covariance only with diagonal components.
-      if (std::is_same<Distribution,
-          distribution::DiagonalGaussianDistribution>::value)
-      {
-        arma::vec covariance = arma::sum((tmp % tmp) %
-            (arma::ones<arma::vec>(observations.n_rows) *
-            trans(arma::exp(condLogProb.col(i) - probRowSums[i]))), 1);
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(covariance);
-        dists[i].Covariance(std::move(covariance));
-      }
-      else
-      {
-        arma::mat tmpB = tmp.each_row() % trans(arma::exp(condLogProb.col(i) -
-                                                          probRowSums[i]));
-        arma::mat covariance = tmp * trans(tmpB);
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(covariance);
-        dists[i].Covariance(std::move(covariance));
-      }
-    }
+    UpdateDistributions(observations, condLogProb, dists, probRowSums);
 
     // Calculate the new values for omega using the updated conditional
     // probabilities.
@@ -181,11 +135,15 @@ Estimate(const arma::mat& observations,
 
   double l = LogLikelihood(observations, dists, weights);
 
-  Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
-      << l << std::endl;
+  #pragma omp critical
+  {
+    Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
+        << l << std::endl;
+  }
 
   double lOld = -DBL_MAX;
   arma::mat condLogProb(observations.n_cols, dists.size());
+  const arma::vec logProbabilities = arma::log(probabilities);
 
   // Iterate to update the model until no more improvement is found.
   size_t iteration = 1;
@@ -193,79 +151,16 @@ Estimate(const arma::mat& observations,
   {
     // Calculate the conditional probabilities of choosing a particular
     // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional log probabilities into condLogProb vector for each
-      // Gaussian.  First we make an alias of the condLogProb vector.
-      arma::vec condLogProbAlias = condLogProb.unsafe_col(i);
-      dists[i].LogProbability(observations, condLogProbAlias);
-      condLogProbAlias += log(weights[i]);
-    }
+    ConditionalLogProbabilities(observations, dists, weights, condLogProb);
 
-    // Normalize row-wise.
-    for (size_t i = 0; i < condLogProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = mlpack::math::AccuLog(condLogProb.row(i));
-      if (probSum != -std::numeric_limits<double>::infinity())
-        condLogProb.row(i) -= probSum;
-    }
+    // Multiply the conditional probability of each point being from each
+    // Gaussian by the probability of the point being from this mixture model.
+    condLogProb.each_col() += logProbabilities;
 
-    // This will store the sum of probabilities of each state over all the
-    // observations.
+    // Calculate the new means and covariances, and store the sum of
+    // probabilities of each state over all the observations.
     arma::vec probRowSums(dists.size());
-
-    // Calculate the new value of the means using the updated conditional
-    // probabilities.
-    arma::vec logProbabilities = arma::log(probabilities);
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Calculate the sum of probabilities of points, which is the
-      // conditional probability of each point being from Gaussian i
-      // multiplied by the probability of the point being from this mixture
-      // model.
-      arma::vec tmpProb = condLogProb.col(i) + logProbabilities;
-      probRowSums[i] = mlpack::math::AccuLog(tmpProb);
-
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != -std::numeric_limits<double>::infinity())
-      {
-        dists[i].Mean() = observations *
-              arma::exp(condLogProb.col(i) + logProbabilities - probRowSums[i]);
-      }
-      else
-        continue;
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations.each_col() - dists[i].Mean();
-
-      // If the distribution is DiagonalGaussianDistribution, calculate the
-      // covariance only with diagonal components.
-      if (std::is_same<Distribution,
-          distribution::DiagonalGaussianDistribution>::value)
-      {
-        arma::vec cov = arma::sum((tmp % tmp) %
-            (arma::ones<arma::vec>(observations.n_rows) *
-            trans(arma::exp(condLogProb.col(i) +
-                            logProbabilities - probRowSums[i]))), 1);
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(cov);
-        dists[i].Covariance(std::move(cov));
-      }
-      else
-      {
-        arma::mat tmpB = tmp.each_row() % trans(arma::exp(condLogProb.col(i) +
-            logProbabilities - probRowSums[i]));
-        arma::mat cov = (tmp * trans(tmpB));
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(cov);
-        dists[i].Covariance(std::move(cov));
-      }
-    }
+    UpdateDistributions(observations, condLogProb, dists, probRowSums);
 
     // Calculate the new values for omega using the updated conditional
     // probabilities.
@@ -382,31 +277,181 @@ LogLikelihood(const arma::mat& observations,
               const arma::vec& weights) const
 {
   double logLikelihood = 0;
+  size_t outliers = 0;
 
-  arma::vec logPhis;
-  arma::mat logLikelihoods(dists.size(), observations.n_cols);
-
-  // It has to be LogProbability() otherwise Probability() would overflow easily
-  for (size_t i = 0; i < dists.size(); ++i)
+  // Sum over every point, one block of points at a time.
+  const size_t numBlocks = (observations.n_cols + blockSize - 1) / blockSize;
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+: logLikelihood, outliers)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
   {
-    dists[i].LogProbability(observations, logPhis);
-    logLikelihoods.row(i) = log(weights(i)) + trans(logPhis);
+    const size_t begin = b * blockSize;
+    const size_t end = std::min(begin + blockSize,
+        (size_t) observations.n_cols);
+    const arma::mat block = observations.cols(begin, end - 1);
+
+    // It has to be LogProbability() otherwise Probability() would overflow
+    // easily.
+    arma::vec logPhis;
+    arma::mat logLikelihoods(dists.size(), block.n_cols);
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      dists[i].LogProbability(block, logPhis);
+      logLikelihoods.row(i) = log(weights(i)) + trans(logPhis);
+    }
+
+    for (size_t j = 0; j < block.n_cols; ++j)
+    {
+      const double pointLogLikelihood =
+          mlpack::math::AccuLog(logLikelihoods.col(j));
+      if (pointLogLikelihood == -std::numeric_limits<double>::infinity())
+        ++outliers;
+      logLikelihood += pointLogLikelihood;
+    }
   }
-  // Now sum over every point.
-  for (size_t j = 0; j < observations.n_cols; ++j)
+
+  if (outliers > 0)
   {
-    if (mlpack::math::AccuLog(logLikelihoods.col(j)) ==
-        -std::numeric_limits<double>::infinity())
+    #pragma omp critical
     {
-      Log::Info << "Likelihood of point " << j << " is 0!  It is probably an "
-          << "outlier." << std::endl;
+      Log::Info << "Likelihood of " << outliers << " points is 0!  They are "
+          << "probably outliers." << std::endl;
     }
-    logLikelihood += mlpack::math::AccuLog(logLikelihoods.col(j));
   }
 
   return logLikelihood;
 }
 
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+ConditionalLogProbabilities(const arma::mat& observations,
+                            const std::vector<Distribution>& dists,
+                            const arma::vec& weights,
+                            arma::mat& condLogProb) const
+{
+  // Each block of observations is handled by one thread, for all of the
+  // Gaussians at once.
+  const size_t numBlocks = (observations.n_cols + blockSize - 1) / blockSize;
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * blockSize;
+    const size_t end = std::min(begin + blockSize,
+        (size_t) observations.n_cols);
+    const arma::mat block = observations.cols(begin, end - 1);
+
+    arma::vec logProbs;
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      dists[i].LogProbability(block, logProbs);
+      condLogProb.submat(begin, i, end - 1, i) = logProbs + log(weights[i]);
+    }
+
+    // Normalize row-wise.
+    for (size_t j = begin; j < end; ++j)
+    {
+      // Avoid dividing by zero; if the probability for everything is 0, we
+      // don't want to make it NaN.
+      const double probSum = mlpack::math::AccuLog(condLogProb.row(j));
+      if (probSum != -std::numeric_limits<double>::infinity())
+        condLogProb.row(j) -= probSum;
+    }
+  }
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+UpdateDistributions(const arma::mat& observations,
+                    const arma::mat& condLogProb,
+                    std::vector<Distribution>& dists,
+                    arma::vec& probRowSums)
+{
+  // Each Gaussian is updated by one thread.  Exceptions (from a failed
+  // Cholesky decomposition) can't leave the parallel region, so the first one
+  // is kept and thrown afterwards.
+  std::exception_ptr exception;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) dists.size(); ++i)
+  {
+    probRowSums[i] = mlpack::math::AccuLog(condLogProb.col(i));
+
+    // Don't update if there's no probability of the Gaussian having points.
+    if (probRowSums[i] == -std::numeric_limits<double>::infinity())
+      continue;
+
+    try
+    {
+      // Calculate the new value of the mean using the updated conditional
+      // probabilities.
+      const arma::vec probs = arma::exp(condLogProb.col(i) - probRowSums[i]);
+      dists[i].Mean() = observations * probs;
+
+      // Calculate the new value of the covariance using the updated
+      // conditional probabilities and the updated mean.  This is done one
+      // block of observations at a time, so that the centered observations
+      // are never all held in memory.
+      const size_t dim = observations.n_rows;
+      const bool isDiagGaussDist = std::is_same<Distribution,
+          distribution::DiagonalGaussianDistribution>::value;
+      arma::mat covariance;
+      if (isDiagGaussDist)
+        covariance.zeros(dim, 1);
+      else
+        covariance.zeros(dim, dim);
+
+      for (size_t begin = 0; begin < observations.n_cols; begin += blockSize)
+      {
+        const size_t end = std::min(begin + blockSize,
+            (size_t) observations.n_cols);
+        const arma::mat tmp = observations.cols(begin, end - 1).each_col() -
+            dists[i].Mean();
+
+        // If the distribution is DiagonalGaussianDistribution, calculate the
+        // covariance only with diagonal components.
+        if (isDiagGaussDist)
+        {
+          covariance += (tmp % tmp) * probs.subvec(begin, end - 1);
+        }
+        else
+        {
+          const arma::mat tmpB = tmp.each_row() %
+              trans(probs.subvec(begin, end - 1));
+          covariance += tmp * trans(tmpB);
+        }
+      }
+
+      // Apply covariance constraint.
+      if (isDiagGaussDist)
+      {
+        arma::vec diagCovariance = std::move(covariance);
+        constraint.ApplyConstraint(diagCovariance);
+        dists[i].Covariance(std::move(diagCovariance));
+      }
+      else
+      {
+        constraint.ApplyConstraint(covariance);
+        dists[i].Covariance(std::move(covariance));
+      }
+    }
+    catch (...)
+    {
+      #pragma omp critical
+      {
+        if (!exception)
+          exception = std::current_exception();
+      }
+    }
+  }
+
+  if (exception)
+    std::rethrow_exception(exception);
+}
+
 template<typename InitialClusteringType,
          typename CovarianceConstraintPolicy,
          typename Distribution>
@@ -212,6 +212,10 @@ class GMM
    * is deterministic after the initial position is given, then 'trials' should
    * be set to 1.
    *
+   * When OpenMP is available, the trials are run at the same time, with the
+   * threads split between them, if the initial models can be drawn before the
+   * fitting (as with EMFit<>).
+   *
    * @tparam FittingType The type of fitting method which should be used
    *     (EMFit<> is suggested).
    * @param observations Observations of the model.
@@ -242,6 +246,9 @@ class GMM
    * is deterministic after the initial position is given, then 'trials' should
    * be set to 1.
    *
+   * When OpenMP is available, the trials are run at the same time, like in the
+   * other overload of Train().
+   *
    * @param observations Observations of the model.
    * @param probabilities Probability of each observation being from this
    *     distribution.
@@ -297,6 +304,33 @@ class GMM
       const arma::mat& dataPoints,
       const std::vector<distribution::GaussianDistribution>& distsL,
       const arma::vec& weights) const;
+
+  /**
+   * Run the given number of trials of the fitter at the same time, each with a
+   * share of the threads, and keep the model with the greatest log-likelihood.
+   * The initial models of the trials are drawn one after another first, since
+   * the initial clusterings use the shared random number generator.  This
+   * returns false (and does nothing) if OpenMP is not available, if there is
+   * only one thread, if it is called from a parallel region, or if the initial
+   * models must be drawn but the fitter has no InitialClustering() method to
+   * do it; the caller then runs the trials one after another.  Output of the
+   * fitter during the trials must be serialized (EMFit does this).
+   *
+   * @param observations Observations of the model.
+   * @param trials Number of trials to perform.
+   * @param useExistingModel If true, every trial starts from the current model.
+   * @param fitter Fitter to copy for each trial.
+   * @param estimate Function that fits a model with a fitter, starting from
+   *     the given model.
+   * @param bestLikelihood Log-likelihood of the best trial.
+   */
+  template<typename FittingType, typename EstimateType>
+  bool ConcurrentTrials(const arma::mat& observations,
+                        const size_t trials,
+                        const bool useExistingModel,
+                        FittingType& fitter,
+                        EstimateType estimate,
+                        double& bestLikelihood);
 };
 
 } // namespace gmm
@@ -17,8 +17,42 @@
 // In case it hasn't already been included.
 #include "gmm.hpp"
 
+#include <exception>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace gmm {
+namespace details {
+
+//! Draw an initial model with fitter.InitialClustering(), if FittingType has
+//! it.
+template<typename FittingType>
+auto DrawInitialModel(FittingType& fitter,
+                      const arma::mat& observations,
+                      std::vector<distribution::GaussianDistribution>& dists,
+                      arma::vec& weights,
+                      const int /* preferred */)
+    -> decltype(fitter.InitialClustering(observations, dists, weights), bool())
+{
+  fitter.InitialClustering(observations, dists, weights);
+  return true;
+}
+
+//! Otherwise, the initial model can't be drawn separately.
+template<typename FittingType>
+bool DrawInitialModel(FittingType& /* fitter */,
+                      const arma::mat& /* observations */,
+                      std::vector<distribution::GaussianDistribution>& /* d */,
+                      arma::vec& /* weights */,
+                      const long /* fallback */)
+{
+  return false;
+}
+
+} // namespace details
 
 /**
  * Fit the GMM to the given observations.
@@ -44,6 +78,21 @@ double GMM::Train(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
+    // Run all of the trials at the same time, if possible.
+    auto estimate = [&observations](FittingType& trialFitter,
+        std::vector<distribution::GaussianDistribution>& trialDists,
+        arma::vec& trialWeights)
+    {
+      trialFitter.Estimate(observations, trialDists, trialWeights, true);
+    };
+    if (ConcurrentTrials(observations, trials, useExistingModel, fitter,
+        estimate, bestLikelihood))
+    {
+      Log::Info << "GMM::Train(): log-likelihood of trained GMM is "
+          << bestLikelihood << "." << std::endl;
+      return bestLikelihood;
+    }
+
     // If each trial must start from the same initial location, we must save it.
     std::vector<distribution::GaussianDistribution> distsOrig;
     arma::vec weightsOrig;
@@ -128,6 +177,22 @@ double GMM::Train(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
+    // Run all of the trials at the same time, if possible.
+    auto estimate = [&observations, &probabilities](FittingType& trialFitter,
+        std::vector<distribution::GaussianDistribution>& trialDists,
+        arma::vec& trialWeights)
+    {
+      trialFitter.Estimate(observations, probabilities, trialDists,
+          trialWeights, true);
+    };
+    if (ConcurrentTrials(observations, trials, useExistingModel, fitter,
+        estimate, bestLikelihood))
+    {
+      Log::Info << "GMM::Train(): log-likelihood of trained GMM is "
+          << bestLikelihood << "." << std::endl;
+      return bestLikelihood;
+    }
+
     // If each trial must start from the same initial location, we must save it.
     std::vector<distribution::GaussianDistribution> distsOrig;
     arma::vec weightsOrig;
@@ -187,6 +252,98 @@ double GMM::Train(const arma::mat& observations,
   return bestLikelihood;
 }
 
+template<typename FittingType, typename EstimateType>
+bool GMM::ConcurrentTrials(const arma::mat& observations,
+                           const size_t trials,
+                           const bool useExistingModel,
+                           FittingType& fitter,
+                           EstimateType estimate,
+                           double& bestLikelihood)
+{
+  #ifdef HAS_OPENMP
+  const size_t maxThreads = omp_get_max_threads();
+  if (maxThreads == 1 || omp_in_parallel())
+    return false;
+
+  // Draw the initial model of each trial, unless they all start from the
+  // current model.
+  std::vector<std::vector<distribution::GaussianDistribution>> trialDists(
+      trials, dists);
+  std::vector<arma::vec> trialWeights(trials, weights);
+  if (!useExistingModel)
+  {
+    for (size_t trial = 0; trial < trials; ++trial)
+    {
+      if (!details::DrawInitialModel(fitter, observations, trialDists[trial],
+          trialWeights[trial], 0))
+        return false;
+    }
+  }
+
+  // Split the threads between the trials.  Each trial uses its share for its
+  // own parallel loops, so nested parallelism must be allowed.
+  const size_t outerThreads = std::min(trials, maxThreads);
+  const size_t innerThreads = std::max((size_t) 1, maxThreads / outerThreads);
+  const int oldMaxActiveLevels = omp_get_max_active_levels();
+  if (innerThreads > 1 && oldMaxActiveLevels < 2)
+    omp_set_max_active_levels(2);
+
+  // Exceptions can't leave the parallel region, so the first one is kept and
+  // thrown afterwards.
+  arma::vec likelihoods(trials);
+  std::exception_ptr exception;
+
+  #pragma omp parallel for num_threads(outerThreads) schedule(dynamic)
+  for (omp_size_t trial = 0; trial < (omp_size_t) trials; ++trial)
+  {
+    omp_set_num_threads(innerThreads);
+    try
+    {
+      FittingType trialFitter(fitter);
+      estimate(trialFitter, trialDists[trial], trialWeights[trial]);
+      likelihoods[trial] = LogLikelihood(observations, trialDists[trial],
+          trialWeights[trial]);
+    }
+    catch (...)
+    {
+      #pragma omp critical
+      {
+        if (!exception)
+          exception = std::current_exception();
+      }
+    }
+  }
+
+  omp_set_max_active_levels(oldMaxActiveLevels);
+  if (exception)
+    std::rethrow_exception(exception);
+
+  // Keep the first of the best trials, like the serial loop does.
+  size_t bestTrial = 0;
+  for (size_t trial = 0; trial < trials; ++trial)
+  {
+    Log::Info << "GMM::Train(): Log-likelihood of trial " << trial << " is "
+        << likelihoods[trial] << "." << std::endl;
+    if (likelihoods[trial] > likelihoods[bestTrial])
+      bestTrial = trial;
+  }
+
+  dists = std::move(trialDists[bestTrial]);
+  weights = std::move(trialWeights[bestTrial]);
+  bestLikelihood = likelihoods[bestTrial];
+  return true;
+  #else
+  // Without OpenMP, the trials are run one after another by the caller.
+  (void) observations;
+  (void) trials;
+  (void) useExistingModel;
+  (void) fitter;
+  (void) estimate;
+  (void) bestLikelihood;
+  return false;
+  #endif
+}
+
 /**
  * Serialize the object.
  */
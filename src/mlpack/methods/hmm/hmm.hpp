@@ -158,6 +158,10 @@ class HMM
    * log-likelihood of the model between iterations is less than the tolerance,
    * the Baum-Welch algorithm terminates.
    *
+   * If OpenMP is enabled, the expectation step of each iteration processes the
+   * sequences in parallel.  The emission distributions must therefore support
+   * concurrent calls to LogProbability().
+   *
    * @note
    * Train() can be called multiple times with different sequences; each time it
    * is called, it uses the current parameters of the HMM as a starting point
@@ -284,6 +288,21 @@ class HMM
   double Predict(const arma::mat& dataSeq,
                  arma::Row<size_t>& stateSeq) const;
 
+  /**
+   * Compute the most probable hidden state sequence of each of the given data
+   * sequences, using the Viterbi algorithm.  If OpenMP is enabled, the
+   * sequences are processed in parallel.
+   *
+   * @param dataSeq Vector of observation sequences.
+   * @param stateSeq Vector in which the most probable state sequence of each
+   *    observation sequence will be stored.
+   * @param logLikelihoods Vector in which the log-likelihood of each most
+   *    probable state sequence will be stored.
+   */
+  void Predict(const std::vector<arma::mat>& dataSeq,
+               std::vector<arma::Row<size_t> >& stateSeq,
+               arma::vec& logLikelihoods) const;
+
   /**
    * Compute the log-likelihood of the given data sequence.
    *
@@ -292,6 +311,17 @@ class HMM
    */
   double LogLikelihood(const arma::mat& dataSeq) const;
 
+  /**
+   * Compute the log-likelihood of each of the given data sequences.  If OpenMP
+   * is enabled, the sequences are processed in parallel.
+   *
+   * @param dataSeq Vector of data sequences to evaluate the likelihood of.
+   * @param logLikelihoods Vector in which the log-likelihood of each sequence
+   *    will be stored.
+   */
+  void LogLikelihood(const std::vector<arma::mat>& dataSeq,
+                     arma::vec& logLikelihoods) const;
+
   /**
    * HMM filtering. Computes the k-step-ahead expected emission at each time
    * conditioned only on prior observations. That is
@@ -421,6 +451,84 @@ class HMM
    */
   void ConvertToLogSpace() const;
 
+  /**
+   * Compute the log-probability of each observation of the given data sequence
+   * under the emission distribution of each state.  The returned matrix has
+   * rows equal to the number of hidden states and columns equal to the number
+   * of observations.
+   *
+   * @param dataSeq Data sequence to compute probabilities for.
+   * @param logEmission Matrix in which the log-probabilities will be saved.
+   */
+  void EmissionLogProbabilities(const arma::mat& dataSeq,
+                                arma::mat& logEmission) const;
+
+  /**
+   * The recursion of the Forward algorithm, given the emission
+   * log-probabilities computed by EmissionLogProbabilities().  Each step is a
+   * product of the transition matrix and the previous forward probabilities.
+   *
+   * @param logEmission Emission log-probabilities of the data sequence.
+   * @param logScales Vector in which the log of the scaling factors will be
+   *    saved.
+   * @param forwardLogProb Matrix in which forward log-probabilities will be
+   *    saved.
+   */
+  void ForwardRecursion(const arma::mat& logEmission,
+                        arma::vec& logScales,
+                        arma::mat& forwardLogProb) const;
+
+  /**
+   * The recursion of the Backward algorithm, given the emission
+   * log-probabilities computed by EmissionLogProbabilities() and the scaling
+   * factors computed by ForwardRecursion().
+   *
+   * @param logEmission Emission log-probabilities of the data sequence.
+   * @param logScales Vector of the log of the scaling factors.
+   * @param backwardLogProb Matrix in which backward log-probabilities will be
+   *    saved.
+   */
+  void BackwardRecursion(const arma::mat& logEmission,
+                         const arma::vec& logScales,
+                         arma::mat& backwardLogProb) const;
+
+  /**
+   * Compute log(matrix * exp(logVector)) in linear space, without overflow,
+   * by shifting logVector by its maximum.  The elements for which terms may
+   * have underflowed are computed again in log space.
+   *
+   * @param matrix Matrix in linear space.
+   * @param logMatrix Logarithm of the matrix.
+   * @param logVector Vector in log space.
+   * @param result Vector in which the result (in log space) will be saved.
+   */
+  static void LogProduct(const arma::mat& matrix,
+                         const arma::mat& logMatrix,
+                         const arma::vec& logVector,
+                         arma::vec& result);
+
+  /**
+   * Compute log(exp(logA) * exp(logB)^T) in linear space, without overflow,
+   * by shifting each row of logA and logB by its maximum.  The elements for
+   * which terms may have underflowed are computed again in log space.
+   *
+   * @param logA First matrix, in log space.
+   * @param logB Second matrix, in log space (same number of columns as logA).
+   * @param result Matrix in which the result (in log space) will be saved.
+   */
+  static void LogProductTranspose(const arma::mat& logA,
+                                  const arma::mat& logB,
+                                  arma::mat& result);
+
+  /**
+   * Add the given log-space values to the given log-space sums, element by
+   * element.
+   *
+   * @param logSum Sums in log space.
+   * @param logValues Values to add, in log space (same size as logSum).
+   */
+  static void LogAccumulate(arma::mat& logSum, const arma::mat& logValues);
+
   /**
    * A proxy vriable in linear space for logInitial.
    * Should be removed in mlpack 4.0.
@@ -101,10 +101,14 @@ double HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   // Maximum iterations?
   size_t iterations = 1000;
 
-  // Find length of all sequences and ensure they are the correct size.
+  // Find length of all sequences and ensure they are the correct size.  The
+  // observations of each sequence start at column offsets[seq] of the list of
+  // emission observations.
+  std::vector<size_t> offsets(dataSeq.size());
   size_t totalLength = 0;
   for (size_t seq = 0; seq < dataSeq.size(); seq++)
   {
+    offsets[seq] = totalLength;
     totalLength += dataSeq[seq].n_cols;
 
     if (dataSeq[seq].n_rows != dimensionality)
@@ -114,10 +118,19 @@ double HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   }
 
   // These are used later for training of each distribution.  We initialize it
-  // all now so we don't have to do any allocation later on.
+  // all now so we don't have to do any allocation later on.  The observations
+  // themselves do not change between iterations.
   std::vector<arma::vec> emissionProb(logTransition.n_cols,
       arma::vec(totalLength));
   arma::mat emissionList(dimensionality, totalLength);
+  for (size_t seq = 0; seq < dataSeq.size(); seq++)
+  {
+    if (dataSeq[seq].n_cols > 0)
+    {
+      emissionList.cols(offsets[seq], offsets[seq] + dataSeq[seq].n_cols - 1) =
+          dataSeq[seq];
+    }
+  }
 
   // This should be the Baum-Welch algorithm (EM for HMM estimation). This
   // follows the procedure outlined in Elliot, Aggoun, and Moore's book "Hidden
@@ -133,53 +146,83 @@ double HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
     // Reset log likelihood.
     loglik = 0;
 
-    // Sum over time.
-    size_t sumTime = 0;
+    // The sequences are processed in parallel, and they only read the log-space
+    // parameters, so these must be up to date before the threads start.
+    ConvertToLogSpace();
 
-    // Loop over each sequence.
-    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    #pragma omp parallel
     {
-      arma::mat stateLogProb;
-      arma::mat forwardLog;
-      arma::mat backwardLog;
-      arma::vec logScales;
-
-      // Add the log-likelihood of this sequence.  This is the E-step.
-      loglik += LogEstimate(dataSeq[seq], stateLogProb, forwardLog,
-          backwardLog, logScales);
-
-      // Add to estimate of initial probability for state j.
-      for (size_t j = 0; j < logTransition.n_cols; ++j)
-        newLogInitial[j] = math::LogAdd(newLogInitial[j], stateLogProb(j, 0));
-
-      // Now re-estimate the parameters.  This is the M-step.
-      //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
-      //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t]) b(i,
-      //           t + 1)))
-      //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t) b(i, t)
-      // We store the new estimates in a different matrix.
-      for (size_t t = 0; t < dataSeq[seq].n_cols; ++t)
+      // Each thread accumulates the statistics of its own sequences.
+      arma::vec localLogInitial(newLogInitial.n_elem);
+      localLogInitial.fill(-std::numeric_limits<double>::infinity());
+      arma::mat localLogTransition(newLogTransition.n_rows,
+          newLogTransition.n_cols);
+      localLogTransition.fill(-std::numeric_limits<double>::infinity());
+      double localLoglik = 0;
+
+      // Loop over each sequence.
+      #pragma omp for schedule(dynamic)
+      for (omp_size_t seq = 0; seq < (omp_size_t) dataSeq.size(); seq++)
       {
-        for (size_t j = 0; j < logTransition.n_cols; ++j)
+        const size_t length = dataSeq[seq].n_cols;
+        arma::mat logEmission;
+        arma::mat forwardLog;
+        arma::mat backwardLog;
+        arma::vec logScales;
+
+        // Add the log-likelihood of this sequence.  This is the E-step.  The
+        // emission log-probabilities are only computed once per sequence.
+        EmissionLogProbabilities(dataSeq[seq], logEmission);
+        ForwardRecursion(logEmission, logScales, forwardLog);
+        BackwardRecursion(logEmission, logScales, backwardLog);
+        localLoglik += accu(logScales);
+
+        const arma::mat stateLogProb = forwardLog + backwardLog;
+
+        // Add to estimate of initial probability for state j.
+        LogAccumulate(localLogInitial, stateLogProb.col(0));
+
+        // Now re-estimate the parameters.  This is the M-step.
+        //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
+        //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t])
+        //           b(i, t + 1)))
+        //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t)
+        //           b(i, t)
+        // We store the new estimates in a different matrix.  The estimate of
+        // T_ij (probability of transition from state j to state i) is a sum
+        // over t of products, so for all i and j it is a matrix product.  We
+        // postpone multiplication of the old T_ij until later.
+        if (length > 1)
         {
-          if (t < dataSeq[seq].n_cols - 1)
+          arma::mat next = backwardLog.cols(1, length - 1) +
+              logEmission.cols(1, length - 1);
+          for (size_t t = 1; t < length; ++t)
           {
-            // Estimate of T_ij (probability of transition from state j to state
-            // i).  We postpone multiplication of the old T_ij until later.
-            for (size_t i = 0; i < logTransition.n_rows; i++)
-            {
-              newLogTransition(i, j) = math::LogAdd(newLogTransition(i, j),
-                  forwardLog(j, t) + backwardLog(i, t + 1) +
-                  emission[i].LogProbability(dataSeq[seq].unsafe_col(t + 1)) -
-                  logScales[t + 1]);
-            }
+            if (std::isfinite(logScales[t]))
+              next.col(t - 1) -= logScales[t];
           }
 
-          // Add to list of emission observations, for Distribution::Train().
-          emissionList.col(sumTime) = dataSeq[seq].col(t);
-          emissionProb[j][sumTime] = exp(stateLogProb(j, t));
+          arma::mat logTransitionSum;
+          LogProductTranspose(next, forwardLog.cols(0, length - 2),
+              logTransitionSum);
+          LogAccumulate(localLogTransition, logTransitionSum);
+        }
+
+        // Store the weights of the observations, for Distribution::Train().
+        // The sequences are stored in disjoint parts of the vectors.
+        for (size_t j = 0; j < logTransition.n_cols; ++j)
+        {
+          emissionProb[j].subvec(offsets[seq], offsets[seq] + length - 1) =
+              exp(stateLogProb.row(j).t());
         }
-        sumTime++;
+      }
+
+      // Combine the statistics of each thread.
+      #pragma omp critical
+      {
+        loglik += localLoglik;
+        LogAccumulate(newLogInitial, localLogInitial);
+        LogAccumulate(newLogTransition, localLogTransition);
       }
     }
 
@@ -337,9 +380,14 @@ double HMM<Distribution>::LogEstimate(const arma::mat& dataSeq,
                                       arma::mat& backwardLogProb,
                                       arma::vec& logScales) const
 {
-  // First run the forward-backward algorithm.
-  Forward(dataSeq, logScales, forwardLogProb);
-  Backward(dataSeq, logScales, backwardLogProb);
+  // First run the forward-backward algorithm.  The emission log-probabilities
+  // are shared by both passes.
+  ConvertToLogSpace();
+
+  arma::mat logEmission;
+  EmissionLogProbabilities(dataSeq, logEmission);
+  ForwardRecursion(logEmission, logScales, forwardLogProb);
+  BackwardRecursion(logEmission, logScales, backwardLogProb);
 
   // Now assemble the state probability matrix based on the forward and backward
   // probabilities.
@@ -459,43 +507,41 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
                                   arma::Row<size_t>& stateSeq) const
 {
   // This is an implementation of the Viterbi algorithm for finding the most
-  // probable sequence of states to produce the observed data sequence.  We
-  // don't use log-likelihoods to save that little bit of time, but we'll
-  // calculate the log-likelihood at the end of it all.
+  // probable sequence of states to produce the observed data sequence.
   stateSeq.set_size(dataSeq.n_cols);
   arma::mat logStateProb(logTransition.n_rows, dataSeq.n_cols);
-  arma::mat stateSeqBack(logTransition.n_rows, dataSeq.n_cols);
+  arma::Mat<size_t> stateSeqBack(logTransition.n_rows, dataSeq.n_cols);
 
   ConvertToLogSpace();
 
+  arma::mat logEmission;
+  EmissionLogProbabilities(dataSeq, logEmission);
+
   // The calculation of the first state is slightly different; the probability
   // of the first state being state j is the maximum probability that the state
   // came to be j from another state.
-  logStateProb.col(0).zeros();
+  logStateProb.col(0) = logInitial + logEmission.col(0);
   for (size_t state = 0; state < logTransition.n_rows; state++)
-  {
-    logStateProb(state, 0) = logInitial[state] +
-        emission[state].LogProbability(dataSeq.unsafe_col(0));
     stateSeqBack(state, 0) = state;
-  }
 
-  // Store the best first state.
-  arma::uword index;
   for (size_t t = 1; t < dataSeq.n_cols; t++)
   {
-    // Assemble the state probability for this element.
-    // Given that we are in state j, we use state with the highest probability
-    // of being the previous state.
+    // Assemble the state probability for this element.  Given that we are in
+    // state j (row j), we use the state with the highest probability of being
+    // the previous state.
+    arma::mat prob = logTransition;
+    prob.each_row() += logStateProb.col(t - 1).t();
+
+    const arma::uvec index = arma::index_max(prob, 1);
     for (size_t j = 0; j < logTransition.n_rows; j++)
     {
-      arma::vec prob = logStateProb.col(t - 1) + logTransition.row(j).t();
-      logStateProb(j, t) = prob.max(index) +
-          emission[j].LogProbability(dataSeq.unsafe_col(t));
-      stateSeqBack(j, t) = index;
+      logStateProb(j, t) = prob(j, index[j]) + logEmission(j, t);
+      stateSeqBack(j, t) = index[j];
     }
   }
 
   // Backtrack to find the most probable state sequence.
+  arma::uword index;
   logStateProb.unsafe_col(dataSeq.n_cols - 1).max(index);
   stateSeq[dataSeq.n_cols - 1] = index;
   for (size_t t = 2; t <= dataSeq.n_cols; t++)
@@ -507,6 +553,26 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
   return logStateProb(stateSeq(dataSeq.n_cols - 1), dataSeq.n_cols - 1);
 }
 
+/**
+ * Compute the most probable hidden state sequence of each of the given data
+ * sequences, in parallel.
+ */
+template<typename Distribution>
+void HMM<Distribution>::Predict(const std::vector<arma::mat>& dataSeq,
+                                std::vector<arma::Row<size_t> >& stateSeq,
+                                arma::vec& logLikelihoods) const
+{
+  // The threads only read the log-space parameters.
+  ConvertToLogSpace();
+
+  stateSeq.resize(dataSeq.size());
+  logLikelihoods.set_size(dataSeq.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t seq = 0; seq < (omp_size_t) dataSeq.size(); ++seq)
+    logLikelihoods[seq] = Predict(dataSeq[seq], stateSeq[seq]);
+}
+
 /**
  * Compute the log-likelihood of the given data sequence.
  */
@@ -522,6 +588,23 @@ double HMM<Distribution>::LogLikelihood(const arma::mat& dataSeq) const
   return accu(logScales);
 }
 
+/**
+ * Compute the log-likelihood of each of the given data sequences, in parallel.
+ */
+template<typename Distribution>
+void HMM<Distribution>::LogLikelihood(const std::vector<arma::mat>& dataSeq,
+                                      arma::vec& logLikelihoods) const
+{
+  // The threads only read the log-space parameters.
+  ConvertToLogSpace();
+
+  logLikelihoods.set_size(dataSeq.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t seq = 0; seq < (omp_size_t) dataSeq.size(); ++seq)
+    logLikelihoods[seq] = LogLikelihood(dataSeq[seq]);
+}
+
 /**
  * HMM filtering.
  */
@@ -577,44 +660,85 @@ template<typename Distribution>
 void HMM<Distribution>::Forward(const arma::mat& dataSeq,
                                 arma::vec& logScales,
                                 arma::mat& forwardLogProb) const
+{
+  ConvertToLogSpace();
+
+  arma::mat logEmission;
+  EmissionLogProbabilities(dataSeq, logEmission);
+  ForwardRecursion(logEmission, logScales, forwardLogProb);
+}
+
+/**
+ * The Backward procedure (part of the Forward-Backward algorithm).
+ */
+template<typename Distribution>
+void HMM<Distribution>::Backward(const arma::mat& dataSeq,
+                                 const arma::vec& logScales,
+                                 arma::mat& backwardLogProb) const
+{
+  ConvertToLogSpace();
+
+  arma::mat logEmission;
+  EmissionLogProbabilities(dataSeq, logEmission);
+  BackwardRecursion(logEmission, logScales, backwardLogProb);
+}
+
+/**
+ * Compute the log-probability of each observation under the emission
+ * distribution of each state.
+ */
+template<typename Distribution>
+void HMM<Distribution>::EmissionLogProbabilities(const arma::mat& dataSeq,
+                                                 arma::mat& logEmission) const
+{
+  logEmission.set_size(logTransition.n_rows, dataSeq.n_cols);
+  for (size_t t = 0; t < dataSeq.n_cols; t++)
+  {
+    for (size_t state = 0; state < logTransition.n_rows; state++)
+    {
+      logEmission(state, t) =
+          emission[state].LogProbability(dataSeq.unsafe_col(t));
+    }
+  }
+}
+
+/**
+ * The recursion of the Forward procedure.
+ */
+template<typename Distribution>
+void HMM<Distribution>::ForwardRecursion(const arma::mat& logEmission,
+                                         arma::vec& logScales,
+                                         arma::mat& forwardLogProb) const
 {
   // Our goal is to calculate the forward probabilities:
   //  P(X_k | o_{1:k}) for all possible states X_k, for each time point k.
-  forwardLogProb.resize(logTransition.n_rows, dataSeq.n_cols);
+  forwardLogProb.resize(logTransition.n_rows, logEmission.n_cols);
   forwardLogProb.fill(-std::numeric_limits<double>::infinity());
-  logScales.resize(dataSeq.n_cols);
+  logScales.resize(logEmission.n_cols);
   logScales.fill(-std::numeric_limits<double>::infinity());
 
-  ConvertToLogSpace();
-
   // The first entry in the forward algorithm uses the initial state
   // probabilities.  Note that MATLAB assumes that the starting state (at
   // t = -1) is state 0; this is not our assumption here.  To force that
   // behavior, you could append a single starting state to every single data
   // sequence and that should produce results in line with MATLAB.
-  for (size_t state = 0; state < logTransition.n_rows; state++)
-  {
-    forwardLogProb(state, 0) = logInitial(state) +
-        emission[state].LogProbability(dataSeq.unsafe_col(0));
-  }
+  forwardLogProb.col(0) = logInitial + logEmission.col(0);
 
   // Then normalize the column.
   logScales[0] = math::AccuLog(forwardLogProb.col(0));
   if (std::isfinite(logScales[0]))
     forwardLogProb.col(0) -= logScales[0];
 
-  // Now compute the probabilities for each successive observation.
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  // The forward probability of state j at time t is the sum over all states of
+  // the probability of the previous state transitioning to the current state
+  // and emitting the given observation; for all states at once, this is the
+  // product of the transition matrix with the previous forward probabilities.
+  const arma::mat transition = exp(logTransition);
+  arma::vec logSum;
+  for (size_t t = 1; t < logEmission.n_cols; t++)
   {
-    for (size_t j = 0; j < logTransition.n_rows; j++)
-    {
-      // The forward probability of state j at time t is the sum over all states
-      // of the probability of the previous state transitioning to the current
-      // state and emitting the given observation.
-      arma::vec tmp = forwardLogProb.col(t - 1) + logTransition.row(j).t();
-      forwardLogProb(j, t) = math::AccuLog(tmp) +
-          emission[j].LogProbability(dataSeq.unsafe_col(t));
-    }
+    LogProduct(transition, logTransition, forwardLogProb.col(t - 1), logSum);
+    forwardLogProb.col(t) = logSum + logEmission.col(t);
 
     // Normalize probability.
     logScales[t] = math::AccuLog(forwardLogProb.col(t));
@@ -623,42 +747,120 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
   }
 }
 
+/**
+ * The recursion of the Backward procedure.
+ */
 template<typename Distribution>
-void HMM<Distribution>::Backward(const arma::mat& dataSeq,
-                                 const arma::vec& logScales,
-                                 arma::mat& backwardLogProb) const
+void HMM<Distribution>::BackwardRecursion(const arma::mat& logEmission,
+                                          const arma::vec& logScales,
+                                          arma::mat& backwardLogProb) const
 {
   // Our goal is to calculate the backward probabilities:
   //  P(X_k | o_{k + 1:T}) for all possible states X_k, for each time point k.
-  backwardLogProb.resize(logTransition.n_rows, dataSeq.n_cols);
+  backwardLogProb.resize(logTransition.n_rows, logEmission.n_cols);
   backwardLogProb.fill(-std::numeric_limits<double>::infinity());
 
   // The last element probability is 1.
-  backwardLogProb.col(dataSeq.n_cols - 1).fill(0);
+  backwardLogProb.col(logEmission.n_cols - 1).fill(0);
+
+  // The backward probability of state j at time t is the sum over all states of
+  // the probability of the next state having been a transition from the
+  // current state multiplied by the probability of each of those states
+  // emitting the given observation; for all states at once, this is the
+  // product of the transposed transition matrix with those probabilities.
+  const arma::mat logTransitionT = logTransition.t();
+  const arma::mat transitionT = exp(logTransitionT);
+  arma::vec logSum;
+  for (size_t t = logEmission.n_cols - 2; t + 1 > 0; t--)
+  {
+    LogProduct(transitionT, logTransitionT,
+        backwardLogProb.col(t + 1) + logEmission.col(t + 1), logSum);
+    backwardLogProb.col(t) = logSum;
 
-  // Now step backwards through all other observations.
-  for (size_t t = dataSeq.n_cols - 2; t + 1 > 0; t--)
+    // Normalize by the weights from the forward algorithm.
+    if (std::isfinite(logScales[t + 1]))
+      backwardLogProb.col(t) -= logScales[t + 1];
+  }
+}
+
+/**
+ * Compute log(matrix * exp(logVector)).
+ */
+template<typename Distribution>
+void HMM<Distribution>::LogProduct(const arma::mat& matrix,
+                                   const arma::mat& logMatrix,
+                                   const arma::vec& logVector,
+                                   arma::vec& result)
+{
+  const double maxLog = logVector.max();
+  if (!std::isfinite(maxLog))
   {
-    for (size_t j = 0; j < logTransition.n_rows; j++)
+    result.set_size(matrix.n_rows);
+    result.fill(-std::numeric_limits<double>::infinity());
+    return;
+  }
+
+  result = log(matrix * exp(logVector - maxLog)) + maxLog;
+
+  // Terms more than exp(-600) times smaller than the shift may have underflowed
+  // (exp() underflows below about exp(-745)); if the result is that small, it
+  // is computed term by term.
+  for (size_t i = 0; i < result.n_elem; ++i)
+  {
+    if (!(result[i] > maxLog - 600.0))
+      result[i] = math::AccuLog(arma::vec(logMatrix.row(i).t() + logVector));
+  }
+}
+
+/**
+ * Compute log(exp(logA) * exp(logB)^T).
+ */
+template<typename Distribution>
+void HMM<Distribution>::LogProductTranspose(const arma::mat& logA,
+                                            const arma::mat& logB,
+                                            arma::mat& result)
+{
+  // Shift each row by its maximum.  Rows without any finite element are not
+  // shifted; their results are -inf anyway.
+  arma::vec shiftA = arma::max(logA, 1);
+  arma::vec shiftB = arma::max(logB, 1);
+  shiftA.elem(arma::find_nonfinite(shiftA)).zeros();
+  shiftB.elem(arma::find_nonfinite(shiftB)).zeros();
+
+  arma::mat shiftedA = logA;
+  shiftedA.each_col() -= shiftA;
+  arma::mat shiftedB = logB;
+  shiftedB.each_col() -= shiftB;
+
+  result = log(exp(shiftedA) * exp(shiftedB).t());
+  result.each_col() += shiftA;
+  result.each_row() += shiftB.t();
+
+  // As in LogProduct(), small results are computed term by term.
+  for (size_t j = 0; j < result.n_cols; ++j)
+  {
+    for (size_t i = 0; i < result.n_rows; ++i)
     {
-      // The backward probability of state j at time t is the sum over all state
-      // of the probability of the next state having been a transition from the
-      // current state multiplied by the probability of each of those states
-      // emitting the given observation.
-      for (size_t state = 0; state < logTransition.n_rows; state++)
+      if (!(result(i, j) > shiftA[i] + shiftB[j] - 600.0))
       {
-        backwardLogProb(j, t) = math::LogAdd(backwardLogProb(j, t),
-            logTransition(state, j) + backwardLogProb(state, t + 1)
-            + emission[state].LogProbability(dataSeq.unsafe_col(t + 1)));
+        result(i, j) = math::AccuLog(arma::vec(logA.row(i).t() +
+            logB.row(j).t()));
       }
-
-      // Normalize by the weights from the forward algorithm.
-      if (std::isfinite(logScales[t + 1]))
-        backwardLogProb(j, t) -= logScales[t + 1];
     }
   }
 }
 
+/**
+ * Add log-space values to log-space sums.
+ */
+template<typename Distribution>
+void HMM<Distribution>::LogAccumulate(arma::mat& logSum,
+                                      const arma::mat& logValues)
+{
+  for (size_t i = 0; i < logSum.n_elem; ++i)
+    logSum[i] = math::LogAdd(logSum[i], logValues[i]);
+}
+
 /**
  * Make sure the variables in log space are in sync with the linear counter parts
  */
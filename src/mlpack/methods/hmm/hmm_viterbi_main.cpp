@@ -48,7 +48,14 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Viterbi State Prediction",
     ", the following command could be used:"
     "\n\n" +
     PRINT_CALL("hmm_viterbi", "input", "obs", "input_model", "hmm", "output",
-        "states"),
+        "states") +
+    "\n\n"
+    "Many observation sequences can be processed at once (in parallel, if "
+    "OpenMP is enabled) by concatenating them in " +
+    PRINT_PARAM_STRING("input") + " and giving the length of each sequence "
+    "with the " + PRINT_PARAM_STRING("lengths") + " parameter.  The predicted "
+    "state sequences are then concatenated in the same way in " +
+    PRINT_PARAM_STRING("output") + ".",
     SEE_ALSO("@hmm_train", "#hmm_train"),
     SEE_ALSO("@hmm_generate", "#hmm_generate"),
     SEE_ALSO("@hmm_loglik", "#hmm_loglik"),
@@ -60,6 +67,9 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Viterbi State Prediction",
 PARAM_MATRIX_IN_REQ("input", "Matrix containing observations,", "i");
 PARAM_MODEL_IN_REQ(HMMModel, "input_model", "Trained HMM to use.", "m");
 PARAM_UMATRIX_OUT("output", "File to save predicted state sequence to.", "o");
+PARAM_UROW_IN("lengths", "If specified, the input holds several observation "
+    "sequences one after another, and this gives the length of each sequence.",
+    "l");
 
 // Because we don't know what the type of our HMM is, we need to write a
 // function that can take arbitrary HMM types.
@@ -88,7 +98,45 @@ struct Viterbi
     }
 
     arma::Row<size_t> sequence;
-    hmm.Predict(dataSeq, sequence);
+    if (!CLI::HasParam("lengths"))
+    {
+      hmm.Predict(dataSeq, sequence);
+    }
+    else
+    {
+      // Split the input into its sequences and predict them all at once.
+      const arma::Row<size_t>& lengths =
+          CLI::GetParam<arma::Row<size_t>>("lengths");
+      if (arma::accu(lengths) != dataSeq.n_cols)
+      {
+        Log::Fatal << "Sum of sequence lengths (" << arma::accu(lengths)
+            << ") does not match the number of observations ("
+            << dataSeq.n_cols << ")!" << endl;
+      }
+
+      std::vector<arma::mat> dataSeqs(lengths.n_elem);
+      size_t begin = 0;
+      for (size_t i = 0; i < lengths.n_elem; ++i)
+      {
+        if (lengths[i] == 0)
+          Log::Fatal << "Sequence " << i << " is empty!" << endl;
+
+        dataSeqs[i] = dataSeq.cols(begin, begin + lengths[i] - 1);
+        begin += lengths[i];
+      }
+
+      std::vector<arma::Row<size_t>> sequences;
+      arma::vec logLikelihoods;
+      hmm.Predict(dataSeqs, sequences, logLikelihoods);
+
+      sequence.set_size(dataSeq.n_cols);
+      begin = 0;
+      for (size_t i = 0; i < sequences.size(); ++i)
+      {
+        sequence.cols(begin, begin + lengths[i] - 1) = sequences[i];
+        begin += lengths[i];
+      }
+    }
 
     // Save output.
     CLI::GetParam<arma::Mat<size_t>>("output") = std::move(sequence);
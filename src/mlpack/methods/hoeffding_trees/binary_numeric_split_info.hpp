@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_HOEFFDING_TREES_BINARY_NUMERIC_SPLIT_INFO_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/decision_tree/flat_forest.hpp>
 
 namespace mlpack {
 namespace tree {
@@ -32,6 +33,22 @@ class BinaryNumericSplitInfo
     return (value < splitPoint) ? 0 : 1;
   }
 
+  //! Store the split in the given node of a FlatForest, and set the node of
+  //! each child.
+  void Flatten(FlatForest& forest,
+               const size_t node,
+               const size_t dimension,
+               std::vector<size_t>& childNodes) const
+  {
+    // The FlatForest sends values at most the threshold left, so use the
+    // largest value that is less than the split point.
+    const size_t first = forest.AddNumericSplit(node, dimension,
+        std::nextafter((double) splitPoint,
+        -std::numeric_limits<double>::infinity()));
+    childNodes[0] = first;
+    childNodes[1] = first + 1;
+  }
+
   //! Serialize the split (save/load the split points).
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */)
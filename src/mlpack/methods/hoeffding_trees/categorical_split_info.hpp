@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_HOEFFDING_TREES_CATEGORICAL_SPLIT_INFO_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/decision_tree/flat_forest.hpp>
 
 namespace mlpack {
 namespace tree {
@@ -30,6 +31,19 @@ class CategoricalSplitInfo
     return size_t(value);
   }
 
+  //! Store the split in the given node of a FlatForest, and set the node of
+  //! each child (one per category).
+  static void Flatten(FlatForest& forest,
+                      const size_t node,
+                      const size_t dimension,
+                      std::vector<size_t>& childNodes)
+  {
+    const size_t first = forest.AddCategoricalSplit(node, dimension,
+        childNodes.size());
+    for (size_t i = 0; i < childNodes.size(); ++i)
+      childNodes[i] = first + i;
+  }
+
   //! Serialize the object.  (Nothing needs to be saved.)
   template<typename Archive>
   void serialize(Archive& /* ar */, const unsigned int /* version */) { }
@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/data/dataset_mapper.hpp>
+#include <mlpack/methods/decision_tree/flat_forest.hpp>
 #include "gini_impurity.hpp"
 #include "hoeffding_numeric_split.hpp"
 #include "hoeffding_categorical_split.hpp"
@@ -158,6 +159,13 @@ class HoeffdingTree
    * Train on a set of points, either in streaming mode or in batch mode, with
    * the given labels.
    *
+   * In streaming mode, the result is the same as training on each point in
+   * order with Train(point, label), but the points are first sent down to the
+   * leaves they fall in, and each leaf is then trained on its own points; when
+   * OpenMP is available, both steps are done in parallel.  Passing large
+   * batches of a stream to this function is therefore much faster than passing
+   * the points one at a time.
+   *
    * @param data Data points to train on.
    * @param label Labels of data points.
    * @param batchTraining If true, perform training in batch.
@@ -274,7 +282,8 @@ class HoeffdingTree
 
   /**
    * Classify the given points, using this node and the entire (sub)tree beneath
-   * it.  The predicted labels for each point are returned.
+   * it.  The predicted labels for each point are returned.  The points are
+   * classified in parallel when OpenMP is available.
    *
    * @param data Points to classify.
    * @param predictions Predicted labels for each point.
@@ -287,7 +296,8 @@ class HoeffdingTree
    * it.  The predicted labels for each point are returned, as well as an
    * estimate of the probability that the prediction is correct for each point.
    * This estimate is simply the MajorityProbability() for the leaf that each
-   * point bins to.
+   * point bins to.  The points are classified in parallel when OpenMP is
+   * available.
    *
    * @param data Points to classify.
    * @param predictions Predicted labels for each point.
@@ -298,6 +308,17 @@ class HoeffdingTree
                 arma::Row<size_t>& predictions,
                 arma::rowvec& probabilities) const;
 
+  /**
+   * Append the tree to the given FlatForest, for fast classification of many
+   * points.  The tree votes for the majority class of each leaf, so the
+   * FlatForest gives the same predictions as Classify(); its probabilities
+   * are the (weighted) fractions of votes.
+   *
+   * @param forest Forest to append the tree to.
+   * @param weight Weight of the tree in the forest.
+   */
+  void Flatten(FlatForest& forest, const double weight = 1.0) const;
+
   /**
    * Given that this node should split, create the children.
    */
@@ -352,6 +373,27 @@ class HoeffdingTree
   typename NumericSplitType<FitnessFunction>::SplitInfo numericSplit;
   //! If the split has occurred, these are the children.
   std::vector<HoeffdingTree*> children;
+
+  /**
+   * Train this leaf on the given points of the dataset, in order.  If the leaf
+   * splits, the rest of the points are passed on to the children.  The
+   * majority class is only updated when checking for a split and at the end.
+   *
+   * @param data Dataset the points are in.
+   * @param labels Labels of the whole dataset.
+   * @param points Indices of the points to train on.
+   */
+  template<typename MatType>
+  void TrainLeaf(const MatType& data,
+                 const arma::Row<size_t>& labels,
+                 const std::vector<size_t>& points);
+
+  //! Set the majority class and its probability from the split statistics.
+  void UpdateMajority();
+
+  //! Store this node and its subtree in the given (unset) node of a
+  //! FlatForest.
+  void FlattenNode(FlatForest& forest, const size_t node) const;
 };
 
 } // namespace tree
@@ -245,8 +245,18 @@ void HoeffdingTree<
     // Don't split if there are fewer than five points.
     size_t oldMaxSamples = maxSamples;
     maxSamples = std::max(size_t(data.n_cols - 1), size_t(5));
-    for (size_t i = 0; i < data.n_cols; ++i)
-      Train(data.col(i), labels[i]);
+    if (splitDimension == size_t(-1))
+    {
+      std::vector<size_t> points(data.n_cols);
+      for (size_t i = 0; i < data.n_cols; ++i)
+        points[i] = i;
+      TrainLeaf(data, labels, points);
+    }
+    else
+    {
+      for (size_t i = 0; i < data.n_cols; ++i)
+        Train(data.col(i), labels[i]);
+    }
     maxSamples = oldMaxSamples;
 
     // Now, if we did split, find out which points go to which child, and
@@ -297,9 +307,41 @@ void HoeffdingTree<
   }
   else
   {
-    // We aren't training in batch mode; loop through the points.
+    // We aren't training in batch mode.  First find the leaf that each point
+    // goes to; the tree does not change while we do this.
+    std::vector<HoeffdingTree*> leaves(data.n_cols);
+    #pragma omp parallel for
+    for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+    {
+      HoeffdingTree* node = this;
+      while (!node->children.empty())
+        node = node->children[node->CalculateDirection(data.col(i))];
+      leaves[i] = node;
+    }
+
+    // Now collect the points of each leaf, in order.
+    std::unordered_map<HoeffdingTree*, size_t> leafIndices;
+    std::vector<HoeffdingTree*> leafNodes;
+    std::vector<std::vector<size_t>> leafPoints;
     for (size_t i = 0; i < data.n_cols; ++i)
-      Train(data.col(i), labels[i]);
+    {
+      auto it = leafIndices.insert(std::make_pair(leaves[i],
+          leafNodes.size()));
+      if (it.second)
+      {
+        leafNodes.push_back(leaves[i]);
+        leafPoints.push_back(std::vector<size_t>());
+      }
+      leafPoints[it.first->second].push_back(i);
+    }
+
+    // Training a leaf (and splitting it) only changes that leaf and the
+    // children it creates, so each leaf can be trained on its own points by a
+    // different thread.  This gives the same tree as training on the points
+    // one at a time.
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t l = 0; l < (omp_size_t) leafNodes.size(); ++l)
+      leafNodes[l]->TrainLeaf(data, labels, leafPoints[l]);
   }
 }
 
@@ -384,16 +426,7 @@ void HoeffdingTree<
     }
 
     // Grab majority class from splits.
-    if (categoricalSplits.size() > 0)
-    {
-      majorityClass = categoricalSplits[0].MajorityClass();
-      majorityProbability = categoricalSplits[0].MajorityProbability();
-    }
-    else
-    {
-      majorityClass = numericSplits[0].MajorityClass();
-      majorityProbability = numericSplits[0].MajorityProbability();
-    }
+    UpdateMajority();
 
     // Check for a split, if we should.
     if (numSamples % checkInterval == 0)
@@ -416,6 +449,85 @@ void HoeffdingTree<
   }
 }
 
+//! Train a leaf on some points.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+template<typename MatType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::TrainLeaf(const MatType& data,
+             const arma::Row<size_t>& labels,
+             const std::vector<size_t>& points)
+{
+  for (size_t p = 0; p < points.size(); ++p)
+  {
+    const size_t point = points[p];
+
+    ++numSamples;
+    size_t numericIndex = 0;
+    size_t categoricalIndex = 0;
+    for (size_t i = 0; i < data.n_rows; ++i)
+    {
+      if (datasetInfo->Type(i) == data::Datatype::categorical)
+        categoricalSplits[categoricalIndex++].Train(data(i, point),
+            labels[point]);
+      else if (datasetInfo->Type(i) == data::Datatype::numeric)
+        numericSplits[numericIndex++].Train(data(i, point), labels[point]);
+    }
+
+    // The majority class is only needed when we check for a split and when
+    // we are done, so there is no need to compute it for every point.
+    if (numSamples % checkInterval != 0)
+      continue;
+
+    UpdateMajority();
+    if (SplitCheck() > 0)
+    {
+      children.clear();
+      CreateChildren();
+
+      // Pass the rest of the points to the children, in order.
+      std::vector<std::vector<size_t>> childPoints(children.size());
+      for (size_t q = p + 1; q < points.size(); ++q)
+        childPoints[CalculateDirection(data.col(points[q]))].push_back(
+            points[q]);
+
+      for (size_t i = 0; i < children.size(); ++i)
+        if (!childPoints[i].empty())
+          children[i]->TrainLeaf(data, labels, childPoints[i]);
+
+      return;
+    }
+  }
+
+  if (!points.empty())
+    UpdateMajority();
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::UpdateMajority()
+{
+  if (categoricalSplits.size() > 0)
+  {
+    majorityClass = categoricalSplits[0].MajorityClass();
+    majorityProbability = categoricalSplits[0].MajorityProbability();
+  }
+  else
+  {
+    majorityClass = numericSplits[0].MajorityClass();
+    majorityProbability = numericSplits[0].MajorityProbability();
+  }
+}
+
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
          template<typename> class CategoricalSplitType>
@@ -680,7 +792,8 @@ void HoeffdingTree<
 >::Classify(const MatType& data, arma::Row<size_t>& predictions) const
 {
   predictions.set_size(data.n_cols);
-  for (size_t i = 0; i < data.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
     predictions[i] = Classify(data.col(i));
 }
 
@@ -701,10 +814,52 @@ void HoeffdingTree<
 {
   predictions.set_size(data.n_cols);
   probabilities.set_size(data.n_cols);
-  for (size_t i = 0; i < data.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
     Classify(data.col(i), predictions[i], probabilities[i]);
 }
 
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::Flatten(FlatForest& forest, const double weight) const
+{
+  FlattenNode(forest, forest.AddTree(numClasses, weight, true));
+}
+
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::FlattenNode(FlatForest& forest, const size_t node) const
+{
+  if (children.size() == 0)
+  {
+    forest.SetLeaf(node, majorityClass, arma::vec());
+    return;
+  }
+
+  std::vector<size_t> childNodes(children.size());
+  if (datasetInfo->Type(splitDimension) == data::Datatype::numeric)
+    numericSplit.Flatten(forest, node, splitDimension, childNodes);
+  else
+    categoricalSplit.Flatten(forest, node, splitDimension, childNodes);
+
+  for (size_t i = 0; i < children.size(); ++i)
+    children[i]->FlattenNode(forest, childNodes[i]);
+}
+
 template<
     typename FitnessFunction,
     template<typename> class NumericSplitType,
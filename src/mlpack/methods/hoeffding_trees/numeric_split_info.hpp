@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_HOEFFDING_TREES_NUMERIC_SPLIT_INFO_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/decision_tree/flat_forest.hpp>
 
 namespace mlpack {
 namespace tree {
@@ -36,6 +37,26 @@ class NumericSplitInfo
     return bin;
   }
 
+  //! Store the split in the given node of a FlatForest, as a chain of binary
+  //! splits, and set the node of each child (one more than the split points).
+  void Flatten(FlatForest& forest,
+               const size_t node,
+               const size_t dimension,
+               std::vector<size_t>& childNodes) const
+  {
+    // Child i gets the points that are not in children 0, ..., i - 1 and are
+    // at most the i'th split point, like in CalculateDirection().
+    size_t current = node;
+    for (size_t i = 0; i < splitPoints.n_elem; ++i)
+    {
+      const size_t first = forest.AddNumericSplit(current, dimension,
+          (double) splitPoints[i]);
+      childNodes[i] = first;
+      current = first + 1;
+    }
+    childNodes[splitPoints.n_elem] = current;
+  }
+
   //! Serialize the split (save/load the split points).
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */)
@@ -0,0 +1,322 @@
+/**
+ * @file gaussian_series.cpp
+ *
+ * Implementation of the GaussianSeries class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "gaussian_series.hpp"
+
+#include <map>
+
+using namespace mlpack;
+using namespace mlpack::kde;
+
+GaussianSeries::GaussianSeries(const size_t dimension,
+                               const size_t maxOrder,
+                               const double bandwidth) :
+    dimension(dimension),
+    maxOrder(maxOrder),
+    scale(std::sqrt(2.0) * bandwidth),
+    cramerConstant(std::pow(1.09, (double) dimension))
+{
+  if (maxOrder == 0)
+  {
+    throw std::invalid_argument("GaussianSeries::GaussianSeries(): the order "
+        "of the expansions must be at least 1!");
+  }
+
+  // Enumerate the multi-indices by degree, up to the degree needed to
+  // translate far-field expansions into local expansions.  Every multi-index
+  // but 0 is obtained from exactly one parent of lower degree, by adding one
+  // to its last nonzero dimension.
+  const size_t maxDegree = 2 * maxOrder - 2;
+  std::vector<std::vector<size_t>> indices(1,
+      std::vector<size_t>(dimension, 0));
+  std::map<std::vector<size_t>, size_t> lookup;
+  lookup[indices[0]] = 0;
+  degrees.push_back(0);
+  parents.push_back(0);
+  lastDimensions.push_back(0);
+  numTerms.push_back(0);
+  numTerms.push_back(1);
+
+  size_t begin = 0;
+  for (size_t n = 1; n <= maxDegree; ++n)
+  {
+    const size_t end = indices.size();
+    for (size_t i = begin; i < end; ++i)
+    {
+      for (size_t k = lastDimensions[i]; k < dimension; ++k)
+      {
+        std::vector<size_t> index(indices[i]);
+        ++index[k];
+        lookup[index] = indices.size();
+        indices.push_back(index);
+        degrees.push_back(n);
+        parents.push_back(i);
+        lastDimensions.push_back(k);
+      }
+    }
+
+    begin = end;
+    numTerms.push_back(indices.size());
+  }
+
+  multiIndices.set_size(dimension, indices.size());
+  for (size_t i = 0; i < indices.size(); ++i)
+    for (size_t k = 0; k < dimension; ++k)
+      multiIndices(k, i) = indices[i][k];
+
+  const size_t numBaseTerms = NumTerms();
+  factorials.set_size(numBaseTerms);
+  for (size_t i = 0; i < numBaseTerms; ++i)
+  {
+    factorials[i] = 1.0;
+    for (size_t k = 0; k < dimension; ++k)
+      factorials[i] *= std::tgamma(indices[i][k] + 1.0);
+  }
+
+  sums.set_size(numBaseTerms, numBaseTerms);
+  for (size_t a = 0; a < numBaseTerms; ++a)
+  {
+    for (size_t b = 0; b < numBaseTerms; ++b)
+    {
+      std::vector<size_t> index(indices[a]);
+      for (size_t k = 0; k < dimension; ++k)
+        index[k] += indices[b][k];
+      sums(a, b) = lookup[index];
+    }
+  }
+
+  // By the Cauchy-Schwarz inequality, the sum of |t^a| / sqrt(a!) over the
+  // multi-indices of degree n is at most || t ||^n b_n, with
+  // b_n = sqrt((n + d - 1)! / ((d - 1)! n! n!)).  The tails of the series are
+  // summed until the terms are small; with the extra terms here, that is the
+  // case for any radius up to about ten times the bandwidth.
+  logBoundCoefficients.resize(2 * maxOrder + 500);
+  for (size_t n = 0; n < logBoundCoefficients.size(); ++n)
+  {
+    logBoundCoefficients[n] = 0.5 * (std::lgamma(n + (double) dimension) -
+        std::lgamma((double) dimension) - 2.0 * std::lgamma(n + 1.0));
+  }
+}
+
+void GaussianSeries::AccumulateFarField(const arma::vec& point,
+                                        const arma::vec& center,
+                                        arma::vec& coefficients) const
+{
+  arma::vec monomials;
+  Monomials(point, center, NumTerms(), monomials);
+  coefficients += monomials / factorials;
+}
+
+double GaussianSeries::EvaluateFarField(const arma::vec& coefficients,
+                                        const size_t order,
+                                        const arma::vec& center,
+                                        const arma::vec& point) const
+{
+  const size_t count = numTerms[order];
+  arma::vec hermite;
+  Hermite(point, center, count, hermite);
+  return arma::dot(coefficients.head(count), hermite);
+}
+
+void GaussianSeries::AccumulateLocal(const arma::vec& point,
+                                     const size_t order,
+                                     const arma::vec& center,
+                                     arma::vec& coefficients) const
+{
+  const size_t count = numTerms[order];
+  arma::vec hermite;
+  Hermite(point, center, count, hermite);
+  coefficients.head(count) += hermite / factorials.head(count);
+}
+
+void GaussianSeries::TranslateFarFieldToLocal(const arma::vec& farField,
+                                              const arma::vec& farCenter,
+                                              const size_t order,
+                                              const arma::vec& localCenter,
+                                              arma::vec& local) const
+{
+  // The derivatives of h_a are (-1)^|b| h_{a + b}, so we need the Hermite
+  // functions of degree up to 2 (order - 1) at the distance between the
+  // centers.
+  const size_t count = numTerms[order];
+  arma::vec hermite;
+  Hermite(localCenter, farCenter, numTerms[2 * order - 1], hermite);
+
+  for (size_t b = 0; b < count; ++b)
+  {
+    double sum = 0.0;
+    for (size_t a = 0; a < count; ++a)
+      sum += farField[a] * hermite[sums(a, b)];
+
+    if (degrees[b] % 2 == 1)
+      sum = -sum;
+    local[b] += sum / factorials[b];
+  }
+}
+
+void GaussianSeries::TranslateLocal(const arma::vec& local,
+                                    const arma::vec& center,
+                                    const arma::vec& newCenter,
+                                    arma::vec& newLocal) const
+{
+  // Expand each term ((q - c) / s)^b = (u + d)^b, with u = (q - c') / s and
+  // d = (c' - c) / s, with the multinomial theorem.
+  const size_t count = NumTerms();
+  arma::vec monomials;
+  Monomials(newCenter, center, count, monomials);
+
+  for (size_t g = 0; g < count; ++g)
+  {
+    double sum = 0.0;
+    for (size_t e = 0; e < count; ++e)
+    {
+      const size_t i = sums(g, e);
+      if (i < count)
+        sum += local[i] * factorials[i] / factorials[e] * monomials[e];
+    }
+
+    newLocal[g] += sum / factorials[g];
+  }
+}
+
+double GaussianSeries::EvaluateLocal(const arma::vec& coefficients,
+                                     const arma::vec& center,
+                                     const arma::vec& point) const
+{
+  arma::vec monomials;
+  Monomials(point, center, NumTerms(), monomials);
+  return arma::dot(coefficients, monomials);
+}
+
+size_t GaussianSeries::TruncationOrder(const double radius,
+                                       const double minDistance,
+                                       const double maxError,
+                                       double& error) const
+{
+  // The remainder of either expansion is at most
+  // K^d exp(-(minDistance / s)^2 / 2) sum_{n >= p} b_n (sqrt(2) radius / s)^n
+  // per reference point.
+  const double distance = minDistance / scale;
+  const double factor = cramerConstant * std::exp(-0.5 * distance * distance);
+  const double x = std::sqrt(2.0) * radius / scale;
+
+  for (size_t order = 1; order <= maxOrder; ++order)
+  {
+    error = factor * SeriesTail(x, order);
+    if (error <= maxError)
+      return order;
+  }
+
+  return 0;
+}
+
+size_t GaussianSeries::TranslationOrder(const double farRadius,
+                                        const double localRadius,
+                                        const double minDistance,
+                                        const double maxError,
+                                        double& error) const
+{
+  // The error is the remainder of the far-field expansion, plus the remainder
+  // of the local expansion of the truncated far-field expansion; for the
+  // latter, we use (a + b)! <= 2^(|a| + |b|) a! b!.
+  const double distance = minDistance / scale;
+  const double factor = cramerConstant * std::exp(-0.5 * distance * distance);
+  const double x = std::sqrt(2.0) * farRadius / scale;
+  const double y = 2.0 * farRadius / scale;
+  const double z = 2.0 * localRadius / scale;
+
+  for (size_t order = 1; order <= maxOrder; ++order)
+  {
+    error = factor * (SeriesTail(x, order) +
+        SeriesHead(y, order) * SeriesTail(z, order));
+    if (error <= maxError)
+      return order;
+  }
+
+  return 0;
+}
+
+void GaussianSeries::Monomials(const arma::vec& point,
+                               const arma::vec& center,
+                               const size_t count,
+                               arma::vec& monomials) const
+{
+  const arma::vec t = (point - center) / scale;
+  monomials.set_size(count);
+  monomials[0] = 1.0;
+  for (size_t i = 1; i < count; ++i)
+    monomials[i] = monomials[parents[i]] * t[lastDimensions[i]];
+}
+
+void GaussianSeries::Hermite(const arma::vec& point,
+                             const arma::vec& center,
+                             const size_t count,
+                             arma::vec& hermite) const
+{
+  const arma::vec t = (point - center) / scale;
+  const size_t maxDegree = degrees[count - 1];
+
+  // Compute the Hermite functions of each dimension with the recurrence
+  // h_{n + 1}(t) = 2 t h_n(t) - 2 n h_{n - 1}(t).
+  arma::mat h(maxDegree + 1, dimension);
+  for (size_t k = 0; k < dimension; ++k)
+  {
+    h(0, k) = std::exp(-t[k] * t[k]);
+    if (maxDegree > 0)
+      h(1, k) = 2.0 * t[k] * h(0, k);
+    for (size_t n = 1; n < maxDegree; ++n)
+      h(n + 1, k) = 2.0 * t[k] * h(n, k) - 2.0 * n * h(n - 1, k);
+  }
+
+  hermite.set_size(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    double value = 1.0;
+    for (size_t k = 0; k < dimension; ++k)
+      value *= h(multiIndices(k, i), k);
+    hermite[i] = value;
+  }
+}
+
+double GaussianSeries::SeriesTail(const double x, const size_t from) const
+{
+  if (x == 0.0)
+    return (from == 0) ? 1.0 : 0.0;
+
+  const double logX = std::log(x);
+  double sum = 0.0;
+  double lastTerm = 0.0;
+  for (size_t n = from; n < logBoundCoefficients.size(); ++n)
+  {
+    const double term = std::exp(logBoundCoefficients[n] + n * logX);
+    sum += term;
+
+    // The ratio of successive terms decreases with n, so once it is at most
+    // 1/2, the rest of the series is at most the current term.
+    if (n > from && term <= 0.5 * lastTerm)
+      return sum + term;
+    lastTerm = term;
+  }
+
+  // The series has not converged yet, so there is no useful bound.
+  return DBL_MAX;
+}
+
+double GaussianSeries::SeriesHead(const double x, const size_t to) const
+{
+  if (x == 0.0)
+    return (to > 0) ? 1.0 : 0.0;
+
+  const double logX = std::log(x);
+  double sum = 0.0;
+  for (size_t n = 0; n < to; ++n)
+    sum += std::exp(logBoundCoefficients[n] + n * logX);
+  return sum;
+}
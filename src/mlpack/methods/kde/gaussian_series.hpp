@@ -0,0 +1,267 @@
+/**
+ * @file gaussian_series.hpp
+ *
+ * Hermite (far-field) and Taylor (local) series expansions of sums of Gaussian
+ * kernels, as used by the fast Gauss transform.
+ *
+ * @code
+ * @article{greengard1991fast,
+ *   title={The fast Gauss transform},
+ *   author={Greengard, Leslie and Strain, John},
+ *   journal={SIAM Journal on Scientific and Statistical Computing},
+ *   volume={12},
+ *   number={1},
+ *   pages={79--94},
+ *   year={1991}
+ * }
+ *
+ * @inproceedings{lee2006dual,
+ *   title={Dual-tree fast Gauss transforms},
+ *   author={Lee, Dongryeol and Gray, Alexander G. and Moore, Andrew W.},
+ *   booktitle={Advances in Neural Information Processing Systems 18},
+ *   pages={747--754},
+ *   year={2006}
+ * }
+ * @endcode
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_GAUSSIAN_SERIES_HPP
+#define MLPACK_METHODS_KDE_GAUSSIAN_SERIES_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace kde {
+
+/**
+ * GaussianSeries computes series expansions of sums of Gaussian kernels
+ * K(q, x) = exp(-|| q - x ||^2 / (2 h^2)).  With s = sqrt(2) h, the sum over a
+ * set of reference points x_r can be written around a center c_R of the
+ * reference points as a Hermite (far-field) expansion,
+ *
+ *   sum_r K(q, x_r) = sum_a A_a h_a((q - c_R) / s),
+ *   A_a = sum_r ((x_r - c_R) / s)^a / a!,
+ *
+ * or around a center c_Q of the query points as a Taylor (local) expansion,
+ *
+ *   sum_r K(q, x_r) = sum_b B_b ((q - c_Q) / s)^b,
+ *   B_b = sum_r h_b((x_r - c_Q) / s) / b!,
+ *
+ * where a and b are multi-indices and h_a is the product of the Hermite
+ * functions h_n(t) = (-1)^n d^n/dt^n exp(-t^2) of each dimension.  A far-field
+ * expansion can be translated into a local expansion, and a local expansion
+ * can be moved to a new center exactly.
+ *
+ * The expansions are truncated to the multi-indices of total degree less than
+ * the order p, as in the improved fast Gauss transform, so an expansion of
+ * order p has (p - 1 + d)! / ((p - 1)! d!) coefficients instead of the p^d of
+ * the original fast Gauss transform.  The multi-indices are sorted by degree,
+ * so the coefficients of an expansion of order p < MaxOrder() are the first
+ * NumTerms(p) coefficients of an expansion of order MaxOrder().
+ *
+ * The error bounds returned by TruncationOrder() and TranslationOrder() are
+ * rigorous; they follow from Cramer's inequality for Hermite functions,
+ * |h_n(t)| <= K 2^(n / 2) sqrt(n!) exp(-t^2 / 2) with K < 1.09.
+ */
+class GaussianSeries
+{
+ public:
+  /**
+   * Prepare the multi-indices of the expansions of the given maximum order.
+   *
+   * @param dimension Dimensionality of the points.
+   * @param maxOrder Maximum order of the expansions (at least 1).
+   * @param bandwidth Bandwidth h of the Gaussian kernel.
+   */
+  GaussianSeries(const size_t dimension,
+                 const size_t maxOrder,
+                 const double bandwidth);
+
+  //! Get the dimensionality of the points.
+  size_t Dimension() const { return dimension; }
+  //! Get the maximum order of the expansions.
+  size_t MaxOrder() const { return maxOrder; }
+  //! Get the bandwidth of the kernel.
+  double Bandwidth() const { return scale / std::sqrt(2.0); }
+
+  //! Get the number of coefficients of an expansion of the given order.
+  size_t NumTerms(const size_t order) const { return numTerms[order]; }
+  //! Get the number of coefficients of an expansion of the maximum order.
+  size_t NumTerms() const { return numTerms[maxOrder]; }
+
+  /**
+   * Add the given reference point to a far-field expansion of the maximum
+   * order around the given center.
+   *
+   * @param point Reference point.
+   * @param center Center of the expansion.
+   * @param coefficients Coefficients of the expansion (NumTerms() elements).
+   */
+  void AccumulateFarField(const arma::vec& point,
+                          const arma::vec& center,
+                          arma::vec& coefficients) const;
+
+  /**
+   * Evaluate the given far-field expansion, truncated to the given order, at
+   * the given query point.
+   *
+   * @param coefficients Coefficients of the expansion (NumTerms() elements).
+   * @param order Order to truncate the expansion to.
+   * @param center Center of the expansion.
+   * @param point Query point.
+   */
+  double EvaluateFarField(const arma::vec& coefficients,
+                          const size_t order,
+                          const arma::vec& center,
+                          const arma::vec& point) const;
+
+  /**
+   * Add the given reference point to the terms up to the given order of a
+   * local expansion around the given center.
+   *
+   * @param point Reference point.
+   * @param order Order of the terms to compute.
+   * @param center Center of the expansion.
+   * @param coefficients Coefficients of the expansion (NumTerms() elements).
+   */
+  void AccumulateLocal(const arma::vec& point,
+                       const size_t order,
+                       const arma::vec& center,
+                       arma::vec& coefficients) const;
+
+  /**
+   * Translate the given far-field expansion, truncated to the given order,
+   * into the terms up to the given order of a local expansion, and add them to
+   * the given local expansion.
+   *
+   * @param farField Coefficients of the far-field expansion.
+   * @param farCenter Center of the far-field expansion.
+   * @param order Order of the translation.
+   * @param localCenter Center of the local expansion.
+   * @param local Coefficients of the local expansion (NumTerms() elements).
+   */
+  void TranslateFarFieldToLocal(const arma::vec& farField,
+                                const arma::vec& farCenter,
+                                const size_t order,
+                                const arma::vec& localCenter,
+                                arma::vec& local) const;
+
+  /**
+   * Move the given local expansion to a new center and add it to another
+   * local expansion around that center.  This does not introduce any error.
+   *
+   * @param local Coefficients of the local expansion.
+   * @param center Center of the local expansion.
+   * @param newCenter Center of the new local expansion.
+   * @param newLocal Coefficients of the new local expansion.
+   */
+  void TranslateLocal(const arma::vec& local,
+                      const arma::vec& center,
+                      const arma::vec& newCenter,
+                      arma::vec& newLocal) const;
+
+  /**
+   * Evaluate the given local expansion at the given query point.
+   *
+   * @param coefficients Coefficients of the expansion (NumTerms() elements).
+   * @param center Center of the expansion.
+   * @param point Query point.
+   */
+  double EvaluateLocal(const arma::vec& coefficients,
+                       const arma::vec& center,
+                       const arma::vec& point) const;
+
+  /**
+   * Find the smallest order for which a far-field expansion of points within
+   * the given radius of its center (or a local expansion used for query points
+   * within the given radius of its center) has an error of at most maxError
+   * per reference point.  Returns 0 if no order up to MaxOrder() is enough.
+   *
+   * @param radius Radius of the points around the center of the expansion.
+   * @param minDistance Lower bound on the distance between the query points
+   *     and the reference points (and the centers).
+   * @param maxError Maximum error per reference point.
+   * @param error Will be set to the error bound per reference point.
+   */
+  size_t TruncationOrder(const double radius,
+                         const double minDistance,
+                         const double maxError,
+                         double& error) const;
+
+  /**
+   * Find the smallest order for which the translation of a far-field expansion
+   * into a local expansion has an error of at most maxError per reference
+   * point.  Returns 0 if no order up to MaxOrder() is enough.
+   *
+   * @param farRadius Radius of the reference points around the center of the
+   *     far-field expansion.
+   * @param localRadius Radius of the query points around the center of the
+   *     local expansion.
+   * @param minDistance Lower bound on the distance between the query points
+   *     and the reference points (and the centers).
+   * @param maxError Maximum error per reference point.
+   * @param error Will be set to the error bound per reference point.
+   */
+  size_t TranslationOrder(const double farRadius,
+                          const double localRadius,
+                          const double minDistance,
+                          const double maxError,
+                          double& error) const;
+
+ private:
+  //! Compute ((point - center) / scale)^a for the first count multi-indices.
+  void Monomials(const arma::vec& point,
+                 const arma::vec& center,
+                 const size_t count,
+                 arma::vec& monomials) const;
+
+  //! Compute h_a((point - center) / scale) for the first count multi-indices.
+  void Hermite(const arma::vec& point,
+               const arma::vec& center,
+               const size_t count,
+               arma::vec& hermite) const;
+
+  //! Return sum_{n >= from} b_n x^n, where b_n bounds the sum of
+  //! |t^a| / sqrt(a!) over the multi-indices of degree n for || t || = 1.
+  double SeriesTail(const double x, const size_t from) const;
+
+  //! Return sum_{n < to} b_n x^n.
+  double SeriesHead(const double x, const size_t to) const;
+
+  //! The dimensionality of the points.
+  size_t dimension;
+  //! The maximum order of the expansions.
+  size_t maxOrder;
+  //! The scale of the expansions, sqrt(2) times the bandwidth.
+  double scale;
+
+  //! The number of multi-indices of degree less than n, for n < 2 maxOrder.
+  std::vector<size_t> numTerms;
+  //! The multi-indices of degree less than 2 maxOrder - 1 (one per column).
+  arma::umat multiIndices;
+  //! The degree of each multi-index.
+  std::vector<size_t> degrees;
+  //! The multi-index that each multi-index is obtained from by adding one to
+  //! the dimension in lastDimensions.
+  std::vector<size_t> parents;
+  //! The dimension in which each multi-index differs from its parent.
+  std::vector<size_t> lastDimensions;
+  //! The factorial a! of the multi-indices of degree less than maxOrder.
+  arma::vec factorials;
+  //! The index of the sum of any two multi-indices of degree less than
+  //! maxOrder.
+  arma::Mat<size_t> sums;
+  //! The logarithms of the coefficients b_n of the error bounds.
+  std::vector<double> logBoundCoefficients;
+  //! The constant K^d of Cramer's inequality.
+  double cramerConstant;
+};
+
+} // namespace kde
+} // namespace mlpack
+
+#endif
@@ -17,15 +17,20 @@
 #include <mlpack/core/tree/binary_space_tree.hpp>
 
 #include "kde_stat.hpp"
+#include "gaussian_series.hpp"
 
 namespace mlpack {
 namespace kde /** Kernel Density Estimation. */ {
 
 //! KDEMode represents the ways in which KDE algorithm can be executed.
+//! FGT_MODE is the dual-tree algorithm with series expansions of the Gaussian
+//! kernel (dual-tree fast Gauss transform); it requires the Gaussian kernel and
+//! the Euclidean distance.
 enum KDEMode
 {
   DUAL_TREE_MODE,
-  SINGLE_TREE_MODE
+  SINGLE_TREE_MODE,
+  FGT_MODE
 };
 
 //! KDEDefaultParams contains the default input parameter values for KDE.
@@ -55,6 +60,9 @@ struct KDEDefaultParams
 
   //! Monte Carlo break coefficient.
   static constexpr double mcBreakCoef = 0.4;
+
+  //! Maximum order of the series expansions in FGT mode.
+  static constexpr size_t seriesOrder = 6;
 };
 
 /**
@@ -63,6 +71,15 @@ struct KDEDefaultParams
  * probability density function of a variable in a non parametric way.
  * This implementation performs this estimation using a tree-independent
  * dual-tree algorithm. Details about this algorithm are available in KDERules.
+ * In dual-tree mode, independent subtrees of the query tree are traversed in
+ * parallel when OpenMP is available (see tree::ParallelDualTreeTraverser); the
+ * error guarantees are the same as for a single thread.
+ *
+ * In FGT mode, the dual-tree algorithm also approximates the contributions of
+ * reference nodes with far-field and local series expansions of the Gaussian
+ * kernel (see GaussianSeries), which is much faster than the finite difference
+ * approximation when the bandwidth is large compared to the nodes.  The order
+ * of each approximation is chosen so that the error guarantees still hold.
  *
  * @tparam KernelType Kernel function to use for KDE calculations.
  * @tparam MetricType Metric to use for KDE calculations.
@@ -199,7 +216,8 @@ class KDE
    *
    * - Use std::move if the query tree is no longer needed.
    *
-   * @pre The model has to be previously trained and mode has to be dual-tree.
+   * @pre The model has to be previously trained and mode has to be dual-tree
+   *      or FGT.
    * @param queryTree Tree of query points to get the density of.
    * @param oldFromNewQueries Mappings of query points to the tree dataset.
    * @param estimations Object which will hold the density of each query point.
@@ -290,6 +308,13 @@ class KDE
   //! Modify Monte Carlo break coefficient. (0 < newCoef <= 1).
   void MCBreakCoef(const double newCoef);
 
+  //! Get the maximum order of the series expansions in FGT mode.
+  size_t SeriesOrder() const { return seriesOrder; }
+
+  //! Modify the maximum order of the series expansions in FGT mode.
+  //! (newOrder >= 1).
+  size_t& SeriesOrder() { return seriesOrder; }
+
   //! Serialize the model.
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int version);
@@ -341,6 +366,25 @@ class KDE
   //! is the limit before Monte Carlo estimation recurses.
   double mcBreakCoef;
 
+  //! Maximum order of the series expansions in FGT mode.
+  size_t seriesOrder;
+
+  //! Create the series expansions of the kernel for FGT mode (the caller must
+  //! delete them), or return NULL in the other modes.
+  GaussianSeries* BuildSeries() const;
+
+  //! Set the expansion centers of all the nodes of the given tree, and build
+  //! the far-field expansions of the nodes if farField is true.
+  static void BuildExpansions(Tree* tree,
+                              const GaussianSeries& series,
+                              const bool farField);
+
+  //! Evaluate the local expansions of the given tree after a traversal and add
+  //! them to the estimations.
+  static void EvaluateLocalExpansions(Tree* tree,
+                                      const GaussianSeries& series,
+                                      arma::vec& estimations);
+
   //! Check whether absolute and relative error values are compatible.
   static void CheckErrorValues(const double relError, const double absError);
 
@@ -377,7 +421,7 @@ struct version<mlpack::kde::KDE<KernelType,
                                 DualTreeTraversalType,
                                 SingleTreeTraversalType>>
 {
-  typedef mpl::int_<1> type;
+  typedef mpl::int_<2> type;
   typedef mpl::integral_c_tag tag;
   BOOST_STATIC_CONSTANT(int, value = version::type::value);
   BOOST_MPL_ASSERT((boost::mpl::less<boost::mpl::int_<1>,
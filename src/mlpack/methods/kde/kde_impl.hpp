@@ -12,6 +12,7 @@
 
 #include "kde.hpp"
 #include "kde_rules.hpp"
+#include <mlpack/core/tree/parallel_dual_tree_traverser.hpp>
 
 namespace mlpack {
 namespace kde {
@@ -38,6 +39,20 @@ TreeType* BuildTree(
   return new TreeType(std::forward<MatType>(dataset));
 }
 
+//! Get the bandwidth of the Gaussian kernel for the series expansions.
+inline double SeriesBandwidth(const kernel::GaussianKernel& kernel)
+{
+  return kernel.Bandwidth();
+}
+
+//! Series expansions are only available for the Gaussian kernel.
+template<typename KernelType>
+double SeriesBandwidth(const KernelType& /* kernel */)
+{
+  throw std::invalid_argument("cannot evaluate KDE model: FGT mode requires "
+                              "the Gaussian kernel");
+}
+
 template<typename KernelType,
          typename MetricType,
          typename MatType,
@@ -72,7 +87,8 @@ KDE(const double relError,
     trained(false),
     mode(mode),
     monteCarlo(monteCarlo),
-    initialSampleSize(initialSampleSize)
+    initialSampleSize(initialSampleSize),
+    seriesOrder(KDEDefaultParams::seriesOrder)
 {
   CheckErrorValues(relError, absError);
   MCProb(mcProb);
@@ -106,7 +122,8 @@ KDE(const KDE& other) :
     mcProb(other.mcProb),
     initialSampleSize(other.initialSampleSize),
     mcEntryCoef(other.mcEntryCoef),
-    mcBreakCoef(other.mcBreakCoef)
+    mcBreakCoef(other.mcBreakCoef),
+    seriesOrder(other.seriesOrder)
 {
   if (trained)
   {
@@ -152,7 +169,8 @@ KDE(KDE&& other) :
     mcProb(other.mcProb),
     initialSampleSize(other.initialSampleSize),
     mcEntryCoef(other.mcEntryCoef),
-    mcBreakCoef(other.mcBreakCoef)
+    mcBreakCoef(other.mcBreakCoef),
+    seriesOrder(other.seriesOrder)
 {
   other.kernel = std::move(KernelType());
   other.metric = std::move(MetricType());
@@ -168,6 +186,7 @@ KDE(KDE&& other) :
   other.initialSampleSize = KDEDefaultParams::initialSampleSize;
   other.mcEntryCoef = KDEDefaultParams::mcEntryCoef;
   other.mcBreakCoef = KDEDefaultParams::mcBreakCoef;
+  other.seriesOrder = KDEDefaultParams::seriesOrder;
 }
 
 template<typename KernelType,
@@ -214,6 +233,7 @@ operator=(KDE other)
   this->initialSampleSize = other.initialSampleSize;
   this->mcEntryCoef = other.mcEntryCoef;
   this->mcBreakCoef = other.mcBreakCoef;
+  this->seriesOrder = other.seriesOrder;
 
   return *this;
 }
@@ -330,7 +350,7 @@ void KDE<KernelType,
          SingleTreeTraversalType>::
 Evaluate(MatType querySet, arma::vec& estimations)
 {
-  if (mode == DUAL_TREE_MODE)
+  if (mode == DUAL_TREE_MODE || mode == FGT_MODE)
   {
     Timer::Start("building_query_tree");
     std::vector<size_t> oldFromNewQueries;
@@ -372,19 +392,19 @@ Evaluate(MatType querySet, arma::vec& estimations)
 
     // Evaluate.
     typedef KDERules<MetricType, KernelType, Tree> RuleType;
-    RuleType rules = RuleType(referenceTree->Dataset(),
-                              querySet,
-                              estimations,
-                              relError,
-                              absError,
-                              mcProb,
-                              initialSampleSize,
-                              mcEntryCoef,
-                              mcBreakCoef,
-                              metric,
-                              kernel,
-                              monteCarlo,
-                              false);
+    RuleType rules(referenceTree->Dataset(),
+                   querySet,
+                   estimations,
+                   relError,
+                   absError,
+                   mcProb,
+                   initialSampleSize,
+                   mcEntryCoef,
+                   mcBreakCoef,
+                   metric,
+                   kernel,
+                   monteCarlo,
+                   false);
 
     // Create traverser.
     SingleTreeTraversalType<RuleType> traverser(rules);
@@ -449,11 +469,11 @@ Evaluate(Tree* queryTree,
   }
 
   // Check the mode is correct.
-  if (mode != DUAL_TREE_MODE)
+  if (mode != DUAL_TREE_MODE && mode != FGT_MODE)
   {
     throw std::invalid_argument("cannot evaluate KDE model: cannot use "
                                 "a query tree when mode is different from "
-                                "dual-tree");
+                                "dual-tree or FGT");
   }
 
   // Clean accumulated alpha if Monte Carlo estimations are available.
@@ -466,27 +486,46 @@ Evaluate(Tree* queryTree,
     Timer::Stop("cleaning_query_tree");
   }
 
+  // Prepare the series expansions in FGT mode.
+  GaussianSeries* series = BuildSeries();
+  if (series)
+  {
+    Timer::Start("building_expansions");
+    BuildExpansions(referenceTree, *series, true);
+    BuildExpansions(queryTree, *series, false);
+    Timer::Stop("building_expansions");
+  }
+
   Timer::Start("computing_kde");
 
   // Evaluate.
   typedef KDERules<MetricType, KernelType, Tree> RuleType;
-  RuleType rules = RuleType(referenceTree->Dataset(),
-                            queryTree->Dataset(),
-                            estimations,
-                            relError,
-                            absError,
-                            mcProb,
-                            initialSampleSize,
-                            mcEntryCoef,
-                            mcBreakCoef,
-                            metric,
-                            kernel,
-                            monteCarlo,
-                            false);
-
-  // Create traverser.
-  DualTreeTraversalType<RuleType> traverser(rules);
+  RuleType rules(referenceTree->Dataset(),
+                 queryTree->Dataset(),
+                 estimations,
+                 relError,
+                 absError,
+                 mcProb,
+                 initialSampleSize,
+                 mcEntryCoef,
+                 mcBreakCoef,
+                 metric,
+                 kernel,
+                 monteCarlo,
+                 false,
+                 series);
+  rules.InitializeAlpha(*referenceTree);
+
+  // Create the traverser.  Independent query subtrees are traversed in
+  // parallel, each with its own share of the error tolerance.
+  tree::ParallelDualTreeTraverser<RuleType, DualTreeTraversalType>
+      traverser(rules);
   traverser.Traverse(*queryTree, *referenceTree);
+  if (series)
+  {
+    EvaluateLocalExpansions(queryTree, *series, estimations);
+    delete series;
+  }
   estimations /= referenceTree->Dataset().n_cols;
   Timer::Stop("computing_kde");
 
@@ -535,28 +574,41 @@ Evaluate(arma::vec& estimations)
     Timer::Stop("cleaning_query_tree");
   }
 
+  // Prepare the series expansions in FGT mode.
+  GaussianSeries* series = BuildSeries();
+  if (series)
+  {
+    Timer::Start("building_expansions");
+    BuildExpansions(referenceTree, *series, true);
+    Timer::Stop("building_expansions");
+  }
+
   Timer::Start("computing_kde");
 
   // Evaluate.
   typedef KDERules<MetricType, KernelType, Tree> RuleType;
-  RuleType rules = RuleType(referenceTree->Dataset(),
-                            referenceTree->Dataset(),
-                            estimations,
-                            relError,
-                            absError,
-                            mcProb,
-                            initialSampleSize,
-                            mcEntryCoef,
-                            mcBreakCoef,
-                            metric,
-                            kernel,
-                            monteCarlo,
-                            true);
-
-  if (mode == DUAL_TREE_MODE)
+  RuleType rules(referenceTree->Dataset(),
+                 referenceTree->Dataset(),
+                 estimations,
+                 relError,
+                 absError,
+                 mcProb,
+                 initialSampleSize,
+                 mcEntryCoef,
+                 mcBreakCoef,
+                 metric,
+                 kernel,
+                 monteCarlo,
+                 true,
+                 series);
+
+  if (mode == DUAL_TREE_MODE || mode == FGT_MODE)
   {
-    // Create traverser.
-    DualTreeTraversalType<RuleType> traverser(rules);
+    // Create the traverser.  Independent query subtrees are traversed in
+    // parallel, each with its own share of the error tolerance.
+    rules.InitializeAlpha(*referenceTree);
+    tree::ParallelDualTreeTraverser<RuleType, DualTreeTraversalType>
+        traverser(rules);
     traverser.Traverse(*referenceTree, *referenceTree);
   }
   else if (mode == SINGLE_TREE_MODE)
@@ -566,6 +618,12 @@ Evaluate(arma::vec& estimations)
       traverser.Traverse(i, *referenceTree);
   }
 
+  if (series)
+  {
+    EvaluateLocalExpansions(referenceTree, *series, estimations);
+    delete series;
+  }
+
   estimations /= referenceTree->Dataset().n_cols;
   // Rearrange if necessary.
   RearrangeEstimations(*oldFromNewReferences, estimations);
@@ -730,6 +788,12 @@ serialize(Archive& ar, const unsigned int version)
     mcBreakCoef = KDEDefaultParams::mcBreakCoef;
   }
 
+  // Backward compatibility: Old versions of KDE did not have FGT mode.
+  if (version > 1)
+    ar & BOOST_SERIALIZATION_NVP(seriesOrder);
+  else if (Archive::is_loading::value)
+    seriesOrder = KDEDefaultParams::seriesOrder;
+
   // If we are loading, clean up memory if necessary.
   if (Archive::is_loading::value)
   {
@@ -777,6 +841,151 @@ CheckErrorValues(const double relError, const double absError)
   }
 }
 
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+GaussianSeries* KDE<KernelType,
+                    MetricType,
+                    MatType,
+                    TreeType,
+                    DualTreeTraversalType,
+                    SingleTreeTraversalType>::
+BuildSeries() const
+{
+  if (mode != FGT_MODE)
+    return NULL;
+
+  if (!std::is_same<MetricType, metric::EuclideanDistance>::value)
+  {
+    throw std::invalid_argument("cannot evaluate KDE model: FGT mode requires "
+                                "the Euclidean distance");
+  }
+
+  if (seriesOrder == 0)
+  {
+    throw std::invalid_argument("cannot evaluate KDE model: the order of the "
+                                "series expansions must be at least 1");
+  }
+
+  return new GaussianSeries(referenceTree->Dataset().n_rows, seriesOrder,
+      SeriesBandwidth(kernel));
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void KDE<KernelType,
+         MetricType,
+         MatType,
+         TreeType,
+         DualTreeTraversalType,
+         SingleTreeTraversalType>::
+BuildExpansions(Tree* tree, const GaussianSeries& series, const bool farField)
+{
+  // Collect all the nodes; their expansions are independent.
+  std::vector<Tree*> nodes(1, tree);
+  for (size_t i = 0; i < nodes.size(); ++i)
+    for (size_t j = 0; j < nodes[i]->NumChildren(); ++j)
+      nodes.push_back(&nodes[i]->Child(j));
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) nodes.size(); ++i)
+  {
+    Tree* node = nodes[i];
+    KDEStat& stat = node->Stat();
+    node->Center(stat.ExpansionCenter());
+    stat.ExpansionRadius() = node->FurthestDescendantDistance();
+    stat.LocalCoefficients().reset();
+    stat.FarFieldCoefficients().reset();
+
+    // A far-field expansion with more terms than points is not worth it.
+    if (farField && node->NumDescendants() > series.NumTerms())
+    {
+      stat.FarFieldCoefficients().zeros(series.NumTerms());
+      for (size_t j = 0; j < node->NumDescendants(); ++j)
+      {
+        series.AccumulateFarField(
+            node->Dataset().unsafe_col(node->Descendant(j)),
+            stat.ExpansionCenter(), stat.FarFieldCoefficients());
+      }
+    }
+  }
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void KDE<KernelType,
+         MetricType,
+         MatType,
+         TreeType,
+         DualTreeTraversalType,
+         SingleTreeTraversalType>::
+EvaluateLocalExpansions(Tree* tree,
+                        const GaussianSeries& series,
+                        arma::vec& estimations)
+{
+  // Push the local expansions down the tree one level at a time, and evaluate
+  // them at the points of the leaves.
+  std::vector<Tree*> level(1, tree);
+  while (!level.empty())
+  {
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) level.size(); ++i)
+    {
+      Tree* node = level[i];
+      KDEStat& stat = node->Stat();
+      if (stat.LocalCoefficients().n_elem == 0)
+        continue;
+
+      if (node->NumChildren() == 0)
+      {
+        for (size_t j = 0; j < node->NumPoints(); ++j)
+        {
+          const size_t point = node->Point(j);
+          estimations[point] += series.EvaluateLocal(stat.LocalCoefficients(),
+              stat.ExpansionCenter(), node->Dataset().unsafe_col(point));
+        }
+      }
+      else
+      {
+        for (size_t j = 0; j < node->NumChildren(); ++j)
+        {
+          KDEStat& childStat = node->Child(j).Stat();
+          if (childStat.LocalCoefficients().n_elem == 0)
+            childStat.LocalCoefficients().zeros(series.NumTerms());
+          series.TranslateLocal(stat.LocalCoefficients(),
+              stat.ExpansionCenter(), childStat.ExpansionCenter(),
+              childStat.LocalCoefficients());
+        }
+      }
+
+      stat.LocalCoefficients().reset();
+    }
+
+    std::vector<Tree*> nextLevel;
+    for (size_t i = 0; i < level.size(); ++i)
+      for (size_t j = 0; j < level[i]->NumChildren(); ++j)
+        nextLevel.push_back(&level[i]->Child(j));
+    level.swap(nextLevel);
+  }
+}
+
 template<typename KernelType,
          typename MetricType,
          typename MatType,
@@ -50,6 +50,12 @@ PROGRAM_INFO("Kernel Density Estimation",
     "use dual-tree algorithm or single-tree algorithm using the " +
     PRINT_PARAM_STRING("algorithm") + " option."
     "\n\n"
+    "With the Gaussian kernel, the 'fgt' algorithm can also be used: this is "
+    "the dual-tree algorithm, which also approximates the kernel sums with "
+    "series expansions (the dual-tree fast Gauss transform).  This is "
+    "typically much faster than the 'dual-tree' algorithm when the bandwidth "
+    "is large, and it has the same error guarantees."
+    "\n\n"
     "Monte Carlo estimations can be used to accelerate the KDE estimate when "
     "the Gaussian Kernel is used. This provides a probabilistic guarantee on "
     "the the error of the resulting KDE instead of an absolute guarantee."
@@ -143,7 +149,7 @@ PARAM_STRING_IN("tree", "Tree to use for the prediction."
     "('kd-tree', 'ball-tree', 'cover-tree', 'octree', 'r-tree').",
     "t", "kd-tree");
 PARAM_STRING_IN("algorithm", "Algorithm to use for the prediction."
-    "('dual-tree', 'single-tree').",
+    "('dual-tree', 'single-tree', 'fgt').",
     "a", "dual-tree");
 PARAM_DOUBLE_IN("rel_error",
                 "Relative error tolerance for the prediction.",
@@ -222,8 +228,8 @@ static void mlpackMain()
       "laplacian", "spherical", "triangular" }, true, "unknown kernel type");
   RequireParamInSet<string>("tree", { "kd-tree", "ball-tree", "cover-tree",
       "octree", "r-tree"}, true, "unknown tree type");
-  RequireParamInSet<string>("algorithm", { "dual-tree", "single-tree"},
-      true, "unknown algorithm");
+  RequireParamInSet<string>("algorithm", { "dual-tree", "single-tree",
+      "fgt" }, true, "unknown algorithm");
   RequireParamValue<double>("rel_error", [](double x){return x >= 0 && x <= 1;},
       true, "relative error must be between 0 and 1");
   RequireParamValue<double>("abs_error", [](double x){return x >= 0;},
@@ -241,6 +247,13 @@ static void mlpackMain()
       "Monte Carlo break coefficient must be greater than 0 and less than "
       "or equal to 1");
 
+  if (CLI::HasParam("reference") && modeStr == "fgt" &&
+      kernelStr != "gaussian")
+  {
+    Log::Fatal << "The 'fgt' algorithm only works with the Gaussian kernel!"
+        << endl;
+  }
+
   KDEModel* kde;
 
   if (CLI::HasParam("reference"))
@@ -281,6 +294,8 @@ static void mlpackMain()
       kde->Mode() = KDEMode::DUAL_TREE_MODE;
     else if (modeStr == "single-tree")
       kde->Mode() = KDEMode::SINGLE_TREE_MODE;
+    else if (modeStr == "fgt")
+      kde->Mode() = KDEMode::FGT_MODE;
   }
   else
   {
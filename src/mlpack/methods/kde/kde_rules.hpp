@@ -14,6 +14,10 @@
 #define MLPACK_METHODS_KDE_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/metrics/block_distances.hpp>
+#include <random>
+
+#include "gaussian_series.hpp"
 
 namespace mlpack {
 namespace kde {
@@ -21,6 +25,22 @@ namespace kde {
 /**
  * A dual-tree traversal Rules class for kernel density estimation.  This
  * contains the Score() and BaseCase() implementations.
+ *
+ * The rules can be used with tree::ParallelDualTreeTraverser.  The error
+ * tolerance that is left over from pruning is accumulated in the statistics
+ * of the query nodes (and per query point), so each query subtree carries its
+ * own share of the error budget and the guarantees are the same as for the
+ * serial traversal.  Each copy of the rules also draws its Monte Carlo samples
+ * from its own random number generator.
+ *
+ * If a GaussianSeries object is given, the dual-tree Score() also tries to
+ * approximate the contribution of the reference node with series expansions
+ * (see GaussianSeries) when the finite difference bound is not tight enough:
+ * either the far-field expansion of the reference node is evaluated at each
+ * query point, or it is translated into the local expansion of the query
+ * node, or the reference points are added directly to the local expansion of
+ * the query node, whichever is cheapest.  The local expansions are stored in
+ * the statistics of the query nodes and must be evaluated after the traversal.
  */
 template<typename MetricType, typename KernelType, typename TreeType>
 class KDERules
@@ -45,6 +65,10 @@ class KDERules
    *                   possible.
    * @param sameSet True if query and reference sets are the same
    *                (monochromatic evaluation).
+   * @param series If not NULL, series expansions of the Gaussian kernel will be
+   *               used in dual-tree scoring when possible.  The expansion
+   *               centers and far-field expansions must be stored in the
+   *               statistics of the trees.
    */
   KDERules(const arma::mat& referenceSet,
            const arma::mat& querySet,
@@ -58,11 +82,40 @@ class KDERules
            MetricType& metric,
            KernelType& kernel,
            const bool monteCarlo,
-           const bool sameSet);
+           const bool sameSet,
+           const GaussianSeries* series = NULL);
+
+  /**
+   * Construct the KDERules object as a copy of another, for the traversal of a
+   * query subtree.  The copy writes into the same density vector and shares
+   * the per-query-point accumulated error tolerances of the given object, but
+   * it has its own traversal information, Monte Carlo random number generator
+   * and counters (which are set to zero).
+   *
+   * @param other KDERules object to copy.
+   */
+  KDERules(const KDERules& other);
+
+  /**
+   * Compute the Monte Carlo alpha of the given reference node and of all its
+   * descendants ahead of time, so that the traversal does not need to modify
+   * the statistics of the reference tree.  This must be called before the
+   * rules are used in a parallel traversal with Monte Carlo estimations.
+   *
+   * @param referenceNode Root of the reference tree.
+   */
+  void InitializeAlpha(TreeType& referenceNode);
 
   //! Base Case.
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  //! Base cases between every query point in [queryBegin, queryEnd) and every
+  //! reference point in [referenceBegin, referenceEnd), computed at once.
+  void BaseCaseBlock(const size_t queryBegin,
+                     const size_t queryEnd,
+                     const size_t referenceBegin,
+                     const size_t referenceEnd);
+
   //! SingleTree Rescore.
   double Score(const size_t queryIndex, TreeType& referenceNode);
 
@@ -89,9 +142,13 @@ class KDERules
 
   //! Get the number of base cases.
   size_t BaseCases() const { return baseCases; }
+  //! Modify the number of base cases.
+  size_t& BaseCases() { return baseCases; }
 
   //! Get the number of scores.
   size_t Scores() const { return scores; }
+  //! Modify the number of scores.
+  size_t& Scores() { return scores; }
 
  private:
   //! Evaluate kernel value of 2 points given their indexes.
@@ -102,9 +159,24 @@ class KDERules
   double EvaluateKernel(const arma::vec& query,
                         const arma::vec& reference) const;
 
+  //! Try to approximate the contribution of the reference node to the query
+  //! node with series expansions.  Returns true if it was approximated.
+  bool SeriesApproximation(TreeType& queryNode,
+                           TreeType& referenceNode,
+                           const double minDistance,
+                           const double errorTolerance,
+                           const bool alreadyDidRefPoint0);
+
   //! Calculate depth alpha for some node.
   double CalculateAlpha(TreeType* node);
 
+  //! Seed the Monte Carlo random number generator of a copy of the rules from
+  //! the first query point it samples for, if it is not seeded yet.
+  void SeedMonteCarlo(const size_t queryIndex);
+
+  //! Return a random integer in [lo, hiExclusive) for Monte Carlo sampling.
+  size_t RandomIndex(const size_t lo, const size_t hiExclusive);
+
   //! The reference set.
   const arma::mat& referenceSet;
 
@@ -145,15 +217,20 @@ class KDERules
   //! Whether Monte Carlo estimations are going to be applied.
   const bool monteCarlo;
 
-  //! Accumulated not used MC alpha values for each query point.
+  //! Accumulated not used MC alpha values for each query point.  This may be
+  //! an alias of the vector of the object this object was copied from.
   arma::vec accumMCAlpha;
 
-  //! Accumulated not used error tolerance for each query point.
+  //! Accumulated not used error tolerance for each query point.  This may be
+  //! an alias of the vector of the object this object was copied from.
   arma::vec accumError;
 
   //! Whether reference and query sets are the same.
   const bool sameSet;
 
+  //! Series expansions of the Gaussian kernel (or NULL).
+  const GaussianSeries* series;
+
   //! Whether the kernel used for the rule is the Gaussian Kernel.
   constexpr static bool kernelIsGaussian =
       std::is_same<KernelType, kernel::GaussianKernel>::value;
@@ -167,6 +244,20 @@ class KDERules
   //! The last reference index.
   size_t lastReferenceIndex;
 
+  //! The distances computed by the last call to BaseCaseBlock().
+  arma::mat blockDistances;
+  //! The norms of each reference leaf, cached by BaseCaseBlock().
+  metric::BlockNormCache<double> referenceNorms;
+
+  //! The seed of the Monte Carlo random number generators.
+  size_t mcSeed;
+
+  //! Whether the Monte Carlo random number generator has been seeded.
+  bool mcSeeded;
+
+  //! The random number generator used for Monte Carlo sampling.
+  std::mt19937 mcGenerator;
+
   //! Traversal information.
   TraversalInfoType traversalInfo;
 
@@ -36,7 +36,8 @@ KDERules<MetricType, KernelType, TreeType>::KDERules(
     MetricType& metric,
     KernelType& kernel,
     const bool monteCarlo,
-    const bool sameSet) :
+    const bool sameSet,
+    const GaussianSeries* series) :
     referenceSet(referenceSet),
     querySet(querySet),
     densities(densities),
@@ -50,9 +51,12 @@ KDERules<MetricType, KernelType, TreeType>::KDERules(
     kernel(kernel),
     monteCarlo(monteCarlo),
     sameSet(sameSet),
+    series(series),
     absErrorTol(absError / referenceSet.n_cols),
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
+    mcSeed(0),
+    mcSeeded(true),
     baseCases(0),
     scores(0)
 {
@@ -61,7 +65,58 @@ KDERules<MetricType, KernelType, TreeType>::KDERules(
 
   // Initialize accumMCAlpha only if Monte Carlo estimations are available.
   if (monteCarlo && kernelIsGaussian)
+  {
     accumMCAlpha = arma::vec(querySet.n_cols, arma::fill::zeros);
+
+    // The generators of the copies of these rules are derived from the global
+    // random seed too.
+    mcSeed = (size_t) math::RandInt(std::numeric_limits<int>::max());
+    mcGenerator.seed((uint32_t) mcSeed);
+  }
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+KDERules<MetricType, KernelType, TreeType>::KDERules(const KDERules& other) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    densities(other.densities),
+    absError(other.absError),
+    relError(other.relError),
+    mcBeta(other.mcBeta),
+    initialSampleSize(other.initialSampleSize),
+    mcAccessCoef(other.mcAccessCoef),
+    mcBreakCoef(other.mcBreakCoef),
+    metric(other.metric),
+    kernel(other.kernel),
+    monteCarlo(other.monteCarlo),
+    accumMCAlpha(const_cast<double*>(other.accumMCAlpha.memptr()),
+        other.accumMCAlpha.n_elem, false, true),
+    accumError(const_cast<double*>(other.accumError.memptr()),
+        other.accumError.n_elem, false, true),
+    sameSet(other.sameSet),
+    series(other.series),
+    absErrorTol(other.absErrorTol),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    mcSeed(other.mcSeed),
+    mcSeeded(false),
+    baseCases(0),
+    scores(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDERules<MetricType, KernelType, TreeType>::InitializeAlpha(
+    TreeType& referenceNode)
+{
+  if (!monteCarlo || !kernelIsGaussian)
+    return;
+
+  // CalculateAlpha() uses the alpha of the parent, so go top-down.
+  CalculateAlpha(&referenceNode);
+  for (size_t i = 0; i < referenceNode.NumChildren(); ++i)
+    InitializeAlpha(referenceNode.Child(i));
 }
 
 //! The base case.
@@ -96,6 +151,42 @@ double KDERules<MetricType, KernelType, TreeType>::BaseCase(
   return distance;
 }
 
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDERules<MetricType, KernelType, TreeType>::BaseCaseBlock(
+    const size_t queryBegin,
+    const size_t queryEnd,
+    const size_t referenceBegin,
+    const size_t referenceEnd)
+{
+  metric::BlockDistances(metric, querySet, queryBegin, queryEnd - queryBegin,
+      referenceSet, referenceBegin, referenceEnd - referenceBegin,
+      blockDistances, referenceNorms);
+
+  for (size_t queryIndex = queryBegin; queryIndex < queryEnd; ++queryIndex)
+  {
+    for (size_t referenceIndex = referenceBegin; referenceIndex < referenceEnd;
+         ++referenceIndex)
+    {
+      // Skip the same pairs that BaseCase() would skip.
+      if ((sameSet && (queryIndex == referenceIndex)) ||
+          ((lastQueryIndex == queryIndex) &&
+           (lastReferenceIndex == referenceIndex)))
+        continue;
+
+      const double distance = blockDistances(queryIndex - queryBegin,
+          referenceIndex - referenceBegin);
+      const double kernelValue = kernel.Evaluate(distance);
+      densities(queryIndex) += kernelValue;
+      accumError(queryIndex) += 2 * relError * kernelValue;
+
+      ++baseCases;
+      lastQueryIndex = queryIndex;
+      lastReferenceIndex = referenceIndex;
+      traversalInfo.LastBaseCase() = distance;
+    }
+  }
+}
+
 //! Single-tree scoring function.
 template<typename MetricType, typename KernelType, typename TreeType>
 inline double KDERules<MetricType, KernelType, TreeType>::
@@ -189,6 +280,8 @@ Score(const size_t queryIndex, TreeType& referenceNode)
            kernelIsGaussian)
   {
     // Monte Carlo probabilistic estimation.
+    SeedMonteCarlo(queryIndex);
+
     // Calculate z using accumulated alpha if possible.
     const double alpha = depthAlpha + accumMCAlpha(queryIndex);
     const boost::math::normal normalDist;
@@ -222,9 +315,9 @@ Score(const size_t queryIndex, TreeType& referenceNode)
         // Sample and evaluate random points from the reference node.
         size_t randomPoint;
         if (alreadyDidRefPoint0)
-          randomPoint = math::RandInt(1, refNumDesc);
+          randomPoint = RandomIndex(1, refNumDesc);
         else
-          randomPoint = math::RandInt(0, refNumDesc);
+          randomPoint = RandomIndex(0, refNumDesc);
 
         sample(oldSize + i) =
             EvaluateKernel(queryIndex, referenceNode.Descendant(randomPoint));
@@ -393,11 +486,24 @@ Score(TreeType& queryNode, TreeType& referenceNode)
     if (kernelIsGaussian && monteCarlo)
       queryStat.AccumAlpha() += depthAlpha;
   }
+  else if (series != NULL &&
+           SeriesApproximation(queryNode, referenceNode, minDistance,
+               errorTolerance, alreadyDidRefPoint0))
+  {
+    // Prune.
+    score = DBL_MAX;
+
+    // Store not used alpha for Monte Carlo.
+    if (kernelIsGaussian && monteCarlo)
+      queryStat.AccumAlpha() += depthAlpha;
+  }
   else if (monteCarlo &&
            refNumDesc >= mcAccessCoef * initialSampleSize &&
            kernelIsGaussian)
   {
     // Monte Carlo probabilistic estimation.
+    SeedMonteCarlo(queryNode.Descendant(0));
+
     // Calculate z using accumulated alpha if possible.
     const double alpha = depthAlpha + queryStat.AccumAlpha();
     const boost::math::normal normalDist;
@@ -439,9 +545,9 @@ Score(TreeType& queryNode, TreeType& referenceNode)
           // Sample and evaluate random points from the reference node.
           size_t randomPoint;
           if (alreadyDidRefPoint0)
-            randomPoint = math::RandInt(1, refNumDesc);
+            randomPoint = RandomIndex(1, refNumDesc);
           else
-            randomPoint = math::RandInt(0, refNumDesc);
+            randomPoint = RandomIndex(0, refNumDesc);
 
           sample(oldSize + i) =
               EvaluateKernel(queryIndex, referenceNode.Descendant(randomPoint));
@@ -544,6 +650,141 @@ EvaluateKernel(const arma::vec& query, const arma::vec& reference) const
   return kernel.Evaluate(metric.Evaluate(query, reference));
 }
 
+template<typename MetricType, typename KernelType, typename TreeType>
+bool KDERules<MetricType, KernelType, TreeType>::SeriesApproximation(
+    TreeType& queryNode,
+    TreeType& referenceNode,
+    const double minDistance,
+    const double errorTolerance,
+    const bool alreadyDidRefPoint0)
+{
+  // Approximation methods.
+  enum { NO_SERIES, FAR_FIELD, FAR_FIELD_TO_LOCAL, DIRECT_LOCAL };
+
+  KDEStat& queryStat = queryNode.Stat();
+  const KDEStat& referenceStat = referenceNode.Stat();
+  const size_t queryNumDesc = queryNode.NumDescendants();
+  const size_t refNumDesc = referenceNode.NumDescendants();
+
+  // The error tolerance for each reference point, relaxed by the leftover
+  // tolerance of the query node as for the finite difference prune.
+  const double maxError = errorTolerance +
+      queryStat.AccumError() / (2 * refNumDesc);
+
+  // Pick the cheapest approximation that is accurate enough, as long as it is
+  // cheaper than the base cases.  Far-field expansions are only built for
+  // large enough reference nodes.
+  int method = NO_SERIES;
+  size_t bestOrder = 0;
+  double bestError = 0.0;
+  double bestCost = (double) queryNumDesc * refNumDesc;
+  double error;
+  if (referenceStat.FarFieldCoefficients().n_elem > 0)
+  {
+    size_t order = series->TruncationOrder(referenceStat.ExpansionRadius(),
+        minDistance, maxError, error);
+    double cost = (double) queryNumDesc * series->NumTerms(order);
+    if (order > 0 && cost < bestCost)
+    {
+      method = FAR_FIELD;
+      bestOrder = order;
+      bestError = error;
+      bestCost = cost;
+    }
+
+    order = series->TranslationOrder(referenceStat.ExpansionRadius(),
+        queryStat.ExpansionRadius(), minDistance, maxError, error);
+    cost = (double) series->NumTerms(order) * series->NumTerms(order);
+    if (order > 0 && cost < bestCost)
+    {
+      method = FAR_FIELD_TO_LOCAL;
+      bestOrder = order;
+      bestError = error;
+      bestCost = cost;
+    }
+  }
+
+  const size_t order = series->TruncationOrder(queryStat.ExpansionRadius(),
+      minDistance, maxError, error);
+  const double cost = (double) refNumDesc * series->NumTerms(order);
+  if (order > 0 && cost < bestCost)
+  {
+    method = DIRECT_LOCAL;
+    bestOrder = order;
+    bestError = error;
+  }
+
+  if (method == NO_SERIES)
+    return false;
+
+  if (method == FAR_FIELD)
+  {
+    for (size_t i = 0; i < queryNumDesc; ++i)
+    {
+      const size_t queryIndex = queryNode.Descendant(i);
+      densities(queryIndex) += series->EvaluateFarField(
+          referenceStat.FarFieldCoefficients(), bestOrder,
+          referenceStat.ExpansionCenter(), querySet.unsafe_col(queryIndex));
+    }
+  }
+  else
+  {
+    if (queryStat.LocalCoefficients().n_elem == 0)
+      queryStat.LocalCoefficients().zeros(series->NumTerms());
+
+    if (method == FAR_FIELD_TO_LOCAL)
+    {
+      series->TranslateFarFieldToLocal(referenceStat.FarFieldCoefficients(),
+          referenceStat.ExpansionCenter(), bestOrder,
+          queryStat.ExpansionCenter(), queryStat.LocalCoefficients());
+    }
+    else
+    {
+      for (size_t i = 0; i < refNumDesc; ++i)
+      {
+        series->AccumulateLocal(
+            referenceSet.unsafe_col(referenceNode.Descendant(i)), bestOrder,
+            queryStat.ExpansionCenter(), queryStat.LocalCoefficients());
+      }
+    }
+  }
+
+  // The expansions include every pair of points, so take out the pairs that
+  // must not be counted: the pair of the first points, if its base case has
+  // been computed already, and each point with itself, if the nodes overlap.
+  // (Overlapping nodes are nested.)
+  if (alreadyDidRefPoint0)
+  {
+    const size_t queryPoint0 = queryNode.Point(0);
+    const size_t referencePoint0 = referenceNode.Point(0);
+    if (!(sameSet && queryPoint0 == referencePoint0))
+      densities(queryPoint0) -= EvaluateKernel(queryPoint0, referencePoint0);
+  }
+
+  if (sameSet)
+  {
+    TreeType* lowerNode = NULL;
+    for (TreeType* node = &queryNode; node != NULL; node = node->Parent())
+      if (node == &referenceNode)
+        lowerNode = &queryNode;
+    for (TreeType* node = &referenceNode; node != NULL; node = node->Parent())
+      if (node == &queryNode)
+        lowerNode = &referenceNode;
+
+    if (lowerNode != NULL)
+    {
+      const double selfKernel = kernel.Evaluate(0.0);
+      for (size_t i = 0; i < lowerNode->NumDescendants(); ++i)
+        densities(lowerNode->Descendant(i)) -= selfKernel;
+    }
+  }
+
+  // Subtract used error tolerance or add extra available tolerance.
+  queryStat.AccumError() -= refNumDesc * (2 * bestError - 2 * errorTolerance);
+
+  return true;
+}
+
 template<typename MetricType, typename KernelType, typename TreeType>
 inline force_inline double KDERules<MetricType, KernelType, TreeType>::
 CalculateAlpha(TreeType* node)
@@ -573,6 +814,27 @@ CalculateAlpha(TreeType* node)
   return stat.MCAlpha();
 }
 
+template<typename MetricType, typename KernelType, typename TreeType>
+inline force_inline void KDERules<MetricType, KernelType, TreeType>::
+SeedMonteCarlo(const size_t queryIndex)
+{
+  // A copy traverses a set of query points that no other copy sees, so seeding
+  // from its first query point gives each copy a different stream.
+  if (!mcSeeded)
+  {
+    mcGenerator.seed((uint32_t) (mcSeed + queryIndex + 1));
+    mcSeeded = true;
+  }
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline force_inline size_t KDERules<MetricType, KernelType, TreeType>::
+RandomIndex(const size_t lo, const size_t hiExclusive)
+{
+  std::uniform_int_distribution<size_t> dist(lo, hiExclusive - 1);
+  return dist(mcGenerator);
+}
+
 //! Clean rules base case.
 template<typename TreeType>
 inline force_inline
@@ -29,7 +29,8 @@ class KDEStat
       mcBeta(0),
       mcAlpha(0),
       accumAlpha(0),
-      accumError(0)
+      accumError(0),
+      expansionRadius(0)
   { /* Nothing to do.*/ }
 
   //! Initialization for a fully initialized node.
@@ -38,7 +39,8 @@ class KDEStat
       mcBeta(0),
       mcAlpha(0),
       accumAlpha(0),
-      accumError(0)
+      accumError(0),
+      expansionRadius(0)
   { /* Nothing to do. */ }
 
   //! Get accumulated Monte Carlo alpha of the node.
@@ -65,6 +67,30 @@ class KDEStat
   //! Modify Monte Carlo alpha of the node.
   inline double& MCAlpha() { return mcAlpha; }
 
+  //! Get the center of the series expansions of the node.
+  inline const arma::vec& ExpansionCenter() const { return expansionCenter; }
+
+  //! Modify the center of the series expansions of the node.
+  inline arma::vec& ExpansionCenter() { return expansionCenter; }
+
+  //! Get the radius of the points of the node around the expansion center.
+  inline double ExpansionRadius() const { return expansionRadius; }
+
+  //! Modify the radius of the points of the node around the expansion center.
+  inline double& ExpansionRadius() { return expansionRadius; }
+
+  //! Get the far-field expansion of the points of the node (may be empty).
+  inline const arma::vec& FarFieldCoefficients() const { return farField; }
+
+  //! Modify the far-field expansion of the points of the node.
+  inline arma::vec& FarFieldCoefficients() { return farField; }
+
+  //! Get the local expansion of the node (may be empty).
+  inline const arma::vec& LocalCoefficients() const { return local; }
+
+  //! Modify the local expansion of the node.
+  inline arma::vec& LocalCoefficients() { return local; }
+
   //! Serialize the statistic to/from an archive.
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int version)
@@ -111,6 +137,21 @@ class KDEStat
 
   //! Accumulated not used error tolerance in the current node.
   double accumError;
+
+  // The series expansions are rebuilt before every evaluation in FGT mode, so
+  // they are not serialized.
+
+  //! Center of the series expansions.
+  arma::vec expansionCenter;
+
+  //! Radius of the points of the node around expansionCenter.
+  double expansionRadius;
+
+  //! Far-field (Hermite) expansion of the points of the node.
+  arma::vec farField;
+
+  //! Local (Taylor) expansion of the contributions to the points of the node.
+  arma::vec local;
 };
 
 } // namespace kde
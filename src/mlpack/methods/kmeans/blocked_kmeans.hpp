@@ -0,0 +1,139 @@
+/**
+ * @file blocked_kmeans.hpp
+ *
+ * An implementation of a step of the Lloyd algorithm for k-means clustering
+ * that computes the distances between blocks of points and blocks of centroids
+ * with matrix multiplications, using OpenMP for parallelization over multiple
+ * threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This is an implementation of a single iteration of Lloyd's algorithm for
+ * k-means, like NaiveKMeans, that does the same O(kN) work in a way that suits
+ * the hardware much better.  The points and the centroids are split into
+ * blocks, and for the Euclidean and squared Euclidean distances the distances
+ * between a block of points and a block of centroids are computed with one
+ * matrix multiplication (which Armadillo hands to the BLAS), using
+ *
+ * ||x - c||^2 = ||x||^2 + ||c||^2 - 2 x^T c.
+ *
+ * The squared norms of the centroids are computed once per iteration, and since
+ * ||x||^2 is the same for every centroid, it is not needed to find the closest
+ * centroid at all.  The points and the centroids are first centered on the mean
+ * of the centroids, since otherwise ||c||^2 and 2 x^T c nearly cancel for data
+ * far from the origin.  For any other metric, the distances of each block are
+ * computed with MetricType::Evaluate().
+ *
+ * Each thread keeps its own partial sums of the new centroids; at the end of
+ * the iteration they are added together pairwise, in a tree of depth
+ * log2(threads), instead of one thread after another.
+ *
+ * When a point is (numerically) at the same distance from two centroids, it
+ * may be assigned to a different one than NaiveKMeans would choose.
+ *
+ * If your intention is to run the full k-means algorithm, you are looking for
+ * the mlpack::kmeans::KMeans class; this class can be used by setting its
+ * LloydStepType template parameter to BlockedKMeans.
+ *
+ * @param MetricType Type of metric used with this implementation.
+ * @param MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class BlockedKMeans
+{
+ public:
+  /**
+   * Construct the BlockedKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   */
+  BlockedKMeans(const MatType& dataset, MetricType& metric);
+
+  /**
+   * Run a single iteration of the Lloyd algorithm, updating the given centroids
+   * into the newCentroids matrix.  If any cluster is empty (that is, if any
+   * cluster has no points assigned to it), then the centroid associated with
+   * that cluster may be filled with invalid data (it will be corrected later).
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points in each cluster at the end of the iteration.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+
+  //! The number of points in each block.
+  static const size_t pointBlockSize = 256;
+  //! The number of centroids in each block.
+  static const size_t centroidBlockSize = 1024;
+
+  /**
+   * Fill scores(j, i) with a value that orders the centroids
+   * [centroidBegin, centroidEnd) by their distance to the point
+   * (pointBegin + i), for the Euclidean and squared Euclidean distances; this
+   * is ||c - m||^2 - 2 (x - m)^T (c - m), where m is the center.  Sparse points
+   * are not centered (that would make them dense), so for them only the
+   * centroids are.
+   */
+  template<bool TakeRoot>
+  void BlockScores(const metric::LMetric<2, TakeRoot>& /* metric */,
+                   const arma::mat& centroids,
+                   const arma::mat& centeredCentroids,
+                   const arma::vec& center,
+                   const arma::vec& centroidNorms,
+                   const size_t centroidBegin,
+                   const size_t centroidEnd,
+                   const size_t pointBegin,
+                   const size_t pointEnd,
+                   arma::mat& scores);
+
+  /**
+   * Fill scores(j, i) with the distance between the centroid
+   * (centroidBegin + j) and the point (pointBegin + i), for any other metric.
+   */
+  template<typename OtherMetricType>
+  void BlockScores(const OtherMetricType& /* metric */,
+                   const arma::mat& centroids,
+                   const arma::mat& centeredCentroids,
+                   const arma::vec& center,
+                   const arma::vec& centroidNorms,
+                   const size_t centroidBegin,
+                   const size_t centroidEnd,
+                   const size_t pointBegin,
+                   const size_t pointEnd,
+                   arma::mat& scores);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "blocked_kmeans_impl.hpp"
+
+#endif
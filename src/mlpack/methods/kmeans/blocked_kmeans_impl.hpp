@@ -0,0 +1,225 @@
+/**
+ * @file blocked_kmeans_impl.hpp
+ *
+ * An implementation of a step of the Lloyd algorithm for k-means clustering
+ * that computes the distances between blocks of points and blocks of centroids
+ * with matrix multiplications, using OpenMP for parallelization over multiple
+ * threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "blocked_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+BlockedKMeans<MetricType, MatType>::BlockedKMeans(const MatType& dataset,
+                                                  MetricType& metric) :
+    dataset(dataset),
+    metric(metric),
+    distanceCalculations(0)
+{ /* Nothing to do. */ }
+
+// Run a single iteration.
+template<typename MetricType, typename MatType>
+double BlockedKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
+                                                   arma::mat& newCentroids,
+                                                   arma::Col<size_t>& counts)
+{
+  // The centroids centered on their mean, and their squared norms, for the
+  // Euclidean distances.
+  const arma::vec center = arma::mean(centroids, 1);
+  arma::mat centeredCentroids(centroids);
+  centeredCentroids.each_col() -= center;
+  const arma::vec centroidNorms =
+      arma::sum(arma::square(centeredCentroids), 0).t();
+
+  const size_t numBlocks = (dataset.n_cols + pointBlockSize - 1) /
+      pointBlockSize;
+
+  // The partial sums of each thread.
+  std::vector<arma::mat> threadCentroids;
+  std::vector<arma::Col<size_t>> threadCounts;
+
+  #pragma omp parallel
+  {
+    size_t thread = 0;
+    size_t numThreads = 1;
+    #ifdef HAS_OPENMP
+      thread = omp_get_thread_num();
+      numThreads = omp_get_num_threads();
+    #endif
+
+    #pragma omp single
+    {
+      threadCentroids.resize(numThreads);
+      threadCounts.resize(numThreads);
+    }
+
+    arma::mat& localCentroids = threadCentroids[thread];
+    arma::Col<size_t>& localCounts = threadCounts[thread];
+    localCentroids.zeros(centroids.n_rows, centroids.n_cols);
+    localCounts.zeros(centroids.n_cols);
+
+    arma::mat scores;
+    arma::vec minScores;
+    arma::Col<size_t> closestClusters;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t block = 0; block < (omp_size_t) numBlocks; ++block)
+    {
+      const size_t pointBegin = block * pointBlockSize;
+      const size_t pointEnd = std::min(pointBegin + pointBlockSize,
+          (size_t) dataset.n_cols);
+
+      minScores.set_size(pointEnd - pointBegin);
+      minScores.fill(std::numeric_limits<double>::infinity());
+      closestClusters.set_size(pointEnd - pointBegin);
+      closestClusters.fill(centroids.n_cols); // Invalid value.
+
+      // Find the closest centroid to each point of the block, one block of
+      // centroids at a time.
+      for (size_t centroidBegin = 0; centroidBegin < centroids.n_cols;
+           centroidBegin += centroidBlockSize)
+      {
+        const size_t centroidEnd = std::min(centroidBegin + centroidBlockSize,
+            (size_t) centroids.n_cols);
+        BlockScores(metric, centroids, centeredCentroids, center,
+            centroidNorms, centroidBegin, centroidEnd, pointBegin, pointEnd,
+            scores);
+
+        for (size_t i = 0; i < scores.n_cols; ++i)
+        {
+          for (size_t j = 0; j < scores.n_rows; ++j)
+          {
+            if (scores(j, i) < minScores[i])
+            {
+              minScores[i] = scores(j, i);
+              closestClusters[i] = centroidBegin + j;
+            }
+          }
+        }
+      }
+
+      // Update the centroids of the points.
+      for (size_t i = 0; i < closestClusters.n_elem; ++i)
+      {
+        Log::Assert(closestClusters[i] != centroids.n_cols);
+
+        localCentroids.unsafe_col(closestClusters[i]) +=
+            dataset.col(pointBegin + i);
+        localCounts(closestClusters[i])++;
+      }
+    }
+
+    // Combine the partial sums of the threads pairwise.  All threads take the
+    // same number of steps, so every thread reaches every barrier.
+    for (size_t step = 1; step < numThreads; step *= 2)
+    {
+      if (thread % (2 * step) == 0 && thread + step < numThreads)
+      {
+        localCentroids += threadCentroids[thread + step];
+        localCounts += threadCounts[thread + step];
+      }
+
+      #pragma omp barrier
+    }
+  }
+
+  newCentroids = std::move(threadCentroids[0]);
+  counts = std::move(threadCounts[0]);
+
+  // Now normalize the centroid.
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+    if (counts(i) != 0)
+      newCentroids.col(i) /= counts(i);
+
+  distanceCalculations += centroids.n_cols * dataset.n_cols;
+
+  // Calculate cluster distortion for this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+template<typename MetricType, typename MatType>
+template<bool TakeRoot>
+void BlockedKMeans<MetricType, MatType>::BlockScores(
+    const metric::LMetric<2, TakeRoot>& /* metric */,
+    const arma::mat& /* centroids */,
+    const arma::mat& centeredCentroids,
+    const arma::vec& center,
+    const arma::vec& centroidNorms,
+    const size_t centroidBegin,
+    const size_t centroidEnd,
+    const size_t pointBegin,
+    const size_t pointEnd,
+    arma::mat& scores)
+{
+  // Both blocks are centered on the same point, so the products are as large
+  // as the spread of the data and not as its offset (see
+  // metric::BlockDistances()).
+  const arma::span centroidSpan(centroidBegin, centroidEnd - 1);
+  if (arma::is_SpMat<MatType>::value)
+  {
+    // Centering sparse points would make them dense, so only the centroids
+    // are centered:
+    //   ||c - m||^2 - 2 (x - m)^T (c - m)
+    //       = ||c - m||^2 + 2 m^T (c - m) - 2 x^T (c - m).
+    scores = -2.0 * centeredCentroids.cols(centroidSpan).t() *
+        dataset.cols(pointBegin, pointEnd - 1);
+    scores.each_col() += centroidNorms(centroidSpan) +
+        2.0 * centeredCentroids.cols(centroidSpan).t() * center;
+  }
+  else
+  {
+    arma::mat pointBlock(dataset.cols(pointBegin, pointEnd - 1));
+    pointBlock.each_col() -= center;
+    scores = -2.0 * centeredCentroids.cols(centroidSpan).t() * pointBlock;
+    scores.each_col() += centroidNorms(centroidSpan);
+  }
+}
+
+template<typename MetricType, typename MatType>
+template<typename OtherMetricType>
+void BlockedKMeans<MetricType, MatType>::BlockScores(
+    const OtherMetricType& /* metric */,
+    const arma::mat& centroids,
+    const arma::mat& /* centeredCentroids */,
+    const arma::vec& /* center */,
+    const arma::vec& /* centroidNorms */,
+    const size_t centroidBegin,
+    const size_t centroidEnd,
+    const size_t pointBegin,
+    const size_t pointEnd,
+    arma::mat& scores)
+{
+  scores.set_size(centroidEnd - centroidBegin, pointEnd - pointBegin);
+  for (size_t i = 0; i < scores.n_cols; ++i)
+  {
+    for (size_t j = 0; j < scores.n_rows; ++j)
+    {
+      scores(j, i) = metric.Evaluate(dataset.col(pointBegin + i),
+          centroids.unsafe_col(centroidBegin + j));
+    }
+  }
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
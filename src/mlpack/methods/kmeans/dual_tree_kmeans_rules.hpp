@@ -15,6 +15,7 @@
 #define MLPACK_METHODS_KMEANS_DUAL_TREE_KMEANS_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/metrics/block_distances.hpp>
 
 namespace mlpack {
 namespace kmeans {
@@ -34,6 +35,10 @@ class DualTreeKMeansRules
                       std::vector<bool>& visited);
 
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
+  void BaseCaseBlock(const size_t queryBegin,
+                     const size_t queryEnd,
+                     const size_t referenceBegin,
+                     const size_t referenceEnd);
 
   double Score(const size_t queryIndex, TreeType& referenceNode);
   double Score(TreeType& queryNode, TreeType& referenceNode);
@@ -77,6 +82,11 @@ class DualTreeKMeansRules
   size_t lastQueryIndex;
   size_t lastReferenceIndex;
   size_t lastBaseCase;
+
+  //! The distances computed by the last call to BaseCaseBlock().
+  arma::mat blockDistances;
+  //! The norms of each centroid leaf, cached by BaseCaseBlock().
+  metric::BlockNormCache<double> centroidNorms;
 };
 
 } // namespace kmeans
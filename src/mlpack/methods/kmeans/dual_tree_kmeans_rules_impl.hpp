@@ -89,6 +89,56 @@ inline force_inline double DualTreeKMeansRules<MetricType, TreeType>::BaseCase(
   return distance;
 }
 
+template<typename MetricType, typename TreeType>
+void DualTreeKMeansRules<MetricType, TreeType>::BaseCaseBlock(
+    const size_t queryBegin,
+    const size_t queryEnd,
+    const size_t referenceBegin,
+    const size_t referenceEnd)
+{
+  metric::BlockDistances(metric, dataset, queryBegin, queryEnd - queryBegin,
+      centroids, referenceBegin, referenceEnd - referenceBegin,
+      blockDistances, centroidNorms);
+
+  for (size_t queryIndex = queryBegin; queryIndex < queryEnd; ++queryIndex)
+  {
+    if (prunedPoints[queryIndex])
+      continue;
+
+    for (size_t referenceIndex = referenceBegin; referenceIndex < referenceEnd;
+         ++referenceIndex)
+    {
+      // If we have already performed this base case, then do not perform it
+      // again.
+      if ((lastQueryIndex == queryIndex) &&
+          (lastReferenceIndex == referenceIndex))
+        continue;
+
+      visited[queryIndex] = true;
+      ++baseCases;
+      const double distance = blockDistances(queryIndex - queryBegin,
+          referenceIndex - referenceBegin);
+
+      if (distance < upperBounds[queryIndex])
+      {
+        lowerBounds[queryIndex] = upperBounds[queryIndex];
+        upperBounds[queryIndex] = distance;
+        assignments[queryIndex] =
+            (tree::TreeTraits<TreeType>::RearrangesDataset) ?
+            oldFromNewCentroids[referenceIndex] : referenceIndex;
+      }
+      else if (distance < lowerBounds[queryIndex])
+      {
+        lowerBounds[queryIndex] = distance;
+      }
+
+      lastQueryIndex = queryIndex;
+      lastReferenceIndex = referenceIndex;
+      lastBaseCase = distance;
+    }
+  }
+}
+
 template<typename MetricType, typename TreeType>
 inline double DualTreeKMeansRules<MetricType, TreeType>::Score(
     const size_t queryIndex,
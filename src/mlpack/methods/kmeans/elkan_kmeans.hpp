@@ -26,7 +26,9 @@ class ElkanKMeans
 
   /**
    * Run a single iteration of Elkan's algorithm, updating the given centroids
-   * into the newCentroids matrix.
+   * into the newCentroids matrix.  The points are processed in parallel with
+   * OpenMP; the assignments do not depend on the number of threads, and the
+   * centroids only up to the rounding of their sums.
    *
    * @param centroids Current cluster centroids.
    * @param newCentroids New cluster centroids.
@@ -34,10 +34,6 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
                                                  arma::mat& newCentroids,
                                                  arma::Col<size_t>& counts)
 {
-  // Clear new centroids.
-  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
-  counts.zeros(centroids.n_cols);
-
   // At the beginning of the iteration, we must compute the distances between
   // all centers.  This is O(k^2).
   clusterDistances.set_size(centroids.n_cols, centroids.n_cols);
@@ -46,9 +42,6 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   // being the closest cluster centroid.
   clusterDistances.diag().fill(DBL_MAX);
 
-  // Initially set r(x) to true.
-  std::vector<bool> mustRecalculate(dataset.n_cols, true);
-
   // If this is the first iteration, we must reset all the bounds.
   if (lowerBounds.n_rows != centroids.n_cols)
   {
@@ -62,36 +55,63 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   }
 
   // Step 1: for all centers, compute between-cluster distances.  For all
-  // centers, compute s(c) = 1/2 min d(c, c').
-  for (size_t i = 0; i < centroids.n_cols; ++i)
+  // centers, compute s(c) = 1/2 min d(c, c').  Each pair is computed by one
+  // thread only.
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) centroids.n_cols; ++i)
   {
     for (size_t j = i + 1; j < centroids.n_cols; ++j)
     {
       const double distance = metric.Evaluate(centroids.col(i),
                                               centroids.col(j));
-      distanceCalculations++;
       clusterDistances(i, j) = distance;
       clusterDistances(j, i) = distance;
     }
   }
+  distanceCalculations += centroids.n_cols * (centroids.n_cols - 1) / 2;
 
   // Now find the closest cluster to each other cluster.  We multiply by 0.5 so
   // that this is equivalent to s(c) for each cluster c.
   minClusterDistances = 0.5 * arma::min(clusterDistances).t();
 
-  // Now loop over all points, and see which ones need to be updated.
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  // Each thread sums the points it assigns into its own centroids and counts.
+  // The points are split statically, so the sums (and the result) only depend
+  // on the number of threads.
+  size_t numThreads = 1;
+  #ifdef HAS_OPENMP
+    numThreads = omp_get_max_threads();
+  #endif
+  std::vector<arma::mat> threadCentroids(numThreads);
+  std::vector<arma::Col<size_t>> threadCounts(numThreads);
+  size_t pointDistanceCalculations = 0;
+
+  #pragma omp parallel reduction(+: pointDistanceCalculations)
   {
-    // Step 2: identify all points such that u(x) <= s(c(x)).
-    if (upperBounds(i) <= minClusterDistances(assignments[i]))
-    {
-      // No change needed.  This point must still belong to that cluster.
-      counts(assignments[i])++;
-      newCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
-      continue;
-    }
-    else
+    size_t thread = 0;
+    #ifdef HAS_OPENMP
+      thread = omp_get_thread_num();
+    #endif
+    arma::mat& localCentroids = threadCentroids[thread];
+    arma::Col<size_t>& localCounts = threadCounts[thread];
+    localCentroids.zeros(centroids.n_rows, centroids.n_cols);
+    localCounts.zeros(centroids.n_cols);
+
+    // Now loop over all points, and see which ones need to be updated.
+    #pragma omp for schedule(static)
+    for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
     {
+      // Step 2: identify all points such that u(x) <= s(c(x)).
+      if (upperBounds(i) <= minClusterDistances(assignments[i]))
+      {
+        // No change needed.  This point must still belong to that cluster.
+        localCounts(assignments[i])++;
+        localCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
+        continue;
+      }
+
+      // Initially set r(x) to true.
+      bool mustRecalculate = true;
+
       for (size_t c = 0; c < centroids.n_cols; ++c)
       {
         // Step 3: for all remaining points x and centers c such that c != c(x),
@@ -108,13 +128,13 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
         // Step 3a: if r(x) then compute d(x, c(x)) and assign r(x) = false.
         // Otherwise, d(x, c(x)) = u(x).
         double dist;
-        if (mustRecalculate[i])
+        if (mustRecalculate)
         {
-          mustRecalculate[i] = false;
+          mustRecalculate = false;
           dist = metric.Evaluate(dataset.col(i), centroids.col(assignments[i]));
           lowerBounds(assignments[i], i) = dist;
           upperBounds(i) = dist;
-          distanceCalculations++;
+          pointDistanceCalculations++;
 
           // Check if we can prune again.
           if (upperBounds(i) <= lowerBounds(c, i))
@@ -136,7 +156,7 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
           const double pointDist = metric.Evaluate(dataset.col(i),
                                                    centroids.col(c));
           lowerBounds(c, i) = pointDist;
-          distanceCalculations++;
+          pointDistanceCalculations++;
           if (pointDist < dist)
           {
             upperBounds(i) = pointDist;
@@ -144,13 +164,31 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
           }
         }
       }
+
+      // At this point, we know the new cluster assignment.
+      // Step 4: for each center c, let m(c) be the mean of the points assigned
+      // to c.
+      localCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
+      localCounts[assignments[i]]++;
     }
+  }
+  distanceCalculations += pointDistanceCalculations;
 
-    // At this point, we know the new cluster assignment.
-    // Step 4: for each center c, let m(c) be the mean of the points assigned to
-    // c.
-    newCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
-    counts[assignments[i]]++;
+  // Combine the sums of the threads, always in the same order.
+  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  counts.zeros(centroids.n_cols);
+  #pragma omp parallel for
+  for (omp_size_t c = 0; c < (omp_size_t) centroids.n_cols; ++c)
+  {
+    for (size_t t = 0; t < numThreads; ++t)
+    {
+      // Threads that were not started have no sums.
+      if (threadCounts[t].n_elem == 0)
+        continue;
+
+      newCentroids.col(c) += threadCentroids[t].col(c);
+      counts[c] += threadCounts[t][c];
+    }
   }
 
   // Now, normalize and calculate the distance each cluster has moved.
@@ -166,7 +204,8 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
     distanceCalculations++;
   }
 
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
   {
     // Step 5: for each point x and center c, assign
     //   l(x, c) = max { l(x, c) - d(c, m(c)), 0 }.
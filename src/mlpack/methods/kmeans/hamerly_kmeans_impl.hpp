@@ -33,8 +33,6 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
                                                    arma::mat& newCentroids,
                                                    arma::Col<size_t>& counts)
 {
-  size_t hamerlyPruned = 0;
-
   // If this is the first iteration, we need to set all the bounds.
   if (minClusterDistances.n_elem != centroids.n_cols)
   {
@@ -45,85 +43,125 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
     minClusterDistances.set_size(centroids.n_cols);
   }
 
-  // Reset new centroids.
-  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
-  counts.zeros(centroids.n_cols);
-
-  // Calculate minimum intra-cluster distance for each cluster.
-  minClusterDistances.fill(DBL_MAX);
-  for (size_t i = 0; i < centroids.n_cols; ++i)
+  // Calculate minimum intra-cluster distance for each cluster.  Each pair is
+  // computed by one thread only, and the minima are taken afterwards.
+  arma::mat clusterDistances(centroids.n_cols, centroids.n_cols);
+  clusterDistances.diag().fill(DBL_MAX);
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) centroids.n_cols; ++i)
   {
     for (size_t j = i + 1; j < centroids.n_cols; ++j)
     {
       const double dist = metric.Evaluate(centroids.col(i), centroids.col(j)) /
           2.0;
-      ++distanceCalculations;
-
-      // Update bounds, if this intra-cluster distance is smaller.
-      if (dist < minClusterDistances(i))
-        minClusterDistances(i) = dist;
-      if (dist < minClusterDistances(j))
-        minClusterDistances(j) = dist;
+      clusterDistances(i, j) = dist;
+      clusterDistances(j, i) = dist;
     }
   }
+  distanceCalculations += centroids.n_cols * (centroids.n_cols - 1) / 2;
+  minClusterDistances = arma::min(clusterDistances).t();
+
+  // Each thread sums the points it assigns into its own centroids and counts.
+  // The points are split statically, so the sums (and the result) only depend
+  // on the number of threads.
+  size_t numThreads = 1;
+  #ifdef HAS_OPENMP
+    numThreads = omp_get_max_threads();
+  #endif
+  std::vector<arma::mat> threadCentroids(numThreads);
+  std::vector<arma::Col<size_t>> threadCounts(numThreads);
+  size_t pointDistanceCalculations = 0;
+  size_t hamerlyPruned = 0;
 
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  #pragma omp parallel reduction(+: pointDistanceCalculations, hamerlyPruned)
   {
-    const double m = std::max(minClusterDistances(assignments[i]),
-                              lowerBounds(i));
-
-    // First bound test.
-    if (upperBounds(i) <= m)
+    size_t thread = 0;
+    #ifdef HAS_OPENMP
+      thread = omp_get_thread_num();
+    #endif
+    arma::mat& localCentroids = threadCentroids[thread];
+    arma::Col<size_t>& localCounts = threadCounts[thread];
+    localCentroids.zeros(centroids.n_rows, centroids.n_cols);
+    localCounts.zeros(centroids.n_cols);
+
+    #pragma omp for schedule(static)
+    for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
     {
-      ++hamerlyPruned;
-      newCentroids.col(assignments[i]) += dataset.col(i);
-      ++counts(assignments[i]);
-      continue;
-    }
-
-    // Tighten upper bound.
-    upperBounds(i) = metric.Evaluate(dataset.col(i),
-                                     centroids.col(assignments[i]));
-    ++distanceCalculations;
-
-    // Second bound test.
-    if (upperBounds(i) <= m)
-    {
-      newCentroids.col(assignments[i]) += dataset.col(i);
-      ++counts(assignments[i]);
-      continue;
-    }
+      const double m = std::max(minClusterDistances(assignments[i]),
+                                lowerBounds(i));
 
-    // The bounds failed.  So test against all other clusters.
-    // This is Hamerly's Point-All-Ctrs() function from the paper.
-    // We have to reset the lower bound first.
-    lowerBounds(i) = DBL_MAX;
-    for (size_t c = 0; c < centroids.n_cols; ++c)
-    {
-      if (c == assignments[i])
+      // First bound test.
+      if (upperBounds(i) <= m)
+      {
+        ++hamerlyPruned;
+        localCentroids.col(assignments[i]) += dataset.col(i);
+        ++localCounts(assignments[i]);
         continue;
+      }
 
-      const double dist = metric.Evaluate(dataset.col(i), centroids.col(c));
+      // Tighten upper bound.
+      upperBounds(i) = metric.Evaluate(dataset.col(i),
+                                       centroids.col(assignments[i]));
+      ++pointDistanceCalculations;
 
-      // Is this a better cluster?  At this point, upperBounds[i] = d(i, c(i)).
-      if (dist < upperBounds(i))
+      // Second bound test.
+      if (upperBounds(i) <= m)
       {
-        // lowerBounds holds the second closest cluster.
-        lowerBounds(i) = upperBounds(i);
-        upperBounds(i) = dist;
-        assignments[i] = c;
+        localCentroids.col(assignments[i]) += dataset.col(i);
+        ++localCounts(assignments[i]);
+        continue;
       }
-      else if (dist < lowerBounds(i))
+
+      // The bounds failed.  So test against all other clusters.
+      // This is Hamerly's Point-All-Ctrs() function from the paper.
+      // We have to reset the lower bound first.
+      lowerBounds(i) = DBL_MAX;
+      for (size_t c = 0; c < centroids.n_cols; ++c)
       {
-        // This is a closer second-closest cluster.
-        lowerBounds(i) = dist;
+        if (c == assignments[i])
+          continue;
+
+        const double dist = metric.Evaluate(dataset.col(i), centroids.col(c));
+
+        // Is this a better cluster?  At this point, upperBounds[i] =
+        // d(i, c(i)).
+        if (dist < upperBounds(i))
+        {
+          // lowerBounds holds the second closest cluster.
+          lowerBounds(i) = upperBounds(i);
+          upperBounds(i) = dist;
+          assignments[i] = c;
+        }
+        else if (dist < lowerBounds(i))
+        {
+          // This is a closer second-closest cluster.
+          lowerBounds(i) = dist;
+        }
       }
+      pointDistanceCalculations += centroids.n_cols - 1;
+
+      // Update new centroids.
+      localCentroids.col(assignments[i]) += dataset.col(i);
+      ++localCounts(assignments[i]);
     }
-    distanceCalculations += centroids.n_cols - 1;
+  }
+  distanceCalculations += pointDistanceCalculations;
 
-    // Update new centroids.
-    newCentroids.col(assignments[i]) += dataset.col(i);
-    ++counts(assignments[i]);
+  // Combine the sums of the threads, always in the same order.
+  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  counts.zeros(centroids.n_cols);
+  #pragma omp parallel for
+  for (omp_size_t c = 0; c < (omp_size_t) centroids.n_cols; ++c)
+  {
+    for (size_t t = 0; t < numThreads; ++t)
+    {
+      // Threads that were not started have no sums.
+      if (threadCounts[t].n_elem == 0)
+        continue;
+
+      newCentroids.col(c) += threadCentroids[t].col(c);
+      counts(c) += threadCounts[t](c);
+    }
   }
 
   // Normalize centroids and calculate cluster movement (contains parts of
@@ -158,7 +196,8 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   }
 
   // Now update bounds (lines 3-8 of Update-Bounds()).
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
   {
     upperBounds(i) += centroidMovements(assignments[i]);
     if (assignments[i] == furthestMovingCluster)
@@ -63,7 +63,7 @@ namespace kmeans /** K-Means clustering. */ {
  * @tparam LloydStepType Implementation of single Lloyd step to use.
  *
  * @see RandomPartition, SampleInitialization, RefinedStart, AllowEmptyClusters,
- *      MaxVarianceNewCluster, NaiveKMeans, ElkanKMeans
+ *      MaxVarianceNewCluster, NaiveKMeans, ElkanKMeans, MiniBatchKMeans
  */
 template<typename MetricType = metric::EuclideanDistance,
          typename InitialPartitionPolicy = SampleInitialization,
@@ -155,6 +155,51 @@ class KMeans
                const bool initialAssignmentGuess = false,
                const bool initialCentroidGuess = false);
 
+  /**
+   * Perform k-means clustering on the data with the given, already constructed
+   * Lloyd step object, returning the centroids of each cluster.  This is useful
+   * when the Lloyd step type takes more parameters than the dataset and the
+   * metric (like MiniBatchKMeans).  lloydStep must have been constructed with
+   * data and a metric equivalent to Metric().
+   *
+   * @param data Dataset to cluster.
+   * @param clusters Number of clusters to compute.
+   * @param centroids Matrix in which centroids are stored.
+   * @param lloydStep Lloyd step object to use for each iteration.
+   * @param initialGuess If true, then it is assumed that centroids contains the
+   *      initial cluster centroids.
+   */
+  void Cluster(const MatType& data,
+               const size_t clusters,
+               arma::mat& centroids,
+               LloydStepType<MetricType, MatType>& lloydStep,
+               const bool initialGuess = false);
+
+  /**
+   * Perform k-means clustering on the data with the given, already constructed
+   * Lloyd step object, returning a list of cluster assignments and also the
+   * centroids of each cluster.  The initial guesses work like in the other
+   * overload of Cluster() that returns assignments and centroids.  lloydStep
+   * must have been constructed with data and a metric equivalent to Metric().
+   *
+   * @param data Dataset to cluster.
+   * @param clusters Number of clusters to compute.
+   * @param assignments Vector to store cluster assignments in.
+   * @param centroids Matrix in which centroids are stored.
+   * @param lloydStep Lloyd step object to use for each iteration.
+   * @param initialAssignmentGuess If true, then it is assumed that assignments
+   *      has a list of initial cluster assignments.
+   * @param initialCentroidGuess If true, then it is assumed that centroids
+   *      contains the initial centroids of each cluster.
+   */
+  void Cluster(const MatType& data,
+               const size_t clusters,
+               arma::Row<size_t>& assignments,
+               arma::mat& centroids,
+               LloydStepType<MetricType, MatType>& lloydStep,
+               const bool initialAssignmentGuess = false,
+               const bool initialCentroidGuess = false);
+
   //! Get the maximum number of iterations.
   size_t MaxIterations() const { return maxIterations; }
   //! Set the maximum number of iterations.
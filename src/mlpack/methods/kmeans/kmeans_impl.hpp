@@ -149,6 +149,31 @@ Cluster(const MatType& data,
         const size_t clusters,
         arma::mat& centroids,
         const bool initialGuess)
+{
+  LloydStepType<MetricType, MatType> lloydStep(data, metric);
+  Cluster(data, clusters, centroids, lloydStep, initialGuess);
+}
+
+/**
+ * Perform k-means clustering on the data with the given Lloyd step object,
+ * returning the centroids of each cluster.
+ */
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+Cluster(const MatType& data,
+        const size_t clusters,
+        arma::mat& centroids,
+        LloydStepType<MetricType, MatType>& lloydStep,
+        const bool initialGuess)
 {
   // Make sure we have more points than clusters.
   if (clusters > data.n_cols)
@@ -207,7 +232,6 @@ Cluster(const MatType& data,
 
   size_t iteration = 0;
 
-  LloydStepType<MetricType, MatType> lloydStep(data, metric);
   arma::mat centroidsOther;
   double cNorm;
 
@@ -284,6 +308,34 @@ Cluster(const MatType& data,
         arma::mat& centroids,
         const bool initialAssignmentGuess,
         const bool initialCentroidGuess)
+{
+  LloydStepType<MetricType, MatType> lloydStep(data, metric);
+  Cluster(data, clusters, assignments, centroids, lloydStep,
+      initialAssignmentGuess, initialCentroidGuess);
+}
+
+/**
+ * Perform k-means clustering on the data with the given Lloyd step object,
+ * returning a list of cluster assignments and the centroids of each cluster.
+ */
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+Cluster(const MatType& data,
+        const size_t clusters,
+        arma::Row<size_t>& assignments,
+        arma::mat& centroids,
+        LloydStepType<MetricType, MatType>& lloydStep,
+        const bool initialAssignmentGuess,
+        const bool initialCentroidGuess)
 {
   // Now, the initial assignments.  First determine if they are necessary.
   if (initialAssignmentGuess)
@@ -308,7 +360,7 @@ Cluster(const MatType& data,
         centroids.col(i) /= counts[i];
   }
 
-  Cluster(data, clusters, centroids,
+  Cluster(data, clusters, centroids, lloydStep,
       initialAssignmentGuess || initialCentroidGuess);
 
   // Calculate final assignments in parallel over the entire dataset.
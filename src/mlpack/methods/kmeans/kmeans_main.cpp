@@ -17,6 +17,8 @@
 #include "allow_empty_clusters.hpp"
 #include "kill_empty_clusters.hpp"
 #include "refined_start.hpp"
+#include "blocked_kmeans.hpp"
+#include "mini_batch_kmeans.hpp"
 #include "elkan_kmeans.hpp"
 #include "hamerly_kmeans.hpp"
 #include "pelleg_moore_kmeans.hpp"
@@ -51,12 +53,21 @@ PROGRAM_INFO("K-Means Clustering",
     "\n\n"
     "There are several options available for the algorithm used for each Lloyd "
     "iteration, specified with the " + PRINT_PARAM_STRING("algorithm") + " "
-    " option.  The standard O(kN) approach can be used ('naive').  Other "
+    " option.  The standard O(kN) approach can be used ('naive'), as well as "
+    "the same approach with the distances computed in blocks by matrix "
+    "multiplications ('blocked'), which is usually much faster.  Other "
     "options include the Pelleg-Moore tree-based algorithm ('pelleg-moore'), "
     "Elkan's triangle-inequality based algorithm ('elkan'), Hamerly's "
     "modification to Elkan's algorithm ('hamerly'), the dual-tree k-means "
-    "algorithm ('dualtree'), and the dual-tree k-means algorithm using the "
-    "cover tree ('dualtree-covertree')."
+    "algorithm ('dualtree'), the dual-tree k-means algorithm using the "
+    "cover tree ('dualtree-covertree'), and mini-batch k-means ('minibatch')."
+    "  Mini-batch k-means gives an approximate clustering: each iteration only "
+    "uses a random batch of points, whose size is given by " +
+    PRINT_PARAM_STRING("batch_size") + ", so the running time is bounded by "
+    "the batch size and " + PRINT_PARAM_STRING("max_iterations") + " and "
+    "not by the size of the dataset.  For very large datasets it should be "
+    "used with " + PRINT_PARAM_STRING("allow_empty_clusters") + ", since the "
+    "default empty cluster strategy passes over the whole dataset."
     "\n\n"
     "The behavior for when an empty cluster is encountered can be modified with"
     " the " + PRINT_PARAM_STRING("allow_empty_clusters") + " option.  When "
@@ -141,8 +152,10 @@ PARAM_DOUBLE_IN("percentage", "Percentage of dataset to use for each refined "
     "start sampling (use when --refined_start is specified).", "p", 0.02);
 
 PARAM_STRING_IN("algorithm", "Algorithm to use for the Lloyd iteration "
-    "('naive', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', or "
-    "'dualtree-covertree').", "a", "naive");
+    "('naive', 'blocked', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', "
+    "'dualtree-covertree', or 'minibatch').", "a", "naive");
+PARAM_INT_IN("batch_size", "Number of points in each batch of mini-batch "
+    "k-means (use with '--algorithm minibatch').", "b", 1024);
 
 // Given the type of initial partition policy, figure out the empty cluster
 // policy and run k-means.
@@ -213,8 +226,9 @@ template<typename InitialPartitionPolicy, typename EmptyClusterPolicy>
 void FindLloydStepType(const InitialPartitionPolicy& ipp)
 {
   RequireParamInSet<string>("algorithm", { "elkan", "hamerly", "pelleg-moore",
-      "dualtree", "dualtree-covertree", "naive" }, true, "unknown k-means "
-      "algorithm");
+      "dualtree", "dualtree-covertree", "naive", "blocked", "minibatch" },
+      true,
+      "unknown k-means algorithm");
 
   const string algorithm = CLI::GetParam<string>("algorithm");
   if (algorithm == "elkan")
@@ -232,6 +246,62 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
         CoverTreeDualTreeKMeans>(ipp);
   else if (algorithm == "naive")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, NaiveKMeans>(ipp);
+  else if (algorithm == "blocked")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, BlockedKMeans>(ipp);
+  else if (algorithm == "minibatch")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
+        MiniBatchKMeans>(ipp);
+}
+
+// Run the clustering with a Lloyd step type that needs no parameters.
+template<typename KMeansType>
+void ClusterDataset(KMeansType& kmeans,
+                    const arma::mat& dataset,
+                    const size_t clusters,
+                    arma::Row<size_t>* assignments,
+                    arma::mat& centroids,
+                    const bool initialCentroidGuess)
+{
+  ReportIgnoredParam("batch_size", "mini-batch k-means is not being used");
+
+  if (assignments)
+  {
+    kmeans.Cluster(dataset, clusters, *assignments, centroids, false,
+        initialCentroidGuess);
+  }
+  else
+  {
+    kmeans.Cluster(dataset, clusters, centroids, initialCentroidGuess);
+  }
+}
+
+// Run the clustering with mini-batch k-means, which needs the batch size.
+template<typename InitialPartitionPolicy, typename EmptyClusterPolicy>
+void ClusterDataset(KMeans<metric::EuclideanDistance,
+                           InitialPartitionPolicy,
+                           EmptyClusterPolicy,
+                           MiniBatchKMeans>& kmeans,
+                    const arma::mat& dataset,
+                    const size_t clusters,
+                    arma::Row<size_t>* assignments,
+                    arma::mat& centroids,
+                    const bool initialCentroidGuess)
+{
+  RequireParamValue<int>("batch_size", [](int x) { return x > 0; }, true,
+      "batch size must be positive");
+
+  MiniBatchKMeans<metric::EuclideanDistance, arma::mat> lloydStep(dataset,
+      kmeans.Metric(), (size_t) CLI::GetParam<int>("batch_size"));
+  if (assignments)
+  {
+    kmeans.Cluster(dataset, clusters, *assignments, centroids, lloydStep,
+        false, initialCentroidGuess);
+  }
+  else
+  {
+    kmeans.Cluster(dataset, clusters, centroids, lloydStep,
+        initialCentroidGuess);
+  }
 }
 
 // Given the template parameters, sanitize/load input and run k-means.
@@ -293,8 +363,8 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
   {
     // We need to get the assignments.
     arma::Row<size_t> assignments;
-    kmeans.Cluster(dataset, clusters, assignments, centroids,
-        false, initialCentroidGuess);
+    ClusterDataset(kmeans, dataset, clusters, &assignments, centroids,
+        initialCentroidGuess);
     Timer::Stop("clustering");
 
     // Now figure out what to do with our results.
@@ -340,7 +410,8 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
   else
   {
     // Just save the centroids.
-    kmeans.Cluster(dataset, clusters, centroids, initialCentroidGuess);
+    ClusterDataset(kmeans, dataset, clusters, NULL, centroids,
+        initialCentroidGuess);
     Timer::Stop("clustering");
   }
 
@@ -0,0 +1,178 @@
+/**
+ * @file mini_batch_kmeans.hpp
+ *
+ * An implementation of mini-batch k-means (Sculley, 2010) as a Lloyd step type
+ * for KMeans, which can also be fed with data incrementally or from a batch
+ * source.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * An implementation of mini-batch k-means, as described in the following
+ * paper:
+ *
+ * @code
+ * @inproceedings{sculley2010web,
+ *   title={Web-scale k-means clustering},
+ *   author={Sculley, D.},
+ *   booktitle={Proceedings of the 19th International Conference on World Wide
+ *       Web (WWW '10)},
+ *   pages={1177--1178},
+ *   year={2010}
+ * }
+ * @endcode
+ *
+ * Instead of using the whole dataset, each iteration samples a batch of points
+ * uniformly (with replacement), finds the closest centroid of every point of
+ * the batch, and then moves each centroid towards each of its points in turn
+ * with a per-centroid learning rate of 1 / (number of points the centroid has
+ * seen so far).  So each centroid is the running mean of the points it was
+ * given, and the cost of an iteration depends only on the batch size and the
+ * number of clusters, not on the size of the dataset.  The result is an
+ * approximation of the k-means solution.
+ *
+ * This class can be used as the LloydStepType of KMeans; to choose a batch size
+ * other than the default, construct it and pass it to the KMeans::Cluster()
+ * overload that takes a Lloyd step object.  The counts that Iterate() gives
+ * are the number of points each centroid has seen over all iterations, so the
+ * EmptyClusterPolicy is only used for centroids that have not been given any
+ * point yet.  (MaxVarianceNewCluster makes a pass over the whole dataset each
+ * time it is used, so for very large datasets AllowEmptyClusters is a better
+ * choice.)  The residual that Iterate() returns shrinks as the learning rates
+ * shrink, but it does not need to reach zero, so the maximum number of
+ * iterations of KMeans should be set to bound the running time.
+ *
+ * The step can also be used on its own for continuous clustering: Update()
+ * takes a new batch of points (or a whole batch source, such as a
+ * data::MappedBatchSource) and moves the given centroids, keeping the number
+ * of points seen by each centroid between calls.  The centroids must be
+ * initialized beforehand, for instance with an InitialPartitionPolicy on the
+ * first batch.
+ *
+ * @code
+ * extern arma::mat firstBatch, secondBatch;
+ * metric::EuclideanDistance metric;
+ * MiniBatchKMeans<metric::EuclideanDistance, arma::mat> step(metric, 1000);
+ *
+ * arma::mat centroids;
+ * SampleInitialization().Cluster(firstBatch, 10, centroids);
+ * step.Update(firstBatch, centroids);
+ * step.Update(secondBatch, centroids);
+ * @endcode
+ *
+ * @tparam MetricType Type of metric used with this implementation.
+ * @tparam MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class MiniBatchKMeans
+{
+ public:
+  /**
+   * Construct the MiniBatchKMeans object with the given dataset and metric, to
+   * be used by KMeans.
+   *
+   * @param dataset Dataset to sample the batches from.
+   * @param metric Instantiated metric.
+   * @param batchSize Number of points in each batch.
+   */
+  MiniBatchKMeans(const MatType& dataset,
+                  MetricType& metric,
+                  const size_t batchSize = 1024);
+
+  /**
+   * Construct the MiniBatchKMeans object without a dataset, for use with
+   * Update() only.
+   *
+   * @param metric Instantiated metric.
+   * @param batchSize Number of points in each batch read from a batch source.
+   */
+  MiniBatchKMeans(MetricType& metric, const size_t batchSize = 1024);
+
+  /**
+   * Run a single iteration of mini-batch k-means on a batch sampled from the
+   * dataset, updating the given centroids into the newCentroids matrix.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points seen by each cluster in all iterations so
+   *     far.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  /**
+   * Move the given centroids with all of the points of the given batch, which
+   * may come from outside the dataset.  The residual (the norm of the change
+   * of the centroids) is returned.
+   *
+   * @param batch New points to use.
+   * @param centroids Centroids to update.
+   */
+  template<typename BatchType>
+  double Update(const BatchType& batch, arma::mat& centroids);
+
+  /**
+   * Make one pass over the points of the given batch source (for instance a
+   * data::MappedBatchSource or data::CSVBatchSource), reading blocks of
+   * BatchSize() points in a random order and moving the given centroids with
+   * each block.  Only one block is held in memory at a time.  The residual of
+   * the whole pass is returned.
+   *
+   * @param source Batch source to read the points from.
+   * @param centroids Centroids to update.
+   */
+  template<typename SourceType>
+  double UpdateFromSource(SourceType& source, arma::mat& centroids);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the number of points seen by each cluster so far.
+  const arma::Col<size_t>& ClusterCounts() const { return clusterCounts; }
+
+ private:
+  //! The dataset, if any.
+  const MatType* dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+  //! The number of points in each batch.
+  size_t batchSize;
+
+  //! The number of points seen by each cluster so far.
+  arma::Col<size_t> clusterCounts;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+
+  /**
+   * Move the centroids with the points of the given indices, in that order.
+   */
+  template<typename PointsType>
+  void Step(const PointsType& points,
+            const arma::Col<size_t>& indices,
+            arma::mat& centroids);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "mini_batch_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,195 @@
+/**
+ * @file mini_batch_kmeans_impl.hpp
+ *
+ * Implementation of mini-batch k-means (Sculley, 2010).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mini_batch_kmeans.hpp"
+
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+MiniBatchKMeans<MetricType, MatType>::MiniBatchKMeans(const MatType& dataset,
+                                                      MetricType& metric,
+                                                      const size_t batchSize) :
+    dataset(&dataset),
+    metric(metric),
+    batchSize(batchSize),
+    distanceCalculations(0)
+{
+  if (batchSize == 0)
+    throw std::invalid_argument("MiniBatchKMeans: batch size must be positive");
+}
+
+template<typename MetricType, typename MatType>
+MiniBatchKMeans<MetricType, MatType>::MiniBatchKMeans(MetricType& metric,
+                                                      const size_t batchSize) :
+    dataset(NULL),
+    metric(metric),
+    batchSize(batchSize),
+    distanceCalculations(0)
+{
+  if (batchSize == 0)
+    throw std::invalid_argument("MiniBatchKMeans: batch size must be positive");
+}
+
+// Run a single iteration.
+template<typename MetricType, typename MatType>
+double MiniBatchKMeans<MetricType, MatType>::Iterate(
+    const arma::mat& centroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts)
+{
+  if (dataset == NULL)
+  {
+    throw std::logic_error("MiniBatchKMeans::Iterate(): no dataset given; use "
+        "Update() instead");
+  }
+
+  // Sample the batch uniformly, with replacement.
+  std::uniform_int_distribution<size_t> pointDist(0, dataset->n_cols - 1);
+  arma::Col<size_t> indices(batchSize);
+  for (size_t i = 0; i < batchSize; ++i)
+    indices[i] = pointDist(math::randGen);
+
+  newCentroids = centroids;
+  Step(*dataset, indices, newCentroids);
+  counts = clusterCounts;
+
+  // Calculate cluster distortion for this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+template<typename MetricType, typename MatType>
+template<typename BatchType>
+double MiniBatchKMeans<MetricType, MatType>::Update(const BatchType& batch,
+                                                    arma::mat& centroids)
+{
+  if (batch.n_cols == 0)
+    return 0.0;
+
+  const arma::mat oldCentroids(centroids);
+  Step(batch, arma::regspace<arma::Col<size_t>>(0, batch.n_cols - 1),
+      centroids);
+
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(oldCentroids.col(i), centroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+template<typename MetricType, typename MatType>
+template<typename SourceType>
+double MiniBatchKMeans<MetricType, MatType>::UpdateFromSource(
+    SourceType& source,
+    arma::mat& centroids)
+{
+  const size_t numPoints = source.NumPoints();
+  const size_t numBlocks = (numPoints + batchSize - 1) / batchSize;
+
+  // Visit the blocks in a random order, so that the centroids are not pulled
+  // towards whatever order the points are stored in.
+  std::vector<size_t> order(numBlocks);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), math::randGen);
+
+  const arma::mat oldCentroids(centroids);
+  arma::Mat<typename SourceType::ElemType> block;
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    const size_t begin = order[b] * batchSize;
+    const size_t count = std::min(batchSize, numPoints - begin);
+    source.Block(begin, count, block);
+
+    Step(arma::conv_to<arma::mat>::from(block),
+        arma::regspace<arma::Col<size_t>>(0, count - 1), centroids);
+  }
+
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(oldCentroids.col(i), centroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+template<typename MetricType, typename MatType>
+template<typename PointsType>
+void MiniBatchKMeans<MetricType, MatType>::Step(
+    const PointsType& points,
+    const arma::Col<size_t>& indices,
+    arma::mat& centroids)
+{
+  if (clusterCounts.n_elem != centroids.n_cols)
+    clusterCounts.zeros(centroids.n_cols);
+
+  // Find the closest centroid to each point of the batch, with the centroids
+  // as they were at the start of the batch.
+  arma::Col<size_t> closestClusters(indices.n_elem);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) indices.n_elem; ++i)
+  {
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+    {
+      const double distance = metric.Evaluate(points.col(indices[i]),
+          centroids.unsafe_col(j));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    Log::Assert(closestCluster != centroids.n_cols);
+    closestClusters[i] = closestCluster;
+  }
+
+  distanceCalculations += indices.n_elem * centroids.n_cols;
+
+  // Now take a gradient step for each point, with a learning rate of one over
+  // the number of points its centroid has seen.
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    const size_t cluster = closestClusters[i];
+    const double eta = 1.0 / (double) (++clusterCounts[cluster]);
+
+    centroids.col(cluster) *= (1.0 - eta);
+    centroids.col(cluster) += eta * points.col(indices[i]);
+  }
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
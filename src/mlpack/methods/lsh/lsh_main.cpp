@@ -17,6 +17,7 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 
 #include "lsh_search.hpp"
+#include "simhash_search.hpp"
 
 using namespace std;
 using namespace mlpack;
@@ -55,6 +56,26 @@ PROGRAM_INFO("K-Approximate-Nearest-Neighbor Search with LSH",
     "different from run to run.  Thus, the " + PRINT_PARAM_STRING("seed") +
     " parameter can be specified to set the random seed."
     "\n\n"
+    "To find neighbors for the cosine distance instead, set " +
+    PRINT_PARAM_STRING("hash_type") + " to 'simhash'.  Then each point is "
+    "hashed to a binary signature of " + PRINT_PARAM_STRING("bits") + " bits, "
+    "and the neighbors are the points whose signatures have the smallest "
+    "Hamming distances; if " + PRINT_PARAM_STRING("rerank") + " is set, that "
+    "many candidates are reranked with the exact cosine distance.  SimHash "
+    "models are saved to " + PRINT_PARAM_STRING("output_simhash_model") +
+    " and loaded from " + PRINT_PARAM_STRING("input_simhash_model") + ".  "
+    "Reranking needs the reference set, so a SimHash model only keeps the "
+    "reference set if " + PRINT_PARAM_STRING("rerank") + " is set when it is "
+    "trained, or if " + PRINT_PARAM_STRING("store_reference") + " is given; "
+    "otherwise the model only holds the signatures, and it cannot be used "
+    "with " + PRINT_PARAM_STRING("rerank") + " later.  For "
+    "example, the following will find 5 neighbors of each point in " +
+    PRINT_DATASET("input") + " with 128-bit signatures, reranking 50 "
+    "candidates:"
+    "\n\n" +
+    PRINT_CALL("lsh", "k", 5, "reference", "input", "hash_type", "simhash",
+        "bits", 128, "rerank", 50, "neighbors", "neighbors") +
+    "\n\n"
     "This program also has many other parameters to control its functionality;"
     " see the parameter-specific documentation for more information.",
     SEE_ALSO("@knn", "#knn"),
@@ -64,7 +85,9 @@ PROGRAM_INFO("K-Approximate-Nearest-Neighbor Search with LSH",
     SEE_ALSO("Locality-sensitive hashing scheme based on p-stable distributions"
         " (pdf)", "http://mlpack.org/papers/lsh.pdf"),
     SEE_ALSO("mlpack::neighbor::LSHSearch C++ class documentation",
-        "@doxygen/classmlpack_1_1neighbor_1_1LSHSearch.html"));
+        "@doxygen/classmlpack_1_1neighbor_1_1LSHSearch.html"),
+    SEE_ALSO("mlpack::neighbor::SimHashSearch C++ class documentation",
+        "@doxygen/classmlpack_1_1neighbor_1_1SimHashSearch.html"));
 
 // Define our input parameters that this program will take.
 PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
@@ -75,6 +98,10 @@ PARAM_UMATRIX_OUT("neighbors", "Matrix to output neighbors into.", "n");
 PARAM_MODEL_IN(LSHSearch<>, "input_model", "Input LSH model.", "m");
 PARAM_MODEL_OUT(LSHSearch<>, "output_model", "Output for trained LSH model.",
     "M");
+PARAM_MODEL_IN(SimHashSearch, "input_simhash_model", "Input SimHash model.",
+    "");
+PARAM_MODEL_OUT(SimHashSearch, "output_simhash_model", "Output for trained "
+    "SimHash model.", "");
 
 // For testing recall.
 PARAM_UMATRIX_IN("true_neighbors", "Matrix of true neighbors to compute "
@@ -97,6 +124,17 @@ PARAM_INT_IN("bucket_size", "The size of a bucket in the second level hash.",
     "B", 500);
 PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 
+PARAM_STRING_IN("hash_type", "Type of hashing: 'euclidean' (p-stable LSH, for "
+    "the Euclidean distance) or 'simhash' (binary signatures, for the cosine "
+    "distance).", "", "euclidean");
+PARAM_INT_IN("bits", "The number of bits of each SimHash signature.", "", 64);
+PARAM_INT_IN("rerank", "The number of candidates with the smallest Hamming "
+    "distances to rerank with the exact cosine distance, for SimHash; if 0, "
+    "the Hamming distances are used.", "", 0);
+PARAM_FLAG("store_reference", "If set, a trained SimHash model keeps the "
+    "reference set, so that it can be used with 'rerank' later.  The reference "
+    "set is always kept if 'rerank' is set.", "");
+
 static void mlpackMain()
 {
   if (CLI::GetParam<int>("seed") != 0)
@@ -114,20 +152,38 @@ static void mlpackMain()
       "second hash size must be greater than 0");
   RequireParamValue<int>("bucket_size", [](int x) { return x > 0; }, true,
       "bucket size must be greater than 0");
+  RequireParamValue<int>("projections", [](int x) { return x > 0; }, true,
+      "number of projections must be greater than 0");
+  RequireParamValue<int>("tables", [](int x) { return x > 0; }, true,
+      "number of tables must be greater than 0");
+  RequireParamValue<int>("num_probes", [](int x) { return x >= 0; }, true,
+      "number of probes must not be negative");
+  RequireParamValue<int>("bits", [](int x) { return x > 0; }, true,
+      "number of bits must be greater than 0");
+  RequireParamValue<int>("rerank", [](int x) { return x >= 0; }, true,
+      "number of candidates to rerank must not be negative");
+  RequireParamInSet<string>("hash_type", { "euclidean", "simhash" }, true,
+      "unknown hash type");
 
   size_t k = CLI::GetParam<int>("k");
   size_t secondHashSize = CLI::GetParam<int>("second_hash_size");
   size_t bucketSize = CLI::GetParam<int>("bucket_size");
 
-  RequireOnlyOnePassed({ "input_model", "reference" }, true);
-  RequireAtLeastOnePassed({ "neighbors", "distances", "output_model" }, false,
-      "no results will be saved");
+  RequireOnlyOnePassed({ "input_model", "input_simhash_model", "reference" },
+      true);
+  RequireAtLeastOnePassed({ "neighbors", "distances", "output_model",
+      "output_simhash_model" }, false, "no results will be saved");
   if (CLI::HasParam("k"))
   {
     RequireAtLeastOnePassed({ "query", "reference" }, true, "must pass set to "
         "search");
   }
 
+  // A SimHash model is used if one is given, or if one should be trained.
+  const bool simhash = CLI::HasParam("input_simhash_model") ||
+      (CLI::HasParam("reference") &&
+       CLI::GetParam<string>("hash_type") == "simhash");
+
   if (CLI::HasParam("input_model") && CLI::HasParam("k") &&
       !CLI::HasParam("query"))
   {
@@ -139,11 +195,45 @@ static void mlpackMain()
   ReportIgnoredParam({{ "k", false }}, "neighbors");
   ReportIgnoredParam({{ "k", false }}, "distances");
 
+  ReportIgnoredParam({{ "k", false }}, "num_probes");
+  ReportIgnoredParam({{ "k", false }}, "rerank");
+
+  ReportIgnoredParam({{ "reference", false }}, "hash_type");
+  ReportIgnoredParam({{ "reference", false }}, "projections");
+  ReportIgnoredParam({{ "reference", false }}, "tables");
   ReportIgnoredParam({{ "reference", false }}, "bucket_size");
   ReportIgnoredParam({{ "reference", false }}, "second_hash_size");
   ReportIgnoredParam({{ "reference", false }}, "hash_width");
+  ReportIgnoredParam({{ "reference", false }}, "bits");
+  ReportIgnoredParam({{ "reference", false }}, "store_reference");
 
-  if (CLI::HasParam("input_model") && !CLI::HasParam("k"))
+  // Each type of model ignores the parameters of the other.
+  if (CLI::HasParam("reference"))
+  {
+    if (simhash)
+    {
+      ReportIgnoredParam("projections", "SimHash is used");
+      ReportIgnoredParam("tables", "SimHash is used");
+      ReportIgnoredParam("bucket_size", "SimHash is used");
+      ReportIgnoredParam("second_hash_size", "SimHash is used");
+      ReportIgnoredParam("hash_width", "SimHash is used");
+    }
+    else
+    {
+      ReportIgnoredParam("bits", "SimHash is not used");
+      ReportIgnoredParam("store_reference", "SimHash is not used");
+    }
+  }
+  if (CLI::HasParam("k"))
+  {
+    if (simhash)
+      ReportIgnoredParam("num_probes", "SimHash is used");
+    else
+      ReportIgnoredParam("rerank", "SimHash is not used");
+  }
+
+  if ((CLI::HasParam("input_model") || CLI::HasParam("input_simhash_model")) &&
+      !CLI::HasParam("k"))
   {
     Log::Warn << PRINT_PARAM_STRING("k") << " not passed; no search will be "
         << "performed!" << std::endl;
@@ -158,19 +248,41 @@ static void mlpackMain()
   const size_t numTables = CLI::GetParam<int>("tables");
   const double hashWidth = CLI::GetParam<double>("hash_width");
   const size_t numProbes = (size_t) CLI::GetParam<int>("num_probes");
+  const size_t numBits = (size_t) CLI::GetParam<int>("bits");
+  const size_t numCandidates = (size_t) CLI::GetParam<int>("rerank");
 
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
-  if (hashWidth == 0.0)
+  if (simhash)
+    Log::Info << "Using SimHash with " << numBits << "-bit signatures." << endl;
+  else if (hashWidth == 0.0)
     Log::Info << "Using LSH with " << numProj << " projections (K) and " <<
         numTables << " tables (L) with default hash width." << endl;
   else
     Log::Info << "Using LSH with " << numProj << " projections (K) and " <<
         numTables << " tables (L) with hash width(r): " << hashWidth << endl;
 
-  LSHSearch<>* allkann;
-  if (CLI::HasParam("reference"))
+  LSHSearch<>* allkann = NULL;
+  SimHashSearch* simhashSearch = NULL;
+  if (CLI::HasParam("reference") && simhash)
+  {
+    simhashSearch = new SimHashSearch();
+    referenceData = std::move(CLI::GetParam<arma::mat>("reference"));
+    Log::Info << "Using reference data from '"
+        << CLI::GetPrintableParam<arma::mat>("reference") << "' ("
+        << referenceData.n_rows << " x " << referenceData.n_cols << ")."
+        << endl;
+
+    // The reference set is only needed for reranking.
+    const bool storeReferenceSet = CLI::HasParam("store_reference") ||
+        (CLI::HasParam("k") && numCandidates > 0);
+
+    Timer::Start("hash_building");
+    simhashSearch->Train(std::move(referenceData), numBits, storeReferenceSet);
+    Timer::Stop("hash_building");
+  }
+  else if (CLI::HasParam("reference"))
   {
     allkann = new LSHSearch<>();
     referenceData = std::move(CLI::GetParam<arma::mat>("reference"));
@@ -184,6 +296,19 @@ static void mlpackMain()
         secondHashSize, bucketSize);
     Timer::Stop("hash_building");
   }
+  else if (simhash)
+  {
+    simhashSearch = CLI::GetParam<SimHashSearch*>("input_simhash_model");
+    if (CLI::HasParam("k") && numCandidates > 0 &&
+        simhashSearch->ReferenceSet().n_cols != simhashSearch->NumPoints())
+    {
+      Log::Fatal << "Cannot rerank with the SimHash model from '"
+          << CLI::GetPrintableParam<SimHashSearch*>("input_simhash_model")
+          << "': it does not store the reference set!  Train the model with "
+          << PRINT_PARAM_STRING("rerank") << " or "
+          << PRINT_PARAM_STRING("store_reference") << "." << endl;
+    }
+  }
   else // We must have an input model.
   {
     allkann = CLI::GetParam<LSHSearch<>*>("input_model");
@@ -200,7 +325,15 @@ static void mlpackMain()
           << CLI::GetPrintableParam<arma::mat>("query") << "' ("
           << queryData.n_rows << " x " << queryData.n_cols << ")." << endl;
 
-      allkann->Search(queryData, k, neighbors, distances, 0, numProbes);
+      if (simhash)
+        simhashSearch->Search(queryData, k, neighbors, distances,
+            numCandidates);
+      else
+        allkann->Search(queryData, k, neighbors, distances, 0, numProbes);
+    }
+    else if (simhash)
+    {
+      simhashSearch->Search(k, neighbors, distances, numCandidates);
     }
     else
     {
@@ -229,7 +362,7 @@ static void mlpackMain()
         << endl;
 
     // Compute recall and print it.
-    double recallPercentage = 100 * allkann->ComputeRecall(neighbors,
+    double recallPercentage = 100 * LSHSearch<>::ComputeRecall(neighbors,
         trueNeighbors);
 
     Log::Info << "Recall: " << recallPercentage << endl;
@@ -241,5 +374,8 @@ static void mlpackMain()
     CLI::GetParam<arma::mat>("distances") = std::move(distances);
     CLI::GetParam<arma::Mat<size_t>>("neighbors") = std::move(neighbors);
   }
-  CLI::GetParam<LSHSearch<>*>("output_model") = allkann;
+  if (simhash)
+    CLI::GetParam<SimHashSearch*>("output_simhash_model") = simhashSearch;
+  else
+    CLI::GetParam<LSHSearch<>*>("output_model") = allkann;
 }
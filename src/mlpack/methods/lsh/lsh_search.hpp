@@ -302,20 +302,24 @@ class LSHSearch
    * hash table and all the points (if any) in those buckets are collected as
    * the potential neighbor candidates.
    *
-   * @param queryPoint The query point currently being processed.
+   * @param queryProjection The projections of the query currently being
+   *    processed on the projections of the tables to search (numProj values
+   *    per table, without the offsets).
    * @param referenceIndices The list of neighbor candidates obtained from
    *    hashing the query into all the hash tables and eventually into
-   *    multiple buckets of the second hash table.
-   * @param numTablesToSearch The number of tables to perform the search in. If
-   *    0, all tables are searched.
+   *    multiple buckets of the second hash table, in increasing order.
+   * @param numTablesToSearch The number of tables to perform the search in.
    * @param T The number of additional probing bins for multiprobe LSH. If 0,
    *    single-probe is used.
+   * @param candidates Scratch bitset with one (false) entry per reference
+   *    point, used to find each candidate only once.  It is false again when
+   *    the function returns.
    */
-  template<typename VecType>
-  void ReturnIndicesFromTable(const VecType& queryPoint,
+  void ReturnIndicesFromTable(const arma::vec& queryProjection,
                               arma::uvec& referenceIndices,
-                              size_t numTablesToSearch,
-                              const size_t T) const;
+                              const size_t numTablesToSearch,
+                              const size_t T,
+                              std::vector<bool>& candidates) const;
 
   /**
    * This is a helper function that computes the distance of the query to the
@@ -414,6 +418,11 @@ class LSHSearch
    */
   bool PerturbationValid(const std::vector<bool>& A) const;
 
+  //! The number of reference points that Train() hashes together.
+  static const size_t TrainBlockSize = 1024;
+  //! The number of query points that Search() hashes together.
+  static const size_t SearchBlockSize = 64;
+
   //! Reference dataset.
   arma::mat referenceSet;
 
@@ -15,6 +15,10 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/math/random.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace neighbor {
 
@@ -256,90 +260,157 @@ void LSHSearch<SortPolicy>::Train(arma::mat referenceSet,
   // size_t, otherwise negative numbers are cast to 0.
   arma::Mat<size_t> secondHashVectors(numTables, this->referenceSet.n_cols);
 
-  for (size_t i = 0; i < numTables; i++)
+  // The projections of all tables, side by side, so that a block of points can
+  // be projected on all of them with a single matrix multiplication.  (The
+  // slices of a cube are contiguous.)
+  const arma::mat allProjections(projections.memptr(), projections.n_rows,
+      numProj * numTables, false, true);
+  const arma::vec allOffsets = arma::vectorise(offsets);
+
+  // Hash the points in blocks, in parallel.
+  const size_t numBlocks = (this->referenceSet.n_cols + TrainBlockSize - 1) /
+      TrainBlockSize;
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
   {
+    const size_t begin = (size_t) b * TrainBlockSize;
+    const size_t end = std::min(begin + TrainBlockSize,
+        (size_t) this->referenceSet.n_cols);
+
     // Step IV: create the 'numProj'-dimensional key for each point in each
     // table.
 
     // The following code performs the task of hashing each point to a
     // 'numProj'-dimensional integer key.  Hence you get a ('numProj' x
-    // 'referenceSet.n_cols') key matrix.
+    // 'referenceSet.n_cols') key matrix for each table; here, the key
+    // matrices of all tables are stacked.
     //
     // For a single table, let the 'numProj' projections be denoted by 'proj_i'
     // and the corresponding offset be 'offset_i'.  Then the key of a single
     // point is obtained as:
     // key = { floor((<proj_i, point> + offset_i) / 'hashWidth') forall i }
-    arma::mat offsetMat = arma::repmat(offsets.unsafe_col(i), 1,
-                                       this->referenceSet.n_cols);
-    arma::mat hashMat = projections.slice(i).t() * (this->referenceSet);
-    hashMat += offsetMat;
+    arma::mat hashMat = allProjections.t() *
+        this->referenceSet.cols(begin, end - 1);
+    hashMat.each_col() += allOffsets;
     hashMat /= hashWidth;
+    hashMat = arma::floor(hashMat);
 
     // Step V: Putting the points in the 'secondHashTable' by hashing the key.
     // Now we hash every key, point ID to its corresponding bucket.  We must
     // also normalize the hashes to the range [0, secondHashSize).
-    arma::rowvec unmodVector = secondHashWeights.t() * arma::floor(hashMat);
-    for (size_t j = 0; j < unmodVector.n_elem; ++j)
+    for (size_t i = 0; i < numTables; ++i)
     {
-      double shs = (double) secondHashSize; // Convenience cast.
-      if (unmodVector[j] >= 0.0)
-      {
-        const size_t key = size_t(fmod(unmodVector[j], shs));
-        secondHashVectors(i, j) = key;
-      }
-      else
+      arma::rowvec unmodVector = secondHashWeights.t() *
+          hashMat.rows(i * numProj, (i + 1) * numProj - 1);
+      for (size_t j = 0; j < unmodVector.n_elem; ++j)
       {
-        const double mod = fmod(-unmodVector[j], shs);
-        const size_t key = (mod < 1.0) ? 0 : secondHashSize - size_t(mod);
-        secondHashVectors(i, j) = key;
+        double shs = (double) secondHashSize; // Convenience cast.
+        if (unmodVector[j] >= 0.0)
+        {
+          const size_t key = size_t(fmod(unmodVector[j], shs));
+          secondHashVectors(i, begin + j) = key;
+        }
+        else
+        {
+          const double mod = fmod(-unmodVector[j], shs);
+          const size_t key = (mod < 1.0) ? 0 : secondHashSize - size_t(mod);
+          secondHashVectors(i, begin + j) = key;
+        }
       }
     }
   }
 
-  // Now, using the hash vectors for each table, count the number of rows we
-  // have in the second hash table.
+  // Now we put the points in the buckets with a counting sort.  Each bucket
+  // holds (up to bucketSize of) its points in table order, and then in point
+  // order; that is, in the order of the entries of secondHashVectors.t().  We
+  // split that sequence into one chunk per thread, and each thread counts the
+  // points of its chunk in each bucket.
+  const size_t numEntries = secondHashVectors.n_elem;
+  size_t numChunks = 1;
+  #ifdef HAS_OPENMP
+    numChunks = omp_get_max_threads();
+  #endif
+  numChunks = std::max(std::min(numChunks, numEntries), (size_t) 1);
+  const size_t chunkSize = (numEntries + numChunks - 1) / numChunks;
+
+  // The bucket of the given entry of the sequence.
+  const size_t numPoints = this->referenceSet.n_cols;
+  auto entryBucket = [&secondHashVectors, numPoints](const size_t e)
+  {
+    return secondHashVectors(e / numPoints, e % numPoints);
+  };
+
+  arma::Mat<size_t> chunkCounts(secondHashSize, numChunks, arma::fill::zeros);
+  arma::Mat<size_t> chunkFirst(secondHashSize, numChunks);
+  chunkFirst.fill(numEntries);
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t c = 0; c < (omp_size_t) numChunks; ++c)
+  {
+    const size_t begin = (size_t) c * chunkSize;
+    const size_t end = std::min(begin + chunkSize, numEntries);
+    for (size_t e = begin; e < end; ++e)
+    {
+      const size_t hashInd = entryBucket(e);
+      if (chunkCounts(hashInd, c)++ == 0)
+        chunkFirst(hashInd, c) = e;
+    }
+  }
+
+  // Turn the counts into the position of each chunk in each bucket, and count
+  // the number of rows we have in the second hash table.
   arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
-  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
-    secondHashBinCounts[secondHashVectors[i]]++;
+  arma::Col<size_t> firstEntry(secondHashSize);
+  for (size_t h = 0; h < secondHashSize; ++h)
+  {
+    firstEntry[h] = chunkFirst.row(h).min();
+    for (size_t c = 0; c < numChunks; ++c)
+    {
+      const size_t count = chunkCounts(h, c);
+      chunkCounts(h, c) = secondHashBinCounts[h];
+      secondHashBinCounts[h] += count;
+    }
+  }
 
   // Enforce the maximum bucket size.
   const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
   secondHashBinCounts.transform([effectiveBucketSize](size_t val)
       { return std::min(val, effectiveBucketSize); });
 
-  const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
-  bucketContentSize.zeros(numRowsInTable);
+  // The rows of the buckets are assigned in the order in which the buckets are
+  // first seen.
+  arma::uvec nonEmptyBuckets = arma::find(secondHashBinCounts > 0);
+  std::sort(nonEmptyBuckets.begin(), nonEmptyBuckets.end(),
+      [&firstEntry](const arma::uword a, const arma::uword b)
+      { return firstEntry[a] < firstEntry[b]; });
+
+  const size_t numRowsInTable = nonEmptyBuckets.n_elem;
+  bucketContentSize.set_size(numRowsInTable);
+  secondHashTable.clear();
   secondHashTable.resize(numRowsInTable);
+  for (size_t row = 0; row < numRowsInTable; ++row)
+  {
+    const size_t hashInd = nonEmptyBuckets[row];
+    bucketRowInHashTable[hashInd] = row;
+    bucketContentSize[row] = secondHashBinCounts[hashInd];
+    secondHashTable[row].set_size(secondHashBinCounts[hashInd]);
+  }
 
-  // Next we must assign each point in each table to the right second hash
-  // table.
-  size_t currentRow = 0;
-  for (size_t i = 0; i < numTables; ++i)
+  // Finally, each thread puts the points of its chunk in their buckets, if the
+  // buckets are not full.  The positions of different chunks do not overlap.
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t c = 0; c < (omp_size_t) numChunks; ++c)
   {
-    // Insert the point in the corresponding row to its bucket in the
-    // 'secondHashTable'.
-    for (size_t j = 0; j < secondHashVectors.n_cols; j++)
+    const size_t begin = (size_t) c * chunkSize;
+    const size_t end = std::min(begin + chunkSize, numEntries);
+    for (size_t e = begin; e < end; ++e)
     {
-      // This is the bucket number.
-      size_t hashInd = (size_t) secondHashVectors(i, j);
-      // The point ID is 'j'.
-
-      // If this is currently an empty bucket, start a new row keep track of
-      // which row corresponds to the bucket.
-      const size_t maxSize = secondHashBinCounts[hashInd];
-      if (bucketRowInHashTable[hashInd] == secondHashSize)
-      {
-        bucketRowInHashTable[hashInd] = currentRow;
-        secondHashTable[currentRow].set_size(maxSize);
-        currentRow++;
-      }
-
-      // If this vector in the hash table is not full, add the point.
-      const size_t index = bucketRowInHashTable[hashInd];
-      if (bucketContentSize[index] < maxSize)
-        secondHashTable[index](bucketContentSize[index]++) = j;
-    } // Loop over all points in the reference set.
-  } // Loop over tables.
+      const size_t hashInd = entryBucket(e);
+      const size_t position = chunkCounts(hashInd, c)++;
+      if (position < secondHashBinCounts[hashInd])
+        secondHashTable[bucketRowInHashTable[hashInd]](position) =
+            e % numPoints;
+    }
+  }
 
   Log::Info << "Final hash table size: " << numRowsInTable << " rows, with a "
             << "maximum length of " << arma::max(secondHashBinCounts) << ", "
@@ -697,32 +768,19 @@ void LSHSearch<SortPolicy>::GetAdditionalProbingBins(
 }
 
 template<typename SortPolicy>
-template<typename VecType>
 void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
-    const VecType& queryPoint,
+    const arma::vec& queryProjection,
     arma::uvec& referenceIndices,
-    size_t numTablesToSearch,
-    const size_t T) const
+    const size_t numTablesToSearch,
+    const size_t T,
+    std::vector<bool>& candidates) const
 {
-  // Decide on the number of tables to look into.
-  if (numTablesToSearch == 0) // If no user input is given, search all.
-    numTablesToSearch = numTables;
-
-  // Sanity check to make sure that the existing number of tables is not
-  // exceeded.
-  if (numTablesToSearch > numTables)
-    numTablesToSearch = numTables;
-
-  // Hash the query in each of the 'numTablesToSearch' hash tables using the
-  // 'numProj' projections for each table. This gives us 'numTablesToSearch'
-  // keys for the query where each key is a 'numProj' dimensional integer
-  // vector.
-
-  // Compute the projection of the query in each table.
+  // The projections of the query in each of the 'numTablesToSearch' hash
+  // tables give us 'numTablesToSearch' keys for the query where each key is a
+  // 'numProj' dimensional integer vector.
   arma::mat allProjInTables(numProj, numTablesToSearch);
-  arma::mat queryCodesNotFloored(numProj, numTablesToSearch);
-  for (size_t i = 0; i < numTablesToSearch; i++)
-    queryCodesNotFloored.unsafe_col(i) = projections.slice(i).t() * queryPoint;
+  arma::mat queryCodesNotFloored = arma::reshape(queryProjection, numProj,
+      numTablesToSearch);
 
   queryCodesNotFloored += offsets.cols(0, numTablesToSearch - 1);
   allProjInTables = arma::floor(queryCodesNotFloored / hashWidth);
@@ -775,77 +833,41 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
     }
   }
 
-  // There are two ways to proceed here:
-  // Either allocate a maxNumPoints-size vector, place all candidates, and run
-  // unique on the vector to discard duplicates.
-  // Or allocate a referenceSet.n_cols size vector (i.e. number of reference
-  // points) of zeros, and mark found indices as 1.
-  // Option 1 runs faster for small maxNumPoints but worse for larger values, so
-  // we choose based on a heuristic.
-  const float cutoff = 0.1;
-  const float selectivity = static_cast<float>(maxNumPoints) /
-      static_cast<float>(referenceSet.n_cols);
-
-  if (selectivity > cutoff)
+  // Collect the points of the buckets.  A point can be in several of them, so
+  // we mark the points we have seen in the (per-thread) candidates bitset, and
+  // unmark them when we are done; this is much cheaper than clearing a vector
+  // of the size of the reference set for each query.
+  referenceIndices.set_size(maxNumPoints);
+  size_t numCandidates = 0;
+  for (size_t i = 0; i < numTablesToSearch; ++i) // For all tables.
   {
-    // Heuristic: larger maxNumPoints means we should use find() because it
-    // should be faster.
-    // Reference points hashed in the same bucket as the query are set to >0.
-    arma::Col<size_t> refPointsConsidered;
-    refPointsConsidered.zeros(referenceSet.n_cols);
-
-    for (size_t i = 0; i < numTablesToSearch; ++i) // for all tables
+    for (size_t p = 0; p < T + 1; ++p) // For entire probing sequence.
     {
-      for (size_t p = 0; p < T + 1; ++p) // For entire probing sequence.
-      {
-        // get the sequence code
-        size_t hashInd = hashMat(p, i);
-        size_t tableRow = bucketRowInHashTable[hashInd];
+      const size_t hashInd = hashMat(p, i); // Find the query's bucket.
+      const size_t tableRow = bucketRowInHashTable[hashInd];
 
-        if (tableRow < secondHashSize && bucketContentSize[tableRow] > 0)
+      if (tableRow < secondHashSize)
+      {
+        for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
         {
-          // Pick the indices in the bucket corresponding to hashInd.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsidered[ secondHashTable[tableRow](j) ]++;
+          const size_t index = secondHashTable[tableRow][j];
+          if (!candidates[index])
+          {
+            candidates[index] = true;
+            referenceIndices[numCandidates++] = index;
+          }
         }
       }
     }
-
-    // Only keep reference points found in at least one bucket.
-    referenceIndices = arma::find(refPointsConsidered > 0);
-    return;
   }
-  else
-  {
-    // Heuristic: smaller maxNumPoints means we should use unique() because it
-    // should be faster.
-    // Allocate space for the query's potential neighbors.
-    arma::uvec refPointsConsideredSmall;
-    refPointsConsideredSmall.zeros(maxNumPoints);
-
-    // Retrieve candidates.
-    size_t start = 0;
-
-    for (size_t i = 0; i < numTablesToSearch; ++i) // For all tables
-    {
-      for (size_t p = 0; p < T + 1; ++p)
-      {
-        const size_t hashInd =  hashMat(p, i); // Find the query's bucket.
-        const size_t tableRow = bucketRowInHashTable[hashInd];
 
-        if (tableRow < secondHashSize)
-        {
-          // Store all secondHashTable points in the candidates set.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsideredSmall(start++) = secondHashTable[tableRow](j);
-       }
-      }
-    }
+  referenceIndices.resize(numCandidates);
+  for (size_t j = 0; j < numCandidates; ++j)
+    candidates[referenceIndices[j]] = false;
 
-    // Keep only one copy of each candidate.
-    referenceIndices = arma::unique(refPointsConsideredSmall);
-    return;
-  }
+  // Keep the candidates in increasing order, so that ties between neighbors
+  // are broken by index.
+  std::sort(referenceIndices.begin(), referenceIndices.end());
 }
 
 // Search for nearest neighbors in a given query set.
@@ -900,33 +922,52 @@ void LSHSearch<SortPolicy>::Search(const arma::mat& querySet,
     Log::Info << "Running multiprobe LSH with " << Teffective
         <<" additional probing bins per table per query." << std::endl;
 
+  // Decide on the number of tables to look into.
+  const size_t tablesToSearch = (numTablesToSearch == 0) ? numTables :
+      std::min(numTablesToSearch, numTables);
+  const arma::mat allProjections(projections.memptr(), projections.n_rows,
+      numProj * tablesToSearch, false, true);
+
   size_t avgIndicesReturned = 0;
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
+  // Parallelization to process more than one block of queries at a time.
+  const size_t numBlocks = (querySet.n_cols + SearchBlockSize - 1) /
+      SearchBlockSize;
+  #pragma omp parallel shared(resultingNeighbors, distances) \
       reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
+    std::vector<bool> candidates(referenceSet.n_cols, false);
     arma::uvec refIndices;
-    ReturnIndicesFromTable(querySet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running
-    // #pragma omp atomic
-    avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+    {
+      // Project the whole block of queries on the projections of all tables
+      // at once.
+      const size_t begin = (size_t) b * SearchBlockSize;
+      const size_t end = std::min(begin + SearchBlockSize,
+          (size_t) querySet.n_cols);
+      const arma::mat queryProjections = allProjections.t() *
+          querySet.cols(begin, end - 1);
+
+      for (size_t i = begin; i < end; ++i)
+      {
+        // Hash every query into every hash table and eventually into the
+        // 'secondHashTable' to obtain the neighbor candidates.
+        ReturnIndicesFromTable(queryProjections.unsafe_col(i - begin),
+            refIndices, tablesToSearch, Teffective, candidates);
+
+        // An informative book-keeping for the number of neighbor candidates
+        // returned on average.
+        avgIndicesReturned += refIndices.n_elem;
+
+        // Sequentially go through all the candidates and save the best 'k'
+        // candidates.
+        BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+      }
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -966,33 +1007,52 @@ Search(const size_t k,
     Log::Info << "Running multiprobe LSH with " << Teffective <<
       " additional probing bins per table per query."<< std::endl;
 
+  // Decide on the number of tables to look into.
+  const size_t tablesToSearch = (numTablesToSearch == 0) ? numTables :
+      std::min(numTablesToSearch, numTables);
+  const arma::mat allProjections(projections.memptr(), projections.n_rows,
+      numProj * tablesToSearch, false, true);
+
   size_t avgIndicesReturned = 0;
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
+  // Parallelization to process more than one block of queries at a time.
+  const size_t numBlocks = (referenceSet.n_cols + SearchBlockSize - 1) /
+      SearchBlockSize;
+  #pragma omp parallel shared(resultingNeighbors, distances) \
       reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) referenceSet.n_cols; ++i)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
+    std::vector<bool> candidates(referenceSet.n_cols, false);
     arma::uvec refIndices;
-    ReturnIndicesFromTable(referenceSet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running.
-    // #pragma omp atomic
-    avgIndicesReturned += refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, resultingNeighbors, distances);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+    {
+      // Project the whole block of queries on the projections of all tables
+      // at once.
+      const size_t begin = (size_t) b * SearchBlockSize;
+      const size_t end = std::min(begin + SearchBlockSize,
+          (size_t) referenceSet.n_cols);
+      const arma::mat queryProjections = allProjections.t() *
+          referenceSet.cols(begin, end - 1);
+
+      for (size_t i = begin; i < end; ++i)
+      {
+        // Hash every query into every hash table and eventually into the
+        // 'secondHashTable' to obtain the neighbor candidates.
+        ReturnIndicesFromTable(queryProjections.unsafe_col(i - begin),
+            refIndices, tablesToSearch, Teffective, candidates);
+
+        // An informative book-keeping for the number of neighbor candidates
+        // returned on average.
+        avgIndicesReturned += refIndices.n_elem;
+
+        // Sequentially go through all the candidates and save the best 'k'
+        // candidates.
+        BaseCase(i, refIndices, k, resultingNeighbors, distances);
+      }
+    }
   }
 
   Timer::Stop("computing_neighbors");
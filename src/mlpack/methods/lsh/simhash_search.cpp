@@ -0,0 +1,228 @@
+/**
+ * @file simhash_search.cpp
+ *
+ * Implementation of the SimHashSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "simhash_search.hpp"
+
+#include <mlpack/core/kernels/cosine_distance.hpp>
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+SimHashSearch::SimHashSearch(arma::mat referenceSet,
+                             const size_t numBits,
+                             const bool storeReferenceSet) :
+    numBits(0),
+    numWords(0),
+    numPoints(0),
+    distanceEvaluations(0)
+{
+  Train(std::move(referenceSet), numBits, storeReferenceSet);
+}
+
+SimHashSearch::SimHashSearch() :
+    numBits(0),
+    numWords(0),
+    numPoints(0),
+    distanceEvaluations(0)
+{
+  // Nothing to do.
+}
+
+void SimHashSearch::Train(arma::mat referenceSet,
+                          const size_t numBits,
+                          const bool storeReferenceSet)
+{
+  if (numBits == 0)
+  {
+    throw std::invalid_argument("SimHashSearch::Train(): the number of bits "
+        "must be greater than 0!");
+  }
+
+  this->numBits = numBits;
+  numWords = (numBits + 63) / 64;
+  numPoints = referenceSet.n_cols;
+
+  // The normal distribution is rotation invariant, so the normals of the
+  // hyperplanes are uniformly distributed directions.
+  projections.randn(numBits, referenceSet.n_rows);
+
+  Hash(referenceSet, signatures);
+
+  if (storeReferenceSet)
+    this->referenceSet = std::move(referenceSet);
+  else
+    this->referenceSet.reset();
+
+  Log::Info << "Hashed " << numPoints << " points to " << numBits << "-bit "
+      << "signatures (" << signatures.size() * sizeof(uint64_t) << " bytes)."
+      << std::endl;
+}
+
+void SimHashSearch::Search(const arma::mat& querySet,
+                           const size_t k,
+                           arma::Mat<size_t>& neighbors,
+                           arma::mat& distances,
+                           const size_t numCandidates)
+{
+  if (querySet.n_rows != projections.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "SimHashSearch::Search(): dimensionality of query set ("
+        << querySet.n_rows << ") is not equal to the dimensionality the model "
+        << "was trained on (" << projections.n_cols << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  std::vector<uint64_t> querySignatures;
+  Hash(querySet, querySignatures);
+  SearchSignatures(querySet, querySignatures, false, k, neighbors, distances,
+      numCandidates);
+}
+
+void SimHashSearch::Search(const size_t k,
+                           arma::Mat<size_t>& neighbors,
+                           arma::mat& distances,
+                           const size_t numCandidates)
+{
+  SearchSignatures(referenceSet, signatures, true, k, neighbors, distances,
+      numCandidates);
+}
+
+void SimHashSearch::Hash(const arma::mat& points,
+                         std::vector<uint64_t>& pointSignatures) const
+{
+  pointSignatures.assign(points.n_cols * numWords, 0);
+
+  // Project the points on all hyperplanes in blocks, in parallel.
+  const size_t numBlocks = (points.n_cols + BlockSize - 1) / BlockSize;
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = (size_t) b * BlockSize;
+    const size_t end = std::min(begin + BlockSize, (size_t) points.n_cols);
+    const arma::mat projected = projections * points.cols(begin, end - 1);
+
+    for (size_t i = begin; i < end; ++i)
+    {
+      uint64_t* signature = pointSignatures.data() + i * numWords;
+      for (size_t bit = 0; bit < numBits; ++bit)
+      {
+        if (projected(bit, i - begin) >= 0.0)
+          signature[bit / 64] |= (uint64_t(1) << (bit % 64));
+      }
+    }
+  }
+}
+
+void SimHashSearch::SearchSignatures(
+    const arma::mat& querySet,
+    const std::vector<uint64_t>& querySignatures,
+    const bool monochromatic,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances,
+    const size_t numCandidates)
+{
+  if (numWords == 0)
+  {
+    throw std::invalid_argument("SimHashSearch::Search(): the model is not "
+        "trained!");
+  }
+
+  const size_t available = (monochromatic && numPoints > 0) ? numPoints - 1 :
+      numPoints;
+  if (k > available)
+  {
+    std::ostringstream oss;
+    oss << "SimHashSearch::Search(): requested " << k << " approximate "
+        << "nearest neighbors, but there are only " << available
+        << " reference points to choose from!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (numCandidates > 0 && referenceSet.n_cols != numPoints)
+  {
+    throw std::invalid_argument("SimHashSearch::Search(): cannot rerank the "
+        "candidates, because the model does not store the reference set!");
+  }
+
+  const size_t numQueries = querySignatures.size() / numWords;
+  neighbors.set_size(k, numQueries);
+  distances.set_size(k, numQueries);
+  if (k == 0)
+    return;
+
+  // The number of candidates to keep for each query.
+  const size_t numKept = std::min(std::max(k, numCandidates), available);
+
+  size_t evaluations = 0;
+  #pragma omp parallel for schedule(dynamic) reduction(+:evaluations)
+  for (omp_size_t q = 0; q < (omp_size_t) numQueries; ++q)
+  {
+    const uint64_t* query = querySignatures.data() + q * numWords;
+
+    // Keep the numKept points with the smallest Hamming distances (and then
+    // the smallest indices) in a max-heap.
+    typedef std::pair<size_t, size_t> Candidate;
+    std::vector<Candidate> heap;
+    heap.reserve(numKept);
+    for (size_t r = 0; r < numPoints; ++r)
+    {
+      if (monochromatic && r == (size_t) q)
+        continue;
+
+      const uint64_t* reference = signatures.data() + r * numWords;
+      size_t hamming = 0;
+      for (size_t w = 0; w < numWords; ++w)
+        hamming += PopCount(query[w] ^ reference[w]);
+
+      if (heap.size() < numKept)
+      {
+        heap.push_back(Candidate(hamming, r));
+        std::push_heap(heap.begin(), heap.end());
+      }
+      else if (hamming < heap.front().first)
+      {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = Candidate(hamming, r);
+        std::push_heap(heap.begin(), heap.end());
+      }
+    }
+
+    // Compute the distances of the candidates: either exactly, or from the
+    // estimated angle.
+    std::vector<std::pair<double, size_t>> results(heap.size());
+    for (size_t j = 0; j < heap.size(); ++j)
+    {
+      const size_t r = heap[j].second;
+      if (numCandidates > 0)
+      {
+        results[j].first = 1.0 - kernel::CosineDistance::Evaluate(
+            querySet.unsafe_col(q), referenceSet.unsafe_col(r));
+      }
+      else
+      {
+        results[j].first = 1.0 - std::cos(M_PI * heap[j].first / numBits);
+      }
+      results[j].second = r;
+    }
+    if (numCandidates > 0)
+      evaluations += results.size();
+
+    std::sort(results.begin(), results.end());
+    for (size_t j = 0; j < k; ++j)
+    {
+      neighbors(j, q) = results[j].second;
+      distances(j, q) = results[j].first;
+    }
+  }
+
+  distanceEvaluations += evaluations;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file simhash_search.hpp
+ *
+ * Defines the SimHashSearch class, which performs approximate nearest neighbor
+ * search for the cosine distance with binary (SimHash) signatures.
+ *
+ * @code
+ * @inproceedings{charikar2002similarity,
+ *   title={Similarity estimation techniques from rounding algorithms},
+ *   author={Charikar, Moses S.},
+ *   booktitle={Proceedings of the 34th Annual ACM Symposium on Theory of
+ *       Computing},
+ *   pages={380--388},
+ *   year={2002}
+ * }
+ * @endcode
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LSH_SIMHASH_SEARCH_HPP
+#define MLPACK_METHODS_LSH_SIMHASH_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <cstdint>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The SimHashSearch class finds the approximate nearest neighbors of points
+ * for the cosine distance, 1 - (a^T b) / (|| a || || b ||).  Each point is
+ * hashed to a binary signature: bit i is set if the point is on the positive
+ * side of the i'th of a set of random hyperplanes (through the origin).  The
+ * probability that two points get a different bit is theta / pi, where theta
+ * is the angle between them, so the Hamming distance between two signatures
+ * estimates the angle.
+ *
+ * The signatures are packed into 64-bit words, and the search compares the
+ * signature of each query with the signature of every reference point with
+ * XOR and population count (which compiles to the POPCNT instruction when the
+ * target supports it, for instance with -mpopcnt or -march=native).  A 64-bit
+ * signature takes 8 bytes per point, instead of 8 bytes per dimension for the
+ * point itself.
+ *
+ * The distances that are returned are estimated from the Hamming distances,
+ * unless the candidates with the smallest Hamming distances are reranked with
+ * the exact cosine distance (kernel::CosineDistance), which requires the model
+ * to keep the reference set.  A model that does not keep the reference set
+ * only holds the signatures and the hyperplanes.
+ *
+ * @code
+ * SimHashSearch simhash(referenceSet, 128);
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * // Find 5 neighbors, reranking the 50 best candidates.
+ * simhash.Search(querySet, 5, neighbors, distances, 50);
+ * @endcode
+ */
+class SimHashSearch
+{
+ public:
+  /**
+   * Hash the given reference set.  In order to avoid copying the reference
+   * set, consider passing it with std::move().
+   *
+   * @param referenceSet Set of reference points.
+   * @param numBits Number of bits of each signature.
+   * @param storeReferenceSet If false, the reference set is not kept, and the
+   *     results cannot be reranked with the exact cosine distance.
+   */
+  SimHashSearch(arma::mat referenceSet,
+                const size_t numBits = 64,
+                const bool storeReferenceSet = true);
+
+  /**
+   * Create an untrained model.  Be sure to call Train() before calling
+   * Search(); otherwise, an exception will be thrown when Search() is called.
+   */
+  SimHashSearch();
+
+  /**
+   * Hash the given reference set with new random hyperplanes.  In order to
+   * avoid copying the reference set, consider passing it with std::move().
+   *
+   * @param referenceSet Set of reference points.
+   * @param numBits Number of bits of each signature.
+   * @param storeReferenceSet If false, the reference set is not kept, and the
+   *     results cannot be reranked with the exact cosine distance.
+   */
+  void Train(arma::mat referenceSet,
+             const size_t numBits = 64,
+             const bool storeReferenceSet = true);
+
+  /**
+   * Compute the approximate nearest neighbors of the points in the given query
+   * set.  The matrices will be set to k rows and one column per query point.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing the (cosine) distances of the neighbors.
+   * @param numCandidates If nonzero, the given number of reference points
+   *     (at least k) with the smallest Hamming distances are reranked with
+   *     the exact cosine distance.  If zero, the neighbors are the points with
+   *     the smallest Hamming distances, and the distances are estimated.
+   */
+  void Search(const arma::mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances,
+              const size_t numCandidates = 0);
+
+  /**
+   * Compute the approximate nearest neighbors of the points in the reference
+   * set (a point is not its own neighbor).  The matrices will be set to k rows
+   * and one column per reference point.
+   *
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each point.
+   * @param distances Matrix storing the (cosine) distances of the neighbors.
+   * @param numCandidates If nonzero, the given number of reference points
+   *     (at least k) with the smallest Hamming distances are reranked with
+   *     the exact cosine distance.  If zero, the neighbors are the points with
+   *     the smallest Hamming distances, and the distances are estimated.
+   */
+  void Search(const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances,
+              const size_t numCandidates = 0);
+
+  //! Get the number of bits of each signature.
+  size_t NumBits() const { return numBits; }
+  //! Get the number of 64-bit words of each signature.
+  size_t NumWords() const { return numWords; }
+  //! Get the number of reference points.
+  size_t NumPoints() const { return numPoints; }
+
+  //! Get the reference set (empty if it is not stored).
+  const arma::mat& ReferenceSet() const { return referenceSet; }
+  //! Get the hyperplanes (one per row).
+  const arma::mat& Projections() const { return projections; }
+  //! Get the signatures of the reference points (NumWords() words per point).
+  const std::vector<uint64_t>& Signatures() const { return signatures; }
+
+  //! Return the number of exact distance evaluations performed.
+  size_t DistanceEvaluations() const { return distanceEvaluations; }
+  //! Modify the number of exact distance evaluations performed.
+  size_t& DistanceEvaluations() { return distanceEvaluations; }
+
+  //! Serialize the model.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! The number of points that are hashed together.
+  static const size_t BlockSize = 1024;
+
+  /**
+   * Compute the signatures of the given points.
+   *
+   * @param points Points to hash.
+   * @param pointSignatures Will be set to the signatures, NumWords() words
+   *     per point.
+   */
+  void Hash(const arma::mat& points,
+            std::vector<uint64_t>& pointSignatures) const;
+
+  /**
+   * Find the neighbors of the queries with the given signatures.
+   *
+   * @param querySet Query points (only used for reranking).
+   * @param querySignatures Signatures of the queries.
+   * @param monochromatic If true, the queries are the reference points, and
+   *     a point is not its own neighbor.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing the distances of the neighbors.
+   * @param numCandidates Number of candidates to rerank (or 0).
+   */
+  void SearchSignatures(const arma::mat& querySet,
+                        const std::vector<uint64_t>& querySignatures,
+                        const bool monochromatic,
+                        const size_t k,
+                        arma::Mat<size_t>& neighbors,
+                        arma::mat& distances,
+                        const size_t numCandidates);
+
+  //! Return the number of set bits of the given word.
+  static size_t PopCount(uint64_t word)
+  {
+    #ifdef __GNUC__
+      return (size_t) __builtin_popcountll(word);
+    #else
+      word = word - ((word >> 1) & 0x5555555555555555ULL);
+      word = (word & 0x3333333333333333ULL) +
+          ((word >> 2) & 0x3333333333333333ULL);
+      word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+      return (size_t) ((word * 0x0101010101010101ULL) >> 56);
+    #endif
+  }
+
+  //! The reference set (empty if it is not stored).
+  arma::mat referenceSet;
+  //! The number of bits of each signature.
+  size_t numBits;
+  //! The number of 64-bit words of each signature.
+  size_t numWords;
+  //! The number of reference points.
+  size_t numPoints;
+  //! The random hyperplanes, one per row.
+  arma::mat projections;
+  //! The signatures of the reference points, numWords words per point.
+  std::vector<uint64_t> signatures;
+  //! The number of exact distance evaluations.
+  size_t distanceEvaluations;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation of serialize().
+#include "simhash_search_impl.hpp"
+
+#endif
@@ -14,6 +14,8 @@
 #define MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -57,6 +59,14 @@ enum NeighborSearchMode
  * can be found in the NearestNeighborSort class and the kernel::ExampleKernel
  * class.
  *
+ * In single-tree mode, the query points are divided between OpenMP threads
+ * (if mlpack was built with OpenMP); each thread has its own copy of the
+ * search state, and the reference tree is shared.  Search() with a query set
+ * may be called from several threads at once on the same object, as long as
+ * no other method that modifies the object (such as Train(), or changing the
+ * search mode) is called at the same time; BaseCases() and Scores() are only
+ * meaningful when one search runs at a time.
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
  * @tparam MetricType The metric to use for computation.
  * @tparam MatType The type of data matrix.
@@ -207,6 +217,32 @@ class NeighborSearch
    */
   void Train(Tree referenceTree);
 
+  /**
+   * Add the given points to the reference set without rebuilding the reference
+   * tree; the new points get the indices that follow the existing reference
+   * points.  The tree must support insertion, as BinarySpaceTree types (except
+   * the UB tree) do; otherwise std::invalid_argument is thrown.  In naive mode
+   * without a tree, the points are simply appended to the reference set.
+   *
+   * Insertion is much cheaper in batches than one point at a time.  This must
+   * not be called while a search is running.
+   *
+   * @param points Points to add to the reference set.
+   * @param maxLeafSize Maximum number of points in a leaf of the tree.
+   */
+  void InsertPoints(const MatType& points, const size_t maxLeafSize = 20);
+
+  /**
+   * Delete the reference points with the given indices without rebuilding the
+   * reference tree.  As with arma::Mat::shed_cols(), the indices of the
+   * reference points after a deleted point decrease.  The tree must support
+   * deletion, as BinarySpaceTree types do; otherwise std::invalid_argument is
+   * thrown.  This must not be called while a search is running.
+   *
+   * @param indices Indices of the reference points to delete.
+   */
+  void DeletePoints(const std::vector<size_t>& indices);
+
   /**
    * For each point in the query set, compute the nearest neighbors and store
    * the output in the given matrices.  The matrices will be set to the size of
@@ -351,14 +387,28 @@ class NeighborSearch
   MetricType metric;
 
   //! The total number of base cases.
-  size_t baseCases;
+  std::atomic<size_t> baseCases;
   //! The total number of scores (applicable for non-naive search).
-  size_t scores;
+  std::atomic<size_t> scores;
 
   //! If this is true, the reference tree bounds need to be reset on a call to
   //! Search() without a query set.
   bool treeNeedsReset;
 
+  //! Held by searches that modify the statistics of the reference tree, so
+  //! that concurrent searches don't interfere.
+  std::mutex treeMutex;
+
+  /**
+   * Run the single-tree search of every query point of the rules, dividing the
+   * query points between threads.
+   *
+   * @param rules Rules to search with; the candidate lists are shared.
+   * @param numQueries Number of query points.
+   */
+  template<typename RuleType>
+  void SingleTreeSearch(RuleType& rules, const size_t numQueries);
+
   //! The NSModel class should have access to internal members.
   template<typename SortPol>
   friend class TrainVisitor;
@@ -15,12 +15,71 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/tree/greedy_single_tree_traverser.hpp>
+#include <mlpack/core/tree/parallel_dual_tree_traverser.hpp>
 #include "neighbor_search_rules.hpp"
 #include <mlpack/core/tree/spill_tree/is_spill_tree.hpp>
 
 namespace mlpack {
 namespace neighbor {
 
+//! Lay the nodes of the tree out contiguously, if the tree supports it.
+template<typename TreeType>
+auto CompactTree(TreeType& tree, const int /* preferred */)
+    -> decltype(tree.Compact())
+{
+  tree.Compact();
+}
+
+//! Otherwise, leave the tree as it is.
+template<typename TreeType>
+void CompactTree(TreeType& /* tree */, const long /* fallback */) { }
+
+//! Insert points into the tree, if the tree supports it.
+template<typename TreeType, typename MatType>
+auto InsertIntoTree(TreeType& tree,
+                    const MatType& points,
+                    std::vector<size_t>& oldFromNew,
+                    const size_t maxLeafSize,
+                    const int /* preferred */)
+    -> decltype(tree.InsertPoints(points, oldFromNew, maxLeafSize))
+{
+  tree.InsertPoints(points, oldFromNew, maxLeafSize);
+}
+
+//! Otherwise, the model has to be rebuilt.
+template<typename TreeType, typename MatType>
+void InsertIntoTree(TreeType& /* tree */,
+                    const MatType& /* points */,
+                    std::vector<size_t>& /* oldFromNew */,
+                    const size_t /* maxLeafSize */,
+                    const long /* fallback */)
+{
+  throw std::invalid_argument("NeighborSearch::InsertPoints(): the reference "
+      "tree type does not support insertion; build a new model instead");
+}
+
+//! Delete points from the tree, if the tree supports it.
+template<typename TreeType>
+auto DeleteFromTree(TreeType& tree,
+                    const std::vector<size_t>& points,
+                    std::vector<size_t>& oldFromNew,
+                    const int /* preferred */)
+    -> decltype(tree.DeletePoints(points, oldFromNew))
+{
+  tree.DeletePoints(points, oldFromNew);
+}
+
+//! Otherwise, the model has to be rebuilt.
+template<typename TreeType>
+void DeleteFromTree(TreeType& /* tree */,
+                    const std::vector<size_t>& /* points */,
+                    std::vector<size_t>& /* oldFromNew */,
+                    const long /* fallback */)
+{
+  throw std::invalid_argument("NeighborSearch::DeletePoints(): the reference "
+      "tree type does not support deletion; build a new model instead");
+}
+
 //! Call the tree constructor that does mapping.
 template<typename TreeType, typename MatType>
 TreeType* BuildTree(
@@ -30,7 +89,9 @@ TreeType* BuildTree(
         tree::TreeTraits<TreeType>::RearrangesDataset, TreeType
     >* = 0)
 {
-  return new TreeType(std::forward<MatType>(dataset), oldFromNew);
+  TreeType* tree = new TreeType(std::forward<MatType>(dataset), oldFromNew);
+  CompactTree(*tree, 0);
+  return tree;
 }
 
 //! Call the tree constructor that does not do mapping.
@@ -153,8 +214,8 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearch& other) :
     searchMode(other.searchMode),
     epsilon(other.epsilon),
     metric(other.metric),
-    baseCases(other.baseCases),
-    scores(other.scores),
+    baseCases(other.baseCases.load()),
+    scores(other.scores.load()),
     treeNeedsReset(false)
 {
   // Nothing else to do.
@@ -177,8 +238,8 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
     searchMode(other.searchMode),
     epsilon(other.epsilon),
     metric(std::move(other.metric)),
-    baseCases(other.baseCases),
-    scores(other.scores),
+    baseCases(other.baseCases.load()),
+    scores(other.scores.load()),
     treeNeedsReset(other.treeNeedsReset)
 {
   // Clear the other model.
@@ -230,8 +291,8 @@ NeighborSearch<SortPolicy,
   searchMode = other.searchMode;
   epsilon = other.epsilon;
   metric = other.metric;
-  baseCases = other.baseCases;
-  scores = other.scores;
+  baseCases = other.baseCases.load();
+  scores = other.scores.load();
   treeNeedsReset = false;
 }
 
@@ -272,8 +333,8 @@ NeighborSearch<SortPolicy,
   searchMode = other.searchMode;
   epsilon = other.epsilon;
   metric = other.metric;
-  baseCases = other.baseCases;
-  scores = other.scores;
+  baseCases = other.baseCases.load();
+  scores = other.scores.load();
   treeNeedsReset = other.treeNeedsReset;
 
   // Reset the other object.  Clean memory if needed.
@@ -377,6 +438,127 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree referenceTree)
  * Computes the best neighbors and stores them in resultingNeighbors and
  * distances.
  */
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::InsertPoints(
+    const MatType& points,
+    const size_t maxLeafSize)
+{
+  if (referenceSet->n_cols > 0 && points.n_rows != referenceSet->n_rows)
+  {
+    std::stringstream ss;
+    ss << "NeighborSearch::InsertPoints(): the points have " << points.n_rows
+        << " dimensions, but the reference set has " << referenceSet->n_rows
+        << " dimensions";
+    throw std::invalid_argument(ss.str());
+  }
+
+  if (!referenceTree)
+  {
+    // Without a tree, we own the reference set.
+    MatType* newReferenceSet = new MatType(referenceSet->n_cols > 0 ?
+        MatType(arma::join_rows(*referenceSet, points)) : points);
+    delete referenceSet;
+    referenceSet = newReferenceSet;
+    return;
+  }
+
+  // The tree checks the insertion before it changes anything, so the mapping
+  // can be updated in place.  A tree given without a mapping keeps its own
+  // order; its mapping is only kept once the insertion succeeded.
+  if (!oldFromNewReferences.empty())
+  {
+    InsertIntoTree(*referenceTree, points, oldFromNewReferences, maxLeafSize,
+        0);
+  }
+  else
+  {
+    std::vector<size_t> oldFromNew(referenceSet->n_cols);
+    for (size_t i = 0; i < oldFromNew.size(); ++i)
+      oldFromNew[i] = i;
+
+    InsertIntoTree(*referenceTree, points, oldFromNew, maxLeafSize, 0);
+    oldFromNewReferences.swap(oldFromNew);
+  }
+  referenceSet = &referenceTree->Dataset();
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::DeletePoints(
+    const std::vector<size_t>& indices)
+{
+  for (size_t i = 0; i < indices.size(); ++i)
+  {
+    if (indices[i] >= referenceSet->n_cols)
+    {
+      std::stringstream ss;
+      ss << "NeighborSearch::DeletePoints(): cannot delete point " << indices[i]
+          << "; there are only " << referenceSet->n_cols << " reference points";
+      throw std::invalid_argument(ss.str());
+    }
+  }
+
+  if (!referenceTree)
+  {
+    // Without a tree, we own the reference set.
+    std::vector<bool> deleted(referenceSet->n_cols, false);
+    for (size_t i = 0; i < indices.size(); ++i)
+      deleted[indices[i]] = true;
+
+    std::vector<size_t> kept;
+    for (size_t i = 0; i < deleted.size(); ++i)
+      if (!deleted[i])
+        kept.push_back(i);
+
+    MatType* newReferenceSet = new MatType(referenceSet->cols(
+        arma::conv_to<arma::uvec>::from(kept)));
+    delete referenceSet;
+    referenceSet = newReferenceSet;
+    return;
+  }
+
+  // As in InsertPoints(), the mapping is updated in place, unless the tree was
+  // given without one.
+  std::vector<size_t> identity;
+  if (oldFromNewReferences.empty())
+  {
+    identity.resize(referenceSet->n_cols);
+    for (size_t i = 0; i < identity.size(); ++i)
+      identity[i] = i;
+  }
+  std::vector<size_t>& oldFromNew = oldFromNewReferences.empty() ? identity :
+      oldFromNewReferences;
+
+  // Find the points in the dataset of the tree.
+  std::vector<size_t> newFromOld(oldFromNew.size());
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    newFromOld[oldFromNew[i]] = i;
+
+  std::vector<size_t> points(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i)
+    points[i] = newFromOld[indices[i]];
+
+  DeleteFromTree(*referenceTree, points, oldFromNew, 0);
+  if (!identity.empty())
+    oldFromNewReferences.swap(identity);
+  referenceSet = &referenceTree->Dataset();
+}
+
 template<typename SortPolicy,
          typename MetricType,
          typename MatType,
@@ -455,12 +637,14 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, querySet, k, metric, epsilon);
 
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
+      // Trees with self-children cache distances in the reference tree during
+      // the search, so only one such search may run at a time.
+      std::unique_lock<std::mutex> lock(treeMutex, std::defer_lock);
+      if (tree::TreeTraits<Tree>::HasSelfChildren)
+        lock.lock();
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Now traverse for each point.
+      SingleTreeSearch(rules, querySet.n_cols);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -485,8 +669,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, epsilon);
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
+      // Create the traverser.  Independent query subtrees are traversed in
+      // parallel.
+      tree::ParallelDualTreeTraverser<RuleType, DualTreeTraversalType>
+          traverser(rules);
 
       traverser.Traverse(*queryTree, *referenceTree);
 
@@ -644,9 +830,19 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, querySet, k, metric, epsilon, sameSet);
 
-  // Create the traverser.
-  DualTreeTraversalType<RuleType> traverser(rules);
-  traverser.Traverse(queryTree, *referenceTree);
+  if (tree::IsSpillTree<Tree>::value)
+  {
+    // The given query tree may have overlapping children, so its subtrees
+    // can't be traversed independently.
+    DualTreeTraversalType<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+  }
+  else
+  {
+    tree::ParallelDualTreeTraverser<RuleType, DualTreeTraversalType>
+        traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+  }
 
   scores += rules.Scores();
   baseCases += rules.BaseCases();
@@ -708,6 +904,9 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     throw std::invalid_argument(ss.str());
   }
 
+  // The monochromatic search may modify the statistics of the reference tree.
+  std::lock_guard<std::mutex> lock(treeMutex);
+
   Timer::Start("computing_neighbors");
 
   baseCases = 0;
@@ -747,12 +946,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
     case SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Now traverse for each point.
+      SingleTreeSearch(rules, referenceSet->n_cols);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -785,8 +980,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
         }
       }
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
+      // Create the traverser.  Independent query subtrees are traversed in
+      // parallel.
+      tree::ParallelDualTreeTraverser<RuleType, DualTreeTraversalType>
+          traverser(rules);
 
       if (tree::IsSpillTree<Tree>::value)
       {
@@ -865,6 +1062,46 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 }
 
+//! Run the single-tree search for every query point.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename RuleType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SingleTreeSearch(
+    RuleType& rules,
+    const size_t numQueries)
+{
+  // Each thread traverses the reference tree with its own copy of the rules.
+  // The copies share the candidate lists, but every query point is handled by
+  // only one thread.  Trees with self-children cache distances in the
+  // reference tree during the search, so they are traversed by one thread.
+  #pragma omp parallel if (!tree::TreeTraits<Tree>::HasSelfChildren && \
+      numQueries > 1)
+  {
+    RuleType threadRules(rules);
+    const size_t initialBaseCases = threadRules.BaseCases();
+    const size_t initialScores = threadRules.Scores();
+
+    SingleTreeTraversalType<RuleType> traverser(threadRules);
+
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < (omp_size_t) numQueries; ++i)
+      traverser.Traverse(i, *referenceTree);
+
+    #pragma omp critical
+    {
+      rules.BaseCases() += threadRules.BaseCases() - initialBaseCases;
+      rules.Scores() += threadRules.Scores() - initialScores;
+    }
+  }
+}
+
 //! Calculate the average relative error.
 template<typename SortPolicy,
          typename MetricType,
@@ -14,7 +14,9 @@
 #define MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/metrics/block_distances.hpp>
 
+#include <memory>
 #include <queue>
 
 namespace mlpack {
@@ -54,6 +56,18 @@ class NeighborSearchRules
                       const double epsilon = 0,
                       const bool sameSet = false);
 
+  /**
+   * Construct the NeighborSearchRules object as a copy of another.  The copy
+   * has its own traversal information, base case cache and counters, but it
+   * shares the candidate lists of the given object; this allows
+   * tree::ParallelDualTreeTraverser to run one copy per query subtree, writing
+   * results for disjoint sets of query points into the same lists.  The
+   * counters of the new object are set to zero.
+   *
+   * @param other NeighborSearchRules object to copy.
+   */
+  NeighborSearchRules(const NeighborSearchRules& other);
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -73,6 +87,23 @@ class NeighborSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Run the base cases between every query point in [queryBegin, queryEnd) and
+   * every reference point in [referenceBegin, referenceEnd).  This gives the
+   * same results as calling BaseCase() for every pair, but all of the
+   * distances are computed at once with metric::BlockDistances().  The norms
+   * of each reference leaf are cached, so they are only computed once.
+   *
+   * @param queryBegin Index of the first query point.
+   * @param queryEnd One past the index of the last query point.
+   * @param referenceBegin Index of the first reference point.
+   * @param referenceEnd One past the index of the last reference point.
+   */
+  void BaseCaseBlock(const size_t queryBegin,
+                     const size_t queryEnd,
+                     const size_t referenceBegin,
+                     const size_t referenceEnd);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -179,8 +210,9 @@ class NeighborSearchRules
   typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
       CandidateList;
 
-  //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
+  //! Set of candidate neighbors for each point.  This is shared with the
+  //! NeighborSearchRules objects this object was copied from or to.
+  std::shared_ptr<std::vector<CandidateList>> candidates;
 
   //! Number of neighbors to search for.
   const size_t k;
@@ -200,6 +232,10 @@ class NeighborSearchRules
   size_t lastReferenceIndex;
   //! The last base case result.
   double lastBaseCase;
+  //! The distances computed by the last call to BaseCaseBlock().
+  arma::Mat<typename TreeType::Mat::elem_type> blockDistances;
+  //! The norms of each reference leaf, cached by BaseCaseBlock().
+  metric::BlockNormCache<typename TreeType::Mat::elem_type> referenceNorms;
 
   //! The number of base cases that have been performed.
   size_t baseCases;
@@ -29,6 +29,7 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     const bool sameSet) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidates(std::make_shared<std::vector<CandidateList>>()),
     k(k),
     metric(metric),
     sameSet(sameSet),
@@ -54,9 +55,30 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
   std::vector<Candidate> vect(k, def);
   CandidateList pqueue(CandidateCmp(), std::move(vect));
 
-  candidates.reserve(querySet.n_cols);
+  candidates->reserve(querySet.n_cols);
   for (size_t i = 0; i < querySet.n_cols; i++)
-    candidates.push_back(pqueue);
+    candidates->push_back(pqueue);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
+    const NeighborSearchRules& other) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    candidates(other.candidates),
+    k(other.k),
+    metric(other.metric),
+    sameSet(other.sameSet),
+    epsilon(other.epsilon),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0)
+{
+  // The copy gets its own (invalid) traversal information, as in the regular
+  // constructor.
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -69,7 +91,7 @@ void NeighborSearchRules<SortPolicy, MetricType, TreeType>::GetResults(
 
   for (size_t i = 0; i < querySet.n_cols; i++)
   {
-    CandidateList& pqueue = candidates[i];
+    CandidateList& pqueue = (*candidates)[i];
     for (size_t j = 1; j <= k; j++)
     {
       neighbors(k - j, i) = pqueue.top().second;
@@ -107,6 +129,41 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   return distance;
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::BaseCaseBlock(
+    const size_t queryBegin,
+    const size_t queryEnd,
+    const size_t referenceBegin,
+    const size_t referenceEnd)
+{
+  metric::BlockDistances(metric, querySet, queryBegin, queryEnd - queryBegin,
+      referenceSet, referenceBegin, referenceEnd - referenceBegin,
+      blockDistances, referenceNorms);
+
+  for (size_t queryIndex = queryBegin; queryIndex < queryEnd; ++queryIndex)
+  {
+    for (size_t referenceIndex = referenceBegin; referenceIndex < referenceEnd;
+         ++referenceIndex)
+    {
+      // Skip the same pairs that BaseCase() would skip.
+      if ((sameSet && (queryIndex == referenceIndex)) ||
+          ((lastQueryIndex == queryIndex) &&
+           (lastReferenceIndex == referenceIndex)))
+        continue;
+
+      const double distance = blockDistances(queryIndex - queryBegin,
+          referenceIndex - referenceBegin);
+      ++baseCases;
+
+      InsertNeighbor(queryIndex, referenceIndex, distance);
+
+      lastQueryIndex = queryIndex;
+      lastReferenceIndex = referenceIndex;
+      lastBaseCase = distance;
+    }
+  }
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
     const size_t queryIndex,
@@ -143,7 +200,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
   }
 
   // Compare against the best k'th distance for this query point so far.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = (*candidates)[queryIndex].top().first;
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
   return (SortPolicy::IsBetter(distance, bestDistance)) ?
@@ -179,7 +236,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
   const double distance = SortPolicy::ConvertToDistance(oldScore);
 
   // Just check the score again against the distances.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = (*candidates)[queryIndex].top().first;
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
   return (SortPolicy::IsBetter(distance, bestDistance)) ? oldScore : DBL_MAX;
@@ -404,7 +461,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
   // Loop over points held in the node.
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
-    const double distance = candidates[queryNode.Point(i)].top().first;
+    const double distance = (*candidates)[queryNode.Point(i)].top().first;
     if (SortPolicy::IsBetter(worstDistance, distance))
       worstDistance = distance;
     if (SortPolicy::IsBetter(distance, bestPointDistance))
@@ -499,7 +556,7 @@ InsertNeighbor(
     const size_t neighbor,
     const double distance)
 {
-  CandidateList& pqueue = candidates[queryIndex];
+  CandidateList& pqueue = (*candidates)[queryIndex];
   Candidate c = std::make_pair(distance, neighbor);
 
   if (CandidateCmp()(c, pqueue.top()))
@@ -223,6 +223,50 @@ class ReferenceSetVisitor : public boost::static_visitor<const arma::mat&>
   const arma::mat& operator()(NSType *ns) const;
 };
 
+/**
+ * InsertPointsVisitor adds points to the reference set of the given NSType.
+ */
+class InsertPointsVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The points to insert.
+  const arma::mat& points;
+  //! The leaf size, used only by BinarySpaceTree.
+  const size_t leafSize;
+
+ public:
+  //! Insert the points into the reference set of the given NSType.
+  template<typename NSType>
+  void operator()(NSType* ns) const;
+
+  //! Construct the InsertPointsVisitor with the given points and leaf size.
+  InsertPointsVisitor(const arma::mat& points, const size_t leafSize) :
+      points(points),
+      leafSize(leafSize)
+  {};
+};
+
+/**
+ * DeletePointsVisitor deletes points from the reference set of the given
+ * NSType.
+ */
+class DeletePointsVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The indices of the points to delete.
+  const std::vector<size_t>& indices;
+
+ public:
+  //! Delete the points from the reference set of the given NSType.
+  template<typename NSType>
+  void operator()(NSType* ns) const;
+
+  //! Construct the DeletePointsVisitor with the given indices.
+  DeletePointsVisitor(const std::vector<size_t>& indices) :
+      indices(indices)
+  {};
+};
+
 /**
  * DeleteVisitor deletes the given NSType instance.
  */
@@ -242,6 +286,12 @@ class DeleteVisitor : public boost::static_visitor<void>
  * flexibility as the NeighborSearch class.  So if you are using it outside of
  * mlpack_knn and mlpack_kfn, be aware that it is limited!
  *
+ * Once the model is built (or loaded), Search() may be called from several
+ * threads at once, so one model can serve many requests; BuildModel(),
+ * serialization and the methods that modify the model must not be called at
+ * the same time as a search.  Monochromatic searches on the same model are
+ * run one at a time, since they may modify the reference tree.
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
  */
 template<typename SortPolicy>
@@ -389,7 +439,25 @@ class NSModel
                   const NeighborSearchMode searchMode,
                   const double epsilon = 0);
 
-  //! Perform neighbor search.  The query set will be reordered.
+  /**
+   * Add points to the reference set without rebuilding the tree; the new
+   * points get the indices after the existing reference points.  Only binary
+   * space trees other than the UB tree support this (and naive search);
+   * otherwise std::invalid_argument is thrown and the model has to be rebuilt.
+   * This must not be called while a search is running.
+   */
+  void InsertPoints(arma::mat&& points);
+
+  /**
+   * Delete the reference points with the given indices without rebuilding the
+   * tree; the indices of the points after them decrease.  Only binary space
+   * trees support this (and naive search); otherwise std::invalid_argument is
+   * thrown.  This must not be called while a search is running.
+   */
+  void DeletePoints(const std::vector<size_t>& indices);
+
+  //! Perform neighbor search.  The query set will be reordered.  This may be
+  //! called from several threads at once.
   void Search(arma::mat&& querySet,
               const size_t k,
               arma::Mat<size_t>& neighbors,
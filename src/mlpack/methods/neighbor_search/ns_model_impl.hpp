@@ -252,6 +252,24 @@ const arma::mat& ReferenceSetVisitor::operator()(NSType* ns) const
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Insert the points into the given NSType.
+template<typename NSType>
+void InsertPointsVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->InsertPoints(points, leafSize);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Delete the points from the given NSType.
+template<typename NSType>
+void DeletePointsVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->DeletePoints(indices);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Clean memory, if necessary.
 template<typename NSType>
 void DeleteVisitor::operator()(NSType* ns) const
@@ -561,6 +579,32 @@ void NSModel<SortPolicy>::Search(arma::mat&& querySet,
   boost::apply_visitor(search, nSearch);
 }
 
+//! Add points to the reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::InsertPoints(arma::mat&& points)
+{
+  // The new points must be projected like the reference set.
+  if (randomBasis)
+    points = q * points;
+
+  Log::Info << "Inserting " << points.n_cols << " points into the "
+      << TreeName() << "..." << std::endl;
+
+  InsertPointsVisitor insert(points, leafSize);
+  boost::apply_visitor(insert, nSearch);
+}
+
+//! Delete points from the reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::DeletePoints(const std::vector<size_t>& indices)
+{
+  Log::Info << "Deleting " << indices.size() << " points from the "
+      << TreeName() << "..." << std::endl;
+
+  DeletePointsVisitor deletePoints(indices);
+  boost::apply_visitor(deletePoints, nSearch);
+}
+
 //! Perform neighbor search.
 template<typename SortPolicy>
 void NSModel<SortPolicy>::Search(const size_t k,
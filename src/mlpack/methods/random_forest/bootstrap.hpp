@@ -16,6 +16,17 @@
 namespace mlpack {
 namespace tree {
 
+/**
+ * Draw a bootstrap sample of a dataset with the given number of points: return
+ * the indices of numPoints points drawn with replacement.  Training on these
+ * indices (e.g. with DecisionTree::TrainSubset()) avoids copying the dataset.
+ */
+inline arma::uvec BootstrapIndices(const size_t numPoints)
+{
+  return arma::randi<arma::uvec>(numPoints,
+      arma::distr_param(0, numPoints - 1));
+}
+
 /**
  * Given a dataset, create another dataset via bootstrap sampling, with labels.
  */
@@ -36,8 +47,7 @@ void Bootstrap(const MatType& dataset,
     bootstrapWeights.set_size(weights.n_elem);
 
   // Random sampling with replacement.
-  arma::uvec indices = arma::randi<arma::uvec>(dataset.n_cols,
-      arma::distr_param(0, dataset.n_cols - 1));
+  const arma::uvec indices = BootstrapIndices(dataset.n_cols);
   for (size_t i = 0; i < dataset.n_cols; ++i)
   {
     bootstrapDataset.col(i) = dataset.col(indices[i]);
@@ -324,6 +324,15 @@ class RandomForest
                 arma::Row<size_t>& predictions,
                 arma::mat& probabilities) const;
 
+  /**
+   * Append the trees of the random forest to the given FlatForest, for fast
+   * classification of many points.  The FlatForest gives the same predictions
+   * and probabilities as Classify().
+   *
+   * @param forest Forest to append the trees to.
+   */
+  void Flatten(tree::FlatForest& forest) const;
+
   //! Access a tree in the forest.
   const DecisionTreeType& Tree(const size_t i) const { return trees[i]; }
   //! Modify a tree in the forest (be careful!).
@@ -371,6 +380,45 @@ class RandomForest
                const size_t maximumDepth,
                DimensionSelectionType& dimensionSelector);
 
+  /**
+   * Train each tree of the (already resized) forest on a bootstrap sample of
+   * the dataset, by calling TrainSubset() on each tree.  The parameters are
+   * the same as for Train().
+   */
+  template<bool UseWeights, bool UseDatasetInfo, typename MatType>
+  double TrainTrees(const MatType& data,
+                    const data::DatasetInfo& datasetInfo,
+                    const arma::Row<size_t>& labels,
+                    const size_t numClasses,
+                    const arma::rowvec& weights,
+                    const size_t numTrees,
+                    const size_t minimumLeafSize,
+                    const double minimumGainSplit,
+                    const size_t maximumDepth,
+                    DimensionSelectionType& dimensionSelector,
+                    std::false_type /* binned */);
+
+  /**
+   * Train each tree of the (already resized) forest on a bootstrap sample of
+   * the dataset, for numeric split types that bin each dimension (see
+   * NumericSplitTraits).  The dataset is binned once with
+   * DecisionTreeType::BinData(), and each tree is trained on the bins of its
+   * sample with TrainHistogram().  If any dimension is categorical, this falls
+   * back to the other overload.  The parameters are the same as for Train().
+   */
+  template<bool UseWeights, bool UseDatasetInfo, typename MatType>
+  double TrainTrees(const MatType& data,
+                    const data::DatasetInfo& datasetInfo,
+                    const arma::Row<size_t>& labels,
+                    const size_t numClasses,
+                    const arma::rowvec& weights,
+                    const size_t numTrees,
+                    const size_t minimumLeafSize,
+                    const double minimumGainSplit,
+                    const size_t maximumDepth,
+                    DimensionSelectionType& dimensionSelector,
+                    std::true_type /* binned */);
+
   //! The trees in the forest.
   std::vector<DecisionTreeType> trees;
 };
@@ -407,6 +407,26 @@ void RandomForest<
   }
 }
 
+template<
+    typename FitnessFunction,
+    typename DimensionSelectionType,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType,
+    typename ElemType
+>
+void RandomForest<
+    FitnessFunction,
+    DimensionSelectionType,
+    NumericSplitType,
+    CategoricalSplitType,
+    ElemType
+>::Flatten(tree::FlatForest& forest) const
+{
+  // Each tree has the same weight, so the forest averages their probabilities.
+  for (size_t i = 0; i < trees.size(); ++i)
+    trees[i].Flatten(forest);
+}
+
 template<
     typename FitnessFunction,
     typename DimensionSelectionType,
@@ -465,17 +485,54 @@ double RandomForest<
 {
   // Train each tree individually.
   trees.resize(numTrees); // This will fill the vector with untrained trees.
+
+  // Split types that bin the dimensions can share the bins between the trees.
+  typedef NumericSplitTraits<NumericSplitType<FitnessFunction>> SplitTraits;
+  return TrainTrees<UseWeights, UseDatasetInfo>(dataset, datasetInfo, labels,
+      numClasses, weights, numTrees, minimumLeafSize, minimumGainSplit,
+      maximumDepth, dimensionSelector,
+      std::integral_constant<bool, SplitTraits::UsesBins>());
+}
+
+template<
+    typename FitnessFunction,
+    typename DimensionSelectionType,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType,
+    typename ElemType
+>
+template<bool UseWeights, bool UseDatasetInfo, typename MatType>
+double RandomForest<
+    FitnessFunction,
+    DimensionSelectionType,
+    NumericSplitType,
+    CategoricalSplitType,
+    ElemType
+>::TrainTrees(const MatType& dataset,
+              const data::DatasetInfo& datasetInfo,
+              const arma::Row<size_t>& labels,
+              const size_t numClasses,
+              const arma::rowvec& weights,
+              const size_t numTrees,
+              const size_t minimumLeafSize,
+              const double minimumGainSplit,
+              const size_t maximumDepth,
+              DimensionSelectionType& dimensionSelector,
+              std::false_type /* binned */)
+{
   double avgGain = 0.0;
 
-  #pragma omp parallel for reduction( + : avgGain)
+  // Each tree is built by one thread, but the trees split their large nodes
+  // into tasks (see DecisionTree::Train()).  Threads that have no tree left to
+  // build wait at the end of the loop, where they take those tasks, so a forest
+  // with fewer trees than threads still uses all of the threads.
+  #pragma omp parallel for schedule(dynamic) reduction( + : avgGain)
   for (omp_size_t i = 0; i < numTrees; ++i)
   {
+    // The bootstrap sample is a vector of indices into the dataset, so the
+    // dataset is not copied for each tree.
     Timer::Start("bootstrap");
-    MatType bootstrapDataset;
-    arma::Row<size_t> bootstrapLabels;
-    arma::rowvec bootstrapWeights;
-    Bootstrap<UseWeights>(dataset, labels, weights, bootstrapDataset,
-        bootstrapLabels, bootstrapWeights);
+    arma::uvec points = BootstrapIndices(dataset.n_cols);
     Timer::Stop("bootstrap");
 
     // Now build the decision tree.
@@ -484,31 +541,111 @@ double RandomForest<
     {
       if (UseDatasetInfo)
       {
-        avgGain += trees[i].Train(bootstrapDataset, datasetInfo,
-            bootstrapLabels, numClasses, bootstrapWeights, minimumLeafSize,
-            minimumGainSplit, maximumDepth, dimensionSelector);
+        avgGain += trees[i].TrainSubset(dataset, std::move(points), datasetInfo,
+            labels, numClasses, weights, minimumLeafSize, minimumGainSplit,
+            maximumDepth, dimensionSelector);
       }
       else
       {
-        avgGain += trees[i].Train(bootstrapDataset, bootstrapLabels, numClasses,
-            bootstrapWeights, minimumLeafSize, minimumGainSplit, maximumDepth,
-            dimensionSelector);
+        avgGain += trees[i].TrainSubset(dataset, std::move(points), labels,
+            numClasses, weights, minimumLeafSize, minimumGainSplit,
+            maximumDepth, dimensionSelector);
       }
     }
     else
     {
       if (UseDatasetInfo)
       {
-        avgGain += trees[i].Train(bootstrapDataset, datasetInfo,
-            bootstrapLabels, numClasses, minimumLeafSize, minimumGainSplit,
-            maximumDepth, dimensionSelector);
+        avgGain += trees[i].TrainSubset(dataset, std::move(points), datasetInfo,
+            labels, numClasses, minimumLeafSize, minimumGainSplit, maximumDepth,
+            dimensionSelector);
       }
       else
       {
-        avgGain += trees[i].Train(bootstrapDataset, bootstrapLabels, numClasses,
-            minimumLeafSize, minimumGainSplit, maximumDepth, dimensionSelector);
+        avgGain += trees[i].TrainSubset(dataset, std::move(points), labels,
+            numClasses, minimumLeafSize, minimumGainSplit, maximumDepth,
+            dimensionSelector);
+      }
+    }
+    Timer::Stop("train_tree");
+  }
+  return avgGain / numTrees;
+}
+
+template<
+    typename FitnessFunction,
+    typename DimensionSelectionType,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType,
+    typename ElemType
+>
+template<bool UseWeights, bool UseDatasetInfo, typename MatType>
+double RandomForest<
+    FitnessFunction,
+    DimensionSelectionType,
+    NumericSplitType,
+    CategoricalSplitType,
+    ElemType
+>::TrainTrees(const MatType& dataset,
+              const data::DatasetInfo& datasetInfo,
+              const arma::Row<size_t>& labels,
+              const size_t numClasses,
+              const arma::rowvec& weights,
+              const size_t numTrees,
+              const size_t minimumLeafSize,
+              const double minimumGainSplit,
+              const size_t maximumDepth,
+              DimensionSelectionType& dimensionSelector,
+              std::true_type /* binned */)
+{
+  // The bins only hold numeric dimensions.
+  if (UseDatasetInfo)
+  {
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+    {
+      if (datasetInfo.Type(d) != data::Datatype::numeric)
+      {
+        return TrainTrees<UseWeights, UseDatasetInfo>(dataset, datasetInfo,
+            labels, numClasses, weights, numTrees, minimumLeafSize,
+            minimumGainSplit, maximumDepth, dimensionSelector,
+            std::false_type());
       }
     }
+  }
+
+  // Bin each dimension once for the whole forest.  Every tree is trained on
+  // the bins of its bootstrap sample, so no tree bins the data again.
+  Timer::Start("binning");
+  arma::Mat<unsigned char> bins;
+  arma::Mat<typename MatType::elem_type> binMin, binMax;
+  DecisionTreeType::BinData(dataset, bins, binMin, binMax);
+  Timer::Stop("binning");
+
+  double avgGain = 0.0;
+
+  // Like in the other TrainTrees(), the trees split their large nodes into
+  // tasks that idle threads can take.
+  #pragma omp parallel for schedule(dynamic) reduction( + : avgGain)
+  for (omp_size_t i = 0; i < numTrees; ++i)
+  {
+    Timer::Start("bootstrap");
+    arma::uvec points = BootstrapIndices(dataset.n_cols);
+    Timer::Stop("bootstrap");
+
+    // Now build the decision tree.
+    Timer::Start("train_tree");
+    if (UseWeights)
+    {
+      avgGain += trees[i].TrainHistogram(dataset, bins, binMin, binMax,
+          std::move(points), labels, numClasses, weights, minimumLeafSize,
+          minimumGainSplit, maximumDepth, dimensionSelector);
+    }
+    else
+    {
+      avgGain += trees[i].TrainHistogram(dataset, bins, binMin, binMax,
+          std::move(points), labels, numClasses, minimumLeafSize,
+          minimumGainSplit, maximumDepth, dimensionSelector);
+    }
     Timer::Stop("train_tree");
   }
   return avgGain / numTrees;
@@ -262,6 +262,63 @@ class RangeSearch
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, returning the results in compressed sparse row (CSR) form.  This
+   * avoids allocating a separate vector for each query point, and keeps all of
+   * the results contiguous in memory, which is much cheaper when there are many
+   * query points or many results per query point.
+   *
+   * That is:
+   *
+   * - offsets.size() is equal to the number of query points plus one.
+   *
+   * - The indices of the reference points in the range of query point i are
+   *   neighbors[offsets[i]] through neighbors[offsets[i + 1] - 1].
+   *
+   * - distances[j] is the distance corresponding to neighbors[j].
+   *
+   * - The neighbors of each query point are not sorted in any particular order.
+   *
+   * The results take exactly sizeof(size_t) + sizeof(double) bytes each, plus
+   * one offset per query point.  Naive and single-tree search find the results
+   * of one query point at a time and append them, so the vectors may grow
+   * geometrically.  Dual-tree search finds the results in no particular order,
+   * so it traverses the trees twice: once to count the results of each query
+   * point, and once to write them in place in vectors of exactly the right
+   * size.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param offsets Object which will hold the offset of the first result of
+   *      each query point.
+   * @param neighbors Object which will hold the neighbors of all query points.
+   * @param distances Object which will hold the distances of all neighbors.
+   */
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              std::vector<size_t>& offsets,
+              std::vector<size_t>& neighbors,
+              std::vector<double>& distances);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set (which was passed to the constructor), returning the results in
+   * compressed sparse row (CSR) form.  The query set and the reference set are
+   * the same, and a point is not returned as its own neighbor.  See the
+   * overload of Search() above for the format of the results.
+   *
+   * @param range Range of distances in which to search.
+   * @param offsets Object which will hold the offset of the first result of
+   *      each query point.
+   * @param neighbors Object which will hold the neighbors of all query points.
+   * @param distances Object which will hold the distances of all neighbors.
+   */
+  void Search(const math::Range& range,
+              std::vector<size_t>& offsets,
+              std::vector<size_t>& neighbors,
+              std::vector<double>& distances);
+
   //! Get whether single-tree search is being used.
   bool SingleMode() const { return singleMode; }
   //! Modify whether single-tree search is being used.
@@ -312,6 +369,24 @@ class RangeSearch
   //! The total number of scores during the last search.
   size_t scores;
 
+  /**
+   * Perform the dual-tree search of the given query tree in two traversals:
+   * the first counts the results of each query point, and the second writes
+   * each result directly into its place in compressed sparse row form.  If
+   * queryMap or referenceMap is not empty, it is used to map the query or
+   * reference indices back to their original values.  The base cases and
+   * scores of both traversals are added to the counts of this object.
+   */
+  void DualTreeSearch(Tree& queryTree,
+                      const MatType& querySet,
+                      const math::Range& range,
+                      const bool sameSet,
+                      const std::vector<size_t>& queryMap,
+                      const std::vector<size_t>& referenceMap,
+                      std::vector<size_t>& offsets,
+                      std::vector<size_t>& neighbors,
+                      std::vector<double>& distances);
+
   //! For access to mappings when building models.
   friend class TrainVisitor;
 };
@@ -618,6 +618,270 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   }
 }
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const math::Range& range,
+    std::vector<size_t>& offsets,
+    std::vector<size_t>& neighbors,
+    std::vector<double>& distances)
+{
+  if (querySet.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "RangeSearch::Search(): dimensionalities of query set ("
+        << querySet.n_rows << ") and reference set (" << referenceSet->n_rows
+        << ") do not match!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  offsets.clear();
+  offsets.resize(querySet.n_cols + 1, 0);
+  neighbors.clear();
+  distances.clear();
+
+  // If there are no points, there is no search to be done.
+  if (referenceSet->n_cols == 0)
+    return;
+
+  Timer::Start("range_search/computing_neighbors");
+
+  typedef RangeSearchRules<MetricType, Tree> RuleType;
+
+  // Reset counts.
+  baseCases = 0;
+  scores = 0;
+
+  // Reference indices only need to be mapped if we built the reference tree
+  // ourselves.
+  const bool mapReferences = tree::TreeTraits<Tree>::RearrangesDataset &&
+      treeOwner;
+
+  if (naive || singleMode)
+  {
+    // All results for one query point are found before the next query point is
+    // searched, so we can write the results directly in CSR form.
+    RuleType rules(*referenceSet, querySet, range, neighbors, distances, NULL,
+        metric);
+
+    if (naive)
+    {
+      // The naive brute-force solution.
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+      {
+        for (size_t j = 0; j < referenceSet->n_cols; ++j)
+          rules.BaseCase(i, j);
+        offsets[i + 1] = neighbors.size();
+      }
+
+      baseCases += (querySet.n_cols * referenceSet->n_cols);
+    }
+    else
+    {
+      // Create the traverser.
+      typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+
+      // Now have it traverse for each point.
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+      {
+        traverser.Traverse(i, *referenceTree);
+        offsets[i + 1] = neighbors.size();
+      }
+
+      baseCases += rules.BaseCases();
+      scores += rules.Scores();
+    }
+
+    Timer::Stop("range_search/computing_neighbors");
+
+    if (mapReferences)
+    {
+      for (size_t i = 0; i < neighbors.size(); ++i)
+        neighbors[i] = oldFromNewReferences[neighbors[i]];
+    }
+  }
+  else // Dual-tree recursion.
+  {
+    // Build the query tree.
+    Timer::Stop("range_search/computing_neighbors");
+    Timer::Start("range_search/tree_building");
+    std::vector<size_t> oldFromNewQueries;
+    Tree* queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+    Timer::Stop("range_search/tree_building");
+    Timer::Start("range_search/computing_neighbors");
+
+    const std::vector<size_t> noMapping;
+    DualTreeSearch(*queryTree, queryTree->Dataset(), range, false,
+        oldFromNewQueries, mapReferences ? oldFromNewReferences : noMapping,
+        offsets, neighbors, distances);
+
+    // Clean up tree memory.
+    delete queryTree;
+
+    Timer::Stop("range_search/computing_neighbors");
+  }
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const math::Range& range,
+    std::vector<size_t>& offsets,
+    std::vector<size_t>& neighbors,
+    std::vector<double>& distances)
+{
+  offsets.clear();
+  offsets.resize(referenceSet->n_cols + 1, 0);
+  neighbors.clear();
+  distances.clear();
+
+  // If there are no points, there is no search to be done.
+  if (referenceSet->n_cols == 0)
+    return;
+
+  Timer::Start("range_search/computing_neighbors");
+
+  // Here, we will use the query set as the reference set.
+  typedef RangeSearchRules<MetricType, Tree> RuleType;
+
+  // Do we need to map the reference indices?
+  const std::vector<size_t> noMapping;
+  const std::vector<size_t>& mapping =
+      (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset) ?
+      oldFromNewReferences : noMapping;
+
+  if (naive || singleMode)
+  {
+    // All results for one query point are found before the next query point is
+    // searched, so we can write the results directly in CSR form.
+    RuleType rules(*referenceSet, *referenceSet, range, neighbors, distances,
+        NULL, metric, true /* don't return the query in the results */);
+
+    if (naive)
+    {
+      // The naive brute-force solution.
+      for (size_t i = 0; i < referenceSet->n_cols; ++i)
+      {
+        for (size_t j = 0; j < referenceSet->n_cols; ++j)
+          rules.BaseCase(i, j);
+        offsets[i + 1] = neighbors.size();
+      }
+
+      baseCases = (referenceSet->n_cols * referenceSet->n_cols);
+      scores = 0;
+    }
+    else
+    {
+      // The points of the tree are also the query points, so if the tree
+      // rearranged them, we search them in their original order.
+      std::vector<size_t> newFromOld(mapping.size());
+      for (size_t i = 0; i < mapping.size(); ++i)
+        newFromOld[mapping[i]] = i;
+
+      // Create the traverser.
+      typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+
+      // Now have it traverse for each point.
+      for (size_t i = 0; i < referenceSet->n_cols; ++i)
+      {
+        traverser.Traverse(mapping.empty() ? i : newFromOld[i],
+            *referenceTree);
+        offsets[i + 1] = neighbors.size();
+      }
+
+      baseCases = rules.BaseCases();
+      scores = rules.Scores();
+    }
+
+    if (!mapping.empty())
+    {
+      for (size_t i = 0; i < neighbors.size(); ++i)
+        neighbors[i] = mapping[neighbors[i]];
+    }
+  }
+  else // Dual-tree recursion.
+  {
+    baseCases = 0;
+    scores = 0;
+    DualTreeSearch(*referenceTree, *referenceSet, range, true, mapping,
+        mapping, offsets, neighbors, distances);
+  }
+
+  Timer::Stop("range_search/computing_neighbors");
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::DualTreeSearch(
+    Tree& queryTree,
+    const MatType& querySet,
+    const math::Range& range,
+    const bool sameSet,
+    const std::vector<size_t>& queryMap,
+    const std::vector<size_t>& referenceMap,
+    std::vector<size_t>& offsets,
+    std::vector<size_t>& neighbors,
+    std::vector<double>& distances)
+{
+  typedef RangeSearchRules<MetricType, Tree> RuleType;
+  const size_t numQueries = querySet.n_cols;
+
+  // The dual-tree traversal finds the results in no particular order.  So we
+  // first traverse only to count the results of each query point (the counts
+  // are in the order of the query tree).
+  std::vector<size_t> positions(numQueries, 0);
+  {
+    RuleType rules(*referenceSet, querySet, range, positions, metric, sameSet);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+
+    baseCases += rules.BaseCases();
+    scores += rules.Scores();
+  }
+
+  // Turn the counts into offsets of the original query points, then into the
+  // position of the first result of each query point.
+  offsets.clear();
+  offsets.resize(numQueries + 1, 0);
+  for (size_t i = 0; i < numQueries; ++i)
+    offsets[(queryMap.empty() ? i : queryMap[i]) + 1] = positions[i];
+  for (size_t i = 1; i <= numQueries; ++i)
+    offsets[i] += offsets[i - 1];
+  for (size_t i = 0; i < numQueries; ++i)
+    positions[i] = offsets[queryMap.empty() ? i : queryMap[i]];
+
+  // Now traverse again, and write each result directly into its place.  This
+  // takes twice the time, but no result is held more than once: the memory is
+  // exactly one index and one distance per result.
+  neighbors.resize(offsets[numQueries]);
+  distances.resize(offsets[numQueries]);
+  {
+    RuleType rules(*referenceSet, querySet, range, neighbors, distances,
+        &positions, metric, sameSet);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+
+    baseCases += rules.BaseCases();
+    scores += rules.Scores();
+  }
+
+  if (!referenceMap.empty())
+  {
+    for (size_t i = 0; i < neighbors.size(); ++i)
+      neighbors[i] = referenceMap[neighbors[i]];
+  }
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/metrics/block_distances.hpp>
 
 namespace mlpack {
 namespace range {
@@ -49,6 +50,57 @@ class RangeSearchRules
                    MetricType& metric,
                    const bool sameSet = false);
 
+  /**
+   * Construct the RangeSearchRules object, storing the results in flat vectors
+   * instead of in one vector per query point.  If positions is NULL, each
+   * result is appended to neighbors and distances, so the results of one query
+   * point must be collected before the next query point is searched (as in
+   * single-tree or naive search).  Otherwise, neighbors and distances must
+   * already have room for every result, and each result of query point i is
+   * written at index positions[i], which is then incremented; the positions can
+   * be found with the counting constructor below.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param range Range to search for.
+   * @param neighbors Vector to store resulting neighbors in.
+   * @param distances Vector to store resulting distances in.
+   * @param positions Index of the next result of each query point in
+   *      neighbors and distances, or NULL to append the results.
+   * @param metric Instantiated metric.
+   * @param sameSet If true, the query and reference set are taken to be the
+   *      same, and a query point will not return itself in the results.
+   */
+  RangeSearchRules(const arma::mat& referenceSet,
+                   const arma::mat& querySet,
+                   const math::Range& range,
+                   std::vector<size_t>& neighbors,
+                   std::vector<double>& distances,
+                   std::vector<size_t>* positions,
+                   MetricType& metric,
+                   const bool sameSet = false);
+
+  /**
+   * Construct the RangeSearchRules object, only counting the results of each
+   * query point instead of storing them.  A traversal with these rules finds
+   * the sizes needed by a second traversal that stores the results in place.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param range Range to search for.
+   * @param counts Number of results of each query point; each result is added
+   *      to it.
+   * @param metric Instantiated metric.
+   * @param sameSet If true, the query and reference set are taken to be the
+   *      same, and a query point will not return itself in the results.
+   */
+  RangeSearchRules(const arma::mat& referenceSet,
+                   const arma::mat& querySet,
+                   const math::Range& range,
+                   std::vector<size_t>& counts,
+                   MetricType& metric,
+                   const bool sameSet = false);
+
   /**
    * Compute the base case between the given query point and reference point.
    *
@@ -57,6 +109,23 @@ class RangeSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Compute the base cases between every query point in [queryBegin, queryEnd)
+   * and every reference point in [referenceBegin, referenceEnd).  This gives
+   * the same results as calling BaseCase() for every pair, but all of the
+   * distances are computed at once with metric::BlockDistances().  The norms
+   * of each reference leaf are cached, so they are only computed once.
+   *
+   * @param queryBegin Index of the first query point.
+   * @param queryEnd One past the index of the last query point.
+   * @param referenceBegin Index of the first reference point.
+   * @param referenceEnd One past the index of the last reference point.
+   */
+  void BaseCaseBlock(const size_t queryBegin,
+                     const size_t queryEnd,
+                     const size_t referenceBegin,
+                     const size_t referenceEnd);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -127,11 +196,29 @@ class RangeSearchRules
   //! The range of distances for which we are searching.
   const math::Range& range;
 
-  //! The vector the resultant neighbor indices should be stored in.
-  std::vector<std::vector<size_t> >& neighbors;
+  //! The vector the resultant neighbor indices should be stored in (NULL if
+  //! flat results are used).
+  std::vector<std::vector<size_t> >* neighbors;
 
-  //! The vector the resultant neighbor distances should be stored in.
-  std::vector<std::vector<double> >& distances;
+  //! The vector the resultant neighbor distances should be stored in (NULL if
+  //! flat results are used).
+  std::vector<std::vector<double> >* distances;
+
+  //! The flat vector of resultant neighbor indices (NULL if one vector per
+  //! query point is used).
+  std::vector<size_t>* flatNeighbors;
+
+  //! The flat vector of resultant neighbor distances (NULL if one vector per
+  //! query point is used).
+  std::vector<double>* flatDistances;
+
+  //! The index of the next result of each query point in the flat vectors
+  //! (NULL if the results are appended).
+  std::vector<size_t>* flatPositions;
+
+  //! The number of results of each query point (NULL unless the results are
+  //! only counted).
+  std::vector<size_t>* resultCounts;
 
   //! The instantiated metric.
   MetricType& metric;
@@ -143,6 +230,10 @@ class RangeSearchRules
   size_t lastQueryIndex;
   //! The last reference index.
   size_t lastReferenceIndex;
+  //! The distances computed by the last call to BaseCaseBlock().
+  arma::mat blockDistances;
+  //! The norms of each reference leaf, cached by BaseCaseBlock().
+  metric::BlockNormCache<double> referenceNorms;
 
   //! Add all the points in the given node to the results for the given query
   //! point.  If the base case has already been calculated, we make sure to not
@@ -150,6 +241,11 @@ class RangeSearchRules
   void AddResult(const size_t queryIndex,
                  TreeType& referenceNode);
 
+  //! Store a single result for the given query point.
+  void StoreResult(const size_t queryIndex,
+                   const size_t referenceIndex,
+                   const double distance);
+
   TraversalInfoType traversalInfo;
 
   //! The number of base cases.
@@ -30,8 +30,68 @@ RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
     referenceSet(referenceSet),
     querySet(querySet),
     range(range),
-    neighbors(neighbors),
-    distances(distances),
+    neighbors(&neighbors),
+    distances(&distances),
+    flatNeighbors(NULL),
+    flatDistances(NULL),
+    flatPositions(NULL),
+    resultCounts(NULL),
+    metric(metric),
+    sameSet(sameSet),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename TreeType>
+RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
+    const arma::mat& referenceSet,
+    const arma::mat& querySet,
+    const math::Range& range,
+    std::vector<size_t>& neighbors,
+    std::vector<double>& distances,
+    std::vector<size_t>* positions,
+    MetricType& metric,
+    const bool sameSet) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    range(range),
+    neighbors(NULL),
+    distances(NULL),
+    flatNeighbors(&neighbors),
+    flatDistances(&distances),
+    flatPositions(positions),
+    resultCounts(NULL),
+    metric(metric),
+    sameSet(sameSet),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename TreeType>
+RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
+    const arma::mat& referenceSet,
+    const arma::mat& querySet,
+    const math::Range& range,
+    std::vector<size_t>& counts,
+    MetricType& metric,
+    const bool sameSet) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    range(range),
+    neighbors(NULL),
+    distances(NULL),
+    flatNeighbors(NULL),
+    flatDistances(NULL),
+    flatPositions(NULL),
+    resultCounts(&counts),
     metric(metric),
     sameSet(sameSet),
     lastQueryIndex(querySet.n_cols),
@@ -67,14 +127,47 @@ double RangeSearchRules<MetricType, TreeType>::BaseCase(
   lastReferenceIndex = referenceIndex;
 
   if (range.Contains(distance))
-  {
-    neighbors[queryIndex].push_back(referenceIndex);
-    distances[queryIndex].push_back(distance);
-  }
+    StoreResult(queryIndex, referenceIndex, distance);
 
   return distance;
 }
 
+//! Compute the base cases between two blocks of points.
+template<typename MetricType, typename TreeType>
+void RangeSearchRules<MetricType, TreeType>::BaseCaseBlock(
+    const size_t queryBegin,
+    const size_t queryEnd,
+    const size_t referenceBegin,
+    const size_t referenceEnd)
+{
+  metric::BlockDistances(metric, querySet, queryBegin, queryEnd - queryBegin,
+      referenceSet, referenceBegin, referenceEnd - referenceBegin,
+      blockDistances, referenceNorms);
+
+  for (size_t queryIndex = queryBegin; queryIndex < queryEnd; ++queryIndex)
+  {
+    for (size_t referenceIndex = referenceBegin; referenceIndex < referenceEnd;
+         ++referenceIndex)
+    {
+      // Skip the same pairs that BaseCase() would skip.
+      if ((sameSet && (queryIndex == referenceIndex)) ||
+          ((lastQueryIndex == queryIndex) &&
+           (lastReferenceIndex == referenceIndex)))
+        continue;
+
+      const double distance = blockDistances(queryIndex - queryBegin,
+          referenceIndex - referenceBegin);
+      ++baseCases;
+
+      lastQueryIndex = queryIndex;
+      lastReferenceIndex = referenceIndex;
+
+      if (range.Contains(distance))
+        StoreResult(queryIndex, referenceIndex, distance);
+    }
+  }
+}
+
 //! Single-tree scoring function.
 template<typename MetricType, typename TreeType>
 double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
@@ -239,11 +332,16 @@ void RangeSearchRules<MetricType, TreeType>::AddResult(const size_t queryIndex,
   // Resize distances and neighbors vectors appropriately.  We have to use
   // reserve() and not resize(), because we don't know if we will encounter the
   // case where the datasets and points are the same (and we skip in that case).
-  const size_t oldSize = neighbors[queryIndex].size();
-  neighbors[queryIndex].reserve(oldSize + referenceNode.NumDescendants() -
-      baseCaseMod);
-  distances[queryIndex].reserve(oldSize + referenceNode.NumDescendants() -
-      baseCaseMod);
+  // Flat results are either appended, and left to grow geometrically, or
+  // already have room.
+  if (neighbors != NULL)
+  {
+    const size_t oldSize = (*neighbors)[queryIndex].size();
+    (*neighbors)[queryIndex].reserve(oldSize + referenceNode.NumDescendants() -
+        baseCaseMod);
+    (*distances)[queryIndex].reserve(oldSize + referenceNode.NumDescendants() -
+        baseCaseMod);
+  }
 
   for (size_t i = baseCaseMod; i < referenceNode.NumDescendants(); ++i)
   {
@@ -251,11 +349,46 @@ void RangeSearchRules<MetricType, TreeType>::AddResult(const size_t queryIndex,
         (queryIndex == referenceNode.Descendant(i)))
       continue;
 
+    // When only counting, the distance is not needed.
+    if (resultCounts != NULL)
+    {
+      ++(*resultCounts)[queryIndex];
+      continue;
+    }
+
     const double distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
         referenceNode.Dataset().unsafe_col(referenceNode.Descendant(i)));
 
-    neighbors[queryIndex].push_back(referenceNode.Descendant(i));
-    distances[queryIndex].push_back(distance);
+    StoreResult(queryIndex, referenceNode.Descendant(i), distance);
+  }
+}
+
+template<typename MetricType, typename TreeType>
+inline force_inline
+void RangeSearchRules<MetricType, TreeType>::StoreResult(
+    const size_t queryIndex,
+    const size_t referenceIndex,
+    const double distance)
+{
+  if (neighbors != NULL)
+  {
+    (*neighbors)[queryIndex].push_back(referenceIndex);
+    (*distances)[queryIndex].push_back(distance);
+  }
+  else if (resultCounts != NULL)
+  {
+    ++(*resultCounts)[queryIndex];
+  }
+  else if (flatPositions != NULL)
+  {
+    const size_t position = (*flatPositions)[queryIndex]++;
+    (*flatNeighbors)[position] = referenceIndex;
+    (*flatDistances)[position] = distance;
+  }
+  else
+  {
+    flatNeighbors->push_back(referenceIndex);
+    flatDistances->push_back(distance);
   }
 }
 
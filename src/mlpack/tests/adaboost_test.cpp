@@ -894,4 +894,36 @@ BOOST_AUTO_TEST_CASE(ID3DecisionStumpSerializationTest)
   }
 }
 
+/**
+ * Make sure that a FlatForest built from AdaBoost with decision stumps gives
+ * the same predictions and probabilities as AdaBoost.
+ */
+BOOST_AUTO_TEST_CASE(FlatForestTest)
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+
+  arma::Mat<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+
+  const size_t numClasses = 3;
+  arma::Row<size_t> labelsvec = labels.row(0);
+  ID3DecisionStump ds(inputData, labelsvec, numClasses, 6);
+  AdaBoost<ID3DecisionStump> a(inputData, labelsvec, numClasses, ds, 50,
+      1e-10);
+
+  FlatForest flat(a);
+  BOOST_REQUIRE_EQUAL(flat.NumTrees(), a.WeakLearners());
+
+  arma::Row<size_t> predictions, flatPredictions;
+  arma::mat probabilities, flatProbabilities;
+  a.Classify(inputData, predictions, probabilities);
+  flat.Classify(inputData, flatPredictions, flatProbabilities);
+
+  CheckMatrices(predictions, flatPredictions);
+  CheckMatrices(probabilities, flatProbabilities);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,174 @@
+/**
+ * @file batch_source_test.cpp
+ *
+ * Tests for the batch sources and StreamingFunction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/data/batch_sources/binary_batch_source.hpp>
+#include <mlpack/core/data/batch_sources/csv_batch_source.hpp>
+#include <mlpack/core/data/batch_sources/mapped_batch_source.hpp>
+#include <mlpack/core/data/batch_sources/streaming_function.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+#include <mlpack/methods/softmax_regression/softmax_regression.hpp>
+#include <ensmallen.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace mlpack;
+using namespace mlpack::data;
+using namespace mlpack::regression;
+
+BOOST_AUTO_TEST_SUITE(BatchSourceTest);
+
+/**
+ * Make sure that every block of a source holds the right points.
+ */
+template<typename SourceType>
+void CheckBlocks(SourceType& source, const arma::mat& dataset)
+{
+  BOOST_REQUIRE_EQUAL(source.NumPoints(), dataset.n_cols);
+  BOOST_REQUIRE_EQUAL(source.Dimensionality(), dataset.n_rows);
+
+  arma::mat block;
+  for (size_t begin = 0; begin < dataset.n_cols; begin += 37)
+  {
+    const size_t count = std::min((size_t) 37, dataset.n_cols - begin);
+    source.Block(begin, count, block);
+
+    BOOST_REQUIRE_EQUAL(block.n_rows, dataset.n_rows);
+    BOOST_REQUIRE_EQUAL(block.n_cols, count);
+    const arma::mat expected = dataset.cols(begin, begin + count - 1);
+    for (size_t i = 0; i < block.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(block[i], expected[i], 1e-5);
+  }
+
+  // Asking for points past the end must fail.
+  BOOST_REQUIRE_THROW(source.Block(dataset.n_cols - 1, 2, block),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that each batch source reads the right blocks.
+ */
+BOOST_AUTO_TEST_CASE(BatchSourceBlocksTest)
+{
+  arma::mat dataset(4, 500, arma::fill::randu);
+  data::Save("test_batch.csv", dataset);
+  data::Save("test_batch.mbin", dataset);
+
+  CSVBatchSource<> csvSource("test_batch.csv", 16);
+  CheckBlocks(csvSource, dataset);
+
+  BinaryBatchSource<> binarySource("test_batch.mbin");
+  CheckBlocks(binarySource, dataset);
+
+  {
+    MappedBatchSource<> mappedSource("test_batch.mbin");
+    CheckBlocks(mappedSource, dataset);
+  }
+
+  remove("test_batch.csv");
+  remove("test_batch.mbin");
+}
+
+/**
+ * Make sure that a StreamingFunction gives the same objective and gradient as
+ * the function on the whole dataset, when batches cross block boundaries.
+ */
+BOOST_AUTO_TEST_CASE(StreamingFunctionEvaluateTest)
+{
+  arma::mat dataset(5, 1000, arma::fill::randn);
+  arma::Row<size_t> labels(1000);
+  for (size_t i = 0; i < 1000; ++i)
+    labels[i] = (dataset(0, i) + dataset(2, i) > 0) ? 1 : 0;
+  data::Save("test_batch.mbin", dataset);
+
+  BinaryBatchSource<> source("test_batch.mbin");
+  StreamingFunction<LogisticRegressionFunction<>, BinaryBatchSource<>>
+      f(source, labels, 128, 0.0);
+  LogisticRegressionFunction<> lrf(dataset, labels, 0.0);
+
+  BOOST_REQUIRE_EQUAL(f.NumFunctions(), 1000);
+  BOOST_REQUIRE_EQUAL(f.NumBlocks(), 8);
+
+  const arma::mat parameters(1, 6, arma::fill::randn);
+  for (size_t begin = 0; begin < 1000; begin += 100)
+  {
+    const size_t batchSize = std::min((size_t) 150, 1000 - begin);
+
+    arma::mat gradient, streamingGradient, otherGradient;
+    const double objective = lrf.EvaluateWithGradient(parameters, begin,
+        gradient, batchSize);
+    const double streamingObjective = f.EvaluateWithGradient(parameters, begin,
+        streamingGradient, batchSize);
+
+    BOOST_REQUIRE_CLOSE(streamingObjective, objective, 1e-5);
+    CheckMatrices(streamingGradient, gradient, 1e-5);
+
+    BOOST_REQUIRE_CLOSE(f.Evaluate(parameters, begin, batchSize), objective,
+        1e-5);
+    f.Gradient(parameters, begin, otherGradient, batchSize);
+    CheckMatrices(otherGradient, gradient, 1e-5);
+  }
+
+  // After shuffling, a full pass must still see every point once.
+  f.Shuffle();
+  arma::mat gradient, streamingGradient;
+  const double objective = lrf.EvaluateWithGradient(parameters, 0, gradient,
+      1000);
+  const double streamingObjective = f.EvaluateWithGradient(parameters, 0,
+      streamingGradient, 1000);
+  BOOST_REQUIRE_CLOSE(streamingObjective, objective, 1e-5);
+  CheckMatrices(streamingGradient, gradient, 1e-5);
+
+  remove("test_batch.mbin");
+}
+
+/**
+ * Train logistic regression and softmax regression with SGD on a mapped file,
+ * and make sure the models are good.
+ */
+BOOST_AUTO_TEST_CASE(StreamingFunctionTrainTest)
+{
+  arma::mat dataset(3, 2000, arma::fill::randn);
+  arma::Row<size_t> labels(2000);
+  for (size_t i = 0; i < 2000; ++i)
+  {
+    if (i % 2 == 0)
+      dataset.col(i) += 3.0;
+    labels[i] = (i % 2 == 0) ? 1 : 0;
+  }
+  data::Save("test_batch.mbin", dataset);
+
+  MappedBatchSource<> source("test_batch.mbin");
+
+  StreamingFunction<LogisticRegressionFunction<>, MappedBatchSource<>>
+      lrf(source, labels, 300, 0.0);
+  arma::mat lrParameters(1, 4, arma::fill::zeros);
+  ens::SGD<> sgd(0.01, 32, 20 * 2000, 1e-10);
+  sgd.Optimize(lrf, lrParameters);
+
+  LogisticRegression<> lr(3, 0.0);
+  lr.Parameters() = lrParameters;
+  BOOST_REQUIRE_GT(lr.ComputeAccuracy(dataset, labels), 95.0);
+
+  // SoftmaxRegressionFunction has no EvaluateWithGradient().
+  StreamingFunction<SoftmaxRegressionFunction, MappedBatchSource<>>
+      srf(source, labels, 300, 2, 0.0, false);
+  arma::mat srParameters = 0.005 * arma::randn<arma::mat>(2, 3);
+  sgd.Optimize(srf, srParameters);
+
+  SoftmaxRegression sr(3, 2, false);
+  sr.Parameters() = srParameters;
+  BOOST_REQUIRE_GT(sr.ComputeAccuracy(dataset, labels), 95.0);
+
+  remove("test_batch.mbin");
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -370,6 +370,136 @@ BOOST_AUTO_TEST_CASE(BestBinaryNumericSplitNoGainTest)
   BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 0);
 }
 
+/**
+ * Check that the HistogramNumericSplit will split on an obviously splittable
+ * dimension, at the same place as BestBinaryNumericSplit.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitSimpleSplitTest)
+{
+  arma::vec values("0.0 0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9 1.0");
+  arma::Row<size_t> labels("0 0 0 0 0 1 1 1 1 1 1");
+  arma::rowvec weights(labels.n_elem);
+  weights.ones();
+
+  arma::vec classProbabilities;
+  HistogramNumericSplit<GiniGain>::template AuxiliarySplitInfo<double> aux;
+
+  // Call the method to do the splitting.
+  const double bestGain = GiniGain::Evaluate<false>(labels, 2, weights);
+  const double gain = HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(
+      bestGain, values, labels, 2, weights, 3, 1e-7, classProbabilities,
+      aux);
+  const double weightedGain =
+      HistogramNumericSplit<GiniGain>::SplitIfBetter<true>(bestGain, values,
+      labels, 2, weights, 3, 1e-7, classProbabilities, aux);
+
+  // Make sure that a split was made, and that it is perfect.
+  BOOST_REQUIRE_GT(gain, bestGain);
+  BOOST_REQUIRE_EQUAL(gain, weightedGain);
+  BOOST_REQUIRE_SMALL(gain, 1e-5);
+
+  // The split point should be halfway between 0.4 and 0.5.
+  BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 1);
+  BOOST_REQUIRE_CLOSE(classProbabilities[0], 0.45, 1e-5);
+
+  // Too many points are needed in each leaf to split.
+  arma::vec noProbabilities;
+  BOOST_REQUIRE_EQUAL(HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(
+      bestGain, values, labels, 2, weights, 8, 1e-7, noProbabilities, aux),
+      DBL_MAX);
+  BOOST_REQUIRE_EQUAL(noProbabilities.n_elem, 0);
+}
+
+/**
+ * Check that the HistogramNumericSplit finds the same split as
+ * BestBinaryNumericSplit when every value falls in its own bin.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitMatchesBestBinaryTest)
+{
+  arma::vec values(200);
+  arma::Row<size_t> labels(200);
+  for (size_t i = 0; i < 200; ++i)
+  {
+    values[i] = (double) (i % 100);
+    labels[i] = ((i % 100) < 37 || (i % 100) >= 80) ? 0 : 1;
+  }
+  // Make the split noisy.
+  labels[5] = 1;
+  labels[150] = 0;
+  arma::rowvec weights(200, arma::fill::randu);
+
+  for (size_t weighted = 0; weighted < 2; ++weighted)
+  {
+    arma::vec bestProbabilities, histogramProbabilities;
+    BestBinaryNumericSplit<GiniGain>::AuxiliarySplitInfo<double> bestAux;
+    HistogramNumericSplit<GiniGain>::AuxiliarySplitInfo<double> histogramAux;
+
+    double bestGain, histogramGain;
+    if (weighted == 0)
+    {
+      const double gain = GiniGain::Evaluate<false>(labels, 2, weights);
+      bestGain = BestBinaryNumericSplit<GiniGain>::SplitIfBetter<false>(gain,
+          values, labels, 2, weights, 5, 1e-7, bestProbabilities, bestAux);
+      histogramGain = HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(
+          gain, values, labels, 2, weights, 5, 1e-7, histogramProbabilities,
+          histogramAux);
+    }
+    else
+    {
+      const double gain = GiniGain::Evaluate<true>(labels, 2, weights);
+      bestGain = BestBinaryNumericSplit<GiniGain>::SplitIfBetter<true>(gain,
+          values, labels, 2, weights, 5, 1e-7, bestProbabilities, bestAux);
+      histogramGain = HistogramNumericSplit<GiniGain>::SplitIfBetter<true>(
+          gain, values, labels, 2, weights, 5, 1e-7, histogramProbabilities,
+          histogramAux);
+    }
+
+    BOOST_REQUIRE_CLOSE(histogramGain, bestGain, 1e-5);
+    BOOST_REQUIRE_EQUAL(histogramProbabilities.n_elem, 1);
+    BOOST_REQUIRE_EQUAL(bestProbabilities.n_elem, 1);
+    BOOST_REQUIRE_CLOSE(histogramProbabilities[0], bestProbabilities[0], 1e-5);
+  }
+}
+
+/**
+ * Make sure a decision tree built with the HistogramNumericSplit generalizes
+ * about as well as one built with BestBinaryNumericSplit.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitGeneralizationTest)
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+
+  arma::mat testData;
+  if (!data::Load("vc2_test.csv", testData))
+    BOOST_FAIL("Cannot load test dataset vc2_test.csv!");
+
+  arma::Row<size_t> trueTestLabels;
+  if (!data::Load("vc2_test_labels.txt", trueTestLabels))
+    BOOST_FAIL("Cannot load labels for vc2_test_labels.txt");
+
+  arma::rowvec weights(labels.n_cols, arma::fill::ones);
+  DecisionTree<GiniGain, HistogramNumericSplit> d(inputData, labels, 3, 10);
+  DecisionTree<GiniGain, HistogramNumericSplit> wd(inputData, labels, 3,
+      weights, 10);
+
+  arma::Row<size_t> predictions;
+  d.Classify(testData, predictions);
+  BOOST_REQUIRE_EQUAL(predictions.n_elem, testData.n_cols);
+  BOOST_REQUIRE_GT(arma::accu(predictions == trueTestLabels),
+      0.75 * testData.n_cols);
+
+  wd.Classify(testData, predictions);
+  BOOST_REQUIRE_EQUAL(predictions.n_elem, testData.n_cols);
+  BOOST_REQUIRE_GT(arma::accu(predictions == trueTestLabels),
+      0.75 * testData.n_cols);
+}
+
 /**
  * Check that the AllCategoricalSplit will split when the split is obviously
  * better.
@@ -1246,4 +1376,390 @@ BOOST_AUTO_TEST_CASE(DifferentMaximumDepthTest)
   BOOST_REQUIRE_EQUAL(d2.Child(1).NumChildren(), 2);
 }
 
+/**
+ * Make sure that two decision trees have the same structure.
+ */
+template<typename TreeType>
+void CheckSameTree(const TreeType& tree, const TreeType& other)
+{
+  BOOST_REQUIRE_EQUAL(tree.NumChildren(), other.NumChildren());
+  if (tree.NumChildren() == 0)
+    return;
+
+  BOOST_REQUIRE_EQUAL(tree.SplitDimension(), other.SplitDimension());
+  for (size_t i = 0; i < tree.NumChildren(); ++i)
+    CheckSameTree(tree.Child(i), other.Child(i));
+}
+
+/**
+ * Make sure that two decision trees make the same predictions.
+ */
+template<typename TreeType>
+void CheckSamePredictions(const TreeType& tree,
+                          const TreeType& other,
+                          const arma::mat& data)
+{
+  arma::Row<size_t> predictions, otherPredictions;
+  arma::mat probabilities, otherProbabilities;
+  tree.Classify(data, predictions, probabilities);
+  other.Classify(data, otherPredictions, otherProbabilities);
+
+  for (size_t i = 0; i < data.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], otherPredictions[i]);
+  for (size_t i = 0; i < probabilities.n_elem; ++i)
+  {
+    if (std::abs(probabilities[i]) < 1e-10)
+      BOOST_REQUIRE_SMALL(otherProbabilities[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(probabilities[i], otherProbabilities[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure that TrainPresorted() builds the same tree as Train().
+ */
+BOOST_AUTO_TEST_CASE(PresortedTrainTest)
+{
+  arma::mat dataset;
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+
+  const size_t leafSizes[] = { 1, 5, 10 };
+  for (size_t leafSize : leafSizes)
+  {
+    DecisionTree<> d, presortedD;
+    const double entropy = d.Train(dataset, labels, 3, leafSize);
+    const double presortedEntropy = presortedD.TrainPresorted(dataset, labels,
+        3, leafSize);
+
+    BOOST_REQUIRE_CLOSE(entropy, presortedEntropy, 1e-5);
+    CheckSameTree(d, presortedD);
+    CheckSamePredictions(d, presortedD, dataset);
+  }
+
+  // Now limit the depth, and use the information gain.
+  DecisionTree<InformationGain> d(dataset, labels, 3, 2, 1e-7, 4);
+  DecisionTree<InformationGain> presortedD;
+  presortedD.TrainPresorted(dataset, labels, 3, 2, 1e-7, 4);
+  CheckSameTree(d, presortedD);
+  CheckSamePredictions(d, presortedD, dataset);
+}
+
+/**
+ * Make sure that the weighted TrainPresorted() builds the same tree as the
+ * weighted Train(), on a dataset with many duplicate values.
+ */
+BOOST_AUTO_TEST_CASE(PresortedWeightedTrainTest)
+{
+  arma::mat dataset = arma::floor(10 * arma::randu<arma::mat>(4, 1000));
+  arma::Row<size_t> labels(1000);
+  for (size_t i = 0; i < 1000; ++i)
+    labels[i] = (dataset(0, i) + dataset(2, i) > 9 ? 1 : 0) + (i % 7 == 0);
+  arma::rowvec weights(1000);
+  for (size_t i = 0; i < 1000; ++i)
+    weights[i] = 1.0 + (i % 4); // Exactly representable sums.
+
+  DecisionTree<> d(dataset, labels, 3, weights, 3);
+  DecisionTree<> presortedD;
+  presortedD.TrainPresorted(dataset, labels, 3, weights, 3);
+
+  CheckSameTree(d, presortedD);
+  CheckSamePredictions(d, presortedD, dataset);
+
+  // Mismatched labels must throw.
+  arma::Row<size_t> badLabels(999, arma::fill::zeros);
+  BOOST_REQUIRE_THROW(presortedD.TrainPresorted(dataset, badLabels, 3),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that TrainHistogram() builds the same tree as Train() with the
+ * HistogramNumericSplit when every value has its own bin, and that it gives a
+ * reasonable tree when there are more values than bins.
+ */
+BOOST_AUTO_TEST_CASE(HistogramTrainTest)
+{
+  typedef DecisionTree<GiniGain, HistogramNumericSplit> TreeType;
+
+  arma::mat dataset = arma::floor(50 * arma::randu<arma::mat>(4, 2000));
+  arma::Row<size_t> labels(2000);
+  for (size_t i = 0; i < 2000; ++i)
+    labels[i] = (dataset(0, i) + dataset(2, i) > 49 ? 1 : 0) + (i % 7 == 0);
+  arma::rowvec weights(2000);
+  for (size_t i = 0; i < 2000; ++i)
+    weights[i] = 1.0 + (i % 4); // Exactly representable sums.
+
+  TreeType d, histogramD;
+  const double entropy = d.Train(dataset, labels, 3, 3);
+  const double histogramEntropy = histogramD.TrainHistogram(dataset, labels, 3,
+      3);
+  BOOST_REQUIRE_CLOSE(entropy, histogramEntropy, 1e-5);
+  CheckSameTree(d, histogramD);
+  CheckSamePredictions(d, histogramD, dataset);
+
+  TreeType wd(dataset, labels, 3, weights, 3);
+  TreeType histogramWD;
+  histogramWD.TrainHistogram(dataset, labels, 3, weights, 3);
+  CheckSameTree(wd, histogramWD);
+  CheckSamePredictions(wd, histogramWD, dataset);
+
+  // Continuous values don't fit in the bins, but the tree should still
+  // generalize.
+  arma::mat inputData, testData;
+  arma::Row<size_t> trainLabels, trueTestLabels;
+  if (!data::Load("vc2.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+  if (!data::Load("vc2_labels.txt", trainLabels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+  if (!data::Load("vc2_test.csv", testData))
+    BOOST_FAIL("Cannot load test dataset vc2_test.csv!");
+  if (!data::Load("vc2_test_labels.txt", trueTestLabels))
+    BOOST_FAIL("Cannot load labels for vc2_test_labels.txt");
+
+  TreeType vd;
+  vd.TrainHistogram(inputData, trainLabels, 3, 10);
+  arma::Row<size_t> predictions;
+  vd.Classify(testData, predictions);
+  BOOST_REQUIRE_GT(arma::accu(predictions == trueTestLabels),
+      0.75 * testData.n_cols);
+
+  // Mismatched labels must throw.
+  arma::Row<size_t> badLabels(1999, arma::fill::zeros);
+  BOOST_REQUIRE_THROW(histogramD.TrainHistogram(dataset, badLabels, 3),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that a large decision tree built by several threads is the same as
+ * one built by one thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTrainTest)
+{
+  arma::mat dataset(6, 20000, arma::fill::randu);
+  arma::Row<size_t> labels(20000);
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    labels[i] = (dataset(1, i) + dataset(4, i) > 1.0) ? 1 : 0;
+    if (dataset(2, i) > 0.9)
+      labels[i] = 2;
+  }
+  arma::rowvec weights(20000, arma::fill::randu);
+
+  arma::mat categoricalDataset;
+  arma::Row<size_t> categoricalLabels;
+  data::DatasetInfo datasetInfo;
+  MockCategoricalData(categoricalDataset, categoricalLabels, datasetInfo);
+
+  DecisionTree<> d(dataset, labels, 3, 5);
+  DecisionTree<> wd(dataset, labels, 3, weights, 5);
+  DecisionTree<> pd;
+  pd.TrainPresorted(dataset, labels, 3, 5);
+  DecisionTree<> cd(categoricalDataset, datasetInfo, categoricalLabels, 5, 5);
+
+  #ifdef HAS_OPENMP
+  const size_t threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+  DecisionTree<> serialD(dataset, labels, 3, 5);
+  DecisionTree<> serialWD(dataset, labels, 3, weights, 5);
+  DecisionTree<> serialCD(categoricalDataset, datasetInfo, categoricalLabels,
+      5, 5);
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(threads);
+  #endif
+
+  CheckSameTree(d, serialD);
+  CheckSamePredictions(d, serialD, dataset);
+  CheckSameTree(wd, serialWD);
+  CheckSamePredictions(wd, serialWD, dataset);
+  CheckSameTree(pd, serialD);
+  CheckSamePredictions(pd, serialD, dataset);
+  CheckSameTree(cd, serialCD);
+  CheckSamePredictions(cd, serialCD, categoricalDataset);
+}
+
+/**
+ * Make sure that trees with random dimension selectors built by several
+ * threads are the same as the ones built by a single thread from the same
+ * seed.
+ */
+BOOST_AUTO_TEST_CASE(ParallelRandomSelectorTrainTest)
+{
+  typedef DecisionTree<GiniGain, BestBinaryNumericSplit, AllCategoricalSplit,
+      MultipleRandomDimensionSelect> MultipleRandomTree;
+  typedef DecisionTree<GiniGain, BestBinaryNumericSplit, AllCategoricalSplit,
+      RandomDimensionSelect> RandomTree;
+
+  arma::mat dataset(12, 20000, arma::fill::randu);
+  arma::Row<size_t> labels(20000);
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    labels[i] = (dataset(1, i) + dataset(4, i) > 1.0) ? 1 : 0;
+    if (dataset(7, i) > 0.9)
+      labels[i] = 2;
+  }
+  const arma::uvec points = arma::randi<arma::uvec>(15000,
+      arma::distr_param(0, 19999));
+
+  math::RandomSeed(42);
+  MultipleRandomTree m(dataset, labels, 3, 5, 1e-7, 0,
+      MultipleRandomDimensionSelect(3));
+  RandomTree r(dataset, labels, 3, 5);
+  MultipleRandomTree s;
+  s.TrainSubset(dataset, points, labels, 3, 5, 1e-7, 0,
+      MultipleRandomDimensionSelect(3));
+
+  #ifdef HAS_OPENMP
+  const size_t threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+  math::RandomSeed(42);
+  MultipleRandomTree serialM(dataset, labels, 3, 5, 1e-7, 0,
+      MultipleRandomDimensionSelect(3));
+  RandomTree serialR(dataset, labels, 3, 5);
+  MultipleRandomTree serialS;
+  serialS.TrainSubset(dataset, points, labels, 3, 5, 1e-7, 0,
+      MultipleRandomDimensionSelect(3));
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(threads);
+  #endif
+
+  CheckSameTree(m, serialM);
+  CheckSamePredictions(m, serialM, dataset);
+  CheckSameTree(r, serialR);
+  CheckSamePredictions(r, serialR, dataset);
+  CheckSameTree(s, serialS);
+  CheckSamePredictions(s, serialS, dataset);
+}
+
+/**
+ * Make sure that a FlatForest built from decision trees gives the same
+ * predictions and probabilities as the trees.
+ */
+BOOST_AUTO_TEST_CASE(FlatForestTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  DecisionTree<> tree(d, di, l, 5, 3);
+  DecisionTree<GiniGain, HistogramNumericSplit> histogramTree(d, l, 5, 3);
+
+  arma::Row<size_t> predictions, flatPredictions;
+  arma::mat probabilities, flatProbabilities;
+
+  FlatForest flat(tree);
+  tree.Classify(d, predictions, probabilities);
+  flat.Classify(d, flatPredictions, flatProbabilities);
+  CheckMatrices(predictions, flatPredictions);
+  CheckMatrices(probabilities, flatProbabilities);
+
+  FlatForest histogramFlat(histogramTree);
+  histogramTree.Classify(d, predictions, probabilities);
+  histogramFlat.Classify(d, flatPredictions, flatProbabilities);
+  CheckMatrices(predictions, flatPredictions);
+  CheckMatrices(probabilities, flatProbabilities);
+
+  // Two trees with different weights give the weighted average.
+  FlatForest weighted;
+  tree.Flatten(weighted, 3.0);
+  histogramTree.Flatten(weighted, 1.0);
+  BOOST_REQUIRE_EQUAL(weighted.NumTrees(), 2);
+
+  arma::mat otherProbabilities;
+  tree.Classify(d, predictions, otherProbabilities);
+  weighted.Classify(d, flatPredictions, flatProbabilities);
+  const arma::mat expected = (3.0 * otherProbabilities + probabilities) / 4.0;
+  CheckMatrices(expected, flatProbabilities);
+  for (size_t i = 0; i < d.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(flatPredictions[i], expected.col(i).index_max());
+}
+
+/**
+ * Make sure that a FlatForest sends categorical values outside of the range of
+ * categories (including NaN) to the first or last child.
+ */
+BOOST_AUTO_TEST_CASE(FlatForestCategoricalRangeTest)
+{
+  FlatForest flat;
+  const size_t root = flat.AddTree(3);
+  const size_t first = flat.AddCategoricalSplit(root, 0, 3);
+  for (size_t c = 0; c < 3; ++c)
+  {
+    arma::vec probabilities(3, arma::fill::zeros);
+    probabilities[c] = 1.0;
+    flat.SetLeaf(first + c, c, probabilities);
+  }
+
+  const double values[] = { 0.0, 1.0, 2.0, 1.5, -1.0, -1e300,
+      std::numeric_limits<double>::quiet_NaN(), 3.0, 1e300,
+      std::numeric_limits<double>::infinity(),
+      -std::numeric_limits<double>::infinity() };
+  const size_t expected[] = { 0, 1, 2, 1, 0, 0, 0, 2, 2, 2, 0 };
+  for (size_t i = 0; i < 11; ++i)
+  {
+    arma::vec point(1);
+    point[0] = values[i];
+    BOOST_REQUIRE_EQUAL(flat.Classify(point), expected[i]);
+  }
+}
+
+/**
+ * Make sure that TrainSubset() builds the same tree as Train() on a copy of
+ * the points, for a bootstrap sample with repeated points.
+ */
+BOOST_AUTO_TEST_CASE(TrainSubsetTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  const arma::uvec points = arma::randi<arma::uvec>(d.n_cols,
+      arma::distr_param(0, d.n_cols - 1));
+  const arma::mat subset = d.cols(points);
+  const arma::Row<size_t> subsetLabels = l.cols(points);
+  const arma::rowvec weights = 1.0 + arma::floor(4 * arma::randu<arma::rowvec>(
+      d.n_cols));
+  const arma::rowvec subsetWeights = weights.cols(points);
+
+  // Categorical data.
+  DecisionTree<> tree, subsetTree;
+  double entropy = tree.Train(subset, di, subsetLabels, 5, 5);
+  double subsetEntropy = subsetTree.TrainSubset(d, points, di, l, 5, 5);
+  BOOST_REQUIRE_CLOSE(entropy, subsetEntropy, 1e-5);
+  CheckSameTree(tree, subsetTree);
+  CheckSamePredictions(tree, subsetTree, d);
+
+  // Weighted categorical data.
+  tree.Train(subset, di, subsetLabels, 5, subsetWeights, 5);
+  subsetTree.TrainSubset(d, points, di, l, 5, weights, 5);
+  CheckSameTree(tree, subsetTree);
+  CheckSamePredictions(tree, subsetTree, d);
+
+  // Numeric data (the categorical dimensions are treated as numeric).
+  entropy = tree.Train(subset, subsetLabels, 5, 5);
+  subsetEntropy = subsetTree.TrainSubset(d, points, l, 5, 5);
+  BOOST_REQUIRE_CLOSE(entropy, subsetEntropy, 1e-5);
+  CheckSameTree(tree, subsetTree);
+  CheckSamePredictions(tree, subsetTree, d);
+
+  // Weighted numeric data.
+  tree.Train(subset, subsetLabels, 5, subsetWeights, 5);
+  subsetTree.TrainSubset(d, points, l, 5, weights, 5);
+  CheckSameTree(tree, subsetTree);
+  CheckSamePredictions(tree, subsetTree, d);
+
+  // Bad points must throw.
+  const arma::uvec badPoints("0 1 4000");
+  BOOST_REQUIRE_THROW(subsetTree.TrainSubset(d, badPoints, l, 5),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(subsetTree.TrainSubset(d, arma::uvec(), l, 5),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
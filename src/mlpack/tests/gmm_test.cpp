@@ -798,6 +798,74 @@ BOOST_AUTO_TEST_CASE(UseExistingModelTest)
   }
 }
 
+/**
+ * Make sure that the batch GaussianDistribution::LogProbability() gives the
+ * same results as the single-point version.
+ */
+BOOST_AUTO_TEST_CASE(GaussianBatchLogProbabilityTest)
+{
+  arma::mat covariance(5, 5, arma::fill::randu);
+  covariance = covariance * covariance.t() + arma::eye<arma::mat>(5, 5);
+  distribution::GaussianDistribution d(arma::randu<arma::vec>(5), covariance);
+
+  arma::mat points(5, 300, arma::fill::randn);
+  arma::vec logProbabilities;
+  d.LogProbability(points, logProbabilities);
+
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_elem, points.n_cols);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(logProbabilities[i], d.LogProbability(points.col(i)),
+        1e-5);
+  }
+}
+
+/**
+ * Make sure that training with several trials gives the same model whether the
+ * trials are run one after another or at the same time.
+ */
+BOOST_AUTO_TEST_CASE(GMMConcurrentTrialsTest)
+{
+  // Three well-separated Gaussians.
+  arma::mat data(3, 1500, arma::fill::randn);
+  data.cols(0, 499) += 10.0;
+  data.cols(1000, 1499) -= 10.0;
+  arma::vec probabilities(data.n_cols, arma::fill::randu);
+
+  const size_t seed = 42;
+
+  for (size_t weighted = 0; weighted < 2; ++weighted)
+  {
+    math::RandomSeed(seed);
+    GMM gmm(3, 3);
+    const double likelihood = (weighted == 0) ? gmm.Train(data, 4) :
+        gmm.Train(data, probabilities, 4);
+
+    #ifdef HAS_OPENMP
+    const size_t threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    #endif
+    math::RandomSeed(seed);
+    GMM serialGMM(3, 3);
+    const double serialLikelihood = (weighted == 0) ?
+        serialGMM.Train(data, 4) : serialGMM.Train(data, probabilities, 4);
+    #ifdef HAS_OPENMP
+    omp_set_num_threads(threads);
+    #endif
+
+    BOOST_REQUIRE_CLOSE(likelihood, serialLikelihood, 1e-4);
+    for (size_t i = 0; i < gmm.Gaussians(); ++i)
+    {
+      BOOST_REQUIRE_CLOSE(gmm.Weights()[i], serialGMM.Weights()[i], 1e-4);
+      for (size_t j = 0; j < gmm.Dimensionality(); ++j)
+      {
+        BOOST_REQUIRE_CLOSE(gmm.Component(i).Mean()[j],
+            serialGMM.Component(i).Mean()[j], 1e-3);
+      }
+    }
+  }
+}
+
 /********************************************************/
 /** Diagonal Gaussian Mixture Model(DiagonalGMM) Tests **/
 /********************************************************/
@@ -1855,4 +1855,114 @@ BOOST_AUTO_TEST_CASE(DiagonalGMMHMMLoadSaveTest)
   }
 }
 
+/**
+ * Make sure the forward-backward algorithm gives the same log-likelihood and
+ * state probabilities as a sum over all possible state sequences.
+ */
+BOOST_AUTO_TEST_CASE(DiscreteHMMBruteForceEstimateTest)
+{
+  arma::vec initial("0.5 0.2 0.3");
+  arma::mat transition("0.5 0.0 0.1;"
+                       "0.2 0.6 0.2;"
+                       "0.3 0.4 0.7");
+  std::vector<DiscreteDistribution> emission(3);
+  emission[0].Probabilities() = "0.75 0.25 0.00 0.00";
+  emission[1].Probabilities() = "0.00 0.25 0.25 0.50";
+  emission[2].Probabilities() = "0.10 0.40 0.40 0.10";
+
+  HMM<DiscreteDistribution> hmm(initial, transition, emission);
+
+  const arma::mat obs("0 1 2 3 1");
+  const size_t length = obs.n_cols;
+
+  // Sum the probability of the observations over all 3^5 state sequences.
+  double total = 0.0;
+  arma::mat stateProb(3, length, arma::fill::zeros);
+  arma::Row<size_t> states(length, arma::fill::zeros);
+  for (size_t i = 0; i < 243; ++i)
+  {
+    size_t code = i;
+    for (size_t t = 0; t < length; ++t)
+    {
+      states[t] = code % 3;
+      code /= 3;
+    }
+
+    double prob = initial[states[0]] *
+        emission[states[0]].Probability(obs.col(0));
+    for (size_t t = 1; t < length; ++t)
+    {
+      prob *= transition(states[t], states[t - 1]) *
+          emission[states[t]].Probability(obs.col(t));
+    }
+
+    total += prob;
+    for (size_t t = 0; t < length; ++t)
+      stateProb(states[t], t) += prob;
+  }
+  stateProb /= total;
+
+  arma::mat estimatedStateProb;
+  const double logLikelihood = hmm.Estimate(obs, estimatedStateProb);
+
+  BOOST_REQUIRE_CLOSE(logLikelihood, std::log(total), 1e-5);
+  BOOST_REQUIRE_CLOSE(hmm.LogLikelihood(obs), std::log(total), 1e-5);
+  for (size_t i = 0; i < stateProb.n_elem; ++i)
+  {
+    if (stateProb[i] < 1e-10)
+      BOOST_REQUIRE_SMALL(estimatedStateProb[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(estimatedStateProb[i], stateProb[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure the batch versions of Predict() and LogLikelihood() give the same
+ * results as processing each sequence on its own.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMBatchPredictTest)
+{
+  arma::vec initial("0.4 0.3 0.3");
+  arma::mat transition("0.8 0.1 0.0;"
+                       "0.2 0.8 0.3;"
+                       "0.0 0.1 0.7");
+  std::vector<GaussianDistribution> emission(3);
+  emission[0] = GaussianDistribution("0.0 0.0", "1.0 0.0; 0.0 1.0");
+  emission[1] = GaussianDistribution("3.0 1.0", "1.0 0.2; 0.2 1.0");
+  emission[2] = GaussianDistribution("-2.0 4.0", "0.5 0.0; 0.0 2.0");
+
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  std::vector<arma::mat> dataSeq(50);
+  for (size_t i = 0; i < dataSeq.size(); ++i)
+  {
+    arma::Row<size_t> states;
+    hmm.Generate(10 + 7 * i, dataSeq[i], states, i % 2);
+  }
+
+  std::vector<arma::Row<size_t> > stateSeq;
+  arma::vec predictLogLikelihoods;
+  hmm.Predict(dataSeq, stateSeq, predictLogLikelihoods);
+
+  arma::vec logLikelihoods;
+  hmm.LogLikelihood(dataSeq, logLikelihoods);
+
+  BOOST_REQUIRE_EQUAL(stateSeq.size(), dataSeq.size());
+  BOOST_REQUIRE_EQUAL(predictLogLikelihoods.n_elem, dataSeq.size());
+  BOOST_REQUIRE_EQUAL(logLikelihoods.n_elem, dataSeq.size());
+  for (size_t i = 0; i < dataSeq.size(); ++i)
+  {
+    arma::Row<size_t> states;
+    const double predictLogLikelihood = hmm.Predict(dataSeq[i], states);
+
+    BOOST_REQUIRE_EQUAL(stateSeq[i].n_elem, states.n_elem);
+    for (size_t t = 0; t < states.n_elem; ++t)
+      BOOST_REQUIRE_EQUAL(stateSeq[i][t], states[t]);
+
+    BOOST_REQUIRE_CLOSE(predictLogLikelihoods[i], predictLogLikelihood, 1e-5);
+    BOOST_REQUIRE_CLOSE(logLikelihoods[i], hmm.LogLikelihood(dataSeq[i]),
+        1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -20,6 +20,7 @@
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 #include "serialization.hpp"
+#include "mock_categorical_data.hpp"
 
 #include <stack>
 
@@ -1462,4 +1463,73 @@ BOOST_AUTO_TEST_CASE(HoeffdingTreeModelSerializationTest)
   }
 }
 
+/**
+ * Make sure that a FlatForest built from Hoeffding trees with numeric and
+ * categorical splits gives the same predictions as the trees.
+ */
+BOOST_AUTO_TEST_CASE(FlatForestTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  // The default numeric split has many bins, and the binary split has one
+  // split point.
+  HoeffdingTree<> tree(d, di, l, 5, true, 0.95);
+  HoeffdingTree<GiniImpurity, BinaryDoubleNumericSplit> binaryTree(d, di, l,
+      5, true, 0.95);
+
+  FlatForest flat(tree), binaryFlat(binaryTree);
+
+  arma::Row<size_t> predictions, flatPredictions;
+  tree.Classify(d, predictions);
+  flat.Classify(d, flatPredictions);
+  CheckMatrices(predictions, flatPredictions);
+
+  binaryTree.Classify(d, predictions);
+  binaryFlat.Classify(d, flatPredictions);
+  CheckMatrices(predictions, flatPredictions);
+}
+
+/**
+ * Make sure that training in streaming mode on batches of points gives the
+ * same tree as training on the points one at a time.
+ */
+BOOST_AUTO_TEST_CASE(StreamingBatchTrainTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  HoeffdingTree<> pointTree(di, 5, 0.9);
+  for (size_t i = 0; i < d.n_cols; ++i)
+    pointTree.Train(d.col(i), l[i]);
+
+  // Pass the stream in four batches, so that later batches go to leaves that
+  // were created by earlier batches.
+  HoeffdingTree<> batchTree(di, 5, 0.9);
+  for (size_t b = 0; b < 4; ++b)
+  {
+    const size_t begin = b * d.n_cols / 4;
+    const size_t end = (b + 1) * d.n_cols / 4 - 1;
+    batchTree.Train(d.cols(begin, end), l.subvec(begin, end), false);
+  }
+
+  BOOST_REQUIRE_GT(pointTree.NumDescendants(), 0);
+  BOOST_REQUIRE_EQUAL(batchTree.NumDescendants(), pointTree.NumDescendants());
+
+  arma::Row<size_t> pointPredictions, batchPredictions;
+  arma::rowvec pointProbabilities, batchProbabilities;
+  pointTree.Classify(d, pointPredictions, pointProbabilities);
+  batchTree.Classify(d, batchPredictions, batchProbabilities);
+  CheckMatrices(pointPredictions, batchPredictions);
+  CheckMatrices(pointProbabilities, batchProbabilities);
+
+  // The single-point Classify() must agree with the batch one.
+  for (size_t i = 0; i < d.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(batchTree.Classify(d.col(i)), batchPredictions[i]);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -14,6 +14,7 @@
 #include <mlpack/core/tree/octree.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
+#include <mlpack/core/tree/parallel_dual_tree_traverser.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -1301,4 +1302,302 @@ BOOST_AUTO_TEST_CASE(GaussianBreadthDualKDTreeMonteCarloKDE)
   BOOST_REQUIRE_GT(correctResults, 70);
 }
 
+/**
+ * Make sure that the dual-tree rules keep the error guarantees when the query
+ * tree is split into many small subtrees that are traversed in parallel.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeKDETest)
+{
+  arma::mat reference = arma::randu(2, 1500);
+  arma::mat query = arma::randu(2, 500);
+  const double kernelBandwidth = 0.15;
+  const double relError = 0.05;
+
+  typedef KDTree<EuclideanDistance, KDEStat, arma::mat> TreeType;
+  typedef KDERules<EuclideanDistance, GaussianKernel, TreeType> RuleType;
+
+  // The trees rearrange the datasets, so we will use the rearranged datasets
+  // for the brute force estimation too.
+  TreeType referenceTree(reference, 10);
+  TreeType queryTree(query, 10);
+
+  GaussianKernel kernel(kernelBandwidth);
+  EuclideanDistance metric;
+  arma::vec bfEstimations(query.n_cols, arma::fill::zeros);
+  BruteForceKDE<GaussianKernel>(referenceTree.Dataset(), queryTree.Dataset(),
+      bfEstimations, kernel);
+
+  arma::vec treeEstimations(query.n_cols, arma::fill::zeros);
+  RuleType rules(referenceTree.Dataset(), queryTree.Dataset(), treeEstimations,
+      relError, 0.0, 0.95, 100, 3, 0.8, metric, kernel, false, false);
+  // Use several threads, so that the query tree is really split.
+  #ifdef HAS_OPENMP
+  const size_t threads = omp_get_max_threads();
+  omp_set_num_threads(4);
+  #endif
+  ParallelDualTreeTraverser<RuleType, TreeType::DualTreeTraverser>
+      traverser(rules, 20);
+  traverser.Traverse(queryTree, referenceTree);
+  treeEstimations /= reference.n_cols;
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(threads);
+
+  // Each task has at most 20 query points.
+  BOOST_REQUIRE_GE(traverser.NumTasks(), query.n_cols / 20);
+  #else
+  BOOST_REQUIRE_EQUAL(traverser.NumTasks(), 1);
+  #endif
+  BOOST_REQUIRE_GT(rules.Scores(), 0);
+  for (size_t i = 0; i < query.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(bfEstimations[i], treeEstimations[i], relError * 100);
+}
+
+/**
+ * Make sure that Monte Carlo estimations keep their relative error bound when
+ * the query tree is split into many small subtrees that are traversed in
+ * parallel, each with its own copy of the rules and its own generator.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeMonteCarloKDETest)
+{
+  arma::mat reference = arma::randu(2, 3000);
+  arma::mat query = arma::randu(2, 1000);
+  const double kernelBandwidth = 0.4;
+  const double relError = 0.05;
+
+  typedef KDTree<EuclideanDistance, KDEStat, arma::mat> TreeType;
+  typedef KDERules<EuclideanDistance, GaussianKernel, TreeType> RuleType;
+
+  // The trees rearrange the datasets, so we will use the rearranged datasets
+  // for the brute force estimation too.
+  TreeType referenceTree(reference, 10);
+  TreeType queryTree(query, 10);
+
+  GaussianKernel kernel(kernelBandwidth);
+  EuclideanDistance metric;
+  arma::vec bfEstimations(query.n_cols, arma::fill::zeros);
+  BruteForceKDE<GaussianKernel>(referenceTree.Dataset(), queryTree.Dataset(),
+      bfEstimations, kernel);
+
+  arma::vec treeEstimations(query.n_cols, arma::fill::zeros);
+  RuleType rules(referenceTree.Dataset(), queryTree.Dataset(), treeEstimations,
+      relError, 0.0, 0.95, 100, 3, 0.8, metric, kernel, true, false);
+
+  #ifdef HAS_OPENMP
+  const size_t threads = omp_get_max_threads();
+  omp_set_num_threads(4);
+  #endif
+  ParallelDualTreeTraverser<RuleType, TreeType::DualTreeTraverser>
+      traverser(rules, 20);
+  traverser.Traverse(queryTree, referenceTree);
+  treeEstimations /= reference.n_cols;
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(threads);
+  BOOST_REQUIRE_GE(traverser.NumTasks(), query.n_cols / 20);
+  #endif
+
+  // Each estimation is within the bound with probability 0.95, so require
+  // nearly all of them to be.
+  size_t correctResults = 0;
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    const double resultRelativeError =
+        std::abs((bfEstimations[i] - treeEstimations[i]) / bfEstimations[i]);
+    if (resultRelativeError < relError)
+      ++correctResults;
+  }
+
+  BOOST_REQUIRE_GE(correctResults, 0.9 * query.n_cols);
+}
+
+/**
+ * Test monochromatic dual-tree evaluation on a cover tree (which is traversed
+ * in parallel when OpenMP is available) against brute force results.
+ */
+BOOST_AUTO_TEST_CASE(MonochromaticDualCoverTreeKDETest)
+{
+  arma::mat reference = arma::randu(2, 1000);
+  const double kernelBandwidth = 0.3;
+  const double relError = 0.05;
+
+  // Brute force KDE, without the estimation of each point with itself.
+  EpanechnikovKernel kernel(kernelBandwidth);
+  arma::vec bfEstimations(reference.n_cols, arma::fill::zeros);
+  BruteForceKDE<EpanechnikovKernel>(reference, reference, bfEstimations,
+      kernel);
+  bfEstimations -= kernel.Evaluate(0.0) / reference.n_cols;
+
+  metric::EuclideanDistance metric;
+  KDE<EpanechnikovKernel,
+      metric::EuclideanDistance,
+      arma::mat,
+      tree::StandardCoverTree>
+      kde(relError, 0.0, kernel, KDEMode::DUAL_TREE_MODE, metric);
+  kde.Train(reference);
+  arma::vec treeEstimations;
+  kde.Evaluate(treeEstimations);
+
+  BOOST_REQUIRE_EQUAL(treeEstimations.n_elem, reference.n_cols);
+  for (size_t i = 0; i < reference.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(bfEstimations[i], treeEstimations[i], relError * 100);
+}
+
+/**
+ * Test the series expansions of the Gaussian kernel against direct sums, and
+ * make sure the error bounds hold.
+ */
+BOOST_AUTO_TEST_CASE(GaussianSeriesTest)
+{
+  const double bandwidth = 1.5;
+  const size_t order = 6;
+  GaussianSeries series(3, order, bandwidth);
+  BOOST_REQUIRE_EQUAL(series.NumTerms(), 56);
+  BOOST_REQUIRE_EQUAL(series.NumTerms(1), 1);
+
+  // Reference points within 0.3 of the origin, and query points around
+  // (2.05, 0, 0).
+  arma::vec referenceCenter = arma::zeros(3);
+  arma::vec queryCenter = { 2.0, 0.0, 0.0 };
+  arma::vec newQueryCenter = { 2.05, 0.0, 0.0 };
+  arma::mat reference = 0.1 * (2 * arma::randu(3, 50) - 1);
+  arma::mat query = 0.05 * (2 * arma::randu(3, 20) - 1);
+  query.each_col() += newQueryCenter;
+
+  // The query points are within 0.15 of queryCenter.
+
+  arma::vec farField = arma::zeros(series.NumTerms());
+  arma::vec local = arma::zeros(series.NumTerms());
+  arma::vec translated = arma::zeros(series.NumTerms());
+  arma::vec moved = arma::zeros(series.NumTerms());
+  for (size_t i = 0; i < reference.n_cols; ++i)
+  {
+    series.AccumulateFarField(reference.col(i), referenceCenter, farField);
+    series.AccumulateLocal(reference.col(i), order, queryCenter, local);
+  }
+  series.TranslateFarFieldToLocal(farField, referenceCenter, order,
+      queryCenter, translated);
+  series.TranslateLocal(local, queryCenter, newQueryCenter, moved);
+
+  // Find the error bounds for the given order.
+  const double minDistance = 2.0 - 0.1 - 0.3;
+  double farFieldBound = 0.0, localBound = 0.0, translationBound = 0.0;
+  for (double maxError = 1.0; maxError > 1e-20; maxError /= 1.5)
+  {
+    double error;
+    if (series.TruncationOrder(0.3, minDistance, maxError, error) == order)
+      farFieldBound = error;
+    if (series.TruncationOrder(0.15, minDistance, maxError, error) == order)
+      localBound = error;
+    if (series.TranslationOrder(0.3, 0.15, minDistance, maxError, error) ==
+        order)
+      translationBound = error;
+  }
+  BOOST_REQUIRE_GT(farFieldBound, 0.0);
+  BOOST_REQUIRE_GT(localBound, 0.0);
+  BOOST_REQUIRE_GT(translationBound, 0.0);
+
+  GaussianKernel kernel(bandwidth);
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    double sum = 0.0;
+    for (size_t j = 0; j < reference.n_cols; ++j)
+      sum += kernel.Evaluate(query.col(i), reference.col(j));
+
+    const arma::vec point = query.col(i);
+    BOOST_REQUIRE_LE(std::abs(series.EvaluateFarField(farField, order,
+        referenceCenter, point) - sum), reference.n_cols * farFieldBound);
+    BOOST_REQUIRE_LE(std::abs(series.EvaluateLocal(local, queryCenter, point) -
+        sum), reference.n_cols * localBound);
+    BOOST_REQUIRE_LE(std::abs(series.EvaluateLocal(translated, queryCenter,
+        point) - sum), reference.n_cols * translationBound);
+
+    // Moving a local expansion is exact.
+    BOOST_REQUIRE_CLOSE(series.EvaluateLocal(moved, newQueryCenter, point),
+        series.EvaluateLocal(local, queryCenter, point), 1e-8);
+  }
+}
+
+/**
+ * Test FGT mode against brute force results.
+ */
+BOOST_AUTO_TEST_CASE(GaussianFGTKDTreeKDETest)
+{
+  arma::mat reference = arma::randu(3, 2000);
+  arma::mat query = arma::randu(3, 500);
+  arma::vec bfEstimations = arma::vec(query.n_cols, arma::fill::zeros);
+  arma::vec treeEstimations;
+  const double kernelBandwidth = 0.5;
+  const double relError = 0.01;
+
+  // Brute force KDE.
+  GaussianKernel kernel(kernelBandwidth);
+  BruteForceKDE<GaussianKernel>(reference, query, bfEstimations, kernel);
+
+  // FGT KDE.
+  metric::EuclideanDistance metric;
+  KDE<GaussianKernel,
+      metric::EuclideanDistance,
+      arma::mat,
+      tree::KDTree>
+      kde(relError, 0.0, kernel, KDEMode::FGT_MODE, metric);
+  kde.Train(reference);
+  kde.Evaluate(query, treeEstimations);
+
+  for (size_t i = 0; i < query.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(bfEstimations[i], treeEstimations[i], relError * 100);
+
+  // Lower orders must give the same guarantees.
+  kde.SeriesOrder() = 2;
+  kde.Evaluate(query, treeEstimations);
+  for (size_t i = 0; i < query.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(bfEstimations[i], treeEstimations[i], relError * 100);
+}
+
+/**
+ * Test monochromatic FGT mode on a cover tree against brute force results.
+ */
+BOOST_AUTO_TEST_CASE(MonochromaticFGTCoverTreeKDETest)
+{
+  arma::mat reference = arma::randu(2, 1000);
+  const double kernelBandwidth = 0.8;
+  const double relError = 0.01;
+
+  // Brute force KDE, without the estimation of each point with itself.
+  GaussianKernel kernel(kernelBandwidth);
+  arma::vec bfEstimations(reference.n_cols, arma::fill::zeros);
+  BruteForceKDE<GaussianKernel>(reference, reference, bfEstimations, kernel);
+  bfEstimations -= kernel.Evaluate(0.0) / reference.n_cols;
+
+  metric::EuclideanDistance metric;
+  KDE<GaussianKernel,
+      metric::EuclideanDistance,
+      arma::mat,
+      tree::StandardCoverTree>
+      kde(relError, 0.0, kernel, KDEMode::FGT_MODE, metric);
+  kde.Train(reference);
+  arma::vec treeEstimations;
+  kde.Evaluate(treeEstimations);
+
+  BOOST_REQUIRE_EQUAL(treeEstimations.n_elem, reference.n_cols);
+  for (size_t i = 0; i < reference.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(bfEstimations[i], treeEstimations[i], relError * 100);
+}
+
+/**
+ * Make sure FGT mode cannot be used with another kernel.
+ */
+BOOST_AUTO_TEST_CASE(FGTNonGaussianKernelTest)
+{
+  arma::mat reference = arma::randu(2, 100);
+  arma::mat query = arma::randu(2, 10);
+  arma::vec estimations;
+
+  KDE<EpanechnikovKernel,
+      metric::EuclideanDistance,
+      arma::mat,
+      tree::KDTree>
+      kde(0.05, 0.0, EpanechnikovKernel(), KDEMode::FGT_MODE);
+  kde.Train(reference);
+  BOOST_REQUIRE_THROW(kde.Evaluate(query, estimations), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
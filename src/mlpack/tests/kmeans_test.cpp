@@ -12,6 +12,8 @@
 #include <mlpack/methods/kmeans/kmeans.hpp>
 #include <mlpack/methods/kmeans/allow_empty_clusters.hpp>
 #include <mlpack/methods/kmeans/refined_start.hpp>
+#include <mlpack/methods/kmeans/blocked_kmeans.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
 #include <mlpack/methods/kmeans/elkan_kmeans.hpp>
 #include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
 #include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
@@ -20,6 +22,7 @@
 #include <mlpack/methods/kmeans/random_partition.hpp>
 
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
+#include <mlpack/core/data/batch_sources/binary_batch_source.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -605,6 +608,223 @@ BOOST_AUTO_TEST_CASE(HamerlyTest)
   }
 }
 
+/**
+ * Run k-means with the given Lloyd step type with one thread and with all
+ * threads, and make sure the results are the same.
+ */
+template<template<class, class> class LloydStepType>
+void CheckThreadedKMeans()
+{
+  arma::mat dataset(10, 5000);
+  dataset.randu();
+  arma::mat centroids(10, 20);
+  centroids.randu();
+
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      LloydStepType> kmeans;
+
+  arma::Row<size_t> assignments;
+  arma::mat parallelCentroids(centroids);
+  kmeans.Cluster(dataset, 20, assignments, parallelCentroids, false, true);
+
+  #ifdef HAS_OPENMP
+  const size_t threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+  arma::Row<size_t> serialAssignments;
+  arma::mat serialCentroids(centroids);
+  kmeans.Cluster(dataset, 20, serialAssignments, serialCentroids, false,
+      true);
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(threads);
+  #endif
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], serialAssignments[i]);
+
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(parallelCentroids[i], serialCentroids[i], 1e-5);
+}
+
+/**
+ * Make sure that the parallel Elkan and Hamerly iterations give the same
+ * results as the serial ones.
+ */
+BOOST_AUTO_TEST_CASE(ElkanHamerlyThreadsTest)
+{
+  CheckThreadedKMeans<ElkanKMeans>();
+  CheckThreadedKMeans<HamerlyKMeans>();
+}
+
+/**
+ * Make sure the blocked Lloyd step returns the same clusters as the naive
+ * method, with enough points and centroids for several blocks of each, and
+ * with a metric that has no fast block computation.
+ */
+BOOST_AUTO_TEST_CASE(BlockedKMeansTest)
+{
+  const size_t trials = 3;
+
+  for (size_t t = 0; t < trials; ++t)
+  {
+    arma::mat dataset(10, 3000);
+    dataset.randu();
+
+    const size_t k = (t == 2) ? 1100 : 5 * (t + 1);
+    arma::mat centroids(10, k);
+    centroids.randu();
+
+    arma::mat naiveCentroids(centroids);
+    KMeans<> km;
+    arma::Row<size_t> assignments;
+    km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+    KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+        BlockedKMeans> blocked;
+    arma::Row<size_t> blockedAssignments;
+    arma::mat blockedCentroids(centroids);
+    blocked.Cluster(dataset, k, blockedAssignments, blockedCentroids, false,
+        true);
+
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], blockedAssignments[i]);
+
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(naiveCentroids[i], blockedCentroids[i], 1e-5);
+  }
+
+  // Now with the Manhattan distance.
+  arma::mat dataset(5, 1000);
+  dataset.randu();
+  arma::mat centroids(5, 8);
+  centroids.randu();
+
+  arma::mat naiveCentroids(centroids);
+  KMeans<metric::ManhattanDistance, RandomPartition> km;
+  arma::Row<size_t> assignments;
+  km.Cluster(dataset, 8, assignments, naiveCentroids, false, true);
+
+  KMeans<metric::ManhattanDistance, RandomPartition, MaxVarianceNewCluster,
+      BlockedKMeans> blocked;
+  arma::Row<size_t> blockedAssignments;
+  arma::mat blockedCentroids(centroids);
+  blocked.Cluster(dataset, 8, blockedAssignments, blockedCentroids, false,
+      true);
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], blockedAssignments[i]);
+
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(naiveCentroids[i], blockedCentroids[i], 1e-5);
+}
+
+/**
+ * Make sure the blocked Lloyd step still returns the same clusters as the naive
+ * method when the data is far from the origin, where ||c||^2 - 2 x^T c would
+ * cancel catastrophically.
+ */
+BOOST_AUTO_TEST_CASE(BlockedKMeansOffsetTest)
+{
+  arma::mat dataset(10, 3000);
+  dataset.randu();
+  dataset += 1e7;
+
+  arma::mat centroids(10, 20);
+  centroids.randu();
+  centroids += 1e7;
+
+  arma::mat naiveCentroids(centroids);
+  KMeans<> km;
+  arma::Row<size_t> assignments;
+  km.Cluster(dataset, 20, assignments, naiveCentroids, false, true);
+
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      BlockedKMeans> blocked;
+  arma::Row<size_t> blockedAssignments;
+  arma::mat blockedCentroids(centroids);
+  blocked.Cluster(dataset, 20, blockedAssignments, blockedCentroids, false,
+      true);
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], blockedAssignments[i]);
+
+  // The centroids must match to within the spread of the data, not only to
+  // within a relative tolerance of the offset.
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(naiveCentroids[i] - blockedCentroids[i], 1e-5);
+}
+
+/**
+ * Make sure that mini-batch k-means, used through KMeans, finds the centers of
+ * well-separated clusters.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansTest)
+{
+  arma::mat centers("0.0 10.0 0.0 10.0;"
+                    "0.0 0.0 10.0 10.0");
+  arma::mat dataset(2, 20000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) = centers.col(i % 4) + 0.5 * arma::randn<arma::vec>(2);
+
+  // Start from the first point of each cluster.
+  arma::mat centroids = dataset.cols(0, 3);
+
+  KMeans<EuclideanDistance, SampleInitialization, AllowEmptyClusters,
+      MiniBatchKMeans> kmeans(300);
+  MiniBatchKMeans<EuclideanDistance, arma::mat> lloydStep(dataset,
+      kmeans.Metric(), 200);
+  arma::Row<size_t> assignments;
+  kmeans.Cluster(dataset, 4, assignments, centroids, lloydStep, false, true);
+
+  // Every iteration sees one batch.
+  BOOST_REQUIRE_EQUAL(lloydStep.BatchSize(), 200);
+  BOOST_REQUIRE_GT(arma::accu(lloydStep.ClusterCounts()), 0);
+  BOOST_REQUIRE_EQUAL(arma::accu(lloydStep.ClusterCounts()) % 200, 0);
+  for (size_t c = 0; c < 4; ++c)
+    BOOST_REQUIRE_SMALL(arma::norm(centroids.col(c) - centers.col(c)), 0.1);
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], i % 4);
+}
+
+/**
+ * Make sure that mini-batch k-means can be fed with batches incrementally and
+ * from a batch source.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansUpdateTest)
+{
+  arma::mat centers("0.0 10.0 0.0;"
+                    "0.0 0.0 10.0");
+  arma::mat dataset(2, 6000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) = centers.col(i % 3) + 0.5 * arma::randn<arma::vec>(2);
+
+  EuclideanDistance metric;
+  MiniBatchKMeans<EuclideanDistance, arma::mat> step(metric, 250);
+
+  // Feed the first half of the points in batches of 500.
+  arma::mat centroids = dataset.cols(0, 2);
+  for (size_t begin = 0; begin < 3000; begin += 500)
+    step.Update(arma::mat(dataset.cols(begin, begin + 499)), centroids);
+
+  BOOST_REQUIRE_EQUAL(arma::accu(step.ClusterCounts()), 3000);
+  for (size_t c = 0; c < 3; ++c)
+  {
+    BOOST_REQUIRE_EQUAL(step.ClusterCounts()[c], 1000);
+    BOOST_REQUIRE_SMALL(arma::norm(centroids.col(c) - centers.col(c)), 0.15);
+  }
+
+  // Now read the whole dataset from a file.
+  data::Save("test_minibatch.mbin", dataset);
+  data::BinaryBatchSource<> source("test_minibatch.mbin");
+  step.UpdateFromSource(source, centroids);
+  remove("test_minibatch.mbin");
+
+  BOOST_REQUIRE_EQUAL(arma::accu(step.ClusterCounts()), 9000);
+  for (size_t c = 0; c < 3; ++c)
+    BOOST_REQUIRE_SMALL(arma::norm(centroids.col(c) - centers.col(c)), 0.1);
+}
+
 BOOST_AUTO_TEST_CASE(PellegMooreTest)
 {
   const size_t trials = 5;
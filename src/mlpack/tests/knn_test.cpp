@@ -14,6 +14,7 @@
 #include <mlpack/methods/neighbor_search/ns_model.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/example_tree.hpp>
+#include <mlpack/core/tree/parallel_dual_tree_traverser.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -889,6 +890,101 @@ BOOST_AUTO_TEST_CASE(DualBallTreeTest)
   }
 }
 
+/**
+ * Make sure the parallel dual-tree traverser gives the same results as naive
+ * search on a kd-tree, even when the query tree is split into many small tasks.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeTraverserKDTreeTest)
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  typedef KDTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance, TreeType>
+      RuleType;
+
+  // The tree rearranges the dataset, so we will use the rearranged dataset for
+  // the naive search too.
+  TreeType tree(dataset, 5);
+  EuclideanDistance metric;
+
+  RuleType rules(tree.Dataset(), tree.Dataset(), 10, metric);
+  // Use several threads, so that the query tree is really split.
+  #ifdef HAS_OPENMP
+  const size_t threads = omp_get_max_threads();
+  omp_set_num_threads(4);
+  #endif
+  ParallelDualTreeTraverser<RuleType, TreeType::DualTreeTraverser>
+      traverser(rules, 20);
+  traverser.Traverse(tree, tree);
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(threads);
+  #endif
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  rules.GetResults(neighbors, distances);
+
+  KNN naive(tree.Dataset(), NAIVE_MODE);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(tree.Dataset(), 10, naiveNeighbors, naiveDistances);
+
+  // Each task has at most 20 query points.
+  #ifdef HAS_OPENMP
+  BOOST_REQUIRE_GE(traverser.NumTasks(), tree.Dataset().n_cols / 20);
+  #else
+  BOOST_REQUIRE_EQUAL(traverser.NumTasks(), 1);
+  #endif
+  BOOST_REQUIRE_GT(rules.BaseCases(), 0);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], naiveNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], naiveDistances[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure the parallel dual-tree traverser gives the same results as naive
+ * search on a cover tree, where query nodes hold points of their own.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeTraverserCoverTreeTest)
+{
+  arma::mat dataset;
+  dataset.randu(5, 800);
+
+  typedef StandardCoverTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> TreeType;
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance, TreeType>
+      RuleType;
+
+  TreeType queryTree(dataset);
+  TreeType referenceTree(dataset);
+  EuclideanDistance metric;
+
+  RuleType rules(dataset, dataset, 5, metric);
+  ParallelDualTreeTraverser<RuleType, TreeType::DualTreeTraverser>
+      traverser(rules, 20);
+  traverser.Traverse(queryTree, referenceTree);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  rules.GetResults(neighbors, distances);
+
+  KNN naive(dataset, NAIVE_MODE);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(dataset, 5, naiveNeighbors, naiveDistances);
+
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], naiveNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], naiveDistances[i], 1e-5);
+  }
+}
+
 /**
  * Test the spill tree hybrid sp-tree search (defeatist search on overlapping
  * nodes, and backtracking in non-overlapping nodes) against the naive method.
@@ -1226,6 +1322,219 @@ BOOST_AUTO_TEST_CASE(KNNModelMonochromaticTest)
   }
 }
 
+/**
+ * Make sure that concurrent searches with the same NSModel give the same
+ * results as a search on its own, for a tree that is traversed in parallel and
+ * for one that caches distances in its nodes.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelConcurrentSearchTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat referenceData = arma::randu<arma::mat>(5, 1000);
+  std::vector<arma::mat> queryData(6);
+  for (size_t i = 0; i < queryData.size(); ++i)
+    queryData[i] = arma::randu<arma::mat>(5, 40);
+
+  KNNModel models[2];
+  models[0] = KNNModel(KNNModel::TreeTypes::KD_TREE, false);
+  models[1] = KNNModel(KNNModel::TreeTypes::COVER_TREE, false);
+
+  KNN knn(referenceData);
+  arma::Mat<size_t> monoNeighbors;
+  arma::mat monoDistances;
+  knn.Search(3, monoNeighbors, monoDistances);
+
+  for (size_t m = 0; m < 2; ++m)
+  {
+    arma::mat referenceCopy(referenceData);
+    models[m].BuildModel(std::move(referenceCopy), 20, SINGLE_TREE_MODE);
+
+    // Every thread runs a bichromatic search, except the last one, which runs
+    // a monochromatic search.
+    std::vector<arma::Mat<size_t>> neighbors(queryData.size() + 1);
+    std::vector<arma::mat> distances(queryData.size() + 1);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i <= queryData.size(); ++i)
+    {
+      threads.push_back(std::thread([&, i]()
+          {
+            if (i == queryData.size())
+            {
+              models[m].Search(3, neighbors[i], distances[i]);
+              return;
+            }
+
+            arma::mat queryCopy(queryData[i]);
+            models[m].Search(std::move(queryCopy), 3, neighbors[i],
+                distances[i]);
+          }));
+    }
+    for (size_t i = 0; i < threads.size(); ++i)
+      threads[i].join();
+
+    for (size_t i = 0; i <= queryData.size(); ++i)
+    {
+      arma::Mat<size_t> baselineNeighbors = monoNeighbors;
+      arma::mat baselineDistances = monoDistances;
+      if (i < queryData.size())
+        knn.Search(queryData[i], 3, baselineNeighbors, baselineDistances);
+
+      BOOST_REQUIRE_EQUAL(neighbors[i].n_rows, baselineNeighbors.n_rows);
+      BOOST_REQUIRE_EQUAL(neighbors[i].n_cols, baselineNeighbors.n_cols);
+      for (size_t k = 0; k < baselineNeighbors.n_elem; ++k)
+      {
+        BOOST_REQUIRE_EQUAL(neighbors[i][k], baselineNeighbors[k]);
+        BOOST_REQUIRE_CLOSE(distances[i][k], baselineDistances[k], 1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Apply the same insertions and deletions to a dataset that NeighborSearch
+ * applies to its reference set.
+ */
+arma::mat InsertAndDelete(arma::mat dataset,
+                          const arma::mat& newPoints,
+                          const std::vector<size_t>& indices)
+{
+  dataset = arma::join_rows(dataset, newPoints);
+  std::vector<bool> deleted(dataset.n_cols, false);
+  for (size_t i = 0; i < indices.size(); ++i)
+    deleted[indices[i]] = true;
+
+  std::vector<size_t> kept;
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    if (!deleted[i])
+      kept.push_back(i);
+
+  return dataset.cols(arma::conv_to<arma::uvec>::from(kept));
+}
+
+/**
+ * Make sure that two sets of search results are the same.
+ */
+void CheckSearchResults(const arma::Mat<size_t>& neighbors,
+                        const arma::mat& distances,
+                        const arma::Mat<size_t>& trueNeighbors,
+                        const arma::mat& trueDistances)
+{
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, trueNeighbors.n_rows);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, trueNeighbors.n_cols);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], trueNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], trueDistances[i], 1e-5);
+  }
+}
+
+/**
+ * Insert points into and delete points from the reference set of a KNN object,
+ * in every search mode, and make sure that the results are the same as for a
+ * KNN object built on the updated dataset.
+ */
+BOOST_AUTO_TEST_CASE(KNNInsertDeleteTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 800);
+  arma::mat querySet = arma::randu<arma::mat>(4, 60);
+  arma::mat newPoints = 1.5 * arma::randu<arma::mat>(4, 300);
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < 1100; i += 4)
+    indices.push_back(i);
+
+  KNN naive(InsertAndDelete(dataset, newPoints, indices), NAIVE_MODE);
+  arma::Mat<size_t> trueNeighbors, trueMonoNeighbors;
+  arma::mat trueDistances, trueMonoDistances;
+  naive.Search(querySet, 5, trueNeighbors, trueDistances);
+  naive.Search(5, trueMonoNeighbors, trueMonoDistances);
+
+  const NeighborSearchMode modes[] = { NAIVE_MODE, SINGLE_TREE_MODE,
+      DUAL_TREE_MODE };
+  for (size_t m = 0; m < 3; ++m)
+  {
+    KNN knn(dataset, modes[m]);
+    knn.InsertPoints(newPoints, 10);
+    knn.DeletePoints(indices);
+    BOOST_REQUIRE_EQUAL(knn.ReferenceSet().n_cols, 1100 - indices.size());
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    knn.Search(querySet, 5, neighbors, distances);
+    CheckSearchResults(neighbors, distances, trueNeighbors, trueDistances);
+
+    knn.Search(5, neighbors, distances);
+    CheckSearchResults(neighbors, distances, trueMonoNeighbors,
+        trueMonoDistances);
+  }
+
+  // Trees that can't be updated refuse.
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree> coverTreeSearch(dataset);
+  BOOST_REQUIRE_THROW(coverTreeSearch.InsertPoints(newPoints),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(coverTreeSearch.DeletePoints(indices),
+      std::invalid_argument);
+
+  // ... and are left as they were.
+  KNN originalNaive(dataset, NAIVE_MODE);
+  arma::Mat<size_t> originalNeighbors, neighbors;
+  arma::mat originalDistances, distances;
+  originalNaive.Search(querySet, 5, originalNeighbors, originalDistances);
+  coverTreeSearch.Search(querySet, 5, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(coverTreeSearch.ReferenceSet().n_cols, 800);
+  CheckSearchResults(neighbors, distances, originalNeighbors,
+      originalDistances);
+
+  // Bad indices are refused too.
+  KNN knn(dataset);
+  indices.assign(1, 800);
+  BOOST_REQUIRE_THROW(knn.DeletePoints(indices), std::invalid_argument);
+}
+
+/**
+ * Make sure that points can be inserted into and deleted from an NSModel with a
+ * random basis.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelInsertDeleteTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat dataset = arma::randu<arma::mat>(4, 500);
+  arma::mat querySet = arma::randu<arma::mat>(4, 40);
+  arma::mat newPoints = arma::randu<arma::mat>(4, 200);
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < 700; i += 3)
+    indices.push_back(i);
+
+  KNN naive(InsertAndDelete(dataset, newPoints, indices), NAIVE_MODE);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  naive.Search(querySet, 3, trueNeighbors, trueDistances);
+
+  KNNModel model(KNNModel::TreeTypes::KD_TREE, true);
+  arma::mat referenceCopy(dataset);
+  model.BuildModel(std::move(referenceCopy), 10, SINGLE_TREE_MODE);
+
+  arma::mat newPointsCopy(newPoints);
+  model.InsertPoints(std::move(newPointsCopy));
+  model.DeletePoints(indices);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  arma::mat queryCopy(querySet);
+  model.Search(std::move(queryCopy), 3, neighbors, distances);
+  CheckSearchResults(neighbors, distances, trueNeighbors, trueDistances);
+
+  // Cover trees can't be updated.
+  KNNModel coverTreeModel(KNNModel::TreeTypes::COVER_TREE, false);
+  referenceCopy = dataset;
+  coverTreeModel.BuildModel(std::move(referenceCopy), 10, SINGLE_TREE_MODE);
+  newPointsCopy = newPoints;
+  BOOST_REQUIRE_THROW(coverTreeModel.InsertPoints(std::move(newPointsCopy)),
+      std::invalid_argument);
+}
+
 /**
  * If we search twice with the same reference tree, the bounds need to be reset
  * before the second search.  This test ensures that that happens, by making
@@ -9,6 +9,7 @@
  * 3-clause BSD license along with mlpack.  If not, see
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
+#include <cstring>
 #include <sstream>
 
 #include <mlpack/core.hpp>
@@ -710,6 +711,173 @@ BOOST_AUTO_TEST_CASE(SaveArmaBinaryTest)
   remove("test_file.bin");
 }
 
+/**
+ * Make sure that a matrix saved in the memory-mappable binary format is loaded
+ * correctly, and that it uses the mapped memory directly.
+ */
+BOOST_AUTO_TEST_CASE(SaveLoadMappedBinaryTest)
+{
+  arma::mat test = "1 5;"
+                   "2 6;"
+                   "3 7;"
+                   "4 8;";
+
+  BOOST_REQUIRE(data::Save("test_file.mbin", test) == true);
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test_file.mbin", loaded) == true);
+
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 2);
+
+  for (size_t i = 0; i < 8; i++)
+    BOOST_REQUIRE_CLOSE(loaded[i], (double) (i + 1), 1e-5);
+
+#ifndef _WIN32
+  // The matrix should be using auxiliary memory.
+  BOOST_REQUIRE_EQUAL(loaded.mem_state, 1);
+  BOOST_REQUIRE(data::Unmap(loaded) == true);
+  BOOST_REQUIRE_EQUAL(loaded.n_elem, 0);
+#endif
+
+  // Unmapping a regular matrix does nothing.
+  BOOST_REQUIRE(data::Unmap(test) == false);
+  BOOST_REQUIRE_EQUAL(test.n_elem, 8);
+
+  // Now without transposition.
+  BOOST_REQUIRE(data::Save("test_file.mbin", test, false, false) == true);
+  BOOST_REQUIRE(data::Load("test_file.mbin", loaded, false, false) == true);
+
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 2);
+
+  for (size_t i = 0; i < 8; i++)
+    BOOST_REQUIRE_CLOSE(loaded[i], (double) (i + 1), 1e-5);
+
+  // Loading into a matrix of a different type must fail.
+  arma::Mat<size_t> wrongType;
+  BOOST_REQUIRE(data::Load("test_file.mbin", wrongType) == false);
+
+  // Remove the file.
+  remove("test_file.mbin");
+}
+
+/**
+ * Make sure that a MappedMatrix holds the data of the file, and that it can be
+ * moved and reset.
+ */
+BOOST_AUTO_TEST_CASE(MappedMatrixTest)
+{
+  arma::mat test = "1 5;"
+                   "2 6;"
+                   "3 7;"
+                   "4 8;";
+
+  BOOST_REQUIRE(data::Save("test_file.mbin", test) == true);
+
+  data::MappedMatrix<double> mapped("test_file.mbin");
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_rows, 4);
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_cols, 2);
+  for (size_t i = 0; i < 8; i++)
+    BOOST_REQUIRE_CLOSE(mapped.Matrix()[i], (double) (i + 1), 1e-5);
+
+#ifndef _WIN32
+  // The matrix should be using auxiliary memory.
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().mem_state, 1);
+#endif
+
+  // Moving the MappedMatrix moves the mapping.
+  data::MappedMatrix<double> moved(std::move(mapped));
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_elem, 0);
+  BOOST_REQUIRE_EQUAL(moved.Matrix().n_elem, 8);
+  for (size_t i = 0; i < 8; i++)
+    BOOST_REQUIRE_CLOSE(moved.Matrix()[i], (double) (i + 1), 1e-5);
+
+  moved.Reset();
+  BOOST_REQUIRE_EQUAL(moved.Matrix().n_elem, 0);
+
+  // A file with the wrong element type can't be loaded.
+  data::MappedMatrix<size_t> wrongType;
+  BOOST_REQUIRE(wrongType.Load("test_file.mbin") == false);
+
+  remove("test_file.mbin");
+}
+
+/**
+ * Make sure that memory-mappable files whose header sizes overflow are
+ * rejected instead of being mapped.
+ */
+BOOST_AUTO_TEST_CASE(MappedBinaryOverflowHeaderTest)
+{
+  data::MappedMatrixHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, "MLPKMMAT", 8);
+  header.version = data::MappedMatrixVersion;
+  header.elementType = data::MappedElementType<double>();
+  header.byteOrder = 0x01020304;
+
+  // The first header has a number of elements that wraps the size in bytes
+  // around to 0; the second has a data offset that wraps the end of the data
+  // around.
+  const uint64_t rows[] = { (uint64_t(1) << 62), 1 };
+  const uint64_t offsets[] = { 64, uint64_t(-64) };
+  for (size_t i = 0; i < 2; ++i)
+  {
+    header.nRows = rows[i];
+    header.nCols = 4;
+    header.dataOffset = offsets[i];
+
+    std::ofstream f("test_file.mbin", std::ios::out | std::ios::binary);
+    f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const char padding[64] = { 0 };
+    f.write(padding, 64);
+    f.close();
+
+    arma::mat loaded;
+    BOOST_REQUIRE(data::Load("test_file.mbin", loaded) == false);
+    BOOST_REQUIRE(data::LoadMapped("test_file.mbin", loaded, false, true) ==
+        false);
+    BOOST_REQUIRE_EQUAL(loaded.n_elem, 0);
+
+    data::MappedMatrix<double> mapped;
+    BOOST_REQUIRE(mapped.Load("test_file.mbin") == false);
+    BOOST_REQUIRE_EQUAL(mapped.Matrix().n_elem, 0);
+  }
+
+  remove("test_file.mbin");
+}
+
+/**
+ * Make sure that a fatal error while loading or saving a memory-mappable file
+ * stops the timers.
+ */
+BOOST_AUTO_TEST_CASE(MappedBinaryFatalErrorTimerTest)
+{
+  std::fstream f;
+  f.open("test_file.mbin", std::fstream::out);
+  f << "not a memory-mappable matrix file" << std::endl;
+  f.close();
+
+  Timer::EnableTiming();
+
+  arma::mat loaded;
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(data::Load("test_file.mbin", loaded, true),
+      std::runtime_error);
+  BOOST_REQUIRE_THROW(data::Save("nonexistent_dir/test_file.mbin", loaded,
+      true), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+
+  // If the timers were left running, starting them again would throw.
+  BOOST_REQUIRE_NO_THROW(Timer::Start("loading_data"));
+  BOOST_REQUIRE_NO_THROW(Timer::Start("saving_data"));
+  Timer::Stop("loading_data");
+  Timer::Stop("saving_data");
+
+  Timer::DisableTiming();
+  remove("test_file.mbin");
+}
+
 /**
  * Make sure raw_binary is loaded correctly.
  */
@@ -2084,6 +2252,65 @@ BOOST_AUTO_TEST_CASE(MalformedNoTransposeCSVTest)
   remove("test.csv");
 }
 
+/**
+ * Test that splitting a CSV into many small chunks gives the same matrix and
+ * the same mappings as loading it in one piece.
+ */
+BOOST_AUTO_TEST_CASE(LoadCSVChunkedTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < 200; ++i)
+  {
+    f << i << ", " << (i % 7 == 0 ? "\"cat, " : "\"dog ") << (i % 5) << "\", "
+        << (0.5 * i) << ", " << (i % 11 == 3 ? "x" : "1e-3") << endl;
+  }
+  f.close();
+
+  for (size_t t = 0; t < 2; ++t)
+  {
+    const bool transpose = (t == 0);
+
+    arma::mat dataset, chunkedDataset;
+    DatasetInfo info, chunkedInfo;
+
+    LoadCSV loader("test.csv");
+    loader.Load(dataset, info, transpose);
+
+    // Use chunks of only a few lines.
+    LoadCSV chunkedLoader("test.csv", 50);
+    chunkedLoader.Load(chunkedDataset, chunkedInfo, transpose);
+
+    BOOST_REQUIRE_EQUAL(dataset.n_rows, transpose ? 4 : 200);
+    BOOST_REQUIRE_EQUAL(dataset.n_cols, transpose ? 200 : 4);
+    CheckMatrices(dataset, chunkedDataset);
+
+    BOOST_REQUIRE_EQUAL(info.Dimensionality(), chunkedInfo.Dimensionality());
+    for (size_t d = 0; d < info.Dimensionality(); ++d)
+    {
+      BOOST_REQUIRE_EQUAL(info.Type(d), chunkedInfo.Type(d));
+      BOOST_REQUIRE_EQUAL(info.NumMappings(d), chunkedInfo.NumMappings(d));
+    }
+
+    if (transpose)
+    {
+      BOOST_REQUIRE_EQUAL(info.Type(0), Datatype::numeric);
+      BOOST_REQUIRE_EQUAL(info.Type(1), Datatype::categorical);
+      BOOST_REQUIRE_EQUAL(info.Type(2), Datatype::numeric);
+      BOOST_REQUIRE_EQUAL(info.Type(3), Datatype::categorical);
+      BOOST_REQUIRE_EQUAL(info.NumMappings(3), 2);
+
+      for (size_t i = 0; i < 200; ++i)
+      {
+        BOOST_REQUIRE_EQUAL(dataset(0, i), (double) i);
+        BOOST_REQUIRE_CLOSE(dataset(2, i) + 1.0, 0.5 * i + 1.0, 1e-10);
+      }
+    }
+  }
+
+  remove("test.csv");
+}
+
 /**
  * Test that a non-transposed TSV can load with LoadCSV.
  */
@@ -14,6 +14,8 @@
 #include "test_tools.hpp"
 
 #include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/methods/lsh/simhash_search.hpp>
+#include <mlpack/core/kernels/cosine_distance.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
 using namespace std;
@@ -763,7 +765,33 @@ BOOST_AUTO_TEST_CASE(EmptyConstructorTest)
   BOOST_REQUIRE_EQUAL(distances.n_rows, 3);
 }
 
-// These two tests are only compiled if the user has specified OpenMP to be
+/**
+ * Make sure that every point is in one bucket per table when the buckets have
+ * no size limit, and that the bucket size is respected otherwise.
+ */
+BOOST_AUTO_TEST_CASE(HashTableContentsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 3000);
+  const size_t numTables = 6;
+
+  LSHSearch<> lsh(dataset, 4, numTables, 0.5, 99901, 0);
+  arma::Col<size_t> pointCounts(dataset.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < lsh.SecondHashTable().size(); ++i)
+  {
+    BOOST_REQUIRE_GT(lsh.SecondHashTable()[i].n_elem, 0);
+    for (size_t j = 0; j < lsh.SecondHashTable()[i].n_elem; ++j)
+      pointCounts[lsh.SecondHashTable()[i][j]]++;
+  }
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(pointCounts[i], numTables);
+
+  lsh.Train(dataset, 4, numTables, 0.5, 99901, 5);
+  for (size_t i = 0; i < lsh.SecondHashTable().size(); ++i)
+    BOOST_REQUIRE_LE(lsh.SecondHashTable()[i].n_elem, 5);
+}
+
+// These tests are only compiled if the user has specified OpenMP to be
 // used.
 #ifdef HAS_OPENMP
 /**
@@ -844,6 +872,39 @@ BOOST_AUTO_TEST_CASE(ParallelMonochromatic)
       sequentialNeighbors, parallelNeighbors);
   BOOST_REQUIRE_EQUAL(recall, 1);
 }
+
+/**
+ * Test: This test verifies that building the hash tables in parallel gives the
+ * same tables as building them with one thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTrain)
+{
+  arma::mat rdata = arma::randu<arma::mat>(10, 5000);
+
+  size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  math::RandomSeed(1234);
+  LSHSearch<> sequentialLSH(rdata, 5, 10, 0.0, 99901, 20);
+  omp_set_num_threads(prevNumThreads);
+
+  math::RandomSeed(1234);
+  LSHSearch<> parallelLSH(rdata, 5, 10, 0.0, 99901, 20);
+
+  BOOST_REQUIRE_EQUAL(sequentialLSH.SecondHashTable().size(),
+      parallelLSH.SecondHashTable().size());
+  for (size_t i = 0; i < sequentialLSH.SecondHashTable().size(); ++i)
+  {
+    CheckMatrices(sequentialLSH.SecondHashTable()[i],
+        parallelLSH.SecondHashTable()[i]);
+  }
+
+  arma::Mat<size_t> sequentialNeighbors, parallelNeighbors;
+  arma::mat sequentialDistances, parallelDistances;
+  sequentialLSH.Search(5, sequentialNeighbors, sequentialDistances);
+  parallelLSH.Search(5, parallelNeighbors, parallelDistances);
+  CheckMatrices(sequentialNeighbors, parallelNeighbors);
+  CheckMatrices(sequentialDistances, parallelDistances);
+}
 #endif
 
 // Test the copy constructor and the copy operator.
@@ -917,4 +978,100 @@ BOOST_AUTO_TEST_CASE(MoveOperatorTest)
   CheckMatrices(distances, distances2);
 }
 
+/**
+ * Make sure that SimHashSearch finds the exact cosine neighbors when all of the
+ * reference points are reranked.
+ */
+BOOST_AUTO_TEST_CASE(SimHashRerankAllTest)
+{
+  arma::mat rdata = arma::randn<arma::mat>(8, 300);
+  arma::mat qdata = arma::randn<arma::mat>(8, 40);
+  const size_t k = 5;
+
+  SimHashSearch simhash(rdata, 100);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  simhash.Search(qdata, k, neighbors, distances, rdata.n_cols);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, k);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, qdata.n_cols);
+  BOOST_REQUIRE_EQUAL(simhash.DistanceEvaluations(),
+      qdata.n_cols * rdata.n_cols);
+
+  for (size_t q = 0; q < qdata.n_cols; ++q)
+  {
+    std::vector<std::pair<double, size_t>> exact(rdata.n_cols);
+    for (size_t r = 0; r < rdata.n_cols; ++r)
+    {
+      exact[r] = std::make_pair(1.0 - kernel::CosineDistance::Evaluate(
+          qdata.col(q), rdata.col(r)), r);
+    }
+    std::sort(exact.begin(), exact.end());
+
+    for (size_t j = 0; j < k; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors(j, q), exact[j].second);
+      BOOST_REQUIRE_CLOSE(distances(j, q), exact[j].first, 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that without reranking, SimHashSearch returns the points with the
+ * smallest Hamming distances between the signatures, and does not return a
+ * point as its own neighbor.
+ */
+BOOST_AUTO_TEST_CASE(SimHashHammingTest)
+{
+  arma::mat rdata = arma::randn<arma::mat>(6, 200);
+  const size_t k = 4;
+  const size_t numBits = 70; // Two words, the second one partly used.
+
+  SimHashSearch simhash(rdata, numBits, false);
+  BOOST_REQUIRE_EQUAL(simhash.ReferenceSet().n_elem, 0);
+  BOOST_REQUIRE_EQUAL(simhash.NumWords(), 2);
+  BOOST_REQUIRE_EQUAL(simhash.Signatures().size(), 2 * rdata.n_cols);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  simhash.Search(k, neighbors, distances);
+
+  const std::vector<uint64_t>& signatures = simhash.Signatures();
+  for (size_t q = 0; q < rdata.n_cols; ++q)
+  {
+    // Compute the Hamming distance to every other point by comparing bits.
+    std::vector<std::pair<size_t, size_t>> hamming;
+    for (size_t r = 0; r < rdata.n_cols; ++r)
+    {
+      if (r == q)
+        continue;
+
+      size_t h = 0;
+      for (size_t b = 0; b < numBits; ++b)
+      {
+        const uint64_t mask = uint64_t(1) << (b % 64);
+        if ((signatures[2 * q + b / 64] & mask) !=
+            (signatures[2 * r + b / 64] & mask))
+          ++h;
+      }
+      hamming.push_back(std::make_pair(h, r));
+    }
+    std::sort(hamming.begin(), hamming.end());
+
+    for (size_t j = 0; j < k; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors(j, q), hamming[j].second);
+      BOOST_REQUIRE_CLOSE(distances(j, q),
+          1.0 - std::cos(M_PI * hamming[j].first / numBits), 1e-5);
+    }
+  }
+
+  // We can't rerank without the reference set.
+  BOOST_REQUIRE_THROW(simhash.Search(k, neighbors, distances, 10),
+      std::invalid_argument);
+  // And we can't find more neighbors than there are other points.
+  BOOST_REQUIRE_THROW(simhash.Search(rdata.n_cols, neighbors, distances),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -239,4 +239,82 @@ BOOST_AUTO_TEST_CASE(HMMViterbiDiagonalGMMHMMCheckDimensionsTest)
   BOOST_REQUIRE_EQUAL(out.n_cols, observations.n_cols);
 }
 
+/**
+ * Make sure several sequences given with the lengths parameter are predicted
+ * like each sequence on its own.
+ */
+BOOST_AUTO_TEST_CASE(HMMViterbiLengthsTest)
+{
+  // Load data to train a discrete HMM model with.
+  arma::mat inp;
+  data::Load("obs1.csv", inp);
+  std::vector<arma::mat> trainSeq = {inp};
+
+  // Initialize and train a discrete HMM model.
+  HMMModel* h = new HMMModel(DiscreteHMM);
+  h->PerformAction<InitHMMModel, std::vector<arma::mat>>(&trainSeq);
+  h->PerformAction<TrainHMMModel, std::vector<arma::mat>>(&trainSeq);
+
+  // Predict the sequence and its first half separately.
+  const arma::mat half = inp.cols(0, inp.n_cols / 2 - 1);
+  arma::Row<size_t> expected;
+  arma::Row<size_t> expectedHalf;
+  h->DiscreteHMM()->Predict(inp, expected);
+  h->DiscreteHMM()->Predict(half, expectedHalf);
+
+  arma::Row<size_t> lengths(3);
+  lengths[0] = inp.n_cols;
+  lengths[1] = half.n_cols;
+  lengths[2] = inp.n_cols;
+
+  SetInputParam("input_model", h);
+  SetInputParam("input", arma::mat(arma::join_rows(arma::join_rows(inp, half),
+      inp)));
+  SetInputParam("lengths", std::move(lengths));
+
+  // Call to hmm_viterbi_main.
+  mlpackMain();
+
+  // The output should hold the state sequences one after another.
+  arma::Mat<size_t> out = CLI::GetParam<arma::Mat<size_t> >("output");
+
+  BOOST_REQUIRE_EQUAL(out.n_rows, 1);
+  BOOST_REQUIRE_EQUAL(out.n_cols, 2 * inp.n_cols + half.n_cols);
+  for (size_t i = 0; i < inp.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(out[i], expected[i]);
+    BOOST_REQUIRE_EQUAL(out[inp.n_cols + half.n_cols + i], expected[i]);
+  }
+  for (size_t i = 0; i < half.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(out[inp.n_cols + i], expectedHalf[i]);
+}
+
+/**
+ * Make sure lengths that do not match the number of observations are rejected.
+ */
+BOOST_AUTO_TEST_CASE(HMMViterbiWrongLengthsTest)
+{
+  // Load data to train a discrete HMM model with.
+  arma::mat inp;
+  data::Load("obs1.csv", inp);
+  std::vector<arma::mat> trainSeq = {inp};
+
+  // Initialize and train a discrete HMM model.
+  HMMModel* h = new HMMModel(DiscreteHMM);
+  h->PerformAction<InitHMMModel, std::vector<arma::mat>>(&trainSeq);
+  h->PerformAction<TrainHMMModel, std::vector<arma::mat>>(&trainSeq);
+
+  arma::Row<size_t> lengths(2);
+  lengths[0] = inp.n_cols;
+  lengths[1] = 1;
+
+  SetInputParam("input_model", h);
+  SetInputParam("input", inp);
+  SetInputParam("lengths", std::move(lengths));
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -280,6 +280,68 @@ BOOST_AUTO_TEST_CASE(KDEGaussianSingleKDTreeResultsMain)
     BOOST_REQUIRE_CLOSE(kdeEstimations[i], mainEstimations[i], 100 * relError);
 }
 
+/**
+  * Ensure that the estimations we get for KDEMain with the 'fgt' algorithm are
+  * the same as the ones we get from the KDE class in FGT mode.
+ **/
+BOOST_AUTO_TEST_CASE(KDEGaussianFGTResultsMain)
+{
+  // Datasets.
+  arma::mat reference = arma::randu(3, 400);
+  arma::mat query = arma::randu(3, 400);
+  arma::vec kdeEstimations, mainEstimations;
+  double kernelBandwidth = 1.0;
+  double relError = 0.05;
+
+  kernel::GaussianKernel kernel(kernelBandwidth);
+  metric::EuclideanDistance metric;
+  KDE<kernel::GaussianKernel,
+      metric::EuclideanDistance,
+      arma::mat,
+      tree::KDTree>
+      kde(relError, 0.0, kernel, KDEMode::FGT_MODE, metric);
+  kde.Train(reference);
+  kde.Evaluate(query, kdeEstimations);
+  kdeEstimations /= kernel.Normalizer(reference.n_rows);
+
+  // Main estimations.
+  SetInputParam("reference", reference);
+  SetInputParam("query", query);
+  SetInputParam("kernel", std::string("gaussian"));
+  SetInputParam("tree", std::string("kd-tree"));
+  SetInputParam("algorithm", std::string("fgt"));
+  SetInputParam("rel_error", relError);
+  SetInputParam("bandwidth", kernelBandwidth);
+
+  mlpackMain();
+
+  mainEstimations = std::move(CLI::GetParam<arma::vec>("predictions"));
+
+  // Both estimations are within relError of the true values.
+  for (size_t i = 0; i < query.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(kdeEstimations[i], mainEstimations[i], 200 * relError);
+}
+
+/**
+  * Ensure we get an exception when the 'fgt' algorithm is used with a kernel
+  * that is not Gaussian.
+ **/
+BOOST_AUTO_TEST_CASE(KDEMainFGTNonGaussianKernel)
+{
+  arma::mat reference = arma::randu<arma::mat>(2, 10);
+  arma::mat query = arma::randu<arma::mat>(2, 5);
+
+  // Main params.
+  SetInputParam("reference", reference);
+  SetInputParam("query", query);
+  SetInputParam("kernel", std::string("epanechnikov"));
+  SetInputParam("algorithm", std::string("fgt"));
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
+
 /**
   * Ensure we get an exception when an invalid kernel is specified.
  **/
@@ -366,6 +366,23 @@ BOOST_AUTO_TEST_CASE(AlgorithmsSimilarTest)
 
   ResetKmSettings();
 
+  algo = "blocked";
+
+  SetInputParam("input", inputData);
+  SetInputParam("clusters", c);
+  SetInputParam("algorithm", std::move(algo));
+  SetInputParam("labels_only", true);
+  SetInputParam("initial_centroids", initCentroid);
+
+  mlpackMain();
+
+  arma::mat blockedOutput;
+  arma::mat blockedCentroid;
+  blockedOutput = std::move(CLI::GetParam<arma::mat>("output"));
+  blockedCentroid = std::move(CLI::GetParam<arma::mat>("centroid"));
+
+  ResetKmSettings();
+
   algo = "dualtree-covertree";
 
   SetInputParam("input", std::move(inputData));
@@ -386,12 +403,56 @@ BOOST_AUTO_TEST_CASE(AlgorithmsSimilarTest)
   CheckMatrices(naiveOutput, elkanOutput);
   CheckMatrices(naiveOutput, dualTreeOutput);
   CheckMatrices(naiveOutput, dualCoverTreeOutput);
+  CheckMatrices(naiveOutput, blockedOutput);
 
   // Checking all the algorithms return almost same centroid
   CheckMatrices(naiveCentroid, hamerlyCentroid);
   CheckMatrices(naiveCentroid, elkanCentroid);
   CheckMatrices(naiveCentroid, dualTreeCentroid);
   CheckMatrices(naiveCentroid, dualCoverTreeCentroid);
+  CheckMatrices(naiveCentroid, blockedCentroid);
+}
+
+/**
+ * Make sure mini-batch k-means finds well-separated clusters, and that the
+ * batch size must be positive.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchTest)
+{
+  arma::mat inputData(3, 3000, arma::fill::randn);
+  for (size_t i = 0; i < 3000; ++i)
+    inputData(0, i) += 20.0 * (i % 3);
+
+  SetInputParam("input", inputData);
+  SetInputParam("clusters", 3);
+  SetInputParam("algorithm", std::string("minibatch"));
+  SetInputParam("batch_size", 100);
+  SetInputParam("max_iterations", 200);
+  SetInputParam("allow_empty_clusters", true);
+  SetInputParam("labels_only", true);
+
+  mlpackMain();
+
+  const arma::mat labels = CLI::GetParam<arma::mat>("output");
+  BOOST_REQUIRE_EQUAL(labels.n_elem, 3000);
+  // Points generated around the same center must share their label.
+  for (size_t i = 3; i < 3000; ++i)
+    BOOST_REQUIRE_EQUAL(labels[i], labels[i % 3]);
+  BOOST_REQUIRE_NE(labels[0], labels[1]);
+  BOOST_REQUIRE_NE(labels[0], labels[2]);
+  BOOST_REQUIRE_NE(labels[1], labels[2]);
+
+  ResetKmSettings();
+
+  SetInputParam("input", std::move(inputData));
+  SetInputParam("clusters", 3);
+  SetInputParam("algorithm", std::string("minibatch"));
+  SetInputParam("batch_size", 0); // Invalid.
+  SetInputParam("labels_only", true);
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
 }
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -66,8 +66,8 @@ BOOST_AUTO_TEST_CASE(LSHOutputDimensionTest)
 }
 
 /**
- * Ensure that bucket_size, second_hash_size & number of nearest neighbors
- * are always positive.
+ * Ensure that bucket_size, second_hash_size, tables & number of nearest
+ * neighbors are always positive, and that num_probes is not negative.
  */
 BOOST_AUTO_TEST_CASE(LSHParamValidityTest)
 {
@@ -97,6 +97,30 @@ BOOST_AUTO_TEST_CASE(LSHParamValidityTest)
 
   bindings::tests::CleanMemory();
 
+  // Test for tables.
+
+  SetInputParam("reference", reference);
+  SetInputParam("k", (int) 6);
+  SetInputParam("tables", (int) 0);
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+
+  bindings::tests::CleanMemory();
+
+  // Test for num_probes.
+
+  SetInputParam("reference", reference);
+  SetInputParam("k", (int) 6);
+  SetInputParam("num_probes", (int) -1);
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+
+  bindings::tests::CleanMemory();
+
   // Test for number of nearest neighbors.
 
   SetInputParam("reference", std::move(reference));
@@ -385,4 +409,124 @@ BOOST_AUTO_TEST_CASE(LSHModelTrueNighborsDimTest)
   Log::Fatal.ignoreInput = false;
 }
 
+/**
+ * Make sure SimHash models can be trained, saved and reused.
+ */
+BOOST_AUTO_TEST_CASE(LSHSimHashModelReuseTest)
+{
+  arma::mat reference = arma::randn<arma::mat>(5, 100);
+  arma::mat query = arma::randn<arma::mat>(5, 20);
+
+  SetInputParam("reference", std::move(reference));
+  SetInputParam("query", query);
+  SetInputParam("hash_type", std::string("simhash"));
+  SetInputParam("bits", (int) 96);
+  SetInputParam("rerank", (int) 20);
+  SetInputParam("k", (int) 4);
+
+  mlpackMain();
+
+  arma::Mat<size_t> neighbors = CLI::GetParam<arma::Mat<size_t>>("neighbors");
+  arma::mat distances = CLI::GetParam<arma::mat>("distances");
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, 20);
+  BOOST_REQUIRE_EQUAL(distances.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, 20);
+  BOOST_REQUIRE_EQUAL(CLI::GetParam<SimHashSearch*>("output_simhash_model")->
+      NumBits(), 96);
+
+  // Reuse the model; the results must be the same.
+  CLI::GetSingleton().Parameters()["reference"].wasPassed = false;
+
+  SetInputParam("input_simhash_model",
+      CLI::GetParam<SimHashSearch*>("output_simhash_model"));
+  SetInputParam("query", std::move(query));
+
+  mlpackMain();
+
+  CheckMatrices(neighbors, CLI::GetParam<arma::Mat<size_t>>("neighbors"));
+  CheckMatrices(distances, CLI::GetParam<arma::mat>("distances"));
+}
+
+/**
+ * Make sure a SimHash model only keeps the reference set when it is needed for
+ * reranking, and that a model without it cannot be used to rerank.
+ */
+BOOST_AUTO_TEST_CASE(LSHSimHashStoreReferenceTest)
+{
+  arma::mat reference = arma::randn<arma::mat>(5, 100);
+
+  SetInputParam("reference", reference);
+  SetInputParam("hash_type", std::string("simhash"));
+
+  mlpackMain();
+
+  SimHashSearch* model =
+      CLI::GetParam<SimHashSearch*>("output_simhash_model");
+  BOOST_REQUIRE_EQUAL(model->NumPoints(), 100);
+  BOOST_REQUIRE_EQUAL(model->ReferenceSet().n_elem, 0);
+
+  // Reranking with this model must fail.
+  CLI::GetSingleton().Parameters()["reference"].wasPassed = false;
+  CLI::GetSingleton().Parameters()["hash_type"].wasPassed = false;
+
+  SetInputParam("input_simhash_model", model);
+  SetInputParam("k", (int) 4);
+  SetInputParam("rerank", (int) 20);
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+
+  bindings::tests::CleanMemory();
+  CLI::GetSingleton().Parameters()["input_simhash_model"].wasPassed = false;
+  CLI::GetSingleton().Parameters()["k"].wasPassed = false;
+  CLI::GetSingleton().Parameters()["rerank"].wasPassed = false;
+
+  // With store_reference, the reference set is kept.
+  SetInputParam("reference", std::move(reference));
+  SetInputParam("hash_type", std::string("simhash"));
+  SetInputParam("store_reference", true);
+
+  mlpackMain();
+
+  model = CLI::GetParam<SimHashSearch*>("output_simhash_model");
+  BOOST_REQUIRE_EQUAL(model->ReferenceSet().n_cols, 100);
+}
+
+/**
+ * Make sure that the LSH parameters that SimHash ignores do not change its
+ * results.
+ */
+BOOST_AUTO_TEST_CASE(LSHSimHashIgnoredParamsTest)
+{
+  arma::mat reference = arma::randn<arma::mat>(5, 100);
+
+  SetInputParam("reference", reference);
+  SetInputParam("hash_type", std::string("simhash"));
+  SetInputParam("k", (int) 4);
+  SetInputParam("seed", (int) 5);
+
+  mlpackMain();
+
+  const arma::Mat<size_t> neighbors =
+      CLI::GetParam<arma::Mat<size_t>>("neighbors");
+  const arma::mat distances = CLI::GetParam<arma::mat>("distances");
+
+  bindings::tests::CleanMemory();
+
+  SetInputParam("reference", std::move(reference));
+  SetInputParam("hash_type", std::string("simhash"));
+  SetInputParam("k", (int) 4);
+  SetInputParam("seed", (int) 5);
+  SetInputParam("tables", (int) 3);
+  SetInputParam("projections", (int) 2);
+  SetInputParam("num_probes", (int) 5);
+
+  mlpackMain();
+
+  CheckMatrices(neighbors, CLI::GetParam<arma::Mat<size_t>>("neighbors"));
+  CheckMatrices(distances, CLI::GetParam<arma::mat>("distances"));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
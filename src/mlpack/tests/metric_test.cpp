@@ -10,6 +10,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/metrics/block_distances.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -87,4 +88,73 @@ BOOST_AUTO_TEST_CASE(LINFMetricTest)
                       lMetric.Evaluate(a2, b2), 1e-5);
 }
 
+/**
+ * Check BlockDistances() against Evaluate() for every pair of two blocks.
+ */
+template<typename MetricType>
+void CheckBlockDistances(const arma::mat& a, const arma::mat& b)
+{
+  MetricType metric;
+  arma::mat distances;
+  BlockDistances(metric, a, 3, 20, b, 5, 17, distances);
+
+  BOOST_REQUIRE_EQUAL(distances.n_rows, 20);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, 17);
+  for (size_t j = 0; j < 17; ++j)
+  {
+    for (size_t i = 0; i < 20; ++i)
+    {
+      const double expected = metric.Evaluate(a.col(3 + i), b.col(5 + j));
+      if (expected == 0.0)
+        BOOST_REQUIRE_EQUAL(distances(i, j), 0.0);
+      else
+        BOOST_REQUIRE_CLOSE(distances(i, j), expected, 1e-5);
+    }
+  }
+
+  // Cached norms of the block of b must give the same distances, also when
+  // they are reused.
+  BlockNormCache<double> cache;
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    arma::mat cachedDistances;
+    BlockDistances(metric, a, 3, 20, b, 5, 17, cachedDistances, cache);
+    BOOST_REQUIRE_EQUAL(cachedDistances.n_rows, 20);
+    BOOST_REQUIRE_EQUAL(cachedDistances.n_cols, 17);
+    for (size_t i = 0; i < distances.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(cachedDistances[i], distances[i]);
+  }
+}
+
+/**
+ * Make sure that BlockDistances() gives the same distances as Evaluate(), also
+ * for points far from the origin and for duplicate points.
+ */
+BOOST_AUTO_TEST_CASE(BlockDistancesTest)
+{
+  arma::mat a(7, 30, arma::fill::randu);
+  arma::mat b(7, 25, arma::fill::randu);
+  // Some duplicates and some very close points.
+  b.col(6) = a.col(4);
+  b.col(7) = a.col(10);
+  b.col(8) = a.col(10) + 1e-9;
+
+  CheckBlockDistances<EuclideanDistance>(a, b);
+  CheckBlockDistances<SquaredEuclideanDistance>(a, b);
+  CheckBlockDistances<ManhattanDistance>(a, b);
+
+  // Move the points far away from the origin.
+  a += 1e5;
+  b += 1e5;
+  CheckBlockDistances<EuclideanDistance>(a, b);
+  CheckBlockDistances<SquaredEuclideanDistance>(a, b);
+
+  // Empty blocks are fine.
+  EuclideanDistance metric;
+  arma::mat distances;
+  BlockDistances(metric, a, 0, 0, b, 0, 5, distances);
+  BOOST_REQUIRE_EQUAL(distances.n_rows, 0);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, 5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
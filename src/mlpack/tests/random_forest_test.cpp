@@ -152,6 +152,86 @@ BOOST_AUTO_TEST_CASE(UnweightedNumericLearningTest)
   BOOST_REQUIRE_GE(rfCorrect, size_t(0.7 * testDataset.n_cols));
 }
 
+/**
+ * Make sure a random forest can be trained with the HistogramNumericSplit.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericLearningTest)
+{
+  // Load the vc2 dataset.
+  arma::mat dataset;
+  data::Load("vc2.csv", dataset);
+  arma::Row<size_t> labels;
+  data::Load("vc2_labels.txt", labels);
+
+  RandomForest<GiniGain, MultipleRandomDimensionSelect, HistogramNumericSplit>
+      rf(dataset, labels, 3, 20 /* 20 trees */, 1, 1e-7);
+
+  arma::mat testDataset;
+  data::Load("vc2_test.csv", testDataset);
+  arma::Row<size_t> testLabels;
+  data::Load("vc2_test_labels.txt", testLabels);
+
+  arma::Row<size_t> predictions;
+  rf.Classify(testDataset, predictions);
+
+  const size_t correct = arma::accu(predictions == testLabels);
+  BOOST_REQUIRE_GE(correct, size_t(0.7 * testDataset.n_cols));
+}
+
+/**
+ * Make sure a random forest with the HistogramNumericSplit bins the dataset
+ * once for all of its trees: every split of every tree must then send all the
+ * points of one bin of the whole dataset to the same child.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSharedBinsTest)
+{
+  // Many more distinct values than bins in each dimension, so bins computed at
+  // each node would not line up with the bins of the whole dataset.
+  arma::mat dataset(4, 3000, arma::fill::randu);
+  arma::Row<size_t> labels(dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    labels[i] = (dataset(0, i) + dataset(1, i) > 1.0) ? 1 : 0;
+
+  typedef RandomForest<GiniGain, MultipleRandomDimensionSelect,
+      HistogramNumericSplit> ForestType;
+  ForestType rf(dataset, labels, 2, 5 /* 5 trees */, 1, 1e-7);
+
+  arma::Mat<unsigned char> bins;
+  arma::mat binMin, binMax;
+  ForestType::DecisionTreeType::BinData(dataset, bins, binMin, binMax);
+
+  size_t splits = 0;
+  for (size_t t = 0; t < rf.NumTrees(); ++t)
+  {
+    std::vector<const ForestType::DecisionTreeType*> stack;
+    stack.push_back(&rf.Tree(t));
+    while (!stack.empty())
+    {
+      const ForestType::DecisionTreeType& node = *stack.back();
+      stack.pop_back();
+      if (node.NumChildren() == 0)
+        continue;
+
+      ++splits;
+      const size_t dim = node.SplitDimension();
+      std::vector<size_t> binDirection(256, size_t(-1));
+      for (size_t i = 0; i < dataset.n_cols; ++i)
+      {
+        const size_t direction = node.CalculateDirection(dataset.col(i));
+        const size_t b = bins(dim, i);
+        if (binDirection[b] == size_t(-1))
+          binDirection[b] = direction;
+        BOOST_REQUIRE_EQUAL(binDirection[b], direction);
+      }
+
+      for (size_t c = 0; c < node.NumChildren(); ++c)
+        stack.push_back(&node.Child(c));
+    }
+  }
+
+  BOOST_REQUIRE_GT(splits, rf.NumTrees());
+}
+
 /**
  * Test weighted numeric learning, making sure that we get better performance
  * than a single decision tree.
@@ -487,4 +567,103 @@ BOOST_AUTO_TEST_CASE(DifferentTreesTest)
   BOOST_REQUIRE_EQUAL(success, true);
 }
 
+/**
+ * Make sure that a FlatForest built from a random forest gives the same
+ * predictions and probabilities as the random forest, for numeric and
+ * categorical data, and that it can be serialized.
+ */
+BOOST_AUTO_TEST_CASE(FlatForestTest)
+{
+  arma::mat dataset;
+  data::Load("vc2.csv", dataset);
+  arma::Row<size_t> labels;
+  data::Load("vc2_labels.txt", labels);
+
+  RandomForest<> rf(dataset, labels, 3, 20 /* 20 trees */, 1);
+  FlatForest flat(rf);
+  BOOST_REQUIRE_EQUAL(flat.NumTrees(), 20);
+  BOOST_REQUIRE_EQUAL(flat.NumClasses(), 3);
+
+  arma::Row<size_t> predictions, flatPredictions;
+  arma::mat probabilities, flatProbabilities;
+  rf.Classify(dataset, predictions, probabilities);
+  flat.Classify(dataset, flatPredictions, flatProbabilities);
+
+  CheckMatrices(predictions, flatPredictions);
+  CheckMatrices(probabilities, flatProbabilities);
+
+  // Classifying one point at a time must give the same results.
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    size_t prediction;
+    arma::vec pointProbabilities;
+    flat.Classify(dataset.col(i), prediction, pointProbabilities);
+    BOOST_REQUIRE_EQUAL(prediction, predictions[i]);
+    BOOST_REQUIRE_EQUAL(flat.Classify(dataset.col(i)), predictions[i]);
+    for (size_t c = 0; c < 3; ++c)
+      BOOST_REQUIRE_CLOSE(pointProbabilities[c] + 1.0,
+          probabilities(c, i) + 1.0, 1e-10);
+  }
+
+  FlatForest xmlFlat, textFlat, binaryFlat;
+  SerializeObjectAll(flat, xmlFlat, textFlat, binaryFlat);
+
+  arma::Row<size_t> xmlPredictions, textPredictions, binaryPredictions;
+  arma::mat xmlProbabilities, textProbabilities, binaryProbabilities;
+  xmlFlat.Classify(dataset, xmlPredictions, xmlProbabilities);
+  textFlat.Classify(dataset, textPredictions, textProbabilities);
+  binaryFlat.Classify(dataset, binaryPredictions, binaryProbabilities);
+
+  CheckMatrices(predictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+  CheckMatrices(probabilities, xmlProbabilities, textProbabilities,
+      binaryProbabilities);
+
+  // Now with categorical data.
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  RandomForest<> catRf(d, di, l, 5, 10 /* 10 trees */, 1, 1e-7, 0,
+      MultipleRandomDimensionSelect(4));
+  FlatForest catFlat(catRf);
+
+  catRf.Classify(d, predictions, probabilities);
+  catFlat.Classify(d, flatPredictions, flatProbabilities);
+
+  CheckMatrices(predictions, flatPredictions);
+  CheckMatrices(probabilities, flatProbabilities);
+}
+
+/**
+ * A FlatForest without trees, or with an incomplete tree, cannot be used.
+ */
+BOOST_AUTO_TEST_CASE(FlatForestInvalidTest)
+{
+  arma::mat data(3, 10, arma::fill::randu);
+  arma::Row<size_t> predictions;
+
+  FlatForest flat;
+  BOOST_REQUIRE_THROW(flat.Classify(data, predictions), std::invalid_argument);
+
+  const size_t root = flat.AddTree(2);
+  const size_t child = flat.AddNumericSplit(root, 1, 0.5);
+  flat.SetLeaf(child, 0, arma::vec("1.0 0.0"));
+  BOOST_REQUIRE_THROW(flat.Classify(data, predictions), std::invalid_argument);
+  BOOST_REQUIRE_THROW(flat.AddTree(2), std::invalid_argument);
+
+  // A node can only be set once.
+  BOOST_REQUIRE_THROW(flat.SetLeaf(child, 1, arma::vec("0.0 1.0")),
+      std::invalid_argument);
+
+  flat.SetLeaf(child + 1, 1, arma::vec("0.25 0.75"));
+  flat.Classify(data, predictions);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], (data(1, i) <= 0.5) ? 0 : 1);
+
+  // Every tree must have the same number of classes.
+  BOOST_REQUIRE_THROW(flat.AddTree(3), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -596,6 +596,120 @@ BOOST_AUTO_TEST_CASE(SingleTreeVsNaive)
   }
 }
 
+// Convert results in compressed sparse row form to one vector per query point.
+void UnflattenResults(const vector<size_t>& offsets,
+                      const vector<size_t>& flatNeighbors,
+                      const vector<double>& flatDistances,
+                      vector<vector<size_t>>& neighbors,
+                      vector<vector<double>>& distances)
+{
+  neighbors.resize(offsets.size() - 1);
+  distances.resize(offsets.size() - 1);
+  for (size_t i = 0; i < offsets.size() - 1; ++i)
+  {
+    neighbors[i].assign(flatNeighbors.begin() + offsets[i],
+        flatNeighbors.begin() + offsets[i + 1]);
+    distances[i].assign(flatDistances.begin() + offsets[i],
+        flatDistances.begin() + offsets[i + 1]);
+  }
+}
+
+/**
+ * Make sure that the compressed sparse row Search() overloads give the same
+ * results as the regular overloads, for naive, single-tree and dual-tree
+ * search, with and without a query set.
+ */
+BOOST_AUTO_TEST_CASE(CSRResultsTest)
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  arma::mat querySet = arma::randu<arma::mat>(3, 200);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(dataset, mode == 0, mode == 1);
+
+    for (size_t mono = 0; mono < 2; ++mono)
+    {
+      vector<vector<size_t>> neighbors;
+      vector<vector<double>> distances;
+      vector<size_t> offsets;
+      vector<size_t> flatNeighbors;
+      vector<double> flatDistances;
+      if (mono == 1)
+      {
+        rs.Search(Range(0.25, 1.05), neighbors, distances);
+        rs.Search(Range(0.25, 1.05), offsets, flatNeighbors, flatDistances);
+      }
+      else
+      {
+        rs.Search(querySet, Range(0.25, 1.05), neighbors, distances);
+        rs.Search(querySet, Range(0.25, 1.05), offsets, flatNeighbors,
+            flatDistances);
+      }
+
+      BOOST_REQUIRE_EQUAL(offsets.size(), neighbors.size() + 1);
+      BOOST_REQUIRE_EQUAL(flatNeighbors.size(), flatDistances.size());
+      BOOST_REQUIRE_EQUAL(offsets.back(), flatNeighbors.size());
+
+      vector<vector<size_t>> csrNeighbors;
+      vector<vector<double>> csrDistances;
+      UnflattenResults(offsets, flatNeighbors, flatDistances, csrNeighbors,
+          csrDistances);
+
+      vector<vector<pair<double, size_t>>> sorted;
+      SortResults(neighbors, distances, sorted);
+      vector<vector<pair<double, size_t>>> sortedCSR;
+      SortResults(csrNeighbors, csrDistances, sortedCSR);
+
+      for (size_t i = 0; i < sorted.size(); ++i)
+      {
+        BOOST_REQUIRE_EQUAL(sorted[i].size(), sortedCSR[i].size());
+        for (size_t j = 0; j < sorted[i].size(); ++j)
+        {
+          BOOST_REQUIRE_EQUAL(sorted[i][j].second, sortedCSR[i][j].second);
+          BOOST_REQUIRE_CLOSE(sorted[i][j].first, sortedCSR[i][j].first,
+              1e-5);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that dual-tree search in compressed sparse row form stores each
+ * result exactly once: the vectors of results are allocated with exactly one
+ * index and one distance per result, and not grown geometrically or copied from
+ * a temporary buffer.
+ */
+BOOST_AUTO_TEST_CASE(CSRDualTreeMemoryTest)
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  arma::mat querySet = arma::randu<arma::mat>(3, 200);
+
+  RangeSearch<> rs(dataset);
+  for (size_t mono = 0; mono < 2; ++mono)
+  {
+    vector<size_t> offsets;
+    vector<size_t> neighbors;
+    vector<double> distances;
+    if (mono == 1)
+      rs.Search(Range(0.25, 1.05), offsets, neighbors, distances);
+    else
+      rs.Search(querySet, Range(0.25, 1.05), offsets, neighbors, distances);
+
+    BOOST_REQUIRE_GT(neighbors.size(), 0);
+    BOOST_REQUIRE_EQUAL(offsets.back(), neighbors.size());
+    BOOST_REQUIRE_EQUAL(neighbors.capacity(), neighbors.size());
+    BOOST_REQUIRE_EQUAL(distances.capacity(), distances.size());
+  }
+}
+
 /**
  * Ensure that dual tree range search with cover trees works by comparing
  * with the kd-tree implementation.
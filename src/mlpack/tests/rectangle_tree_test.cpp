@@ -1384,4 +1384,73 @@ BOOST_AUTO_TEST_CASE(RectangleTreeMoveDatasetTest)
   BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 1000);
 }
 
+/**
+ * Bulk-load a tree of the given type, make sure that it is valid, and make sure
+ * that it gives the same neighbors as a naive search.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void CheckBulkLoad(const arma::mat& dataset, const bool packed)
+{
+  typedef TreeType<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> Tree;
+  Tree tree(dataset, 20, 6, 5, 2, 0, true);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), dataset.n_cols);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+
+  // Packed trees also meet the fill requirements.
+  if (packed)
+    CheckFills(tree);
+
+  arma::Mat<size_t> neighbors1, neighbors2;
+  arma::mat distances1, distances2;
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat, TreeType>
+      knn1(std::move(tree), SINGLE_TREE_MODE);
+  knn1.Search(5, neighbors1, distances1);
+
+  KNN knn2(dataset, NAIVE_MODE);
+  knn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_CLOSE(distances1[i], distances2[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure that bulk-loading works for every type of rectangle tree, and for
+ * trees that fit in one leaf.
+ */
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadTest)
+{
+  arma::mat dataset(8, 3000, arma::fill::randu);
+
+  CheckBulkLoad<RTree>(dataset, true);
+  CheckBulkLoad<RStarTree>(dataset, true);
+  CheckBulkLoad<XTree>(dataset, true);
+  CheckBulkLoad<HilbertRTree>(dataset, false);
+  CheckBulkLoad<RPlusTree>(dataset, false);
+
+  arma::mat smallDataset(3, 15, arma::fill::randu);
+  RTree<EuclideanDistance, EmptyStatistic, arma::mat> leaf(smallDataset, 20, 6,
+      5, 2, 0, true);
+  BOOST_REQUIRE(leaf.IsLeaf());
+  BOOST_REQUIRE_EQUAL(leaf.Count(), 15);
+  CheckExactContainment(leaf);
+
+  // Points before firstDataIndex are not loaded.
+  RTree<EuclideanDistance, EmptyStatistic, arma::mat> partial(dataset, 20, 6,
+      5, 2, 1000, true);
+  BOOST_REQUIRE_EQUAL(partial.NumDescendants(), 2000);
+  CheckNumDescendants(partial);
+  CheckFills(partial);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
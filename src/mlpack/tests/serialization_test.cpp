@@ -37,6 +37,7 @@
 #include <mlpack/methods/naive_bayes/naive_bayes_classifier.hpp>
 #include <mlpack/methods/rann/ra_search.hpp>
 #include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/methods/lsh/simhash_search.hpp>
 #include <mlpack/methods/decision_stump/decision_stump.hpp>
 #include <mlpack/methods/lars/lars.hpp>
 #include <mlpack/methods/ann/rbm/rbm.hpp>
@@ -1065,6 +1066,41 @@ BOOST_AUTO_TEST_CASE(LSHTest)
       textLsh.SecondHashTable()[i], binaryLsh.SecondHashTable()[i]);
 }
 
+/**
+ * Test that a SimHash model can be serialized and deserialized.
+ */
+BOOST_AUTO_TEST_CASE(SimHashTest)
+{
+  arma::mat referenceData = arma::randn<arma::mat>(10, 100);
+  SimHashSearch simhash(referenceData, 80);
+
+  SimHashSearch xmlSimHash;
+  SimHashSearch textSimHash(arma::randn<arma::mat>(5, 50), 10);
+  SimHashSearch binarySimHash(referenceData, 20, false);
+
+  SerializeObjectAll(simhash, xmlSimHash, textSimHash, binarySimHash);
+
+  CheckMatrices(simhash.ReferenceSet(), xmlSimHash.ReferenceSet(),
+      textSimHash.ReferenceSet(), binarySimHash.ReferenceSet());
+  CheckMatrices(simhash.Projections(), xmlSimHash.Projections(),
+      textSimHash.Projections(), binarySimHash.Projections());
+
+  BOOST_REQUIRE(simhash.Signatures() == xmlSimHash.Signatures());
+  BOOST_REQUIRE(simhash.Signatures() == textSimHash.Signatures());
+  BOOST_REQUIRE(simhash.Signatures() == binarySimHash.Signatures());
+
+  // The models must find the same neighbors.
+  arma::Mat<size_t> neighbors, xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat distances, xmlDistances, textDistances, binaryDistances;
+  simhash.Search(3, neighbors, distances, 10);
+  xmlSimHash.Search(3, xmlNeighbors, xmlDistances, 10);
+  textSimHash.Search(3, textNeighbors, textDistances, 10);
+  binarySimHash.Search(3, binaryNeighbors, binaryDistances, 10);
+
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+  CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
+}
+
 // Make sure serialization works for the decision stump.
 BOOST_AUTO_TEST_CASE(DecisionStumpTest)
 {
@@ -1360,6 +1360,332 @@ BOOST_AUTO_TEST_CASE(KdTreeTest)
   TreeType root(dataset);
 }
 
+/**
+ * Check that the compacted tree has the same structure as the other tree, and
+ * that the parent and dataset pointers of every node are right.
+ */
+template<typename TreeType>
+void CheckCompactNode(const TreeType& compact, const TreeType& other)
+{
+  BOOST_REQUIRE_EQUAL(compact.Begin(), other.Begin());
+  BOOST_REQUIRE_EQUAL(compact.Count(), other.Count());
+  BOOST_REQUIRE_EQUAL(compact.NumChildren(), other.NumChildren());
+  for (size_t d = 0; d < other.Bound().Dim(); ++d)
+  {
+    BOOST_REQUIRE_EQUAL(compact.Bound()[d].Lo(), other.Bound()[d].Lo());
+    BOOST_REQUIRE_EQUAL(compact.Bound()[d].Hi(), other.Bound()[d].Hi());
+  }
+
+  for (size_t i = 0; i < compact.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(compact.Child(i).Parent(), &compact);
+    BOOST_REQUIRE_EQUAL(&compact.Child(i).Dataset(), &compact.Dataset());
+    CheckCompactNode(compact.Child(i), other.Child(i));
+  }
+}
+
+/**
+ * Make sure that compacting a kd-tree in either order keeps the tree the same,
+ * puts the nodes in the expected order, and that compacted trees can be copied,
+ * moved and assigned to.
+ */
+BOOST_AUTO_TEST_CASE(CompactKdTreeTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset(4, 3000, arma::fill::randu);
+  TreeType original(dataset, 10);
+
+  TreeType breadthFirst(original);
+  breadthFirst.Compact(false);
+  BOOST_REQUIRE(breadthFirst.IsCompact());
+  BOOST_REQUIRE(!original.IsCompact());
+  CheckCompactNode(breadthFirst, original);
+
+  // In breadth-first order, the children of the root come first, and siblings
+  // are next to each other.
+  BOOST_REQUIRE_EQUAL(breadthFirst.Right(), breadthFirst.Left() + 1);
+  BOOST_REQUIRE_EQUAL(breadthFirst.Left()->Left(), breadthFirst.Left() + 2);
+  BOOST_REQUIRE_EQUAL(breadthFirst.Right()->Left(), breadthFirst.Left() + 4);
+
+  TreeType vanEmdeBoas(original);
+  vanEmdeBoas.Compact();
+  CheckCompactNode(vanEmdeBoas, original);
+
+  // Compacting again is fine.
+  vanEmdeBoas.Compact(false);
+  CheckCompactNode(vanEmdeBoas, original);
+  vanEmdeBoas.Compact();
+  CheckCompactNode(vanEmdeBoas, original);
+
+  // Copies of a compacted tree are not compacted.
+  TreeType copy(vanEmdeBoas);
+  BOOST_REQUIRE(!copy.IsCompact());
+  CheckCompactNode(copy, original);
+
+  // Moving a compacted tree moves the nodes too.
+  TreeType moved(std::move(vanEmdeBoas));
+  BOOST_REQUIRE(moved.IsCompact());
+  BOOST_REQUIRE(!vanEmdeBoas.IsCompact());
+  CheckCompactNode(moved, original);
+
+  // Assigning to a compacted tree releases its nodes.
+  breadthFirst = copy;
+  BOOST_REQUIRE(!breadthFirst.IsCompact());
+  CheckCompactNode(breadthFirst, original);
+  moved = std::move(breadthFirst);
+  BOOST_REQUIRE(!moved.IsCompact());
+  CheckCompactNode(moved, original);
+
+  // A tree with only one node has nothing to compact.
+  TreeType leaf(dataset, 5000);
+  leaf.Compact();
+  BOOST_REQUIRE(!leaf.IsCompact());
+}
+
+/**
+ * Build a tree with all threads and with one thread, and make sure that the
+ * permutation is right and that both trees hold the same nodes.  The dataset is
+ * large enough that the top levels of the tree are built in parallel.
+ */
+BOOST_AUTO_TEST_CASE(ParallelBuildKdTreeTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset(3, 40000, arma::fill::randu);
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew, 10);
+
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), dataset.n_cols);
+  std::vector<bool> seen(dataset.n_cols, false);
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+  {
+    BOOST_REQUIRE(!seen[oldFromNew[i]]);
+    seen[oldFromNew[i]] = true;
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+      BOOST_REQUIRE_EQUAL(tree.Dataset()(d, i), dataset(d, oldFromNew[i]));
+  }
+  BOOST_REQUIRE(CheckPointBounds(tree));
+
+  #ifdef HAS_OPENMP
+  const size_t threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+  TreeType serialTree(dataset, 10);
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(threads);
+  #endif
+
+  CheckCompactNode(tree, serialTree);
+}
+
+/**
+ * Make sure that ball trees and mean split kd-trees built in parallel are
+ * valid.
+ */
+BOOST_AUTO_TEST_CASE(ParallelBuildTreeTypesTest)
+{
+  arma::mat dataset(3, 40000, arma::fill::randu);
+
+  std::vector<size_t> oldFromNew;
+  BallTree<EuclideanDistance, EmptyStatistic, arma::mat> ballTree(dataset,
+      oldFromNew, 10);
+  BOOST_REQUIRE_EQUAL(ballTree.NumDescendants(), dataset.n_cols);
+  BOOST_REQUIRE(CheckPointBounds(ballTree));
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+      BOOST_REQUIRE_EQUAL(ballTree.Dataset()(d, i), dataset(d, oldFromNew[i]));
+
+  MeanSplitKDTree<EuclideanDistance, EmptyStatistic, arma::mat> meanTree(
+      dataset, oldFromNew, 10);
+  BOOST_REQUIRE_EQUAL(meanTree.NumDescendants(), dataset.n_cols);
+  BOOST_REQUIRE(CheckPointBounds(meanTree));
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+      BOOST_REQUIRE_EQUAL(meanTree.Dataset()(d, i), dataset(d, oldFromNew[i]));
+}
+
+/**
+ * Check that every node of a tree that has been updated holds the points of its
+ * children, and that no leaf is too large.
+ */
+template<typename TreeType>
+void CheckUpdatedNode(const TreeType& node, const size_t maxLeafSize)
+{
+  if (node.NumChildren() == 0)
+  {
+    BOOST_REQUIRE_LE(node.Count(), maxLeafSize);
+    return;
+  }
+
+  BOOST_REQUIRE_EQUAL(node.NumChildren(), 2);
+  BOOST_REQUIRE_GT(node.Left()->Count(), 0);
+  BOOST_REQUIRE_GT(node.Right()->Count(), 0);
+  BOOST_REQUIRE_EQUAL(node.Left()->Begin(), node.Begin());
+  BOOST_REQUIRE_EQUAL(node.Right()->Begin(),
+      node.Begin() + node.Left()->Count());
+  BOOST_REQUIRE_EQUAL(node.Left()->Count() + node.Right()->Count(),
+      node.Count());
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(node.Child(i).Parent(), &node);
+    BOOST_REQUIRE_EQUAL(&node.Child(i).Dataset(), &node.Dataset());
+    CheckUpdatedNode(node.Child(i), maxLeafSize);
+  }
+}
+
+/**
+ * Check that an updated tree holds exactly the given points, with the right
+ * mapping, and that its structure and bounds are valid.
+ */
+template<typename TreeType>
+void CheckUpdatedTree(TreeType& tree,
+                      const arma::mat& dataset,
+                      const std::vector<size_t>& oldFromNew,
+                      const size_t maxLeafSize)
+{
+  BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, dataset.n_cols);
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), dataset.n_cols);
+  BOOST_REQUIRE_EQUAL(tree.Begin(), 0);
+  BOOST_REQUIRE_EQUAL(tree.Count(), dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+      BOOST_REQUIRE_EQUAL(tree.Dataset()(d, i), dataset(d, oldFromNew[i]));
+
+  CheckUpdatedNode(tree, maxLeafSize);
+  BOOST_REQUIRE(CheckPointBounds(tree));
+}
+
+/**
+ * Insert points into and delete points from kd-trees and ball trees, and make
+ * sure that the trees stay valid.
+ */
+template<typename TreeType>
+void CheckInsertDelete()
+{
+  arma::mat dataset(3, 1000, arma::fill::randu);
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew, 10);
+  tree.Compact();
+
+  // Insert a few batches of points, some of them outside of the old bounds.
+  for (size_t b = 0; b < 4; ++b)
+  {
+    const arma::mat points = 2.0 * arma::randu<arma::mat>(3, 150) - 0.5;
+    tree.InsertPoints(points, oldFromNew, 10);
+    dataset = arma::join_rows(dataset, points);
+    CheckUpdatedTree(tree, dataset, oldFromNew, 10);
+  }
+  BOOST_REQUIRE(tree.IsCompact());
+
+  // Delete every third point of the dataset of the tree, and all of the points
+  // in one corner, so that some subtrees become empty.
+  std::vector<size_t> points;
+  std::vector<bool> deleted(dataset.n_cols, false);
+  for (size_t i = 0; i < tree.Dataset().n_cols; ++i)
+  {
+    if (i % 3 == 0 || arma::all(tree.Dataset().col(i) < 0.3))
+    {
+      points.push_back(i);
+      deleted[oldFromNew[i]] = true;
+    }
+  }
+
+  std::vector<size_t> kept;
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    if (!deleted[i])
+      kept.push_back(i);
+
+  tree.DeletePoints(points, oldFromNew);
+  dataset = arma::mat(dataset.cols(arma::conv_to<arma::uvec>::from(kept)));
+  CheckUpdatedTree(tree, dataset, oldFromNew, 10);
+  BOOST_REQUIRE(tree.IsCompact());
+
+  // Deleting every point leaves an empty leaf, which can be filled again.
+  points.resize(tree.Dataset().n_cols);
+  for (size_t i = 0; i < points.size(); ++i)
+    points[i] = i;
+  tree.DeletePoints(points, oldFromNew);
+  BOOST_REQUIRE_EQUAL(tree.NumChildren(), 0);
+  BOOST_REQUIRE_EQUAL(tree.Count(), 0);
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), 0);
+
+  tree.InsertPoints(dataset, oldFromNew, 10);
+  CheckUpdatedTree(tree, dataset, oldFromNew, 10);
+
+  // Bad indices are rejected.
+  points.assign(1, dataset.n_cols);
+  BOOST_REQUIRE_THROW(tree.DeletePoints(points, oldFromNew),
+      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeInsertDeleteTest)
+{
+  CheckInsertDelete<KDTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+  CheckInsertDelete<BallTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+
+  // UB trees can't split their leaves on their own.
+  arma::mat dataset(3, 100, arma::fill::randu);
+  std::vector<size_t> oldFromNew;
+  UBTree<EuclideanDistance, EmptyStatistic, arma::mat> tree(dataset,
+      oldFromNew);
+  BOOST_REQUIRE_THROW(tree.InsertPoints(dataset, oldFromNew),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that inserting small batches of points into a tree does not
+ * reallocate its dataset every time, and that the tree can still be copied and
+ * moved afterwards.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeInsertSpareColumnsTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset(3, 1000, arma::fill::randu);
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew, 10);
+
+  // The first insertion leaves room for as many points again.
+  arma::mat points(3, 10, arma::fill::randu);
+  tree.InsertPoints(points, oldFromNew, 10);
+  dataset = arma::join_rows(dataset, points);
+  const double* memory = tree.Dataset().memptr();
+
+  for (size_t b = 0; b < 50; ++b)
+  {
+    points.randu();
+    tree.InsertPoints(points, oldFromNew, 10);
+    dataset = arma::join_rows(dataset, points);
+    BOOST_REQUIRE_EQUAL(tree.Dataset().memptr(), memory);
+  }
+  CheckUpdatedTree(tree, dataset, oldFromNew, 10);
+
+  // Deleting points does not reallocate the dataset either.
+  std::vector<size_t> deleted(1, 0);
+  dataset.shed_col(oldFromNew[0]);
+  tree.DeletePoints(deleted, oldFromNew);
+  BOOST_REQUIRE_EQUAL(tree.Dataset().memptr(), memory);
+  CheckUpdatedTree(tree, dataset, oldFromNew, 10);
+
+  // A copy owns its own dataset, and a moved tree keeps the spare columns.
+  TreeType copy(tree);
+  TreeType moved(std::move(tree));
+  BOOST_REQUIRE_NE(copy.Dataset().memptr(), memory);
+  BOOST_REQUIRE_EQUAL(moved.Dataset().memptr(), memory);
+  CheckUpdatedTree(copy, dataset, oldFromNew, 10);
+
+  std::vector<size_t> movedOldFromNew(oldFromNew);
+  points.randu();
+  moved.InsertPoints(points, movedOldFromNew, 10);
+  copy.InsertPoints(points, oldFromNew, 10);
+  dataset = arma::join_rows(dataset, points);
+  BOOST_REQUIRE_EQUAL(moved.Dataset().memptr(), memory);
+  CheckUpdatedTree(moved, dataset, movedOldFromNew, 10);
+  CheckUpdatedTree(copy, dataset, oldFromNew, 10);
+}
+
 BOOST_AUTO_TEST_CASE(MaxRPTreeTest)
 {
   typedef MaxRPTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;